@@ -24,13 +24,19 @@
  * \library       seq64rtcli application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2017-04-07
- * \updates       2018-04-22
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This application is seq64 without a GUI, control must be done via MIDI.
+ *
+ *  With "--batch" as the first option, it instead converts or checks many
+ *  MIDI and WRK files, without any MIDI engine, and exits.  See
+ *  seq64_batch().
  */
 
 #include <stdio.h>
+#include <stdlib.h>                     /* atoi(), EXIT_SUCCESS             */
+#include <string.h>                     /* strcmp()                         */
 
 #include "platform_macros.h"            /* determine the environment        */
 
@@ -39,6 +45,7 @@
 #include <unistd.h>
 #endif
 
+#include "batch_converter.hpp"          /* seq64::batch_converter           */
 #include "cmdlineopts.hpp"              /* command-line functions           */
 #include "daemonize.hpp"                /* seq64::daemonize()               */
 #include "file_functions.hpp"           /* seq64::file_accessible()         */
@@ -62,7 +69,15 @@
 static bool s_seq64cli_running = false;
 
 /**
- *  Provides a signal handler for exiting the application gracefully.
+ *  Set by SIGUSR1 to request that the output-thread statistics be written.
+ *  The main loop does the writing, not the signal handler.
+ */
+
+static volatile sig_atomic_t s_seq64cli_dump_stats = 0;
+
+/**
+ *  Provides a signal handler for exiting the application gracefully, and for
+ *  requesting a statistics dump.
  */
 
 static void
@@ -72,14 +87,126 @@ seq64_signal_handler (int signalnumber)
         s_seq64cli_running = false;
     else if (signalnumber == SIGTERM)
         s_seq64cli_running = false;
+    else if (signalnumber == SIGUSR1)
+        s_seq64cli_dump_stats = 1;
 }
 
 #endif  // PLATFORM_LINUX
 
+/**
+ *  Runs the batch mode, for nightly jobs that normalize many files without
+ *  starting a full instance of the application for each one.  The options
+ *  are:
+ *
+\verbatim
+    seq64cli --batch [ --output dir | --check ] [ --ppqn n ] [ --jobs n ]
+        [ --strip-seqspec ] [ --verbose ] file-or-directory ...
+\endverbatim
+ *
+ *  Each file, or each ".mid", ".midi", and ".wrk" file of each directory,
+ *  is loaded, then written to the output directory under the same name (a
+ *  WRK file becomes a ".midi" file).  "--ppqn" rescales the files, and
+ *  "--strip-seqspec" leaves out the Sequencer64 proprietary section.  SMF 0
+ *  files are split by channel, as usual.  "--check" only loads each file.
+ *  The configuration files are not read, so that the results do not depend
+ *  on the settings of the user running the job.
+ *
+ * \param argc
+ *      The number of command-line parameters.
+ *
+ * \param argv
+ *      The command-line parameters, with "--batch" at index 1.
+ *
+ * \return
+ *      Returns EXIT_SUCCESS if every file was processed, and EXIT_FAILURE
+ *      otherwise.
+ */
+
+static int
+seq64_batch (int argc, char * argv [])
+{
+    seq64::rc().set_defaults();             /* start out with normal values */
+    seq64::usr().set_defaults();            /* start out with normal values */
+
+    seq64::batch_converter batch;
+    bool ok = true;
+    bool havedir = false;
+    bool check = false;
+    bool verbose = false;
+    for (int i = 2; i < argc; ++i)
+    {
+        const char * arg = argv[i];
+        bool hasvalue = (i + 1) < argc;
+        if (strcmp(arg, "--output") == 0 && hasvalue)
+        {
+            batch.output_dir(argv[++i]);
+            havedir = true;
+        }
+        else if (strcmp(arg, "--ppqn") == 0 && hasvalue)
+        {
+            int ppqn = atoi(argv[++i]);
+            if (ppqn >= SEQ64_MINIMUM_PPQN && ppqn <= SEQ64_MAXIMUM_PPQN)
+                batch.ppqn(ppqn);
+            else
+            {
+                printf("? PPQN out of range: %d\n", ppqn);
+                ok = false;
+            }
+        }
+        else if (strcmp(arg, "--jobs") == 0 && hasvalue)
+            batch.threads(atoi(argv[++i]));
+        else if (strcmp(arg, "--strip-seqspec") == 0)
+            batch.seqspec(false);
+        else if (strcmp(arg, "--check") == 0)
+            check = true;
+        else if (strcmp(arg, "--verbose") == 0)
+            verbose = true;
+        else if (strcmp(arg, "--help") == 0)
+        {
+            printf
+            (
+                "Usage: seq64cli --batch [ --output dir | --check ] "
+                "[ --ppqn n ] [ --jobs n ]\n"
+                "           [ --strip-seqspec ] [ --verbose ] "
+                "file-or-directory ...\n"
+            );
+            return EXIT_SUCCESS;
+        }
+        else if (arg[0] == '-' && arg[1] == '-')
+        {
+            printf("? Unknown batch option: %s\n", arg);
+            ok = false;
+        }
+        else if (! batch.add_path(std::string(arg)))
+        {
+            printf("? File or directory not found: %s\n", arg);
+            ok = false;
+        }
+    }
+    if (ok && ! check && ! havedir)
+    {
+        printf("? Batch mode needs --output dir, or --check\n");
+        ok = false;
+    }
+    if (ok && batch.jobs().empty())
+    {
+        printf("? No MIDI or WRK files to process\n");
+        ok = false;
+    }
+    if (ok)
+    {
+        batch.check_only(check);
+        ok = batch.run();
+        batch.print_report(verbose);
+    }
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
 /**
  *  The standard C/C++ entry point to this application.  This first thing
- *  this function does is scan the argument vector and strip off all
- *  parameters known to GTK+.
+ *  this function does is check for the batch mode, which skips all of the
+ *  rest.  Then it scans the argument vector and strips off all parameters
+ *  known to GTK+.
  *
  *  The next thing is to set the various settings defaults, and then try to
  *  read the "user" and "rc" configuration files, in that order.  There are
@@ -117,6 +244,9 @@ seq64_signal_handler (int signalnumber)
 int
 main (int argc, char * argv [])
 {
+    if (argc > 1 && strcmp(argv[1], "--batch") == 0)
+        return seq64_batch(argc, argv);
+
 #ifdef PLATFORM_LINUX
     uint32_t usermask = 0;                  /* used only in daemonization   */
 #endif
@@ -219,9 +349,26 @@ main (int argc, char * argv [])
                 {
                     if (signal(SIGTERM, seq64_signal_handler) != SIG_ERR)
                     {
+                        (void) signal(SIGUSR1, seq64_signal_handler);
                         s_seq64cli_running = true;
                         while (s_seq64cli_running)
+                        {
                             usleep(1000000);
+
+                            std::string errmsg;         /* to the console   */
+                            (void) p.check_saves(errmsg);   /* autosave     */
+                            if (s_seq64cli_dump_stats)
+                            {
+                                std::string sf =
+                                    seq64::usr().option_statsfile();
+
+                                if (sf.empty())
+                                    sf = "seq64cli-stats.txt";
+
+                                s_seq64cli_dump_stats = 0;
+                                (void) p.write_statistics(sf);
+                            }
+                        }
                     }
                     else
                         printf("? Cannot set SIGTERM handler\n");
@@ -0,0 +1,220 @@
+#ifndef SEQ64_BATCH_CONVERTER_HPP
+#define SEQ64_BATCH_CONVERTER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          batch_converter.hpp
+ *
+ *  This module declares a class for converting or checking many MIDI and
+ *  WRK files at once, without any MIDI engine.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Each file is loaded by midifile or wrkfile into a perform object of its
+ *  own, which is never launched, so that no MIDI buss, and no ALSA or JACK
+ *  server, is needed.  The song is then written to the output directory,
+ *  optionally at another PPQN, and with or without the Sequencer64
+ *  proprietary section.  SMF 0 files are split into one pattern per
+ *  channel, as when they are opened in the application.  In check mode,
+ *  the files are only loaded, to find the ones that do not parse.
+ *
+ *  The files are handed out to a pool of worker threads.  The midifile
+ *  objects are isolated (see midifile::isolate()), so that the songs do not
+ *  share the global key, scale, and background sequence kept in usr().
+ */
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class midifile;
+    class perform;
+
+/**
+ *  Holds the list of files to process, the conversion settings, and the
+ *  outcome for each file.
+ */
+
+class batch_converter
+{
+
+public:
+
+    /**
+     *  The outcome of the processing of one file.
+     */
+
+    struct job
+    {
+        std::string m_input;        /**< The file to be read.               */
+        std::string m_output;       /**< The file written, if any.          */
+        bool m_ok;                  /**< True if the file was processed.    */
+        std::string m_error;        /**< The reason it was not.             */
+        long m_bytes;               /**< The size of the input file.        */
+        int m_patterns;             /**< The number of patterns loaded.     */
+        double m_seconds;           /**< The time the file took.            */
+    };
+
+private:
+
+    /**
+     *  The files to process, with their outcomes once run() is done.
+     */
+
+    std::vector<job> m_jobs;
+
+    /**
+     *  The directory for the converted files.  Must exist, and must not be
+     *  the directory of an input file.
+     */
+
+    std::string m_output_dir;
+
+    /**
+     *  The PPQN of the converted files, or SEQ64_USE_FILE_PPQN to keep the
+     *  PPQN of each file.
+     */
+
+    int m_ppqn;
+
+    /**
+     *  If true (the default), the Sequencer64 proprietary section is
+     *  written.  If false, it is stripped, leaving a plain MIDI file.
+     */
+
+    bool m_seqspec;
+
+    /**
+     *  If true, the files are only loaded, and nothing is written.
+     */
+
+    bool m_check_only;
+
+    /**
+     *  The number of worker threads.  0 means one per processor core.
+     */
+
+    int m_threads;
+
+    /**
+     *  The index of the next job to be taken by a worker.
+     */
+
+    std::atomic<int> m_next;
+
+    /**
+     *  The time the last run() took, in seconds.
+     */
+
+    double m_elapsed;
+
+public:
+
+    batch_converter ();
+
+    bool add_path (const std::string & path);
+    bool run ();
+    void print_report (bool verbose = false) const;
+
+    /**
+     * \setter m_output_dir
+     */
+
+    void output_dir (const std::string & dir)
+    {
+        m_output_dir = dir;
+    }
+
+    /**
+     * \setter m_ppqn
+     */
+
+    void ppqn (int p)
+    {
+        m_ppqn = p;
+    }
+
+    /**
+     * \setter m_seqspec
+     */
+
+    void seqspec (bool flag)
+    {
+        m_seqspec = flag;
+    }
+
+    /**
+     * \setter m_check_only
+     */
+
+    void check_only (bool flag)
+    {
+        m_check_only = flag;
+    }
+
+    /**
+     * \setter m_threads
+     */
+
+    void threads (int n)
+    {
+        m_threads = n > 0 ? n : 0 ;
+    }
+
+    /**
+     * \getter m_jobs
+     */
+
+    const std::vector<job> & jobs () const
+    {
+        return m_jobs;
+    }
+
+private:
+
+    void work ();
+    void process (job & j);
+    bool save (job & j, perform & p, const midifile & source);
+    bool rescale (job & j);
+    std::string output_name (const std::string & input) const;
+    int thread_count () const;
+
+};          // class batch_converter
+
+}           // namespace seq64
+
+#endif      // SEQ64_BATCH_CONVERTER_HPP
+
+/*
+ * batch_converter.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,15 +28,22 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-04-01
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This is actually an elegant little parser, and works well as long as one
  *  respects its limitations.
+ *
+ *  The file is read once, by index_lines(), into a list of lines, with an
+ *  index of the lines that start a section.  line_after() then finds a
+ *  section by a lookup, instead of rescanning the file from the start for
+ *  each of the many sections of the "rc" and "usr" files.
  */
 
 #include <fstream>
+#include <map>
 #include <string>
+#include <vector>
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -72,6 +79,35 @@ private:
 
     std::string m_error_message;
 
+    /**
+     *  The lines of the configuration file, without their newlines, as read
+     *  by index_lines().
+     */
+
+    std::vector<std::string> m_lines;
+
+    /**
+     *  Maps each section tag, such as "[midi-control]", to the number of the
+     *  line holding it.  If a tag appears more than once, the first line is
+     *  kept.
+     */
+
+    std::map<std::string, size_t> m_sections;
+
+    /**
+     *  The number of the next line to be read into m_line.
+     */
+
+    size_t m_line_index;
+
+    /**
+     *  Indicates that the last line of the file ends with a newline.  If it
+     *  does not, reading that line reaches the end of the file, as it does
+     *  with std::ifstream::getline().
+     */
+
+    bool m_last_line_ended;
+
 protected:
 
     /**
@@ -96,8 +132,10 @@ protected:
 
 protected:
 
-    bool next_data_line (std::ifstream & file);
-    bool line_after (std::ifstream & file, const std::string & tag);
+    void index_lines (std::ifstream & file);
+    bool next_data_line ();
+    bool line_after (const std::string & tag);
+    bool write_text (const std::string & text);
 
     /**
      *  Sometimes we need to know if there are new data lines at the end of an
@@ -113,6 +151,10 @@ protected:
         return m_line[0] == '[';
     }
 
+private:
+
+    bool read_line ();
+
 public:
 
     configfile (const std::string & name);
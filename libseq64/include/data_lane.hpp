@@ -0,0 +1,170 @@
+#ifndef SEQ64_DATA_LANE_HPP
+#define SEQ64_DATA_LANE_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          data_lane.hpp
+ *
+ *  This module declares the cached geometry of the data pane of the pattern
+ *  editor, one vertical bar per occupied pixel column.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The data panes (seqdata and qseqdata) used to walk the whole event list
+ *  on every paint, and draw a line and three digits for each matching
+ *  event, even the ones scrolled out of view.  With tens of thousands of
+ *  recorded controller events, scrolling the pane stutters.
+ *
+ *  A data_lane is built in one pass over the events, only when the edit
+ *  version, event count, length, zoom, or kind of event changes.  Events
+ *  that fall in the same pixel column are reduced to one bar, holding the
+ *  lowest and highest values in the column, the highest selected value,
+ *  and the value of the last event (the one that used to be drawn on top).
+ *  The bars are sorted by pixel column, so a pane finds the first visible
+ *  bar with a binary search, and draws only the visible bars, in a batch.
+ *  Scrolling moves the visible range; it does not rebuild the lane.
+ */
+
+#include <vector>                       /* std::vector                      */
+
+#include "midibyte.hpp"                 /* seq64::midipulse, midibyte       */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class sequence;
+
+/**
+ *  Holds the bars of one kind of event of a sequence, at one zoom.
+ */
+
+class data_lane
+{
+
+public:
+
+    /**
+     *  One occupied pixel column.  The heights are the values drawn, 0 to
+     *  127; for a tempo event, the tempo scaled by tempo_to_note_value().
+     */
+
+    struct bar
+    {
+        int x;                  /**< The pixel column, re 0 at tick 0.      */
+        int low;                /**< The lowest height in the column.       */
+        int high;               /**< The highest height in the column.      */
+        int selected_high;      /**< The highest selected height, or -1.    */
+        int value;              /**< The number to show, from the last one. */
+        int count;              /**< The number of events in the column.    */
+        bool tempo;             /**< True if the column holds a tempo.      */
+    };
+
+    /**
+     *  The bars, in increasing order of pixel column.
+     */
+
+    typedef std::vector<bar> Bars;
+
+private:
+
+    /**
+     *  The sequence the lane was built from, used only to detect a change
+     *  of sequence.
+     */
+
+    const sequence * m_seq;
+
+    /**
+     *  The edit version of the sequence when the lane was built.
+     */
+
+    unsigned long m_version;
+
+    /**
+     *  The event count of the sequence when the lane was built.
+     */
+
+    int m_event_count;
+
+    /**
+     *  The length of the sequence when the lane was built.
+     */
+
+    midipulse m_length;
+
+    /**
+     *  The zoom (ticks per pixel) of the lane.  Zero if nothing has been
+     *  built yet.
+     */
+
+    midipulse m_ticks_per_pixel;
+
+    /**
+     *  The status and controller of the events in the lane.
+     */
+
+    midibyte m_status;
+    midibyte m_cc;
+
+    /**
+     *  The occupied columns.
+     */
+
+    Bars m_bars;
+
+public:
+
+    data_lane ();
+
+    bool update
+    (
+        sequence & s, midipulse ticks_per_pixel, midibyte status, midibyte cc
+    );
+    void clear ();
+    int first_at (int x) const;
+
+    /**
+     * \getter m_bars
+     */
+
+    const Bars & bars () const
+    {
+        return m_bars;
+    }
+
+};          // class data_lane
+
+}           // namespace seq64
+
+#endif      // SEQ64_DATA_LANE_HPP
+
+/*
+ * data_lane.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
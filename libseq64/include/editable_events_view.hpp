@@ -0,0 +1,164 @@
+#ifndef SEQ64_EDITABLE_EVENTS_VIEW_HPP
+#define SEQ64_EDITABLE_EVENTS_VIEW_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          editable_events_view.hpp
+ *
+ *  This module declares a virtualized, index-based view of the events of a
+ *  sequence, for the event editor.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The editable_events container copies every event of the sequence into
+ *  an editable_event, and the edits are copied back wholesale when saved.
+ *  For a long recorded take (100000 events or more) that takes seconds and
+ *  a lot of memory.  This view instead keeps only an index (a vector of
+ *  iterators into the sequence's own event list), which is rebuilt cheaply
+ *  whenever the sequence changes, and makes editable_event rows only for
+ *  the lines actually shown.  The index gives constant-time access to any
+ *  row, for scrolling, and a binary search by time stamp, for jumping to a
+ *  time.  Edits go straight to the sequence, each one after a push_undo().
+ */
+
+#include <map>                          /* std::map                         */
+#include <vector>                       /* std::vector                      */
+
+#include "editable_events.hpp"          /* seq64::editable_events, etc.     */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class sequence;
+
+/**
+ *  Provides row-by-row access to the events of a sequence, as editable
+ *  events, without copying the whole sequence.
+ */
+
+class editable_events_view
+{
+
+private:
+
+    /**
+     *  The rows made so far, by index.  Trimmed to the neighborhood of the
+     *  visible lines by trim().
+     */
+
+    typedef std::map<int, editable_event> Rows;
+
+    /**
+     *  The sequence being viewed and edited.
+     */
+
+    sequence & m_sequence;
+
+    /**
+     *  An empty container of editable events.  It is never loaded; it
+     *  serves as the "parent" of each row, providing the MIDI timing used
+     *  to format and parse time stamps.
+     */
+
+    editable_events m_parent;
+
+    /**
+     *  One iterator per event of the sequence, in time order.
+     */
+
+    std::vector<event_list::const_iterator> m_index;
+
+    /**
+     *  The edit version of the sequence when the index was built.
+     */
+
+    unsigned long m_version;
+
+    /**
+     *  The event count of the sequence when the index was built, or -1 if
+     *  the index has not been built.
+     */
+
+    int m_count;
+
+    /**
+     *  The rows made for the lines shown so far.
+     */
+
+    Rows m_rows;
+
+private:
+
+    editable_events_view ();                            /* unimplemented    */
+    editable_events_view (const editable_events_view &);
+    editable_events_view & operator = (const editable_events_view &);
+
+public:
+
+    editable_events_view (sequence & seq, midibpm bpm);
+
+    bool refresh ();
+    int count ();
+    editable_event & row (int index);
+    int locate (midipulse tick);
+    int locate (const editable_event & e);
+    void trim (int top, int lines);
+    midipulse get_length ();
+
+    bool insert (const editable_event & e);
+    bool remove (int index);
+    bool modify (int index, const editable_event & e);
+
+    /**
+     * \getter m_parent
+     *      Needed to create new editable events to insert.
+     */
+
+    const editable_events & parent () const
+    {
+        return m_parent;
+    }
+
+private:
+
+    bool valid_index (int index)
+    {
+        return index >= 0 && index < count();
+    }
+
+};          // class editable_events_view
+
+}           // namespace seq64
+
+#endif      // SEQ64_EDITABLE_EVENTS_VIEW_HPP
+
+/*
+ * editable_events_view.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
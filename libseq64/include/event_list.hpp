@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2018-07-02
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This module extracts the event-list functionality from the sequencer
@@ -49,6 +49,7 @@
 
 #include <string>
 #include <stack>
+#include <utility>                      /* std::swap()                  */
 
 #include "seq64_features.h"             /* SEQ64_USE_EVENT_MAP          */
 
@@ -277,6 +278,7 @@ public:
     }
 
     bool append (const event & e);
+    event & append_sorted (const event & e);
 
 #ifdef SEQ64_USE_EVENT_MAP
 
@@ -358,6 +360,25 @@ public:
         m_is_modified = true;
     }
 
+    /**
+     *  Turns an iterator obtained through a const event_list, such as the
+     *  ones kept by the event editor, back into a plain iterator, in
+     *  constant time.  Erasing an empty range removes nothing.
+     *
+     * \param ie
+     *      Provides the iterator, which must belong to this container.
+     *
+     * \return
+     *      Returns the same position as a plain iterator.
+     */
+
+    iterator unconst (const_iterator ie)
+    {
+        return m_events.erase(ie, ie);
+    }
+
+    iterator insert_near (iterator hint, const event & e);
+
     /**
      *  Provides a wrapper for clear().  Sets the modified-flag.
      */
@@ -370,6 +391,23 @@ public:
 
     void merge (event_list & el, bool presort = true);
 
+    /**
+     *  Exchanges the events and flags of two lists in constant time.  The
+     *  events are not copied, so their links remain valid.  Any desired
+     *  thread-safety must be provided by the caller.
+     *
+     * \param el
+     *      The list to exchange with this one.
+     */
+
+    void swap (event_list & el)
+    {
+        m_events.swap(el.m_events);
+        std::swap(m_is_modified, el.m_is_modified);
+        std::swap(m_has_tempo, el.m_has_tempo);
+        std::swap(m_has_time_signature, el.m_has_time_signature);
+    }
+
     /**
      *  Sorts the event list; active only for the std::list implementation.
      */
@@ -0,0 +1,272 @@
+#ifndef SEQ64_EVENT_STREAM_HPP
+#define SEQ64_EVENT_STREAM_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_stream.hpp
+ *
+ *  This module declares a class for playing a MIDI track straight from its
+ *  file encoding, for patterns read with "-o stream".
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  A very long linear track, such as a whole song recorded as one pattern,
+ *  costs a heap node per event once it is loaded, and sequence::play()
+ *  walks the event list from its start in every output cycle.  With
+ *  "-o stream=kb", a track at least that large is read like a "-o lazy"
+ *  track, but it also gets an event_stream, which keeps the track in its
+ *  compact SMF encoding and decodes it only a little ahead of the
+ *  playhead, into a small window of fixed size.
+ *
+ *  When the stream is made, the track is scanned once to build a sparse
+ *  index, which holds the tick, byte offset, and running status at every
+ *  so many events.  A seek starts decoding at the nearest index mark
+ *  before the tick, so relocating costs at most that many events.  Normal
+ *  playback never seeks, since each output cycle starts where the last one
+ *  stopped.
+ *
+ *  Only the events that sequence::play() sends are decoded: the channel
+ *  messages, with a Note On of velocity 0 made a Note Off as in
+ *  midifile::parse_track(), and the Set Tempo events.  The stream is
+ *  dropped once the events of the pattern are loaded for drawing or
+ *  editing; see sequence::load_events().
+ *
+ *  An event_stream is not thread-safe.  It is used under the mutex of its
+ *  sequence.
+ */
+
+#include <memory>                       /* std::shared_ptr                  */
+#include <vector>                       /* std::vector                      */
+
+#include "midibyte.hpp"                 /* seq64::midibyte, midipulse       */
+
+/**
+ *  The default number of events decoded ahead of the playhead, at most,
+ *  each time the window runs dry.
+ */
+
+#define SEQ64_STREAM_WINDOW             64
+
+/**
+ *  The default number of events between the marks of the sparse index.
+ */
+
+#define SEQ64_STREAM_INDEX_SPACING      512
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Decodes one track of a MIDI file, in order, from any tick.
+ */
+
+class event_stream
+{
+
+public:
+
+    /**
+     *  One decoded event.  For a Set Tempo event, the status is
+     *  EVENT_MIDI_META and the tempo is in m_bpm.
+     */
+
+    struct message
+    {
+        midipulse m_tick;           /**< The time, in sequence pulses.      */
+        midibpm m_bpm;              /**< The tempo, for Set Tempo only.     */
+        midibyte m_status;          /**< The status, with the channel.      */
+        midibyte m_d0;              /**< The first data byte, if any.       */
+        midibyte m_d1;              /**< The second data byte, if any.      */
+    };
+
+private:
+
+    /**
+     *  An entry of the sparse index, holding the decoder state just before
+     *  an event.
+     */
+
+    struct mark
+    {
+        midipulse m_tick;           /**< The time of that event.            */
+        midipulse m_running_time;   /**< The file time before its delta.    */
+        size_t m_offset;            /**< The offset of its delta.           */
+        midibyte m_status;          /**< The running status before it.      */
+    };
+
+    /**
+     *  The track data, from the first event to the End-of-Track event.  It
+     *  is shared with the loader of the events, so the track is held only
+     *  once.  See midifile::defer_track_events().
+     */
+
+    std::shared_ptr<const midibyte> m_data;
+
+    /**
+     *  The size of m_data.
+     */
+
+    size_t m_size;
+
+    /**
+     *  The PPQN of the sequence, and the PPQN of the file.  If the file
+     *  PPQN is 0, the times are used as read.
+     */
+
+    int m_ppqn;
+    int m_file_ppqn;
+
+    /**
+     *  The sparse index, in order of tick.  The first mark is the start of
+     *  the track.
+     */
+
+    std::vector<mark> m_index;
+
+    /**
+     *  The decoded events not yet played.  Its capacity is set once, so
+     *  that decoding never allocates in the output thread.
+     */
+
+    std::vector<message> m_window;
+
+    /**
+     *  The number of events decoded into the window at a time.
+     */
+
+    size_t m_window_size;
+
+    /**
+     *  The index of the next event to hand out from m_window.
+     */
+
+    size_t m_next;
+
+    /**
+     *  The decoder state: the offset of the next byte, the file time, and
+     *  the running status.  True in m_done once the End-of-Track event, or
+     *  the end of the data, is reached.
+     */
+
+    size_t m_pos;
+    midipulse m_running_time;
+    midibyte m_status;
+    bool m_done;
+
+    /**
+     *  All events before this tick have been handed out, and none at or
+     *  after it.  A seek to this tick costs nothing.
+     */
+
+    midipulse m_cursor;
+
+    /**
+     *  The number of events the stream can play, counted by the scan.
+     */
+
+    int m_count;
+
+    /**
+     *  The time of the last event the stream can play, found by the scan.
+     */
+
+    midipulse m_last_tick;
+
+public:
+
+    event_stream
+    (
+        const std::shared_ptr<const midibyte> & data, size_t size,
+        int ppqn, int file_ppqn,
+        int window = SEQ64_STREAM_WINDOW,
+        int spacing = SEQ64_STREAM_INDEX_SPACING
+    );
+
+    void seek (midipulse tick);
+    const message * next (midipulse limit);
+
+    /**
+     * \getter m_count
+     */
+
+    int count () const
+    {
+        return m_count;
+    }
+
+    /**
+     * \getter m_last_tick
+     */
+
+    midipulse last_tick () const
+    {
+        return m_last_tick;
+    }
+
+    /**
+     * \getter m_index.size()
+     */
+
+    int index_size () const
+    {
+        return int(m_index.size());
+    }
+
+private:
+
+    void build_index (int spacing);
+    void restart (const mark & m);
+    const message * peek ();
+    void fill ();
+    bool decode (message & m);
+    bool read_byte (midibyte & b);
+    bool read_varinum (midilong & value);
+    bool skip (midilong count);
+
+    /**
+     *  Converts a time read from the file to sequence pulses, as done by
+     *  midifile::parse_track().
+     */
+
+    midipulse scaled (midipulse t) const
+    {
+        return m_file_ppqn > 0 ? t * m_ppqn / m_file_ppqn : t ;
+    }
+
+};          // class event_stream
+
+}           // namespace seq64
+
+#endif      // SEQ64_EVENT_STREAM_HPP
+
+/*
+ * event_stream.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
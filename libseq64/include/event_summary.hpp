@@ -0,0 +1,181 @@
+#ifndef SEQ64_EVENT_SUMMARY_HPP
+#define SEQ64_EVENT_SUMMARY_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_summary.hpp
+ *
+ *  This module declares a zoom-dependent summary of the events of a
+ *  sequence, used to draw very dense patterns quickly.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  When zoomed far out, hundreds of events can fall on the same pixel
+ *  column, and drawing each one costs far more than the column is worth.
+ *  This summary divides the sequence into "buckets" of one pixel each, and
+ *  records, for each bucket, which notes sound in it.  The piano roll then
+ *  draws one short run per note row, so the cost depends on the width in
+ *  pixels, not on the number of events.  (The data panes reduce their
+ *  events per pixel column with a data_lane.)
+ *
+ *  The summary is rebuilt, in one pass over the events, only when the edit
+ *  version, event count, or length changes, or when the view zooms in;
+ *  repeated paints of the same view reuse it.  Zooming out by a whole
+ *  factor merges the existing buckets instead.  Edits still rebuild the
+ *  whole summary, since the render snapshot does not say which notes
+ *  changed, and a rebuild costs one pass over the notes.  Selection is not
+ *  tracked, since individual notes are not distinguishable at these zoom
+ *  levels.
+ */
+
+#include <bitset>
+#include <vector>
+
+#include "globals.h"                    /* c_num_keys                       */
+#include "midibyte.hpp"                 /* seq64::midipulse, midibyte       */
+
+/**
+ *  The average number of events per pixel above which an editor should draw
+ *  from an event_summary instead of drawing each event.
+ */
+
+#define SEQ64_LOD_EVENTS_PER_PIXEL      4
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class sequence;
+
+/**
+ *  Holds the per-bucket summary of the notes of a sequence.
+ */
+
+class event_summary
+{
+
+public:
+
+    /**
+     *  The notes sounding in one bucket of the piano roll.
+     */
+
+    typedef std::bitset<c_num_keys> notes;
+
+private:
+
+    /**
+     *  The sequence summarized, used only to detect a change of sequence.
+     */
+
+    const sequence * m_seq;
+
+    /**
+     *  The edit version of the sequence when summarized.
+     */
+
+    unsigned long m_version;
+
+    /**
+     *  The event count of the sequence when summarized.
+     */
+
+    int m_event_count;
+
+    /**
+     *  The length of the sequence when summarized.
+     */
+
+    midipulse m_length;
+
+    /**
+     *  The number of ticks in each bucket, normally the zoom (ticks per
+     *  pixel) of the view.  Zero if nothing has been summarized yet.
+     */
+
+    midipulse m_bucket_ticks;
+
+    /**
+     *  The note buckets.
+     */
+
+    std::vector<notes> m_notes;
+
+public:
+
+    event_summary ();
+
+    static bool use_summary (const sequence & s, midipulse ticks_per_pixel);
+
+    bool update_notes (const sequence & s, midipulse bucket_ticks);
+    void clear ();
+
+    /**
+     * \getter m_bucket_ticks
+     */
+
+    midipulse bucket_ticks () const
+    {
+        return m_bucket_ticks;
+    }
+
+    /**
+     * \getter m_notes.size()
+     */
+
+    int bucket_count () const
+    {
+        return int(m_notes.size());
+    }
+
+    /**
+     *  Gets the notes of a bucket.  No bounds checking.
+     */
+
+    const notes & note_bucket (int b) const
+    {
+        return m_notes[b];
+    }
+
+private:
+
+    bool same_events (const sequence & s) const;
+    void merge (midipulse bucket_ticks);
+    void stamp (const sequence & s, midipulse bucket_ticks);
+    int bucket_of (midipulse tick) const;
+
+};          // class event_summary
+
+}           // namespace seq64
+
+#endif      // SEQ64_EVENT_SUMMARY_HPP
+
+/*
+ * event_summary.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -9,13 +9,14 @@
  *
  * \author        Chris Ahlstrom
  * \date          2015-11-20
- * \updates       2018-06-08
+ * \updates       2018-09-08
  * \version       $Revision$
  *
  *    Also see the file_functions.cpp module.
  */
 
 #include <string>
+#include <vector>
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -46,6 +47,11 @@ extern bool file_extension_match
 (
     const std::string & path, const std::string & target
 );
+extern bool list_directory
+(
+    const std::string & dirpath,
+    std::vector<std::string> & filenames
+);
 
 #endif      // SEQ64_FILE_FUNCTIONS_HPP
 
@@ -0,0 +1,167 @@
+#ifndef SEQ64_LAZY_LOADER_HPP
+#define SEQ64_LAZY_LOADER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          lazy_loader.hpp
+ *
+ *  This module declares the background thread that decodes the events of
+ *  patterns loaded with "-o lazy".
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  With "-o lazy", the MIDI file parser reads only the settings and
+ *  triggers of each track, and leaves the events to be decoded later by
+ *  sequence::load_events().  The GUI and the control code call that
+ *  function directly when they need the events at once.  The output thread
+ *  must not decode anything, so it only asks for the events, by setting an
+ *  atomic flag; the thread here picks the request up within a few
+ *  milliseconds.  The thread also decodes the patterns of the current
+ *  screen-set ahead of time, so that they are usually ready before anybody
+ *  asks.
+ *
+ *  The thread is started the first time there is something to load, so a
+ *  file loaded normally never starts it.
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "globals.h"                    /* c_max_sequence                   */
+#include "mutex.hpp"                    /* seq64::mutex, automutex          */
+
+/**
+ *  How long, in milliseconds, the loader thread sleeps between checks for
+ *  requests that were posted without waking it up.
+ */
+
+#define SEQ64_LAZY_LOADER_POLL_MS       5
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Holds the requests for decoding and the thread that serves them.  There
+ *  is one of these, owned by the perform object.
+ */
+
+class lazy_loader
+{
+
+private:
+
+    /**
+     *  The performance whose sequences are loaded.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  True for each sequence whose events are wanted.
+     */
+
+    std::atomic<bool> m_wanted[c_max_sequence];
+
+    /**
+     *  True if any of the m_wanted flags might be set.
+     */
+
+    std::atomic<bool> m_any_wanted;
+
+    /**
+     *  Tells the thread to exit.
+     */
+
+    std::atomic<bool> m_stop;
+
+    /**
+     *  Held while a sequence is being loaded.  The performance holds it
+     *  while deleting a sequence, so that a sequence is never deleted under
+     *  the loader.
+     */
+
+    mutex m_load_mutex;
+
+    /**
+     *  Protects the start and stop of the thread, and the waiting.
+     */
+
+    std::mutex m_thread_mutex;
+
+    /**
+     *  Wakes up the thread for requests made outside the output thread.
+     */
+
+    std::condition_variable m_wakeup;
+
+    /**
+     *  The loader thread, started by prefetch().
+     */
+
+    std::thread m_thread;
+
+public:
+
+    lazy_loader (perform & p);
+    ~lazy_loader ();
+
+    void request (int seq);
+    void prefetch (int first, int count);
+    void stop ();
+
+    /**
+     * \getter m_load_mutex
+     */
+
+    mutex & load_mutex ()
+    {
+        return m_load_mutex;
+    }
+
+private:
+
+    void run ();
+
+    lazy_loader (const lazy_loader &);              /* no copying       */
+    lazy_loader & operator = (const lazy_loader &); /* no copying       */
+
+};          // class lazy_loader
+
+}           // namespace seq64
+
+#endif      // SEQ64_LAZY_LOADER_HPP
+
+/*
+ * lazy_loader.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
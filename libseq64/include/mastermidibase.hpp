@@ -36,6 +36,7 @@
  *  PortMidi.
  */
 
+#include <atomic>                       /* std::atomic<> event counter      */
 #include <vector>                       /* for channel-filtered recording   */
 
 #include "businfo.hpp"                  /* seq64::businfo & busarray        */
@@ -155,6 +156,14 @@ protected:
 
     sequence * m_seq;
 
+    /**
+     *  Counts the events sent out via play().  Used by the output thread to
+     *  tally the events emitted per frame (see the rt_statistics class).  It
+     *  is atomic so that it can be read without taking m_mutex.
+     */
+
+    std::atomic<unsigned long> m_events_played;
+
     /**
      *  The locking mutex.  This object is passed to an automutex object that
      *  lends exception-safety to the mutex locking.
@@ -288,6 +297,17 @@ public:
         return m_seq;
     }
 
+    /**
+     * \getter m_events_played
+     *      A running count that wraps around; callers should use only the
+     *      difference between two readings.
+     */
+
+    unsigned long events_played () const
+    {
+        return m_events_played.load(std::memory_order_relaxed);
+    }
+
     void start ();
     void stop ();
     void port_start (int client, int port);
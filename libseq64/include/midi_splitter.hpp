@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-24
- * \updates       2018-08-01
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Sequencer64 can also split an SMF 0 file into multiple tracks, effectively
@@ -39,6 +39,7 @@
 #include <map>
 
 #include "globals.h"                    /* SEQ64_USE_DEFAULT_PPQN   */
+#include "midibyte.hpp"                 /* seq64::midipulse         */
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -46,6 +47,7 @@
 
 namespace seq64
 {
+    class event_list;                   /* forward reference        */
     class perform;                      /* forward reference        */
     class sequence;                     /* forward reference        */
 
@@ -112,11 +114,19 @@ public:
 
 private:
 
+    void route_events
+    (
+        const sequence & main_seq,
+        event_list * channel_events,
+        midipulse * channel_lengths
+    );
     bool split_channel
     (
         const sequence & main_seq,
         sequence * seq,
-        int channel
+        int channel,
+        event_list & evl,
+        midipulse length_in_ticks
     );
 
 };          // class midi_splitter
@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-03
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The Seq24 MIDI file is a standard, Format 1 MIDI file, with some extra
@@ -41,8 +41,15 @@
  *
  *  Sequencer64 can also split an SMF 0 file into multiple tracks, effectively
  *  converting it to SMF 1.
+ *
+ *  An SMF 1 file with many tracks can be parsed in parallel:  the track
+ *  chunks are located first, from their length fields, then decoded,
+ *  sorted, and linked by a few worker threads, and finally added to the
+ *  performance in file order.  See parse_tracks_parallel().
  */
 
+#include <atomic>                       /* std::atomic<int>                 */
+#include <iosfwd>                       /* std::istream, std::ifstream      */
 #include <string>
 #include <list>
 #include <vector>
@@ -72,6 +79,21 @@
 
 #define SEQ64_TRACKNAME_MAX          256
 
+/**
+ *  The smallest number of tracks for which an SMF 1 file is parsed by
+ *  several threads.  Below this, starting the threads costs more than it
+ *  saves.
+ */
+
+#define SEQ64_PARALLEL_TRACKS_MIN      8
+
+/**
+ *  Indicates to use one parsing thread per processor core.  See
+ *  midifile::parse_threads().
+ */
+
+#define SEQ64_PARSE_THREADS_AUTO       0
+
 /**
  *  The maximum allowed variable length value for a MIDI file, which allows
  *  the length to fit in a 32-bit integer.
@@ -132,6 +154,7 @@ namespace seq64
 
     class midi_splitter;
     class perform;
+    class song_image;
 
 #if defined SEQ64_USE_MIDI_VECTOR
     class midi_vector;
@@ -150,6 +173,60 @@ class midifile
 
 private:
 
+    /**
+     *  Holds the settings found in a track that belong to the performance,
+     *  not to the sequence:  the tempo and the time signature.  The
+     *  parse_track() function fills it in, and apply_track_meta() hands it
+     *  to the performance, so that a track can be decoded without touching
+     *  the performance.
+     */
+
+    struct track_meta
+    {
+        double tempo_us;            /**< First tempo of the track, or 0.    */
+        bool timesig;               /**< True if an FF 58 event was used.   */
+        int beats_per_bar;          /**< The FF 58 beats/bar.               */
+        int beat_width;             /**< The FF 58 beat width.              */
+        int clocks_per_metronome;   /**< The FF 58 MIDI clocks per click.   */
+        int thirtyseconds;          /**< The FF 58 32nds per quarter note.  */
+        bool seqspec_timesig;       /**< True if a c_timesig was read.      */
+        int seqspec_beats_per_bar;  /**< The c_timesig beats/bar.           */
+        int seqspec_beat_width;     /**< The c_timesig beat width.          */
+
+        track_meta ()
+         :
+            tempo_us                (0.0),
+            timesig                 (false),
+            beats_per_bar           (0),
+            beat_width              (0),
+            clocks_per_metronome    (0),
+            thirtyseconds           (0),
+            seqspec_timesig         (false),
+            seqspec_beats_per_bar   (0),
+            seqspec_beat_width      (0)
+        {
+            // Empty body
+        }
+    };
+
+    /**
+     *  Describes one track chunk for a parallel parse:  where its data lies
+     *  in the file, and what decoding it produced.
+     */
+
+    struct track_chunk
+    {
+        midilong id;                /**< The chunk tag, normally 'MTrk'.    */
+        size_t offset;              /**< The offset of the chunk data.      */
+        size_t length;              /**< The length of the chunk data.      */
+        sequence * seq;             /**< The decoded track, null if none.   */
+        midishort seqnum;           /**< Sequence number read from track.   */
+        bool ok;                    /**< False if the decoding failed.      */
+        track_meta meta;            /**< Performance settings of the track. */
+        std::string error;          /**< Last error from decoding, if any.  */
+        bool error_is_fatal;        /**< Indicates how bad that error is.   */
+    };
+
     /**
      *  Provides locking for the sequence.  Made mutable for use in
      *  certain locked getter functions.
@@ -160,7 +237,8 @@ private:
     /**
      *  Holds the size of the MIDI file.  This variable was added when loading
      *  a file that caused an attempt to load data well beyond the file-size
-     *  of the midicvt test file Dixie04.mid.
+     *  of the midicvt test file Dixie04.mid.  In a track reader, or in a
+     *  wrkfile, it is the size of the chunk held in m_data.
      */
 
     size_t m_file_size;
@@ -196,6 +274,15 @@ private:
 
     size_t m_pos;
 
+    /**
+     *  The offset in the MIDI file of the first byte of m_data.  It is 0,
+     *  except in the track readers made by parse_tracks_parallel(), which
+     *  hold only one track chunk, and in a wrkfile, which reads the file one
+     *  chunk at a time (see read_window()).  Used only in error messages.
+     */
+
+    size_t m_base_pos;
+
     /**
      *  The unchanging name of the MIDI file.
      */
@@ -271,6 +358,83 @@ private:
 
     midi_splitter m_smf0_splitter;
 
+    /**
+     *  The number of threads to use in parsing an SMF 1 file with at least
+     *  SEQ64_PARALLEL_TRACKS_MIN tracks.  SEQ64_PARSE_THREADS_AUTO (0) uses
+     *  one per processor core, and 1 parses the tracks one after another,
+     *  as in seq24.
+     */
+
+    int m_parse_threads;
+
+    /**
+     *  If true, the events of SMF 1 tracks are not decoded when the file is
+     *  read, only the settings and triggers.  Each sequence decodes its
+     *  events the first time they are needed.  Set by "-o lazy".
+     */
+
+    bool m_lazy_events;
+
+    /**
+     *  If not 0, the events of SMF 1 tracks at least this many bytes long
+     *  are not decoded when the file is read, as with m_lazy_events, and
+     *  are played straight from the track data until they are needed for
+     *  drawing or editing.  Set by "-o stream=kb".  See event_stream.
+     */
+
+    size_t m_stream_bytes;
+
+    /**
+     *  Set if the proprietary track of the file held the mute groups.
+     */
+
+    bool m_has_mute_groups;
+
+    /**
+     *  Set if the proprietary track of the file held the global musical
+     *  key, scale, or background sequence.
+     */
+
+    bool m_has_global_bgs;
+
+    /**
+     *  Set if the proprietary track of the file held a tempo track number
+     *  that was set into the performance.
+     */
+
+    bool m_has_tempo_track;
+
+    /**
+     *  If true, the global key, scale, and background sequence of the song
+     *  are kept in the three members below, instead of being stored into
+     *  usr() when read and taken from usr() when written.  Used by the
+     *  batch_converter, which handles many songs at once.  See isolate().
+     */
+
+    bool m_isolated;
+
+    /**
+     *  The global musical key of an isolated song.
+     */
+
+    int m_music_key;
+
+    /**
+     *  The global musical scale of an isolated song.
+     */
+
+    int m_music_scale;
+
+    /**
+     *  The global background sequence of an isolated song.
+     */
+
+    int m_bg_sequence;
+
+private:
+
+    midifile (const midifile & parent, size_t offset, size_t length);
+
 public:
 
     midifile
@@ -284,6 +448,8 @@ public:
 
     virtual bool parse (perform & p, int screenset = 0, bool importing = false);
     virtual bool write (perform & p, bool doseqspec = true);
+    bool capture (perform & p, song_image & image, bool doseqspec = true);
+    bool write (const song_image & image, const perform & p);
 
 #ifdef SEQ64_STAZED_EXPORT_SONG
     bool write_song (perform & p);
@@ -330,6 +496,97 @@ public:
         return m_file_ppqn;
     }
 
+    /**
+     * \getter m_parse_threads
+     */
+
+    int parse_threads () const
+    {
+        return m_parse_threads;
+    }
+
+    /**
+     * \setter m_parse_threads
+     *
+     * \param n
+     *      The number of parsing threads, SEQ64_PARSE_THREADS_AUTO for one
+     *      per processor core, or 1 for the legacy, serial parse.
+     */
+
+    void parse_threads (int n)
+    {
+        m_parse_threads = n >= 0 ? n : SEQ64_PARSE_THREADS_AUTO ;
+    }
+
+    /**
+     * \getter m_lazy_events
+     */
+
+    bool lazy_events () const
+    {
+        return m_lazy_events;
+    }
+
+    /**
+     * \setter m_lazy_events
+     */
+
+    void lazy_events (bool flag)
+    {
+        m_lazy_events = flag;
+    }
+
+    /**
+     * \getter m_stream_bytes
+     */
+
+    size_t stream_bytes () const
+    {
+        return m_stream_bytes;
+    }
+
+    /**
+     * \setter m_stream_bytes
+     *
+     * \param bytes
+     *      The size from which a track is streamed, or 0 for none.
+     */
+
+    void stream_bytes (size_t bytes)
+    {
+        m_stream_bytes = bytes;
+    }
+
+    /**
+     * \getter m_has_mute_groups
+     */
+
+    bool has_mute_groups () const
+    {
+        return m_has_mute_groups;
+    }
+
+    /**
+     * \getter m_has_global_bgs
+     */
+
+    bool has_global_bgs () const
+    {
+        return m_has_global_bgs;
+    }
+
+    /**
+     * \getter m_has_tempo_track
+     */
+
+    bool has_tempo_track () const
+    {
+        return m_has_tempo_track;
+    }
+
+    void isolate ();
+    void isolate (const midifile & source);
+
     /**
      * \getter m_pos
      *
@@ -348,6 +605,7 @@ protected:
     (
         perform & p, sequence & seq, int seqnum, int screenset
     );
+    void link_sequence (sequence & seq);
 
     /**
      * \setter m_error_message
@@ -389,9 +647,88 @@ protected:
         return m_pos >= m_file_size;
     }
 
+    /**
+     * \getter m_file_size
+     *
+     *  The size of the file, or of the chunk currently held in m_data.
+     */
+
+    size_t file_size () const
+    {
+        return m_file_size;
+    }
+
+    /**
+     * \getter m_disable_reported
+     */
+
+    bool disable_reported () const
+    {
+        return m_disable_reported;
+    }
+
+    /**
+     * \setter m_disable_reported
+     *
+     *  Setting it to true makes reads past the end of m_data return 0
+     *  silently.
+     */
+
+    void disable_reported (bool flag)
+    {
+        m_disable_reported = flag;
+    }
+
+    bool open_input_stream (const std::string & tag, std::ifstream & file);
     bool grab_input_stream (const std::string & tag);
+    size_t read_window (std::istream & file, size_t offset, size_t length);
     bool parse_smf_0 (perform & p, int screenset);
     bool parse_smf_1 (perform & p, int screenset, bool is_smf0 = false);
+    bool parse_track
+    (
+        sequence & seq, int track, midishort & seqnum,
+        track_meta & meta, bool is_smf0, bool events = true
+    );
+    void defer_track_events
+    (
+        sequence & seq, int track, size_t offset, size_t length
+    );
+
+    /**
+     * \return
+     *      Returns true if the events of a track of the given size are to
+     *      be decoded later, for "-o lazy" or "-o stream=kb".
+     */
+
+    bool lazy_track (size_t length) const
+    {
+        return m_lazy_events || is_streamed(length);
+    }
+
+    /**
+     * \return
+     *      Returns true if a track of the given size is to be streamed.
+     */
+
+    bool is_streamed (size_t length) const
+    {
+        return m_stream_bytes > 0 && length >= m_stream_bytes;
+    }
+    bool load_track_events (int track, sequence & scratch);
+    void apply_track_meta
+    (
+        perform & p, sequence & seq, int track, const track_meta & meta
+    );
+    int parse_thread_count (int numtracks) const;
+    bool scan_tracks (int numtracks, std::vector<track_chunk> & chunks);
+    bool parse_tracks_parallel
+    (
+        perform & p, int screenset, std::vector<track_chunk> & chunks
+    );
+    void decode_tracks
+    (
+        std::vector<track_chunk> & chunks, std::atomic<int> & next
+    );
     midilong parse_prop_header (int file_size);
     bool parse_proprietary_track (perform & a_perf, int file_size);
     bool checklen (midilong len, midibyte type);
@@ -403,6 +740,7 @@ protected:
     midilong read_varinum ();
     bool read_byte_array (midibyte * b, size_t len);
     bool read_byte_array (midistring & b, size_t len);
+    std::string read_cstring (size_t maxlen);
     void read_gap (size_t sz);
 
     void write_long (midilong value);
@@ -429,6 +767,7 @@ protected:
     int read_seq_number ();
     void write_track_end ();
     bool write_header (int numtracks);
+    bool write_file ();
 #ifdef USE_WRITE_START_TEMPO
     void write_start_tempo (midibpm start_tempo);
 #endif
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-05
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This class still has way too many members, even with the JACK and
@@ -57,9 +57,14 @@
 #include "jack_assistant.hpp"           /* optional seq64::jack_assistant   */
 #include "gui_assistant.hpp"            /* seq64::gui_assistant             */
 #include "keys_perform.hpp"             /* seq64::keys_perform              */
+#include "lazy_loader.hpp"              /* seq64::lazy_loader               */
 #include "mastermidibus.hpp"            /* seq64::mastermidibus for ALSA    */
 #include "midi_control.hpp"             /* seq64::midi_control "struct"     */
+#include "rt_command.hpp"               /* seq64::rt_command_queue          */
+#include "rt_notify.hpp"                /* seq64::rt_notify, change_t       */
+#include "rt_statistics.hpp"            /* seq64::rt_statistics             */
 #include "sequence.hpp"                 /* seq64::sequence                  */
+#include "song_saver.hpp"               /* seq64::song_saver                */
 
 #ifdef SEQ64_SONG_BOX_SELECT
 #include <functional>                   /* std::function, function objects  */
@@ -254,6 +259,7 @@ struct performcallback
 
 class perform
 {
+    friend class benchmark;             // tests/seq64bench.cpp
     friend class jack_assistant;
     friend class keybindentry;
     friend class mainwnd;
@@ -264,6 +270,7 @@ class perform
     friend class perfedit;
     friend class perfroll;
     friend class sequence;              // for setting tempo from events
+    friend class session_snapshot;      // reads and writes the song state
     friend void * input_thread_func (void * myperf);
     friend void * output_thread_func (void * myperf);
 
@@ -667,10 +674,11 @@ private:
     /**
      *  Indicates that playback is running.  However, this flag is conflated
      *  with some JACK support, and we have to supplement it with another
-     *  flag, m_is_pattern_playing.
+     *  flag, m_is_pattern_playing.  Atomic, since the GUI, input, and output
+     *  threads all read it.
      */
 
-    bool m_is_running;
+    std::atomic<bool> m_is_running;
 
     /**
      *  Indicates that a pattern is playing.  It replaces rc_settings ::
@@ -682,17 +690,19 @@ private:
 
     /**
      *  Indicates that events are being written to the MIDI input busses in
-     *  the input thread.
+     *  the input thread.  Atomic, since it is cleared by another thread to
+     *  stop the input thread.
      */
 
-    bool m_inputing;
+    std::atomic<bool> m_inputing;
 
     /**
      *  Indicates that events are being written to the MIDI output busses in
-     *  the output thread.
+     *  the output thread.  Atomic, since it is cleared by another thread to
+     *  stop the output thread.
      */
 
-    bool m_outputing;
+    std::atomic<bool> m_outputing;
 
     /**
      *  Indicates that status of the "loop" button in the performance editor.
@@ -756,6 +766,15 @@ private:
 
     midibpm m_bpm;
 
+    /**
+     *  Holds the last BPM asked for by set_beats_per_minute().  While the
+     *  engine runs, the change is applied by the output thread, so m_bpm
+     *  and the master buss can lag behind by a frame.  This value is set at
+     *  once, so that the user interface can build on it.
+     */
+
+    std::atomic<midibpm> m_pending_bpm;
+
     /**
      *  Holds the beats/bar value as obtained from the MIDI file.
      *  The default value is SEQ64_DEFAULT_BEATS_PER_MEASURE (4).
@@ -813,6 +832,43 @@ private:
 
     mastermidibus * m_master_bus;
 
+    /**
+     *  Holds the timing statistics of the output thread.  These are always
+     *  collected; they are cheap and lock-free.  See the rt_statistics
+     *  module.
+     */
+
+    rt_statistics m_rt_stats;
+
+    /**
+     *  Holds the changes posted for the user interface, which drains them
+     *  instead of polling the dirty flags.  See the rt_notify module.
+     */
+
+    rt_notify m_changes;
+
+    /**
+     *  Holds the state changes posted by the user interface and the control
+     *  surfaces, which the output thread applies at the start of each frame.
+     *  See the rt_command module, and post_command().
+     */
+
+    rt_command_queue m_commands;
+
+    /**
+     *  Decodes the events of patterns loaded with "-o lazy" in the
+     *  background.  See the lazy_loader module.
+     */
+
+    lazy_loader m_lazy_loader;
+
+    /**
+     *  Writes the songs saved by File / Save, and the autosaves, in the
+     *  background.  See the song_saver module.
+     */
+
+    song_saver m_song_saver;
+
     /**
      *  Provides storage for this "rc" configuration option so that the
      *  perform object can set it in the master buss once that has been
@@ -956,6 +1012,14 @@ private:
 
     int m_screenset;
 
+    /**
+     *  Holds the last screen-set asked for by set_screenset().  Like
+     *  m_pending_bpm, it is set at once, while m_screenset is changed by the
+     *  output thread when the engine is running.
+     */
+
+    std::atomic<int> m_pending_screenset;
+
     /**
      *  Holds the current sequence-number offset for the current screen-set.
      *  Saves some multiplications.  It is used in the MIDI control of the
@@ -1041,6 +1105,14 @@ private:
 
     bool m_is_modified;
 
+    /**
+     *  Set once a tempo event from track 0 of a MIDI file has set the tempo
+     *  of this performance.  Only the first file read sets it, so that an
+     *  imported file does not change the tempo.  Used by midifile.
+     */
+
+    bool m_file_tempo_set;
+
 #ifdef SEQ64_SONG_BOX_SELECT
 
     /**
@@ -1162,6 +1234,17 @@ public:
         return m_bpm;
     }
 
+    /**
+     * \getter m_pending_bpm
+     *      The tempo most recently set, whether or not the engine has applied
+     *      it yet.
+     */
+
+    midibpm pending_beats_per_minute () const
+    {
+        return m_pending_bpm.load();
+    }
+
     /**
      * \getter m_sequence_count
      *      It is better to call this getter before bothering to even try to
@@ -1449,6 +1532,80 @@ public:
         return *m_master_bus;
     }
 
+    /**
+     * \getter m_master_bus
+     *      The pointer version, for callers that must cope with a perform
+     *      object that has not been launched, and thus has no buss yet.
+     */
+
+    mastermidibus * master_bus_pointer ()
+    {
+        return m_master_bus;
+    }
+
+    /**
+     * \getter m_rt_stats
+     *      The statistics can be read from any thread.
+     */
+
+    const rt_statistics & rt_stats () const
+    {
+        return m_rt_stats;
+    }
+
+    bool write_statistics (const std::string & filename) const;
+
+    /**
+     * \getter m_changes
+     *      The GUI thread drains the changes and watches the wake-up pipe.
+     */
+
+    rt_notify & changes ()
+    {
+        return m_changes;
+    }
+
+    /**
+     *  Posts a change for the user interface.  Safe to call from any thread.
+     *
+     * \param change
+     *      The kind of change.
+     *
+     * \param seq
+     *      The sequence that changed, if applicable, or -1.
+     */
+
+    void post_change (change_t change, int seq = -1)
+    {
+        m_changes.post(change, seq);
+    }
+
+    bool post_command
+    (
+        command_t command, int value = 0,
+        bool flag = false, midibpm bpm = 0.0
+    );
+    void apply_commands ();
+
+    /**
+     *  Asks for the events of a sequence loaded with "-o lazy" to be decoded
+     *  in the background.  Never blocks, so it is safe to call from the
+     *  output thread.
+     *
+     * \param seq
+     *      The sequence whose events are wanted.
+     */
+
+    void request_events (int seq)
+    {
+        m_lazy_loader.request(seq);
+    }
+
+    void prefetch_screenset (int ss);
+    void load_triggered_events ();
+    void save_song (song_image * image);
+    bool check_saves (std::string & errmsg);
+
     /**
      * \setter m_master_bus.filter_by_channel()
      */
@@ -2373,6 +2530,17 @@ public:
         return m_screenset;
     }
 
+    /**
+     * \getter m_pending_screenset
+     *      The screen-set most recently set, whether or not the engine has
+     *      applied it yet.
+     */
+
+    int pending_screenset () const
+    {
+        return m_pending_screenset.load();
+    }
+
     /**
      * \getter m_playscreen
      */
@@ -2755,26 +2923,8 @@ private:
     void select_and_mute_group (int g_group);
     void set_song_mute (mute_op_t op);
     void set_playing_screenset ();
-
-    /**
-     * \setter m_mode_group
-     */
-
-    void set_mode_group_mute ()
-    {
-        m_mode_group = true;
-    }
-
-    /**
-     * \setter m_mode_group
-     *      Unsets this member.
-     */
-
-    void unset_mode_group_mute ()
-    {
-        m_mode_group = false;
-    }
-
+    void set_mode_group_mute ();
+    void unset_mode_group_mute ();
     void select_group_mute (int gmute);
     void set_mode_group_learn ();
     void unset_mode_group_learn ();
@@ -2805,6 +2955,13 @@ private:
 
     void launch_input_thread ();
     void launch_output_thread ();
+    void apply_command (const rt_command & c);
+    void apply_playing_toggle (int seq);
+    void apply_group_learn (bool flag);
+    void apply_screenset (int ss);
+#ifdef SEQ64_SONG_RECORDING
+    void song_record_toggle (sequence * s);
+#endif
     bool init_jack_transport ();
     bool deinit_jack_transport ();
     bool seq_in_playing_screen (int seq);
@@ -0,0 +1,202 @@
+#ifndef SEQ64_RENDER_SNAPSHOT_HPP
+#define SEQ64_RENDER_SNAPSHOT_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          render_snapshot.hpp
+ *
+ *  This module declares an immutable copy of the drawable notes of a
+ *  sequence, shared by all of the views that draw the sequence.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The pattern editors, the song editor, and the live grid used to draw a
+ *  sequence by walking its event list with reset_draw_marker() and
+ *  get_next_note_event().  That walk uses an iterator stored in the
+ *  sequence, so two windows drawing the same pattern at the same time
+ *  disturb each other, and every step of the walk takes the sequence mutex,
+ *  contending with playback and recording.
+ *
+ *  A render_snapshot is built, under the sequence mutex, once per edit
+ *  version of the sequence, by sequence::snapshot().  It holds what
+ *  get_next_note_event() would return, in the same order, plus the lowest
+ *  and highest notes.  It is never modified after it is built, and it is
+ *  handed out as a shared pointer, so any number of views, in any thread,
+ *  can walk it without locking, and it stays valid for as long as a view
+ *  holds on to it, even if the sequence has moved on to a newer version.
+ */
+
+#include <memory>                       /* std::shared_ptr                  */
+#include <vector>                       /* std::vector                      */
+
+#include "midibyte.hpp"                 /* seq64::midipulse                 */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class event_list;
+
+/**
+ *  Provides the methods for drawing the notes of a sequence.  These values
+ *  are used in the sequence, render_snapshot, and the pattern, song, and
+ *  live-grid views.
+ */
+
+enum draw_type_t
+{
+    DRAW_FIN = 0,           /**< Indicates that drawing is finished.        */
+    DRAW_NORMAL_LINKED,     /**< Used for drawing linked notes.             */
+    DRAW_NOTE_ON,           /**< For starting the drawing of a note.        */
+    DRAW_NOTE_OFF,          /**< For finishing the drawing of a note.       */
+    DRAW_TEMPO              /**< For drawing tempo meta events.             */
+};
+
+/**
+ *  Holds the drawable notes of one version of a sequence.
+ */
+
+class render_snapshot
+{
+
+public:
+
+    /**
+     *  One drawable item, with the values that get_next_note_event()
+     *  returns for it.
+     */
+
+    struct note
+    {
+        midipulse tick_s;       /**< The start time of the note.            */
+        midipulse tick_f;       /**< The end time of a linked note, or 0.   */
+        int key;                /**< The note value, or the scaled tempo.   */
+        int velocity;           /**< The velocity of the note.              */
+        bool selected;          /**< True if the note is selected.          */
+        draw_type_t type;       /**< How to draw the note.                  */
+    };
+
+    /**
+     *  The list of drawable notes, in event order.
+     */
+
+    typedef std::vector<note> Notes;
+
+    /**
+     *  The type of the pointer to a snapshot that is handed to the views.
+     */
+
+    typedef std::shared_ptr<const render_snapshot> pointer;
+
+private:
+
+    /**
+     *  The edit version of the sequence when the snapshot was built.
+     */
+
+    unsigned long m_version;
+
+    /**
+     *  The length of the sequence when the snapshot was built.
+     */
+
+    midipulse m_length;
+
+    /**
+     *  The drawable notes.
+     */
+
+    Notes m_notes;
+
+    /**
+     *  The lowest and highest notes, including the scaled tempo values, as
+     *  per sequence::get_minmax_note_events().  If there are no notes,
+     *  m_lowest is greater than m_highest.
+     */
+
+    int m_lowest;
+    int m_highest;
+
+public:
+
+    render_snapshot
+    (
+        const event_list & evl, midipulse length, unsigned long version
+    );
+
+    /**
+     * \getter m_version
+     */
+
+    unsigned long version () const
+    {
+        return m_version;
+    }
+
+    /**
+     * \getter m_length
+     */
+
+    midipulse length () const
+    {
+        return m_length;
+    }
+
+    /**
+     * \getter m_notes
+     */
+
+    const Notes & notes () const
+    {
+        return m_notes;
+    }
+
+    /**
+     *  Gets the note range, as per sequence::get_minmax_note_events().
+     *
+     * \return
+     *      Returns false if there are no notes or tempo events.
+     */
+
+    bool minmax (int & lowest, int & highest) const
+    {
+        lowest = m_lowest;
+        highest = m_highest;
+        return m_lowest <= m_highest;
+    }
+
+};          // class render_snapshot
+
+}           // namespace seq64
+
+#endif      // SEQ64_RENDER_SNAPSHOT_HPP
+
+/*
+ * render_snapshot.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
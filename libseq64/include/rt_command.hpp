@@ -0,0 +1,222 @@
+#ifndef SEQ64_RT_COMMAND_HPP
+#define SEQ64_RT_COMMAND_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_command.hpp
+ *
+ *  This module declares the queue of commands that the user interface and
+ *  the control surfaces send to the engine.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Mute toggles, mute groups, screen-set changes, the control status, and
+ *  the tempo used to be changed directly by the GUI and input threads,
+ *  while the output thread was reading the same state.  Now, while the
+ *  engine is running, those changes are posted here as commands, and the
+ *  output thread applies them at the start of each frame, so that it is
+ *  the only thread changing that state.  This is the reverse of the
+ *  rt_notify module, which carries the changes from the engine to the GUI.
+ *
+ *  The queue is a bounded, lock-free, multiple-producer, single-consumer
+ *  ring.  Each cell holds a sequence number that tells producers and the
+ *  consumer whose turn it is, so posting never locks or allocates.  If the
+ *  queue is full, the poster makes the change itself, as before.
+ *
+ *  When the engine is not running, there is no frame to pick the commands
+ *  up, so the poster applies the queue itself.  A consumer flag makes sure
+ *  that only one thread drains the queue at a time.
+ */
+
+#include <atomic>
+#include <cstddef>                      /* std::size_t                      */
+
+#include "midibyte.hpp"                 /* seq64::midibpm                   */
+
+/**
+ *  The number of commands the queue can hold.  Must be a power of two.
+ *  Even a burst of MIDI control events rarely posts more than a few
+ *  commands per frame.
+ */
+
+#define SEQ64_RT_COMMAND_QUEUE_SIZE     256
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The kinds of commands.  Each one is applied by calling the perform
+ *  function of the same name from the engine, or the apply_ function that
+ *  holds its state change; see perform::apply_command().
+ */
+
+enum command_t
+{
+    COMMAND_NONE = 0,               /**< Does nothing.                      */
+    COMMAND_SEQUENCE_TOGGLE,        /**< apply_playing_toggle(value).       */
+    COMMAND_SEQUENCE_CHANGE,        /**< sequence_playing_change(value).    */
+    COMMAND_MUTE_GROUP_TRACKS,      /**< mute_group_tracks().               */
+    COMMAND_SELECT_MUTE_GROUP,      /**< select_and_mute_group(value).      */
+    COMMAND_PLAYING_SCREENSET,      /**< set_playing_screenset().           */
+    COMMAND_MUTE_ALL_TRACKS,        /**< mute_all_tracks(flag).             */
+    COMMAND_TOGGLE_ALL_TRACKS,      /**< toggle_all_tracks().               */
+    COMMAND_TOGGLE_PLAYING_TRACKS,  /**< toggle_playing_tracks().           */
+    COMMAND_SET_CONTROL_STATUS,     /**< set_sequence_control_status().     */
+    COMMAND_UNSET_CONTROL_STATUS,   /**< unset_sequence_control_status().   */
+    COMMAND_MODE_GROUP,             /**< [un]set_mode_group_mute() by flag. */
+    COMMAND_MODE_GROUP_LEARN,       /**< apply_group_learn(flag).           */
+    COMMAND_SET_SCREENSET,          /**< apply_screenset(value).            */
+    COMMAND_MUTE_SCREENSET,         /**< mute_screenset(value, flag).       */
+    COMMAND_SET_BPM                 /**< set_beats_per_minute(bpm).         */
+};
+
+/**
+ *  One command, with room for the parameters of any of them.
+ */
+
+struct rt_command
+{
+    command_t m_command;            /**< What to do.                        */
+    int m_value;                    /**< The sequence, group, or status.    */
+    bool m_flag;                    /**< The on/off parameter, if any.      */
+    midibpm m_bpm;                  /**< The tempo, for COMMAND_SET_BPM.    */
+};
+
+/**
+ *  Holds the commands posted for the engine.  There is one of these, owned
+ *  by the perform object.
+ */
+
+class rt_command_queue
+{
+
+private:
+
+    /**
+     *  One slot of the ring.  The sequence number is the position of the
+     *  slot when it is free for a producer, and that position plus one when
+     *  it holds a command for the consumer.
+     */
+
+    struct cell
+    {
+        std::atomic<std::size_t> m_sequence;
+        rt_command m_command;
+    };
+
+    /**
+     *  The ring of commands.
+     */
+
+    cell m_cells[SEQ64_RT_COMMAND_QUEUE_SIZE];
+
+    /**
+     *  The position of the next command to be posted.  Shared by the
+     *  producers.
+     */
+
+    std::atomic<std::size_t> m_enqueue_pos;
+
+    /**
+     *  The position of the next command to be applied.  Changed only by
+     *  the thread holding m_consumer.
+     */
+
+    std::atomic<std::size_t> m_dequeue_pos;
+
+    /**
+     *  True while a thread is draining the queue.
+     */
+
+    std::atomic<bool> m_consumer;
+
+    /**
+     *  The number of commands that could not be posted because the queue
+     *  was full.
+     */
+
+    std::atomic<unsigned long> m_overflows;
+
+public:
+
+    rt_command_queue ();
+
+    bool push (const rt_command & c);
+    bool pop (rt_command & c);
+    bool empty () const;
+
+    /**
+     *  Makes the calling thread the consumer, unless another thread is.
+     *
+     * \return
+     *      Returns true if the caller may now call pop().
+     */
+
+    bool acquire ()
+    {
+        return ! m_consumer.exchange(true, std::memory_order_acquire);
+    }
+
+    /**
+     *  Gives up the consumer role taken by acquire().
+     */
+
+    void release ()
+    {
+        m_consumer.store(false, std::memory_order_release);
+    }
+
+    /**
+     * \getter m_overflows
+     */
+
+    unsigned long overflows () const
+    {
+        return m_overflows.load(std::memory_order_relaxed);
+    }
+
+    static void engine_thread (bool flag);
+    static bool is_engine_thread ();
+
+private:
+
+    rt_command_queue (const rt_command_queue &);                /* no copy  */
+    rt_command_queue & operator = (const rt_command_queue &);   /* no copy  */
+
+};          // class rt_command_queue
+
+}           // namespace seq64
+
+#endif      // SEQ64_RT_COMMAND_HPP
+
+/*
+ * rt_command.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
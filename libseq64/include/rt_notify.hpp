@@ -0,0 +1,171 @@
+#ifndef SEQ64_RT_NOTIFY_HPP
+#define SEQ64_RT_NOTIFY_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_notify.hpp
+ *
+ *  This module declares the change notifications that the engine posts for
+ *  the user interface.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Any thread (output, input, or GUI) can post a change.  Changes are
+ *  coalesced:  each kind of change is a bit in an atomic mask, and each
+ *  sequence has an atomic "changed" flag, so posting the same change many
+ *  times before the GUI gets to it costs nothing extra.  When the mask goes
+ *  from empty to non-empty, one byte is written to a non-blocking pipe,
+ *  which wakes up the GUI thread's event loop.  The GUI then drains the
+ *  mask and the sequence flags in one go.  Posting never locks or
+ *  allocates, so it is safe in the output thread.
+ *
+ *  The playhead is not posted on every tick, only when it has moved by at
+ *  least playhead_step() ticks, which the GUI can set to match its zoom.
+ *
+ *  On Windows there is no pipe, and wake_fd() returns -1; the GUI must then
+ *  poll with drain() on a timer.
+ */
+
+#include <atomic>
+
+#include "globals.h"                    /* c_max_sequence                   */
+#include "midibyte.hpp"                 /* seq64::midipulse                 */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The kinds of changes that can be posted.  These are bits, and are or'ed
+ *  together in the pending mask.
+ */
+
+enum change_t
+{
+    CHANGE_NONE         = 0x00,     /**< Nothing changed.                   */
+    CHANGE_SEQUENCE     = 0x01,     /**< Events or settings of a pattern.   */
+    CHANGE_MUTE         = 0x02,     /**< Playing, queued, or one-shot.      */
+    CHANGE_PLAYHEAD     = 0x04,     /**< The song position moved.           */
+    CHANGE_SCREENSET    = 0x08,     /**< The current screen-set changed.    */
+    CHANGE_TRANSPORT    = 0x10      /**< Start, stop, or tempo.             */
+};
+
+/**
+ *  Holds the pending changes and the wake-up pipe.  There is one of these,
+ *  owned by the perform object.
+ */
+
+class rt_notify
+{
+
+private:
+
+    /**
+     *  The or'ed change_t values posted since the last drain().
+     */
+
+    std::atomic<unsigned> m_pending;
+
+    /**
+     *  True for each sequence changed since the last drain().
+     */
+
+    std::atomic<bool> m_sequences[c_max_sequence];
+
+    /**
+     *  The position of the last posted playhead change.
+     */
+
+    std::atomic<midipulse> m_playhead;
+
+    /**
+     *  The smallest playhead movement, in ticks, that gets posted.
+     */
+
+    std::atomic<midipulse> m_playhead_step;
+
+    /**
+     *  The read [0] and write [1] ends of the wake-up pipe, or -1.
+     */
+
+    int m_wake_fd[2];
+
+public:
+
+    rt_notify ();
+    ~rt_notify ();
+
+    void post (change_t change, int seq = -1);
+    void post_playhead (midipulse tick);
+    unsigned drain (bool * sequences = nullptr);
+
+    /**
+     * \getter m_wake_fd[0]
+     *      The GUI watches this descriptor for input.  It is -1 if the
+     *      platform has no pipes.
+     */
+
+    int wake_fd () const
+    {
+        return m_wake_fd[0];
+    }
+
+    /**
+     * \getter m_playhead_step
+     */
+
+    midipulse playhead_step () const
+    {
+        return m_playhead_step.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \setter m_playhead_step
+     */
+
+    void playhead_step (midipulse ticks)
+    {
+        m_playhead_step.store(ticks > 0 ? ticks : 1, std::memory_order_relaxed);
+    }
+
+private:
+
+    rt_notify (const rt_notify &);                  /* no copying       */
+    rt_notify & operator = (const rt_notify &);     /* no copying       */
+
+};          // class rt_notify
+
+}           // namespace seq64
+
+#endif      // SEQ64_RT_NOTIFY_HPP
+
+/*
+ * rt_notify.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,82 @@
+#ifndef SEQ64_RT_SAFE_HPP
+#define SEQ64_RT_SAFE_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_safe.hpp
+ *
+ *  This module declares the helpers for the "RT-safe" mode, in which the
+ *  output and input threads are not supposed to touch the heap once
+ *  playback has started.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-05
+ * \updates       2018-09-05
+ * \license       GNU GPLv2 or above
+ *
+ *  The RT-safe mode is selected by "-o rtsafe" (or "-o rtsafe=on") or by
+ *  "-o rtsafe=abort"; "-o rtsafe=off" turns it off.  It locks the process
+ *  memory with mlockall() at launch, pre-faults the stacks of the real-time
+ *  threads, and, if configured with --enable-rtguard, checks every call to
+ *  operator new made while a real-time thread has its allocation guard up.
+ *  By default, such allocations are counted and the first one is reported;
+ *  with "abort", the first one aborts the application, so that a debugger
+ *  or core file shows where it came from.
+ *
+ *  Only C++ allocations are checked.  Calls to malloc() from C libraries
+ *  (ALSA, JACK) are not seen by the guard.
+ */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The number of bytes of stack touched by rt_prefault_stack(), so that the
+ *  pages are mapped (and locked) before the thread does real-time work.
+ */
+
+#define SEQ64_RT_STACK_PREFAULT     (128 * 1024)
+
+/*
+ *  Free functions in the seq64 namespace.
+ */
+
+extern bool rt_lock_memory ();
+extern void rt_prefault_stack ();
+extern void rt_guard_allocations (bool guard);
+extern void rt_guard_abort (bool abortit);
+extern void rt_check_allocation ();
+extern unsigned long rt_guard_violations ();
+
+}           // namespace seq64
+
+#endif      // SEQ64_RT_SAFE_HPP
+
+/*
+ * rt_safe.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
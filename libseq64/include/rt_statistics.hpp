@@ -0,0 +1,384 @@
+#ifndef SEQ64_RT_STATISTICS_HPP
+#define SEQ64_RT_STATISTICS_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_statistics.hpp
+ *
+ *  This module declares lock-free counters and histograms for timing the
+ *  output thread.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-03
+ * \updates       2018-09-03
+ * \license       GNU GPLv2 or above
+ *
+ *  These classes replace the old SEQ64_STATISTICS_SUPPORT code in
+ *  perform::output_func().  Recording a value is a handful of relaxed atomic
+ *  operations, with no locking, allocation, or I/O, so it is safe to do from
+ *  the real-time thread all of the time.  Any other thread can read or dump
+ *  the values while playback continues.
+ */
+
+#include <atomic>
+#include <stdint.h>                     /* uint64_t                         */
+#include <stdio.h>                      /* FILE *                           */
+#include <string>
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Returns a monotonic time-stamp in microseconds, for measuring intervals.
+ *  The zero point is arbitrary.
+ */
+
+extern uint64_t rt_microseconds ();
+
+/**
+ *  A fixed-size, HDR-style (log-linear) histogram of unsigned integer
+ *  values.  Values below 2 * sm_sub_buckets each get their own bucket;
+ *  above that, each power-of-two range is split into sm_sub_buckets equal
+ *  buckets.  So every recorded value is kept with a relative error of at
+ *  most 1/16 (6.25%), from 0 up to 2^32 - 1, in 464 buckets.  Larger values
+ *  are clamped into the last bucket.
+ *
+ *  All members are atomics, and record() uses only relaxed operations, so it
+ *  can be called from the output thread while another thread reads the
+ *  histogram.  A reader may see a count that is off by one from the sum of
+ *  the buckets; that is fine for statistics.
+ */
+
+class rt_histogram
+{
+
+public:
+
+    /**
+     *  The number of buckets in each power-of-two range.  Must be a power of
+     *  two itself.
+     */
+
+    static const int sm_sub_bucket_bits = 4;
+    static const int sm_sub_buckets = 1 << sm_sub_bucket_bits;
+
+    /**
+     *  The total number of buckets, enough to cover values up to 2^32 - 1.
+     */
+
+    static const int sm_bucket_count = (32 - sm_sub_bucket_bits + 1) *
+        sm_sub_buckets;
+
+private:
+
+    /**
+     *  The name of the histogram, used in the dump.
+     */
+
+    std::string m_name;
+
+    /**
+     *  The units of the values ("us", "events"), used in the dump.
+     */
+
+    std::string m_units;
+
+    /**
+     *  The number of values recorded.
+     */
+
+    std::atomic<uint64_t> m_count;
+
+    /**
+     *  The sum of the values recorded, for calculating the mean.
+     */
+
+    std::atomic<uint64_t> m_sum;
+
+    /**
+     *  The smallest value recorded.  Starts at the maximum possible value.
+     */
+
+    std::atomic<uint64_t> m_min;
+
+    /**
+     *  The largest value recorded.
+     */
+
+    std::atomic<uint64_t> m_max;
+
+    /**
+     *  The tallies for each bucket.
+     */
+
+    std::atomic<uint64_t> m_buckets[sm_bucket_count];
+
+public:
+
+    rt_histogram (const std::string & name, const std::string & units);
+
+    void record (uint64_t value);
+    void reset ();
+    uint64_t percentile (double pct) const;
+    void show (FILE * fp) const;
+
+    /**
+     * \getter m_name
+     */
+
+    const std::string & name () const
+    {
+        return m_name;
+    }
+
+    /**
+     * \getter m_count
+     */
+
+    uint64_t count () const
+    {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_min
+     *      Returns 0 if nothing has been recorded.
+     */
+
+    uint64_t minimum () const
+    {
+        return count() > 0 ? m_min.load(std::memory_order_relaxed) : 0 ;
+    }
+
+    /**
+     * \getter m_max
+     */
+
+    uint64_t maximum () const
+    {
+        return m_max.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_sum / m_count
+     */
+
+    double mean () const
+    {
+        uint64_t c = count();
+        return c > 0 ?
+            double(m_sum.load(std::memory_order_relaxed)) / double(c) : 0.0 ;
+    }
+
+    static int bucket_index (uint64_t value);
+    static uint64_t bucket_lower (int index);
+
+private:
+
+    rt_histogram (const rt_histogram &);                /* no copying   */
+    rt_histogram & operator = (const rt_histogram &);   /* no copying   */
+
+};          // class rt_histogram
+
+/**
+ *  Holds the statistics for the output thread.  The perform object owns one
+ *  of these, and perform::output_func() fills it in.
+ */
+
+class rt_statistics
+{
+
+private:
+
+    /**
+     *  The time spent doing the work of one pass through the output loop,
+     *  from the top of the loop to the point where it goes to sleep, in
+     *  microseconds.
+     */
+
+    rt_histogram m_loop_duration;
+
+    /**
+     *  How much later than requested the output thread woke up from its
+     *  sleep, in microseconds.
+     */
+
+    rt_histogram m_wakeup_lateness;
+
+    /**
+     *  The time between successive MIDI clocks (24 per quarter note), in
+     *  microseconds, as seen by the output loop.
+     */
+
+    rt_histogram m_clock_interval;
+
+    /**
+     *  The number of MIDI events sent to the master buss in one pass through
+     *  the output loop.
+     */
+
+    rt_histogram m_events_per_frame;
+
+    /**
+     *  The number of passes through the output loop.
+     */
+
+    std::atomic<uint64_t> m_frames;
+
+    /**
+     *  The number of passes through the output loop that took longer than
+     *  the loop period, so that there was no time left to sleep.
+     */
+
+    std::atomic<uint64_t> m_underruns;
+
+public:
+
+    rt_statistics ();
+
+    void reset ();
+    void show (FILE * fp) const;
+    bool write (const std::string & filename) const;
+
+    /**
+     *  Counts one pass through the output loop.
+     */
+
+    void count_frame ()
+    {
+        m_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     *  Counts one underrun.
+     */
+
+    void count_underrun ()
+    {
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_frames
+     */
+
+    uint64_t frames () const
+    {
+        return m_frames.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \getter m_underruns
+     */
+
+    uint64_t underruns () const
+    {
+        return m_underruns.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * \accessor m_loop_duration
+     */
+
+    rt_histogram & loop_duration ()
+    {
+        return m_loop_duration;
+    }
+
+    /**
+     * \accessor m_wakeup_lateness
+     */
+
+    rt_histogram & wakeup_lateness ()
+    {
+        return m_wakeup_lateness;
+    }
+
+    /**
+     * \accessor m_clock_interval
+     */
+
+    rt_histogram & clock_interval ()
+    {
+        return m_clock_interval;
+    }
+
+    /**
+     * \accessor m_events_per_frame
+     */
+
+    rt_histogram & events_per_frame ()
+    {
+        return m_events_per_frame;
+    }
+
+    /**
+     * \getter m_loop_duration, const version
+     */
+
+    const rt_histogram & loop_duration () const
+    {
+        return m_loop_duration;
+    }
+
+    /**
+     * \getter m_wakeup_lateness, const version
+     */
+
+    const rt_histogram & wakeup_lateness () const
+    {
+        return m_wakeup_lateness;
+    }
+
+    /**
+     * \getter m_clock_interval, const version
+     */
+
+    const rt_histogram & clock_interval () const
+    {
+        return m_clock_interval;
+    }
+
+    /**
+     * \getter m_events_per_frame, const version
+     */
+
+    const rt_histogram & events_per_frame () const
+    {
+        return m_events_per_frame;
+    }
+
+};          // class rt_statistics
+
+}           // namespace seq64
+
+#endif      // SEQ64_RT_STATISTICS_HPP
+
+/*
+ * rt_statistics.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,190 @@
+#ifndef SEQ64_RT_TRACE_HPP
+#define SEQ64_RT_TRACE_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_trace.hpp
+ *
+ *  This module declares a low-overhead tracer that records timed spans in
+ *  per-thread ring buffers and writes them as Chrome trace JSON.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-04
+ * \updates       2018-09-04
+ * \license       GNU GPLv2 or above
+ *
+ *  Tracing is enabled by the "-o trace=filename" option.  Each thread's ring
+ *  buffer is allocated when the thread names itself, before it starts its
+ *  real work; after that, recording a span is a couple of clock reads and a
+ *  store into the calling thread's own buffer, with no locking or
+ *  allocation.  When tracing is disabled, a span costs one atomic load.
+ *
+ *  The output file can be loaded into chrome://tracing or the Perfetto UI
+ *  (ui.perfetto.dev).  Only the most recent rt_trace::sm_buffer_size spans
+ *  of each thread are kept.
+ *
+ *  Usage:
+ *
+\verbatim
+        void
+        sequence::play (...)
+        {
+            rt_trace_span span("sequence::play");
+            ...
+        }
+\endverbatim
+ */
+
+#include <atomic>
+#include <stdint.h>                     /* uint64_t                         */
+#include <string>
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Holds the trace buffers for all threads.  There is only one of these, and
+ *  all of its members are static.
+ */
+
+class rt_trace
+{
+
+public:
+
+    /**
+     *  The maximum number of threads that can record spans.  Threads beyond
+     *  this number are silently not traced.
+     */
+
+    static const int sm_max_threads = 16;
+
+    /**
+     *  The number of spans kept per thread.  At 24 bytes per span, this is
+     *  1.5 MB per thread.
+     */
+
+    static const int sm_buffer_size = 65536;
+
+    /**
+     *  One timed span.  The name must be a string literal or otherwise
+     *  outlive the tracer, since only the pointer is stored.
+     */
+
+    struct span
+    {
+        const char * name;
+        uint64_t start;
+        uint64_t duration;
+    };
+
+    /**
+     *  The ring buffer for one thread.  Only the owning thread writes to it,
+     *  so m_count needs no read-modify-write, just a release store.
+     */
+
+    struct buffer
+    {
+        const char * m_name;
+        std::atomic<uint64_t> m_count;
+        span * m_spans;
+    };
+
+private:
+
+    static std::atomic<bool> sm_enabled;
+    static std::atomic<int> sm_thread_count;
+    static uint64_t sm_start_time;
+    static buffer sm_buffers[sm_max_threads];
+
+public:
+
+    static void enable ();
+    static void thread_name (const char * name);
+    static void record (const char * name, uint64_t start, uint64_t end);
+    static bool write (const std::string & filename);
+
+    /**
+     * \getter sm_enabled
+     */
+
+    static bool enabled ()
+    {
+        return sm_enabled.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    static buffer * thread_buffer ();
+
+};          // class rt_trace
+
+/**
+ *  Records the lifetime of the object as a span in the trace, if tracing is
+ *  enabled.  Create it at the top of the scope to be timed.  If the scope
+ *  locks a mutex, creating the span first makes the time spent waiting for
+ *  the lock part of the span.
+ */
+
+class rt_trace_span
+{
+
+private:
+
+    /**
+     *  The name of the span, a string literal.  Null if tracing was not
+     *  enabled when the span started.
+     */
+
+    const char * m_name;
+
+    /**
+     *  The time the span started, in microseconds.
+     */
+
+    uint64_t m_start;
+
+public:
+
+    rt_trace_span (const char * name);
+    ~rt_trace_span ();
+
+private:
+
+    rt_trace_span (const rt_trace_span &);                  /* no copying   */
+    rt_trace_span & operator = (const rt_trace_span &);     /* no copying   */
+
+};          // class rt_trace_span
+
+}           // namespace seq64
+
+#endif      // SEQ64_RT_TRACE_HPP
+
+/*
+ * rt_trace.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
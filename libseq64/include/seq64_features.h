@@ -327,13 +327,6 @@
 
 #define SEQ64_SOLID_PIANOROLL_GRID
 
-/**
- *  An option we've preserved from Seq24, but have disabled until we find a
- *  need for it, is to tally some "statistics" about recording and playback.
- */
-
-#undef  SEQ64_STATISTICS_SUPPORT
-
 /**
  *  Provides additional sequence menu entries from Seq32 that we think are
  *  pretty useful no matter what.  Now a permanent option.
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-30
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The functions add_list_var() and add_long_list() have been replaced by
@@ -38,8 +38,12 @@
  *  module, and now just call its member functions to do the actual work.
  */
 
+#include <atomic>                       /* std::atomic<unsigned long>   */
+#include <functional>                   /* std::function                */
+#include <memory>                       /* std::shared_ptr              */
 #include <string>
 #include <stack>
+#include <vector>
 
 #include "seq64_features.h"             /* various feature #defines     */
 #include "calculations.hpp"             /* measures_to_ticks()          */
@@ -48,6 +52,7 @@
 #include "midi_container.hpp"           /* seq64::midi_container        */
 #include "midibus.hpp"                  /* seq64::midibus               */
 #include "mutex.hpp"                    /* seq64::mutex, automutex      */
+#include "render_snapshot.hpp"          /* seq64::render_snapshot, etc. */
 #include "scales.h"                     /* key and scale constants      */
 #include "triggers.hpp"                 /* seq64::triggers, etc.        */
 
@@ -78,23 +83,10 @@
 
 namespace seq64
 {
+    class event_stream;
     class mastermidibus;
     class perform;
 
-/**
- *  Provides a set of methods for drawing certain items.  These values are
- *  used in the sequence, seqroll, perfroll, and mainwid classes.
- */
-
-enum draw_type_t
-{
-    DRAW_FIN = 0,           /**< Indicates that drawing is finished.        */
-    DRAW_NORMAL_LINKED,     /**< Used for drawing linked notes.             */
-    DRAW_NOTE_ON,           /**< For starting the drawing of a note.        */
-    DRAW_NOTE_OFF,          /**< For finishing the drawing of a note.       */
-    DRAW_TEMPO              /**< For drawing tempo meta events.             */
-};
-
 /**
  *  Provides two editing modes for a sequence.  A feature adapted from
  *  Kepler34.  Not yet ready for prime time.
@@ -180,6 +172,14 @@ public:
         e_is_selected_onset     /**< New, from Kepler34, onsets selected.   */
     };
 
+    /**
+     *  Fills a scratch sequence with the events of this sequence, for a
+     *  sequence loaded with "-o lazy".  Returns false if the events could
+     *  not be decoded.  See defer_events().
+     */
+
+    typedef std::function<bool (sequence &)> event_loader;
+
 private:
 
     /**
@@ -337,6 +337,14 @@ private:
 
     short m_playing_notes[SEQ64_MIDI_NOTES_MAX];
 
+    /**
+     *  A scratch event used by play() to hold a transposed note.  Reusing it
+     *  avoids constructing and destroying an event (and its SysEx vector)
+     *  for every transposed note played.
+     */
+
+    event m_transposed_event;
+
     /**
      *  Indicates if the sequence was playing.
      */
@@ -472,6 +480,61 @@ private:
     bool m_dirty_perf;          /**< Provides performance dirty flagflag.   */
     bool m_dirty_names;         /**< Provides the names dirtiness flag.     */
 
+    /**
+     *  Incremented every time the sequence is marked dirty, and when the
+     *  selection changes or events are removed.  Unlike the dirty flags,
+     *  reading it does not reset it, so any number of views can cache a
+     *  drawing of the sequence and compare the version they drew against
+     *  the current one to see if the drawing is stale.
+     */
+
+    std::atomic<unsigned long> m_edit_version;
+
+    /**
+     *  The latest render snapshot of the notes, built on demand by
+     *  snapshot().  Accessed only with std::atomic_load() and
+     *  std::atomic_store(), so that views can get it without the mutex.
+     */
+
+    mutable render_snapshot::pointer m_snapshot;
+
+    /**
+     *  Decodes the events of the sequence on demand, when the sequence was
+     *  loaded with "-o lazy".  Empty once the events are loaded.  See
+     *  defer_events() and load_events().
+     */
+
+    event_loader m_event_loader;
+
+    /**
+     *  True while the events are still waiting for m_event_loader.  Atomic
+     *  so that the output thread can check it without a lock.
+     */
+
+    std::atomic<bool> m_events_pending;
+
+    /**
+     *  Makes sure that only one thread runs m_event_loader.  Separate from
+     *  m_mutex, so that the decoding does not block playback or drawing.
+     */
+
+    mutable mutex m_load_mutex;
+
+    /**
+     *  Plays the events straight from the track data until they are
+     *  loaded, for a long track read with "-o stream=kb".  Used under
+     *  m_mutex, and dropped by load_events().  See the event_stream module.
+     */
+
+    std::shared_ptr<event_stream> m_stream;
+
+    /**
+     *  True while m_stream is in use.  Atomic so that the GUI and control
+     *  code can check it without a lock.
+     */
+
+    std::atomic<bool> m_streaming;
+
     /**
      *  Indicates that the sequence is currently being edited.
      */
@@ -695,6 +758,31 @@ public:
     ~sequence ();
 
     void partial_assign (const sequence & rhs);
+    void save_assign (const sequence & rhs);
+    void defer_events (const event_loader & loader);
+    void stream_events (const std::shared_ptr<event_stream> & stream);
+    bool load_events ();
+
+    /**
+     * \getter m_events_pending
+     *      If true, the events have not been decoded yet.
+     */
+
+    bool events_pending () const
+    {
+        return m_events_pending.load();
+    }
+
+    /**
+     * \getter m_streaming
+     *      If true, the events are played from the track data, and are to
+     *      be loaded only for drawing or editing.
+     */
+
+    bool streaming () const
+    {
+        return m_streaming.load();
+    }
 
     void set_editing (midibyte status, midibyte cc, midipulse snap, int scale)
     {
@@ -711,6 +799,7 @@ public:
 
     event_list & events ()
     {
+        (void) load_events();               /* the caller may change them   */
         return m_events;
     }
 
@@ -1432,6 +1521,15 @@ public:
     void set_dirty_mp ();
     void set_dirty ();
 
+    /**
+     * \getter m_edit_version
+     */
+
+    unsigned long edit_version () const
+    {
+        return m_edit_version.load();
+    }
+
     /**
      * \getter m_midi_channel
      */
@@ -1478,6 +1576,8 @@ public:
         midibyte d0, midibyte d1, bool paint = false
     );
     bool append_event (const event & er);
+    void swap_events (event_list & evl);
+    void commit_events (event_list & events, bool link);
 
     /**
      *  Calls event_list::sort().
@@ -1710,6 +1810,7 @@ public:
     void inc_draw_marker ();
     void reset_draw_marker ();
     void reset_draw_trigger_marker ();
+    render_snapshot::pointer snapshot () const;
     void reset_ex_iterator (event_list::const_iterator & evi);
     draw_type_t get_next_note_event
     (
@@ -1816,6 +1917,11 @@ public:
 
     void show_events () const;
     void copy_events (const event_list & newevents);
+    bool remove_event (event_list::const_iterator ei, unsigned long version);
+    bool replace_event
+    (
+        event_list::const_iterator ei, unsigned long version, const event & e
+    );
 
     /**
      * \getter m_note_length
@@ -1880,6 +1986,7 @@ private:
 
     void set_parent (perform * p);
     void put_event_on_bus (event & ev);
+    void play_stream (midipulse start_tick, midipulse end_tick, int transpose);
     void reset_loop ();
     void set_trigger_offset (midipulse trigger_offset);
     void adjust_trigger_offsets_to_length (midipulse newlen);
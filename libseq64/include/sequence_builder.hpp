@@ -0,0 +1,118 @@
+#ifndef SEQ64_SEQUENCE_BUILDER_HPP
+#define SEQ64_SEQUENCE_BUILDER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          sequence_builder.hpp
+ *
+ *  This module declares a class for filling a sequence in bulk, as done by
+ *  the MIDI and WRK file importers.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Calling sequence::append_event() for each event of a track locks the
+ *  sequence once per event, and marks it dirty for every sort and length
+ *  change made along the way.  The importers now collect the events of a
+ *  track in a sequence_builder instead, which holds them in an event_list
+ *  of its own, without any locking.  When the track is done, commit()
+ *  sorts that list and hands it to sequence::commit_events(), which takes
+ *  the nodes over under one lock and with one dirty notification.
+ *
+ *  The builder uses the same container as the sequence, rather than a
+ *  vector, because an event has no move operations and owns a vector for
+ *  its SysEx data.  Sorting a vector of events, and copying them into the
+ *  list afterward, copied every event several times, which made the first
+ *  version of the builder slower than the append_event() loop it replaced.
+ *  Sorting and handing over list nodes copies nothing.
+ *
+ *  The builder is not thread-safe.  Each importer, or each parsing thread,
+ *  uses its own.
+ */
+
+#include "event_list.hpp"               /* seq64::event_list                */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class sequence;
+
+/**
+ *  Collects the events of one sequence, unsorted and unlocked, until they
+ *  are committed.
+ */
+
+class sequence_builder
+{
+
+private:
+
+    /**
+     *  The events collected so far, unsorted.
+     */
+
+    event_list m_events;
+
+public:
+
+    sequence_builder ();
+
+    /**
+     *  Adds an event.  No lock is taken, and nothing is sorted.
+     *
+     * \param e
+     *      The event to be copied into the builder.
+     */
+
+    void append (const event & e)
+    {
+        (void) m_events.append(e);
+    }
+
+    /**
+     * \getter m_events.count()
+     */
+
+    int count () const
+    {
+        return m_events.count();
+    }
+
+    void commit (sequence & seq, bool link = false);
+    void clear ();
+
+};          // class sequence_builder
+
+}           // namespace seq64
+
+#endif      // SEQ64_SEQUENCE_BUILDER_HPP
+
+/*
+ * sequence_builder.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,160 @@
+#ifndef SEQ64_SESSION_SNAPSHOT_HPP
+#define SEQ64_SESSION_SNAPSHOT_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          session_snapshot.hpp
+ *
+ *  This module declares a binary snapshot of the performance as loaded from
+ *  a MIDI file, used to skip parsing the file at the next startup.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  With "-o snapshot", after a MIDI file is parsed, the resulting patterns
+ *  (settings, triggers, and events) and the song settings read from the
+ *  file are written to a snapshot file in the configuration directory.  The
+ *  next time the same file is opened, the snapshot is memory-mapped and
+ *  the patterns are rebuilt from it directly:  the events are stored in
+ *  their sorted order, with the index of each Note On's linked Note Off, so
+ *  that neither the MIDI decoding nor the sort and link passes are needed.
+ *
+ *  The MIDI file stays the interchange format; the snapshot is only a
+ *  cache.  Its header holds a hash of the bytes of the MIDI file, the PPQN
+ *  asked for, and the format version, so a snapshot of any other content is
+ *  ignored (and replaced) rather than trusted.  The snapshot is written in
+ *  the byte order of the machine, and a snapshot from a machine with a
+ *  different byte order is also ignored.
+ *
+ *  The "rc" and "usr" files are not part of the snapshot.  They are small,
+ *  and are rewritten at every exit, so they would invalidate it every time.
+ *
+ *  A file read with "-o lazy" has patterns that are not decoded yet, and
+ *  the snapshot holds decoded events only.  Rather than decode every
+ *  pattern up front, which is what "-o lazy" avoids, no snapshot is written
+ *  for such a file.
+ */
+
+#include <string>
+
+#include "midibyte.hpp"                 /* seq64::midilong, etc.            */
+
+/**
+ *  The version of the snapshot format.  Bump it whenever the layout of the
+ *  file, or the meaning of a field, changes.
+ */
+
+#define SEQ64_SNAPSHOT_VERSION          2
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Reads and writes the snapshot of one MIDI file.
+ */
+
+class session_snapshot
+{
+
+public:
+
+    /**
+     *  Tells which of the optional song settings the MIDI file provided.
+     *  Settings the file did not provide are left alone when the snapshot
+     *  is read, just as the parser leaves them alone.
+     */
+
+    enum item_t
+    {
+        ITEM_MUTE_GROUPS    = 0x01,     /**< The c_mutegroups section.      */
+        ITEM_GLOBAL_BGS     = 0x02,     /**< Global key, scale, background. */
+        ITEM_TEMPO_TRACK    = 0x04      /**< The c_tempo_track number.      */
+    };
+
+private:
+
+    /**
+     *  The full path to the snapshot file.
+     */
+
+    std::string m_name;
+
+    /**
+     *  The hash of the MIDI file, the PPQN, and the snapshot version.  Zero
+     *  if the MIDI file could not be read.
+     */
+
+    unsigned long long m_hash;
+
+    /**
+     *  The reason the last read() or write() failed, for the console.
+     */
+
+    std::string m_error_message;
+
+public:
+
+    session_snapshot (const std::string & midifilename, int ppqn);
+
+    bool read (perform & p, int & fileppqn);
+    bool write (perform & p, int fileppqn, unsigned items);
+
+    /**
+     * \getter m_name
+     */
+
+    const std::string & name () const
+    {
+        return m_name;
+    }
+
+    /**
+     * \getter m_error_message
+     */
+
+    const std::string & error_message () const
+    {
+        return m_error_message;
+    }
+
+private:
+
+    bool load (perform & p, const char * data, size_t size, int & fileppqn);
+
+};          // class session_snapshot
+
+}           // namespace seq64
+
+#endif      // SEQ64_SESSION_SNAPSHOT_HPP
+
+/*
+ * session_snapshot.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,218 @@
+#ifndef SEQ64_SONG_SAVER_HPP
+#define SEQ64_SONG_SAVER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_saver.hpp
+ *
+ *  This module declares the background thread that writes MIDI files for
+ *  File / Save and for the autosave.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Saving a song is done in two steps.  First, midifile::capture() copies
+ *  each active sequence, locking it only while it is copied, and encodes
+ *  the small proprietary track, into a song_image.  This is done by the
+ *  thread that asks for the save.  Then the song_saver thread encodes the
+ *  tracks from the copies and writes the file, via a temporary file that is
+ *  renamed over the old one, so that a crash in the middle of a save never
+ *  leaves a truncated song behind.
+ *
+ *  The main window runs a timer of its own, apart from the redraw frames,
+ *  that calls perform::check_saves().  It reports a failed save and, with
+ *  "-o autosave=secs", captures the song to an autosave file every so many
+ *  seconds while it has unsaved changes.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "midibyte.hpp"                 /* seq64::midibyte                  */
+
+/**
+ *  The period, in milliseconds, of the main-window timer that calls
+ *  perform::check_saves().  Autosaves are timed in seconds, so this keeps
+ *  them within a second of their period, even while the GUI is idle.
+ */
+
+#define SEQ64_SAVE_CHECK_PERIOD_MS      1000
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+    class sequence;
+
+/**
+ *  Holds everything needed to write a MIDI file without touching the
+ *  performance again.  Filled in by midifile::capture(), and written by
+ *  midifile::write(const song_image &).  Owns the sequence copies.
+ */
+
+class song_image
+{
+
+public:
+
+    /**
+     *  One track to be written:  its track number, and a detached copy of
+     *  its sequence made by sequence::save_assign().
+     */
+
+    struct track
+    {
+        int number;                 /**< The track (sequence) number.       */
+        sequence * seq;             /**< The copy, owned by the image.      */
+    };
+
+    std::string m_filename;         /**< The file to be written.            */
+    int m_ppqn;                     /**< The PPQN of the midifile.          */
+    bool m_oldformat;               /**< Write the legacy SeqSpec format.   */
+    bool m_globalbgs;               /**< Global key, scale, and background. */
+    bool m_doseqspec;               /**< Write the Sequencer64 SeqSpecs.    */
+    bool m_user_save;               /**< File / Save, not the autosave.     */
+    std::vector<track> m_tracks;    /**< The active sequences, in order.    */
+    std::list<midibyte> m_seqspec;  /**< The encoded proprietary track.     */
+
+public:
+
+    song_image ();
+    ~song_image ();
+
+private:
+
+    song_image (const song_image &);                /* no copying       */
+    song_image & operator = (const song_image &);   /* no copying       */
+
+};          // class song_image
+
+/**
+ *  Holds the queue of captured songs and the thread that writes them.
+ *  There is one of these, owned by the perform object.
+ */
+
+class song_saver
+{
+
+private:
+
+    /**
+     *  The performance whose songs are saved.  The thread does not touch
+     *  it, except to hand it to midi_container::fill(), which reads only
+     *  its tempo and time signature.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  The captured songs waiting to be written, oldest first.
+     */
+
+    std::deque<song_image *> m_queue;
+
+    /**
+     *  True while a song is being written.
+     */
+
+    bool m_writing;
+
+    /**
+     *  The error of the last save that failed, until check_error() takes
+     *  it.
+     */
+
+    std::string m_error_message;
+
+    /**
+     *  Tells the thread to exit once the queue is empty.
+     */
+
+    bool m_stop;
+
+    /**
+     *  The time of the last autosave, or of the start of the application.
+     */
+
+    std::chrono::steady_clock::time_point m_last_autosave;
+
+    /**
+     *  Protects all of the members above, except m_last_autosave, which is
+     *  used only by the GUI thread.
+     */
+
+    std::mutex m_mutex;
+
+    /**
+     *  Wakes up the thread when a song is queued, or when it must stop.
+     */
+
+    std::condition_variable m_wakeup;
+
+    /**
+     *  The writer thread, started by the first save().
+     */
+
+    std::thread m_thread;
+
+public:
+
+    song_saver (perform & p);
+    ~song_saver ();
+
+    void save (song_image * image);
+    bool busy ();
+    bool check_error (std::string & errmsg);
+    void autosave ();
+    void stop ();
+
+private:
+
+    void run ();
+
+    song_saver (const song_saver &);                /* no copying       */
+    song_saver & operator = (const song_saver &);   /* no copying       */
+
+};          // class song_saver
+
+extern std::string autosave_filename (const std::string & filename);
+
+}           // namespace seq64
+
+#endif      // SEQ64_SONG_SAVER_HPP
+
+/*
+ * song_saver.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-10-30
- * \updates       2018-07-07
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  By segregating trigger support into its own module, the sequence class is
@@ -288,6 +288,7 @@ class triggers
     friend class midi_container;
     friend class midifile;
     friend class sequence;
+    friend class session_snapshot;
     friend class Seq24PerfInput;        /* we need better encapsulation */
     friend class FruityPerfInput;       /* we need better encapsulation */
 
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-22
- * \updates       2018-07-21
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This module defines the following categories of "global" variables that
@@ -831,6 +831,73 @@ private:
 
     std::string m_user_option_logfile;
 
+    /**
+     *  If not empty, the output-thread statistics are written to this file
+     *  when the application exits, and (in seq64cli) whenever SIGUSR1 is
+     *  received.  Set by the "-o stats=filename" option; not saved to the
+     *  'usr' file.
+     */
+
+    std::string m_user_option_statsfile;
+
+    /**
+     *  If not empty, tracing of the output, input, and GUI threads is
+     *  enabled, and the trace is written to this file, in Chrome trace JSON
+     *  format, when the application exits.  Set by the "-o trace=filename"
+     *  option; not saved to the 'usr' file.
+     */
+
+    std::string m_user_option_tracefile;
+
+    /**
+     *  If true, the "RT-safe" mode is enabled:  memory is locked at launch,
+     *  and the output and input threads raise the allocation guard while
+     *  playing.  Set by the "-o rtsafe" option; not saved to the 'usr' file.
+     */
+
+    bool m_user_option_rtsafe;
+
+    /**
+     *  If true, an allocation made by a guarded thread aborts the
+     *  application.  Set by the "-o rtsafe=abort" option.
+     */
+
+    bool m_user_option_rtsafe_abort;
+
+    /**
+     *  If true, the events of the patterns of a MIDI file are decoded only
+     *  when first needed, instead of when the file is read.  Set by the
+     *  "-o lazy" option; not saved to the 'usr' file.
+     */
+
+    bool m_user_option_lazy_load;
+
+    /**
+     *  If true, a binary snapshot of each MIDI file opened is kept in the
+     *  configuration directory, and used instead of parsing the file the
+     *  next time, if the file has not changed.  Set by the "-o snapshot"
+     *  option; not saved to the 'usr' file.
+     */
+
+    bool m_user_option_snapshot;
+
+    /**
+     *  The number of seconds between autosaves of a modified song, or 0 for
+     *  no autosave.  Set by "-o autosave=secs"; not saved to the 'usr' file.
+     *  See the song_saver module.
+     */
+
+    int m_user_option_autosave;
+
+    /**
+     *  The size, in kilobytes, from which a track of a MIDI file is played
+     *  straight from its file data until it is drawn or edited, or 0 to
+     *  load every track.  Set by "-o stream=kb"; not saved to the 'usr'
+     *  file.  See the event_stream module.
+     */
+
+    int m_user_option_stream_kb;
+
     /*
      *  [user-work-arounds]
      */
@@ -1789,6 +1856,78 @@ public:
 
     std::string option_logfile () const;
 
+    /**
+     * \getter m_user_option_statsfile
+     */
+
+    const std::string & option_statsfile () const
+    {
+        return m_user_option_statsfile;
+    }
+
+    /**
+     * \getter m_user_option_tracefile
+     */
+
+    const std::string & option_tracefile () const
+    {
+        return m_user_option_tracefile;
+    }
+
+    /**
+     * \getter m_user_option_rtsafe
+     */
+
+    bool option_rtsafe () const
+    {
+        return m_user_option_rtsafe;
+    }
+
+    /**
+     * \getter m_user_option_rtsafe_abort
+     */
+
+    bool option_rtsafe_abort () const
+    {
+        return m_user_option_rtsafe_abort;
+    }
+
+    /**
+     * \getter m_user_option_lazy_load
+     */
+
+    bool option_lazy_load () const
+    {
+        return m_user_option_lazy_load;
+    }
+
+    /**
+     * \getter m_user_option_snapshot
+     */
+
+    bool option_snapshot () const
+    {
+        return m_user_option_snapshot;
+    }
+
+    /**
+     * \getter m_user_option_autosave
+     */
+
+    int option_autosave () const
+    {
+        return m_user_option_autosave;
+    }
+
+    /**
+     * \getter m_user_option_stream_kb
+     */
+
+    int option_stream_kb () const
+    {
+        return m_user_option_stream_kb;
+    }
+
     /**
      * \getter m_work_around_play_image
      */
@@ -1933,6 +2072,86 @@ public:         // used in main application module and the userfile class
         m_user_option_logfile = logfile;
     }
 
+    /**
+     * \setter m_user_option_statsfile
+     */
+
+    void option_statsfile (const std::string & statsfile)
+    {
+        m_user_option_statsfile = statsfile;
+    }
+
+    /**
+     * \setter m_user_option_tracefile
+     */
+
+    void option_tracefile (const std::string & tracefile)
+    {
+        m_user_option_tracefile = tracefile;
+    }
+
+    /**
+     * \setter m_user_option_rtsafe
+     */
+
+    void option_rtsafe (bool flag)
+    {
+        m_user_option_rtsafe = flag;
+    }
+
+    /**
+     * \setter m_user_option_rtsafe_abort
+     */
+
+    void option_rtsafe_abort (bool flag)
+    {
+        m_user_option_rtsafe_abort = flag;
+    }
+
+    /**
+     * \setter m_user_option_lazy_load
+     */
+
+    void option_lazy_load (bool flag)
+    {
+        m_user_option_lazy_load = flag;
+    }
+
+    /**
+     * \setter m_user_option_snapshot
+     */
+
+    void option_snapshot (bool flag)
+    {
+        m_user_option_snapshot = flag;
+    }
+
+    /**
+     * \setter m_user_option_autosave
+     *
+     * \param secs
+     *      The number of seconds between autosaves.  Negative values are
+     *      treated as 0, which disables the autosave.
+     */
+
+    void option_autosave (int secs)
+    {
+        m_user_option_autosave = secs > 0 ? secs : 0 ;
+    }
+
+    /**
+     * \setter m_user_option_stream_kb
+     *
+     * \param kb
+     *      The track size, in kilobytes, from which tracks are streamed.
+     *      Negative values are treated as 0, which disables streaming.
+     */
+
+    void option_stream_kb (int kb)
+    {
+        m_user_option_stream_kb = kb > 0 ? kb : 0 ;
+    }
+
     /**
      * \setter m_work_around_play_image
      */
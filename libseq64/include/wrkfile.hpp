@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-06-04
- * \updates       2018-06-12
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  For a quick guide to the WRK format, see, for example:
@@ -35,9 +35,11 @@
  *      WRK Cakewalk WRK File Parser (Input).
  */
 
+#include <fstream>                      /* std::ifstream                    */
 #include <list>                         /* std::list                        */
 
 #include "midifile.hpp"                 /* seq64::midifile base class       */
+#include "sequence_builder.hpp"         /* seq64::sequence_builder          */
 
 /*
  * Do not document a namespace, it breaks Doxygen.
@@ -157,7 +159,6 @@ private:
         midilong m_PunchOutTime; ///< Punch-out time.
         midilong m_EndAllTime;   ///< Time of latest event (incl. all tracks).
         int m_division;          ///< TODO.
-        midistring m_lastChunkData; ///< Holds the latest raw data chunk.
 
     //  QTextCodec * m_codec;
     //  QDataStream * m_IOStream;
@@ -169,6 +170,28 @@ private:
 
     wrkfile_private m_wrk_data;
 
+    /**
+     *  The WRK file, which stays open during parse().  It is read one chunk
+     *  at a time into the midifile buffer (see midifile::read_window()), so
+     *  that the whole file is never held in memory.
+     */
+
+    std::ifstream m_input;
+
+    /**
+     *  The size of the WRK file.  The midifile::file_size() value is only
+     *  the size of the current chunk.
+     */
+
+    size_t m_input_size;
+
+    /**
+     *  The offset in the WRK file of the next byte to be read into the
+     *  buffer.
+     */
+
+    size_t m_input_pos;
+
     /**
      *  Holds a pointer to the (single) perform object in the Sequencer64
      *  session.  We save it in order to avoid having to pass it around to the
@@ -236,6 +259,20 @@ private:
 
     sequence * m_current_seq;
 
+    /**
+     *  The channel last given to m_current_seq.  Each event carries its
+     *  channel, but the sequence is locked and updated only when it changes.
+     */
+
+    int m_seq_channel;
+
+    /**
+     *  Collects the events of the current sequence, which are committed to
+     *  it, sorted, when the track is finalized.
+     */
+
+    sequence_builder m_builder;
+
 public:
 
     wrkfile
@@ -259,6 +296,15 @@ private:
         return b == 255 ? (-1) : int(b) ;
     }
 
+    /**
+     *  Checks if the whole WRK file has been read into the buffer.
+     */
+
+    bool input_done () const
+    {
+        return m_input_pos >= m_input_size;
+    }
+
     /**
      * \getter m_perform
      */
@@ -281,6 +327,7 @@ private:
         bool end_chunk = false
     );
     void finalize_track ();
+    void set_seq_channel (midibyte channel);
     void not_supported (const std::string & tag);
     midishort to_16_bit (midibyte c1, midibyte c2);
     midilong to_32_bit (midibyte c1, midibyte c2, midibyte c3, midibyte c4);
@@ -289,7 +336,7 @@ private:
     midilong read_32_bit ();
     std::string read_string (int len);
     std::string read_var_string ();
-    void read_raw_data (int size);
+    size_t read_input (size_t length);
     int read_chunk ();
     void NoteArray (int track, int events);
     void Track_chunk ();
@@ -32,18 +32,23 @@ CONFIG(debug, debug|release) {
 
 HEADERS += \
  include/app_limits.h \
+ include/batch_converter.hpp \
  include/businfo.hpp \
  include/calculations.hpp \
  include/click.hpp \
  include/cmdlineopts.hpp \
  include/configfile.hpp \
  include/controllers.hpp \
+ include/data_lane.hpp \
  include/daemonize.hpp \
  include/easy_macros.h \
  include/editable_event.hpp \
  include/editable_events.hpp \
+ include/editable_events_view.hpp \
  include/event.hpp \
  include/event_list.hpp \
+ include/event_stream.hpp \
+ include/event_summary.hpp \
  include/file_functions.hpp \
  include/gdk_basic_keys.h \
  include/globals.h \
@@ -52,6 +57,7 @@ HEADERS += \
  include/keys_perform.hpp \
  include/keystroke.hpp \
  include/lash.hpp \
+ include/lazy_loader.hpp \
  include/mastermidibase.hpp \
  include/mastermidibus.hpp \
  include/midi_container.hpp \
@@ -72,10 +78,19 @@ HEADERS += \
  include/rc_settings.hpp \
  include/recent.hpp \
  include/rect.hpp \
+ include/render_snapshot.hpp \
+ include/rt_command.hpp \
+ include/rt_notify.hpp \
+ include/rt_safe.hpp \
+ include/rt_statistics.hpp \
+ include/rt_trace.hpp \
  include/scales.h \
  include/seq64_features.h \
  include/sequence.hpp \
+ include/sequence_builder.hpp \
+ include/session_snapshot.hpp \
  include/settings.hpp \
+ include/song_saver.hpp \
  include/triggers.hpp \
  include/user_instrument.hpp \
  include/user_midi_bus.hpp \
@@ -84,24 +99,30 @@ HEADERS += \
  include/wrkfile.hpp
 
 SOURCES += \
+ src/batch_converter.cpp \
  src/businfo.cpp \
  src/calculations.cpp \
  src/click.cpp \
  src/cmdlineopts.cpp \
  src/configfile.cpp \
  src/controllers.cpp \
+ src/data_lane.cpp \
  src/daemonize.cpp \
  src/easy_macros.cpp \
  src/editable_event.cpp \
  src/editable_events.cpp \
+ src/editable_events_view.cpp \
  src/event.cpp \
  src/event_list.cpp \
+ src/event_stream.cpp \
+ src/event_summary.cpp \
  src/file_functions.cpp \
  src/gui_assistant.cpp \
  src/jack_assistant.cpp \
  src/keys_perform.cpp \
  src/keystroke.cpp \
  src/lash.cpp \
+ src/lazy_loader.cpp \
  src/mastermidibase.cpp \
  src/midi_container.cpp \
  src/midi_control.cpp \
@@ -118,9 +139,18 @@ SOURCES += \
  src/rc_settings.cpp \
  src/recent.cpp \
  src/rect.cpp \
+ src/render_snapshot.cpp \
+ src/rt_command.cpp \
+ src/rt_notify.cpp \
+ src/rt_safe.cpp \
+ src/rt_statistics.cpp \
+ src/rt_trace.cpp \
  src/seq64_features.cpp \
  src/sequence.cpp \
+ src/sequence_builder.cpp \
+ src/session_snapshot.cpp \
  src/settings.cpp \
+ src/song_saver.cpp \
  src/triggers.cpp \
  src/user_instrument.cpp \
  src/user_midi_bus.cpp \
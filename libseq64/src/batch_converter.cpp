@@ -0,0 +1,541 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          batch_converter.cpp
+ *
+ *  This module defines the class for converting or checking many MIDI and
+ *  WRK files at once.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the batch_converter.hpp module for the overview.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <fstream>                      /* std::ifstream                    */
+#include <map>                          /* std::map                         */
+#include <memory>                       /* std::unique_ptr<>                */
+#include <stdio.h>                      /* printf()                         */
+#include <thread>                       /* std::thread                      */
+
+#include "batch_converter.hpp"          /* seq64::batch_converter           */
+#include "file_functions.hpp"           /* seq64::list_directory(), etc.    */
+#include "gui_assistant.hpp"            /* seq64::gui_assistant             */
+#include "keys_perform.hpp"             /* seq64::keys_perform              */
+#include "perform.hpp"                  /* must precede midifile.hpp !      */
+#include "midifile.hpp"                 /* seq64::midifile                  */
+#include "settings.hpp"                 /* seq64::rc() and usr()            */
+#include "wrkfile.hpp"                  /* seq64::wrkfile                   */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Tells if a file found in a directory is one to process, by its
+ *  extension.
+ *
+ * \param filename
+ *      The name of the file.
+ *
+ * \return
+ *      Returns true for ".mid", ".midi", and ".wrk" files, in any case.
+ */
+
+static bool
+is_song_file (const std::string & filename)
+{
+    return
+    (
+        file_extension_match(filename, "mid") ||
+        file_extension_match(filename, "midi") ||
+        file_extension_match(filename, "wrk")
+    );
+}
+
+/**
+ *  Gets the name of a file without its directory.
+ *
+ * \param path
+ *      The name of the file, with or without a directory.
+ *
+ * \return
+ *      Returns the part of the path after the last slash.
+ */
+
+static std::string
+base_name (const std::string & path)
+{
+    std::string::size_type slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1) ;
+}
+
+/**
+ *  Gets the size of a file.
+ *
+ * \param filename
+ *      The name of the file.
+ *
+ * \return
+ *      Returns the size in bytes, or 0 if the file cannot be opened.
+ */
+
+static long
+file_size (const std::string & filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+    long result = 0;
+    if (file.is_open())
+        result = long(file.tellg());
+
+    return result > 0 ? result : 0 ;
+}
+
+/**
+ *  Default constructor.  Files are converted at their own PPQN, with the
+ *  proprietary section, on one thread per processor core.
+ */
+
+batch_converter::batch_converter ()
+ :
+    m_jobs          (),
+    m_output_dir    (),
+    m_ppqn          (SEQ64_USE_FILE_PPQN),
+    m_seqspec       (true),
+    m_check_only    (false),
+    m_threads       (0),
+    m_next          (0),
+    m_elapsed       (0.0)
+{
+    // Empty body
+}
+
+/**
+ *  Adds a file, or the MIDI and WRK files of a directory, to the list.  A
+ *  file named directly is taken whatever its extension is; it is read as a
+ *  WRK file if its extension is ".wrk", and as a MIDI file otherwise.
+ *  Subdirectories are not searched.
+ *
+ * \param path
+ *      The file or directory.
+ *
+ * \return
+ *      Returns false if the path does not exist or cannot be read.
+ */
+
+bool
+batch_converter::add_path (const std::string & path)
+{
+    std::vector<std::string> names;
+    bool result;
+    if (file_is_directory(path))
+    {
+        std::vector<std::string> found;
+        result = list_directory(path, found);
+        for
+        (
+            std::vector<std::string>::const_iterator f = found.begin();
+            f != found.end(); ++f
+        )
+        {
+            if (is_song_file(*f))
+                names.push_back(*f);
+        }
+    }
+    else
+    {
+        result = file_accessible(path);
+        if (result)
+            names.push_back(path);
+    }
+    for
+    (
+        std::vector<std::string>::const_iterator n = names.begin();
+        n != names.end(); ++n
+    )
+    {
+        job j;
+        j.m_input = *n;
+        j.m_ok = false;
+        j.m_bytes = 0;
+        j.m_patterns = 0;
+        j.m_seconds = 0.0;
+        m_jobs.push_back(j);
+    }
+    return result;
+}
+
+/**
+ *  Makes the name of the converted file:  the base name of the input file,
+ *  in the output directory.  A WRK file becomes a ".midi" file.
+ *
+ * \param input
+ *      The name of the input file.
+ *
+ * \return
+ *      Returns the full name of the output file.
+ */
+
+std::string
+batch_converter::output_name (const std::string & input) const
+{
+    std::string base = base_name(input);
+    if (file_extension_match(base, "wrk"))
+        base = base.substr(0, base.length() - 3) + "midi";
+
+    std::string result = m_output_dir;
+    if (! result.empty() && result[result.length() - 1] != '/')
+        result += "/";
+
+    return result + base;
+}
+
+/**
+ * \return
+ *      Returns the number of worker threads to use, never more than the
+ *      number of files, and at least 1.
+ */
+
+int
+batch_converter::thread_count () const
+{
+    int result = m_threads;
+    if (result == 0)
+        result = int(std::thread::hardware_concurrency());  /* 0 if unknown */
+
+    if (result > int(m_jobs.size()))
+        result = int(m_jobs.size());
+
+    return result > 0 ? result : 1 ;
+}
+
+/**
+ *  Processes all of the files.  The output names are checked first:  a file
+ *  whose output name is the same as that of an earlier file, or as the
+ *  name of an input file, is not processed, since the input files must not
+ *  be overwritten.  Then the worker threads take the files, one at a time,
+ *  until none are left.
+ *
+ * \return
+ *      Returns true if every file was processed, and false if any file
+ *      failed, or if the output directory does not exist.
+ */
+
+bool
+batch_converter::run ()
+{
+    std::map<std::string, std::string> outputs;
+    std::string outdir;
+    if (! m_check_only)
+    {
+        outdir = get_full_path(m_output_dir.empty() ? "." : m_output_dir);
+        if (outdir.empty() || ! file_is_directory(outdir))
+        {
+            errprint("batch output directory not found");
+            return false;
+        }
+        for
+        (
+            std::vector<job>::iterator j = m_jobs.begin();
+            j != m_jobs.end(); ++j
+        )
+        {
+            outputs[get_full_path(j->m_input)] = j->m_input;
+        }
+    }
+    for
+    (
+        std::vector<job>::iterator j = m_jobs.begin();
+        j != m_jobs.end(); ++j
+    )
+    {
+        j->m_ok = false;
+        j->m_error.clear();
+        j->m_output.clear();
+        if (! m_check_only)
+        {
+            std::string out = output_name(j->m_input);
+            std::string fullout = outdir + "/" + base_name(out);
+            std::map<std::string, std::string>::iterator o =
+                outputs.find(fullout);
+
+            if (o == outputs.end())
+            {
+                outputs[fullout] = j->m_input;
+                j->m_output = out;
+            }
+            else
+                j->m_error = "output would overwrite " + o->second;
+        }
+    }
+
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    m_next = 0;
+    std::vector<std::thread> workers;
+    int threads = thread_count();
+    for (int t = 1; t < threads; ++t)               /* this thread works too */
+        workers.push_back(std::thread(&batch_converter::work, this));
+
+    work();
+    for
+    (
+        std::vector<std::thread>::iterator w = workers.begin();
+        w != workers.end(); ++w
+    )
+    {
+        w->join();
+    }
+
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    m_elapsed = d.count();
+
+    bool result = true;
+    for
+    (
+        std::vector<job>::const_iterator j = m_jobs.begin();
+        j != m_jobs.end(); ++j
+    )
+    {
+        if (! j->m_ok)
+        {
+            result = false;
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ *  The work loop of the worker threads.  Each thread writes only to the
+ *  jobs it takes.
+ */
+
+void
+batch_converter::work ()
+{
+    int count = int(m_jobs.size());
+    for (;;)
+    {
+        int index = m_next.fetch_add(1);
+        if (index >= count)
+            break;
+
+        job & j = m_jobs[index];
+        if (j.m_error.empty())                      /* not refused by run() */
+            process(j);
+    }
+}
+
+/**
+ *  Loads one file into a perform object of its own, and writes it out,
+ *  unless only checking.  Each track is parsed serially, since the
+ *  parallelism is in the files.  A non-fatal problem found by the parser
+ *  is kept as a warning, with the job still marked as successful.
+ *
+ * \param j
+ *      The job, which receives the outcome.
+ */
+
+void
+batch_converter::process (job & j)
+{
+    std::chrono::steady_clock::time_point start =
+        std::chrono::steady_clock::now();
+
+    j.m_bytes = file_size(j.m_input);
+
+    keys_perform keys;
+    gui_assistant gui(keys);
+    perform p(gui);
+    std::unique_ptr<midifile> f;
+    if (file_extension_match(j.m_input, "wrk"))
+        f.reset(new wrkfile(j.m_input, SEQ64_USE_FILE_PPQN));
+    else
+        f.reset(new midifile(j.m_input, m_ppqn));
+
+    f->isolate();
+    f->parse_threads(1);
+    bool ok = f->parse(p);
+    j.m_error = f->error_message();
+    if (ok)
+    {
+        j.m_patterns = p.sequence_count();
+        if (! m_check_only)
+            ok = save(j, p, *f);
+    }
+    j.m_ok = ok;
+
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    j.m_seconds = d.count();
+}
+
+/**
+ *  Writes a loaded song to the output file of the job.
+ *
+ * \param j
+ *      The job, which receives the error, if any.
+ *
+ * \param p
+ *      The performance holding the song.
+ *
+ * \param source
+ *      The midifile or wrkfile that loaded the song.  It provides the PPQN
+ *      and the global key, scale, and background sequence of the song.
+ *
+ * \return
+ *      Returns true if the file was written.
+ */
+
+bool
+batch_converter::save (job & j, perform & p, const midifile & source)
+{
+    int ppqn = source.ppqn() > 0 ? source.ppqn() : SEQ64_DEFAULT_PPQN ;
+    midifile f
+    (
+        j.m_output, ppqn, rc().legacy_format(), usr().global_seq_feature()
+    );
+    f.isolate(source);
+    bool result = f.write(p, m_seqspec);
+    if (! result)
+        j.m_error = f.error_message();
+    else if (m_ppqn != SEQ64_USE_FILE_PPQN && ppqn != m_ppqn)
+        result = rescale(j);
+
+    return result;
+}
+
+/**
+ *  Reads a converted file back at the PPQN asked for, and writes it again.
+ *  The MIDI parser scales the events as it reads them, but the WRK parser
+ *  always uses the timebase of the file, so this is how a WRK file gets a
+ *  new PPQN.
+ *
+ * \param j
+ *      The job, whose output file has just been written.
+ *
+ * \return
+ *      Returns true if the file was rewritten.
+ */
+
+bool
+batch_converter::rescale (job & j)
+{
+    keys_perform keys;
+    gui_assistant gui(keys);
+    perform p(gui);
+    midifile r(j.m_output, m_ppqn);
+    r.isolate();
+    r.parse_threads(1);
+    bool result = r.parse(p);
+    if (result)
+    {
+        midifile f
+        (
+            j.m_output, m_ppqn, rc().legacy_format(),
+            usr().global_seq_feature()
+        );
+        f.isolate(r);
+        result = f.write(p, m_seqspec);
+        if (! result)
+            j.m_error = f.error_message();
+    }
+    else
+        j.m_error = r.error_message();
+
+    return result;
+}
+
+/**
+ *  Shows the outcome of the last run() on the console:  each file that
+ *  failed, or that had a warning, and the totals and throughput.
+ *
+ * \param verbose
+ *      If true, each file that succeeded is shown as well, with its pattern
+ *      count and time.
+ */
+
+void
+batch_converter::print_report (bool verbose) const
+{
+    int failed = 0;
+    int warned = 0;
+    double megabytes = 0.0;
+    for
+    (
+        std::vector<job>::const_iterator j = m_jobs.begin();
+        j != m_jobs.end(); ++j
+    )
+    {
+        megabytes += double(j->m_bytes) / (1024.0 * 1024.0);
+        if (! j->m_ok)
+        {
+            ++failed;
+            printf("? %s: %s\n", j->m_input.c_str(), j->m_error.c_str());
+        }
+        else
+        {
+            if (! j->m_error.empty())
+            {
+                ++warned;
+                printf("! %s: %s\n", j->m_input.c_str(), j->m_error.c_str());
+            }
+            if (verbose)
+            {
+                printf
+                (
+                    "  %s%s%s: %d patterns, %.1f ms\n",
+                    j->m_input.c_str(), j->m_output.empty() ? "" : " -> ",
+                    j->m_output.c_str(), j->m_patterns, j->m_seconds * 1000.0
+                );
+            }
+        }
+    }
+
+    int count = int(m_jobs.size());
+    double secs = m_elapsed > 0.0 ? m_elapsed : 1e-9 ;
+    printf
+    (
+        "[%s %d files: %d ok, %d failed, %d with warnings; %d threads]\n",
+        m_check_only ? "Checked" : "Converted",
+        count, count - failed, failed, warned, thread_count()
+    );
+    printf
+    (
+        "[%.2f MB in %.3f s: %.1f files/s, %.2f MB/s]\n",
+        megabytes, m_elapsed, double(count) / secs, megabytes / secs
+    );
+}
+
+}           // namespace seq64
+
+/*
+ * batch_converter.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-20
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The "rc" command-line options override setting that are first read from
@@ -251,7 +251,7 @@ static const char * const s_help_1b =
 static const char * const s_help_2 =
 "   -k, --show-keys          Prints pressed key value.\n"
 "   -K, --inverse            Inverse (night) color scheme for seq/perf editors.\n"
-"   -S, --stats              Show global statistics.\n"
+"   -S, --stats              Show output-thread statistics at exit.\n"
 #ifdef SEQ64_JACK_SUPPORT
 "   -j, --jack-transport     Synchronize to JACK transport.\n"
 "   -J, --jack-master        Try to be JACK Master. Also sets -j.\n"
@@ -303,6 +303,31 @@ static const char * const s_help_4 =
 "                            If '=filename' is not provided, then the filename\n"
 "                            specified in '[user-options]' in the 'usr' file is\n"
 "                            used.\n"
+"              stats=file    Write the output-thread timing statistics\n"
+"                            (latency, jitter, underruns) to this file at\n"
+"                            exit.  In seq64cli, SIGUSR1 also writes them.\n"
+"              trace=file    Trace the output, input, and GUI threads, and\n"
+"                            write the trace to this file at exit, for\n"
+"                            viewing in chrome://tracing or Perfetto.\n"
+"              rtsafe        Lock memory at launch and keep the output and\n"
+"                            input threads off the heap.  If built with\n"
+"                            --enable-rtguard, report any allocation they\n"
+"                            make while playing.  Same as 'rtsafe=on'.\n"
+"              rtsafe=abort  The same, but abort on such an allocation.\n"
+"              rtsafe=off    Turn the RT-safe mode off.\n"
+"              lazy          Read only the settings and triggers of each\n"
+"                            pattern when opening a MIDI file; decode the\n"
+"                            events when first played, edited, or drawn.\n"
+"              snapshot      Keep a binary snapshot of each MIDI file opened\n"
+"                            in the configuration directory, and load it\n"
+"                            instead of the file while the file is unchanged.\n"
+"              autosave=secs Every secs seconds, save a modified song to\n"
+"                            'name.autosave.midi' (or 'autosave.midi' in the\n"
+"                            configuration directory), in the background.\n"
+"              stream=kb     Play each pattern of a MIDI file whose track is\n"
+"                            at least kb kilobytes straight from the file\n"
+"                            data, decoding its events just ahead of the\n"
+"                            playhead, until it is drawn or edited.\n"
 #if defined SEQ64_MULTI_MAINWID
 "              wid=RxC,F     Show R rows of sets, C columns of sets, and set\n"
 "                            the sync-status of the set blocks. R can range\n"
@@ -322,6 +347,12 @@ static const char * const s_help_4 =
 "              daemonize     Makes this application fork to the background.\n"
 "              no-daemonize  Or not.  These options do not apply to Windows.\n"
 "\n"
+"seq64cli --batch [--output dir | --check] [--ppqn n] [--jobs n]\n"
+"         [--strip-seqspec] [--verbose] file-or-directory ...\n"
+"              Converts (or only loads, with --check) many MIDI and WRK\n"
+"              files on a pool of threads, with no MIDI engine, then reports\n"
+"              the errors and the throughput.  '--batch' must come first.\n"
+"\n"
 "The 'daemonize' option works only in the CLI build. The 'sets' option works in\n"
 "the CLI build as well.  Specify the '--user-save' option to make these options\n"
 "permanent in the sequencer64.usr configuration file.\n"
@@ -495,6 +526,21 @@ parse_o_options (int argc, char * argv [])
                                 result = true;
                                 usr().option_daemonize(false);
                             }
+                            else if (arg == "rtsafe")
+                            {
+                                result = true;
+                                usr().option_rtsafe(true);
+                            }
+                            else if (arg == "lazy")
+                            {
+                                result = true;
+                                usr().option_lazy_load(true);
+                            }
+                            else if (arg == "snapshot")
+                            {
+                                result = true;
+                                usr().option_snapshot(true);
+                            }
                             else if (arg == "log")
                             {
                                 /*
@@ -523,6 +569,39 @@ parse_o_options (int argc, char * argv [])
                                 if (! arg.empty())
                                     usr().option_use_logfile(true);
                             }
+                            else if (optionname == "stats")
+                            {
+                                result = ! arg.empty();
+                                usr().option_statsfile(arg);
+                            }
+                            else if (optionname == "trace")
+                            {
+                                result = ! arg.empty();
+                                usr().option_tracefile(arg);
+                            }
+                            else if (optionname == "autosave")
+                            {
+                                int secs = atoi(arg.c_str());
+                                result = secs > 0;
+                                usr().option_autosave(secs);
+                            }
+                            else if (optionname == "stream")
+                            {
+                                int kb = atoi(arg.c_str());
+                                result = kb > 0;
+                                usr().option_stream_kb(kb);
+                            }
+                            else if (optionname == "rtsafe")
+                            {
+                                result = arg == "on" || arg == "abort" ||
+                                    arg == "off";
+
+                                if (result)
+                                {
+                                    usr().option_rtsafe(arg != "off");
+                                    usr().option_rtsafe_abort(arg == "abort");
+                                }
+                            }
 #if defined SEQ64_MULTI_MAINWID
                             else if (optionname == "wid")
                             {
@@ -1186,8 +1265,8 @@ build_details ()
 #ifdef SEQ64_SONG_BOX_SELECT
         << "Box song selection on" << std::endl
 #endif
-#ifdef SEQ64_STATISTICS_SUPPORT
-        << "Statistics support on" << std::endl
+#ifdef SEQ64_RTSAFE_GUARD
+        << "RT-safe allocation guard on" << std::endl
 #endif
 #ifdef PLATFORM_WINDOWS
         << "Windows support on" << std::endl
@@ -25,12 +25,13 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2017-12-17
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  We found a couple of unused members in this module and removed them.
  */
 
+#include <algorithm>                    /* std::min()                   */
 #include <iostream>
 #include <string.h>                     /* strncmp() function needed!   */
 
@@ -54,6 +55,10 @@ namespace seq64
 configfile::configfile (const std::string & name)
  :
     m_error_message (),
+    m_lines         (),
+    m_sections      (),
+    m_line_index    (0),
+    m_last_line_ended (true),
     m_name          (name),
     m_d             (nullptr),
     m_line          ()          /* array of characters              */
@@ -62,17 +67,93 @@ configfile::configfile (const std::string & name)
 }
 
 /**
- *  Gets the next line of data from an input stream.  If the line starts with
+ *  Reads the whole configuration file, splits it into lines, and indexes the
+ *  lines that start with a section tag.  The parse() functions call this
+ *  function once, after opening the file, and then read the lines with
+ *  line_after() and next_data_line().
+ *
+ * \param file
+ *      Points to the input stream, which must be open.
+ */
+
+void
+configfile::index_lines (std::ifstream & file)
+{
+    m_lines.clear();
+    m_sections.clear();
+    m_line_index = 0;
+
+    std::string text;
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    if (size > 0)
+    {
+        text.resize(size_t(size));
+        file.read(&text[0], size);
+        text.resize(size_t(file.gcount()));     /* fewer with CR-LF text    */
+    }
+
+    size_t start = 0;
+    while (start < text.length())
+    {
+        size_t end = text.find('\n', start);
+        if (end == std::string::npos)
+            end = text.length();
+
+        m_lines.push_back(text.substr(start, end - start));
+
+        const std::string & line = m_lines.back();
+        if (! line.empty() && line[0] == '[')
+        {
+            size_t bracket = line.find(']');
+            std::string tag = bracket == std::string::npos ?
+                line : line.substr(0, bracket + 1) ;
+
+            (void) m_sections.insert        /* keeps the first one      */
+            (
+                std::make_pair(tag, m_lines.size() - 1)
+            );
+        }
+        start = end + 1;
+    }
+    m_last_line_ended = text.empty() || text[text.length() - 1] == '\n';
+}
+
+/**
+ *  Copies the next line into m_line, as std::ifstream::getline() would.  A
+ *  line too long for m_line is cut short.
+ *
+ * \return
+ *      Returns false if the end of the file was reached, in which case
+ *      m_line may still hold the last line, if it has no newline.
+ */
+
+bool
+configfile::read_line ()
+{
+    bool result = false;
+    if (m_line_index < m_lines.size())
+    {
+        const std::string & line = m_lines[m_line_index++];
+        size_t len = std::min(line.length(), sizeof m_line - 1);
+        (void) line.copy(m_line, len);
+        m_line[len] = 0;
+        result = m_line_index < m_lines.size() || m_last_line_ended;
+    }
+    else
+        m_line[0] = 0;
+
+    return result;
+}
+
+/**
+ *  Gets the next line of data from the file.  If the line starts with
  *  a number-sign, a space (!), or a null, it is skipped, to try the next
  *  line.  This occurs until an EOF is encountered.
  *
  *  Member m_line is a "global" return value.
  *
- * \param file
- *      Points to an input stream.  We converted this item to a reference;
- *      pointers can be subject to problems.  For example, what if someone
- *      passes a null pointer?
- *
  * \return
  *      Returns true if a presumed data line was found.  False is returned if
  *      not found before an EOF or a section marker ("[") is found.  This is a
@@ -81,23 +162,22 @@ configfile::configfile (const std::string & name)
  */
 
 bool
-configfile::next_data_line (std::ifstream & file)
+configfile::next_data_line ()
 {
     bool result = true;
-    char ch;
-    file.getline(m_line, sizeof m_line);
-    ch = m_line[0];
-    while ((ch == '#' || /*ch == ' ' ||*/ ch == '[' || ch == 0) && ! file.eof())
+    bool more = read_line();
+    char ch = m_line[0];
+    while ((ch == '#' || /*ch == ' ' ||*/ ch == '[' || ch == 0) && more)
     {
         if (m_line[0] == '[')
         {
             result = false;
             break;
         }
-        file.getline(m_line, sizeof m_line);
+        more = read_line();
         ch = m_line[0];
     }
-    if (file.eof())
+    if (! more)
         result = false;
 
     return result;
@@ -107,47 +187,66 @@ configfile::next_data_line (std::ifstream & file)
  *  This function gets a specific line of text, specified as a tag.
  *  Then it gets the next non-blank line (i.e. data line) after that.
  *
- *  This function always starts from the beginning of the file.  Therefore,
- *  it can handle reading Sequencer64 configuration files that have had
- *  their tagged sections arranged in a different order.  This feature makes
- *  the configuration file a little more robust against errors.
- *
- * \param file
- *      Points to the input file stream.
+ *  The tag is looked up in the section index made by index_lines(), so the
+ *  position in the file does not matter.  Therefore, it can handle reading
+ *  Sequencer64 configuration files that have had their tagged sections
+ *  arranged in a different order.  This feature makes the configuration
+ *  file a little more robust against errors.
  *
  * \param tag
- *      Provides a tag to be found.  Lines are read until a match occurs
- *      with this tag.  Normally, the tag is a section marker, such as
- *      "[user-interface]".  Best to assume an exact match is needed.
+ *      Provides a tag to be found, a section marker such as
+ *      "[user-interface]".  An exact match with the start of the line, up to
+ *      its first "]", is needed.
  *
  * \return
- *      Returns true if the tag was found.  Otherwise, false is returned.
+ *      Returns true if the tag was found, and a data line follows it.
+ *      Otherwise, false is returned, and m_line is empty if the tag was not
+ *      found.
  */
 
 bool
-configfile::line_after (std::ifstream & file, const std::string & tag)
+configfile::line_after (const std::string & tag)
 {
     bool result = false;
-    file.clear();
-    file.seekg(0, std::ios::beg);
-    file.getline(m_line, sizeof m_line);
-    while (file.good())                 /* includes the EOF check           */
+    std::map<std::string, size_t>::const_iterator s = m_sections.find(tag);
+    if (s != m_sections.end())
     {
-        result = strncmp(m_line, tag.c_str(), tag.length()) == 0;
-        if (result)
-            break;
-        else
-        {
-            if (file.bad())
-            {
-                errprint("bad file stream reading config file");
-            }
-            else
-                file.getline(m_line, sizeof m_line);
-        }
+        m_line_index = s->second + 1;
+        result = next_data_line();
+    }
+    else
+    {
+        m_line_index = m_lines.size();
+        m_line[0] = 0;
     }
+    return result;
+}
+
+/**
+ *  Writes the text of the configuration file, which the write() functions
+ *  build in memory, in one go.  The file is truncated only once the whole
+ *  text is ready.
+ *
+ * \param text
+ *      The full contents of the file.
+ *
+ * \return
+ *      Returns true if the file was opened and written.
+ */
+
+bool
+configfile::write_text (const std::string & text)
+{
+    std::ofstream file(m_name.c_str(), std::ios::out | std::ios::trunc);
+    bool result = file.is_open();
     if (result)
-        result = next_data_line(file);
+    {
+        file.write(text.data(), std::streamsize(text.length()));
+        file.close();
+        result = ! file.fail();
+    }
+    if (! result)
+        fprintf(stderr, "? error writing [%s]\n", m_name.c_str());
 
     return result;
 }
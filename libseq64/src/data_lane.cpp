@@ -0,0 +1,216 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          data_lane.cpp
+ *
+ *  This module defines the cached geometry of the data pane of the pattern
+ *  editor.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the data_lane.hpp module for the overview.
+ */
+
+#include "calculations.hpp"             /* seq64::tempo_to_note_value()     */
+#include "data_lane.hpp"                /* seq64::data_lane                 */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Default constructor.  The lane starts out empty, and is built by the
+ *  first call to update().
+ */
+
+data_lane::data_lane ()
+ :
+    m_seq               (nullptr),
+    m_version           (0),
+    m_event_count       (0),
+    m_length            (0),
+    m_ticks_per_pixel   (0),
+    m_status            (0),
+    m_cc                (0),
+    m_bars              ()
+{
+    // Empty body
+}
+
+/**
+ *  Brings the lane up to date.  The value of an event is its second data
+ *  byte, or its first for one-byte messages, as drawn by the data panes.
+ *  Tempo events are drawn at their scaled tempo, and show the tempo in
+ *  beats/minute.  Other Meta and SysEx events are skipped.
+ *
+ * \param s
+ *      The sequence.  Not const because the sequence's iteration functions
+ *      are not.
+ *
+ * \param ticks_per_pixel
+ *      The zoom of the pane.
+ *
+ * \param status
+ *      The kind of event to show.
+ *
+ * \param cc
+ *      The controller number, if status is a control change.
+ *
+ * \return
+ *      Returns true if the lane was rebuilt, false if it was current.
+ */
+
+bool
+data_lane::update
+(
+    sequence & s, midipulse ticks_per_pixel, midibyte status, midibyte cc
+)
+{
+    if (ticks_per_pixel <= 0)
+        ticks_per_pixel = 1;
+
+    bool current =
+        m_seq == &s && m_ticks_per_pixel == ticks_per_pixel &&
+        m_status == status && m_cc == cc &&
+        m_version == s.edit_version() &&
+        m_event_count == s.event_count() && m_length == s.get_length();
+
+    if (current)
+        return false;
+
+    m_seq = &s;
+    m_version = s.edit_version();
+    m_event_count = s.event_count();
+    m_length = s.get_length();
+    m_ticks_per_pixel = ticks_per_pixel;
+    m_status = status;
+    m_cc = cc;
+    m_bars.clear();
+
+    bool onebyte = event::is_one_byte_msg(status);
+    event_list::const_iterator cev;
+    s.reset_ex_iterator(cev);
+    while (s.get_next_event_match(status, cc, cev))
+    {
+        const event & ev = DREF(cev);
+        ++cev;
+
+        int height, value;
+        bool tempo = ev.is_tempo();
+        if (tempo)
+        {
+            height = int(tempo_to_note_value(ev.tempo()));
+            value = int(ev.tempo());
+        }
+        else if (ev.is_ex_data())
+            continue;
+        else
+        {
+            midibyte d0, d1;
+            ev.get_data(d0, d1);
+            height = value = onebyte ? d0 : d1 ;
+        }
+
+        int x = int(ev.get_timestamp() / ticks_per_pixel);
+        if (m_bars.empty() || m_bars.back().x != x)
+        {
+            bar b;
+            b.x = x;
+            b.low = b.high = height;
+            b.selected_high = -1;
+            b.count = 0;
+            b.tempo = false;
+            m_bars.push_back(b);
+        }
+
+        bar & b = m_bars.back();
+        if (height < b.low)
+            b.low = height;
+
+        if (height > b.high)
+            b.high = height;
+
+        if (ev.is_selected() && height > b.selected_high)
+            b.selected_high = height;
+
+        if (tempo)
+            b.tempo = true;
+
+        b.value = value;
+        ++b.count;
+    }
+    return true;
+}
+
+/**
+ *  Forgets the lane, freeing its memory.  The next update rebuilds it.
+ */
+
+void
+data_lane::clear ()
+{
+    m_seq = nullptr;
+    m_ticks_per_pixel = 0;
+    m_bars.clear();
+}
+
+/**
+ *  Finds the first bar at or to the right of a pixel column, using a binary
+ *  search.
+ *
+ * \param x
+ *      The pixel column, re 0 at tick 0.
+ *
+ * \return
+ *      Returns the index of the bar, or the number of bars if all of them
+ *      are to the left of the column.
+ */
+
+int
+data_lane::first_at (int x) const
+{
+    int lo = 0;
+    int hi = int(m_bars.size());
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (m_bars[mid].x < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+}           // namespace seq64
+
+/*
+ * data_lane.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,321 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          editable_events_view.cpp
+ *
+ *  This module defines the virtualized, index-based view of the events of a
+ *  sequence, for the event editor.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the editable_events_view.hpp module for the overview.
+ *
+ *  The index holds iterators into the sequence's event list, so it is
+ *  checked against the sequence's edit version and event count before
+ *  every use, and rebuilt if they changed.  This is the same check the
+ *  cached drawings of the pattern editors make.
+ */
+
+#include "editable_events_view.hpp"     /* seq64::editable_events_view      */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Principal constructor.  The index is built on first use.
+ *
+ * \param seq
+ *      The sequence to view and edit.
+ *
+ * \param bpm
+ *      The beats/minute, needed for formatting time stamps.
+ */
+
+editable_events_view::editable_events_view (sequence & seq, midibpm bpm)
+ :
+    m_sequence  (seq),
+    m_parent    (seq, bpm),
+    m_index     (),
+    m_version   (0),
+    m_count     (-1),
+    m_rows      ()
+{
+    // Empty body
+}
+
+/**
+ *  Rebuilds the index if the sequence has changed since it was built.
+ *  This is a single pass over the event list that copies one iterator per
+ *  event; no events or strings are copied.  All cached rows are dropped.
+ *
+ * \return
+ *      Returns true if the index was rebuilt.
+ */
+
+bool
+editable_events_view::refresh ()
+{
+    bool result = m_count != m_sequence.event_count() ||
+        m_version != m_sequence.edit_version();
+
+    if (result)
+    {
+        const event_list & evl = m_sequence.events();
+        m_version = m_sequence.edit_version();
+        m_rows.clear();
+        m_index.clear();
+        m_index.reserve(evl.count());
+        for (event_list::const_iterator ei = evl.begin(); ei != evl.end(); ++ei)
+            m_index.push_back(ei);
+
+        m_count = int(m_index.size());
+    }
+    return result;
+}
+
+/**
+ * \return
+ *      Returns the number of events in the sequence, after refreshing the
+ *      index if needed.
+ */
+
+int
+editable_events_view::count ()
+{
+    (void) refresh();
+    return m_count;
+}
+
+/**
+ *  Gets a row, making its editable event if it is not already cached.  The
+ *  caller must check the index against count().
+ *
+ * \param index
+ *      The index of the event, re 0 at the start of the sequence.
+ *
+ * \return
+ *      Returns a reference to the row, valid until the next change to the
+ *      sequence or call to trim().
+ */
+
+editable_event &
+editable_events_view::row (int index)
+{
+    (void) refresh();
+    Rows::iterator ri = m_rows.find(index);
+    if (ri == m_rows.end())
+    {
+        editable_event ev(m_parent, DREF(m_index[index]));
+        ri = m_rows.insert(std::make_pair(index, ev)).first;
+    }
+    return ri->second;
+}
+
+/**
+ *  Finds the first event at or after a given time, using a binary search
+ *  of the index.
+ *
+ * \param tick
+ *      The time to find.
+ *
+ * \return
+ *      Returns the index of the event, or the index of the last event if
+ *      all events are earlier, or -1 if there are no events.
+ */
+
+int
+editable_events_view::locate (midipulse tick)
+{
+    int lo = 0;
+    int hi = count();
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (DREF(m_index[mid]).get_timestamp() < tick)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo < m_count ? lo : m_count - 1 ;
+}
+
+/**
+ *  Finds an event that has the same time, status, and data as the given
+ *  event; used to find an event just inserted or modified.
+ *
+ * \param e
+ *      The event to find.
+ *
+ * \return
+ *      Returns the index of the event, or -1 if it is not found.
+ */
+
+int
+editable_events_view::locate (const editable_event & e)
+{
+    midibyte d0, d1;
+    e.get_data(d0, d1);
+    for (int i = locate(e.get_timestamp()); i >= 0 && i < m_count; ++i)
+    {
+        const event & ev = DREF(m_index[i]);
+        if (ev.get_timestamp() != e.get_timestamp())
+            break;
+
+        midibyte e0, e1;
+        ev.get_data(e0, e1);
+        if (ev.get_status() == e.get_status() && e0 == d0 && e1 == d1)
+            return i;
+    }
+    return -1;
+}
+
+/**
+ *  Drops the cached rows that are far from the visible lines, so that
+ *  scrolling through a long pattern does not accumulate rows.  Rows within
+ *  one screenful above or below the visible lines are kept.
+ *
+ * \param top
+ *      The index of the first visible line.
+ *
+ * \param lines
+ *      The number of visible lines.
+ */
+
+void
+editable_events_view::trim (int top, int lines)
+{
+    int low = top - lines;
+    int high = top + 2 * lines;
+    m_rows.erase(m_rows.begin(), m_rows.lower_bound(low));
+    m_rows.erase(m_rows.upper_bound(high), m_rows.end());
+}
+
+/**
+ * \return
+ *      Returns the time stamp of the last event, or 0 if there are none.
+ */
+
+midipulse
+editable_events_view::get_length ()
+{
+    return count() > 0 ? DREF(m_index[m_count - 1]).get_timestamp() : 0 ;
+}
+
+/**
+ *  Adds an event to the sequence.  If the event is past the end of the
+ *  sequence, the sequence is lengthened to the end of the event's measure,
+ *  which is handy for the tempo track.
+ *
+ * \param e
+ *      The event to add.
+ *
+ * \return
+ *      Returns true if the event was added.
+ */
+
+bool
+editable_events_view::insert (const editable_event & e)
+{
+    m_sequence.push_undo();
+
+    bool result = m_sequence.add_event(e);
+    if (result)
+    {
+        midipulse ts = e.get_timestamp();
+        if (ts >= m_sequence.get_length())
+        {
+            midipulse unit = m_sequence.unit_measure();
+            if (unit > 0)
+                m_sequence.set_length((ts / unit + 1) * unit);
+        }
+        m_sequence.modify();
+    }
+    return result;
+}
+
+/**
+ *  Removes an event from the sequence.
+ *
+ * \param index
+ *      The index of the event.
+ *
+ * \return
+ *      Returns true if the event was removed.  Returns false if the pattern
+ *      changed since the index was built; see refresh().
+ */
+
+bool
+editable_events_view::remove (int index)
+{
+    bool result = valid_index(index);
+    if (result)
+    {
+        m_sequence.push_undo();
+        result = m_sequence.remove_event(m_index[index], m_version);
+        if (result)
+            m_sequence.modify();
+    }
+    return result;
+}
+
+/**
+ *  Replaces an event of the sequence with a modified version.
+ *
+ * \param index
+ *      The index of the event.
+ *
+ * \param e
+ *      The modified event.
+ *
+ * \return
+ *      Returns true if the event was replaced.  Returns false if the pattern
+ *      changed since the index was built.
+ */
+
+bool
+editable_events_view::modify (int index, const editable_event & e)
+{
+    bool result = valid_index(index);
+    if (result)
+    {
+        m_sequence.push_undo();
+        result = m_sequence.replace_event(m_index[index], m_version, e);
+        if (result)
+            m_sequence.modify();
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * editable_events_view.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-19
- * \updates       2018-07-02
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This container now can indicate if certain Meta events (time-signaure or
@@ -262,6 +262,94 @@ event_list::append (const event & e)
     return true;
 }
 
+/**
+ *  Adds an event at the end of the container, for events that arrive
+ *  already in sorted order, such as those read from a session snapshot.
+ *  Unlike append(), the order is kept as given, so that no sort is needed
+ *  afterward, and the stored event is returned, so that the caller can
+ *  link it without searching for it.  Any desired thread-safety must be
+ *  provided by the caller.
+ *
+ * \param e
+ *      Provides the event to be added.  It must not sort before the last
+ *      event in the container.
+ *
+ * \return
+ *      Returns a reference to the copy of the event held by the container.
+ */
+
+event &
+event_list::append_sorted (const event & e)
+{
+#ifdef SEQ64_USE_EVENT_MAP
+    event_key key(e);
+    iterator ie = m_events.insert(m_events.end(), std::make_pair(key, e));
+    event & result = ie->second;
+#else
+    m_events.push_back(e);
+    event & result = m_events.back();
+#endif
+
+    m_is_modified = true;
+    if (e.is_tempo())
+        m_has_tempo = true;
+
+    if (e.is_time_signature())
+        m_has_time_signature = true;
+
+    return result;
+}
+
+/**
+ *  Adds an event in sorted order, starting the search for its place at the
+ *  given position.  Meant for replacing an event with an edited copy, which
+ *  rarely moves far from where the old one was, so that the whole list
+ *  need not be sorted again, as add() would do.  Any desired thread-safety
+ *  must be provided by the caller.
+ *
+ * \param hint
+ *      The position at which to start looking, normally the one that
+ *      followed the event being replaced.
+ *
+ * \param e
+ *      Provides the event to be added.
+ *
+ * \return
+ *      Returns the position of the new event.
+ */
+
+event_list::iterator
+event_list::insert_near (iterator hint, const event & e)
+{
+#ifdef SEQ64_USE_EVENT_MAP
+    event_key key(e);
+    iterator result = m_events.insert(hint, std::make_pair(key, e));
+#else
+    while (hint != m_events.begin())        /* back up past later events    */
+    {
+        iterator prev = hint;
+        --prev;
+        if (e < *prev)
+            hint = prev;
+        else
+            break;
+    }
+    while (hint != m_events.end() && ! (e < *hint))
+        ++hint;                             /* skip earlier, equal events   */
+
+    iterator result = m_events.insert(hint, e);
+#endif
+
+    m_is_modified = true;
+    if (e.is_tempo())
+        m_has_tempo = true;
+
+    if (e.is_time_signature())
+        m_has_time_signature = true;
+
+    return result;
+}
+
 #ifdef SEQ64_USE_EVENT_MAP
 
 /**
@@ -309,6 +397,14 @@ event_list::merge (event_list & el, bool /*presort*/ )
     int initialsize = count();
     int addedsize = el.count();
     m_events.insert(el.events().begin(), el.events().end());
+    el.m_events.clear();                    /* as std::list::merge() does   */
+    m_is_modified = true;
+    if (el.m_has_tempo)
+        m_has_tempo = true;
+
+    if (el.m_has_time_signature)
+        m_has_time_signature = true;
+
     if (count() != (initialsize + addedsize))
     {
         char tmp[64];
@@ -330,6 +426,13 @@ event_list::merge (event_list & el, bool presort)
         el.sort();                          // el.m_events.sort();
 
     m_events.merge(el.m_events);
+    m_is_modified = true;
+    if (el.m_has_tempo)
+        m_has_tempo = true;
+
+    if (el.m_has_time_signature)
+        m_has_time_signature = true;
+
 }
 
 #endif  // SEQ64_USE_EVENT_MAP
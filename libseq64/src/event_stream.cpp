@@ -0,0 +1,449 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_stream.cpp
+ *
+ *  This module defines the class for playing a MIDI track straight from its
+ *  file encoding.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the event_stream.hpp module for the overview.
+ */
+
+#include "calculations.hpp"             /* seq64::bpm_from_bytes()          */
+#include "event.hpp"                    /* seq64::is_note_off_velocity()    */
+#include "event_stream.hpp"             /* seq64::event_stream              */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Principal constructor.  Scans the whole track once, to count the events
+ *  and build the sparse index, and leaves the stream at the start.
+ *
+ * \param data
+ *      The track data, from the first event to the End-of-Track event.
+ *
+ * \param size
+ *      The number of bytes of data.
+ *
+ * \param ppqn
+ *      The PPQN of the sequence.
+ *
+ * \param file_ppqn
+ *      The PPQN of the file, or 0 if the times are not to be scaled.
+ *
+ * \param window
+ *      The number of events to decode ahead at a time.
+ *
+ * \param spacing
+ *      The number of events between index marks.
+ */
+
+event_stream::event_stream
+(
+    const std::shared_ptr<const midibyte> & data, size_t size,
+    int ppqn, int file_ppqn, int window, int spacing
+) :
+    m_data          (data),
+    m_size          (size),
+    m_ppqn          (ppqn),
+    m_file_ppqn     (file_ppqn),
+    m_index         (),
+    m_window        (),
+    m_window_size   (window > 0 ? size_t(window) : 1),
+    m_next          (0),
+    m_pos           (0),
+    m_running_time  (0),
+    m_status        (0),
+    m_done          (false),
+    m_cursor        (0),
+    m_count         (0),
+    m_last_tick     (0)
+{
+    m_window.reserve(m_window_size);
+    build_index(spacing > 0 ? spacing : 1);
+}
+
+/**
+ *  Moves the stream so that next() hands out the events at or after the
+ *  given tick.  A seek to where the last next() stopped costs nothing.  A
+ *  seek forward from there decodes the events in between, unless an index
+ *  mark lies closer.  Otherwise, decoding starts over from the last mark
+ *  before the tick.
+ *
+ * \param tick
+ *      The time to play from, in sequence pulses.
+ */
+
+void
+event_stream::seek (midipulse tick)
+{
+    if (tick == m_cursor)
+        return;
+
+    size_t lo = 0;                          /* find first mark at tick  */
+    size_t hi = m_index.size();
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (m_index[mid].m_tick < tick)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+
+    const mark & m = m_index[lo > 0 ? lo - 1 : 0];  /* last one before it   */
+    if (tick < m_cursor || m.m_tick > m_cursor)
+        restart(m);
+
+    for (;;)
+    {
+        const message * msg = peek();
+        if (is_nullptr(msg) || msg->m_tick >= tick)
+            break;
+
+        ++m_next;
+    }
+    m_cursor = tick;
+}
+
+/**
+ *  Hands out the next event, if it is not later than the given tick.
+ *  Decodes another window of events if the current one is used up.  Does
+ *  not allocate, so it is safe to call from the output thread.
+ *
+ * \param limit
+ *      The last tick of the output cycle.
+ *
+ * \return
+ *      Returns a pointer to the event, which is valid until the next call.
+ *      Returns a null pointer if the next event is later than \a limit, or
+ *      if the end of the track is reached.
+ */
+
+const event_stream::message *
+event_stream::next (midipulse limit)
+{
+    const message * result = peek();
+    if (not_nullptr(result) && result->m_tick <= limit)
+    {
+        ++m_next;
+    }
+    else
+    {
+        result = nullptr;
+        if (limit >= m_cursor)
+            m_cursor = limit + 1;
+    }
+    return result;
+}
+
+/**
+ *  Scans the track, counting the events, and adding an index mark every
+ *  \a spacing events.  The first mark is the start of the track.
+ *
+ * \param spacing
+ *      The number of events between marks.
+ */
+
+void
+event_stream::build_index (int spacing)
+{
+    mark start = { 0, 0, 0, 0 };
+    m_index.clear();
+    m_index.push_back(start);
+    restart(start);
+
+    message msg;
+    int count = 0;
+    for (;;)
+    {
+        mark here = { 0, m_running_time, m_pos, m_status };
+        if (! decode(msg))
+            break;
+
+        if (count > 0 && (count % spacing) == 0)
+        {
+            here.m_tick = msg.m_tick;
+            m_index.push_back(here);
+        }
+        m_last_tick = msg.m_tick;
+        ++count;
+    }
+    m_count = count;
+    restart(start);
+}
+
+/**
+ *  Resets the decoder to an index mark, and empties the window.
+ *
+ * \param m
+ *      The mark to decode from.
+ */
+
+void
+event_stream::restart (const mark & m)
+{
+    m_pos = m.m_offset;
+    m_running_time = m.m_running_time;
+    m_status = m.m_status;
+    m_done = false;
+    m_window.clear();
+    m_next = 0;
+    m_cursor = m.m_tick;
+}
+
+/**
+ * \return
+ *      Returns the next event to hand out, decoding another window if
+ *      needed, or a null pointer at the end of the track.
+ */
+
+const event_stream::message *
+event_stream::peek ()
+{
+    if (m_next == m_window.size())
+        fill();
+
+    return m_next < m_window.size() ? &m_window[m_next] : nullptr ;
+}
+
+/**
+ *  Decodes up to m_window_size events into the window.  The window never
+ *  grows past the capacity reserved by the constructor.
+ */
+
+void
+event_stream::fill ()
+{
+    m_window.clear();
+    m_next = 0;
+
+    message msg;
+    while (m_window.size() < m_window_size && decode(msg))
+        m_window.push_back(msg);
+}
+
+/**
+ *  Decodes the next event that sequence::play() would send, skipping the
+ *  other events.  This follows midifile::parse_track(), including its
+ *  handling of running status and of SysEx.  Decoding stops for good at
+ *  the End-of-Track event, at the end of the data, or at a status byte
+ *  that parse_track() would reject.
+ *
+ * \param [out] m
+ *      Receives the event.
+ *
+ * \return
+ *      Returns false if there are no more events.
+ */
+
+bool
+event_stream::decode (message & m)
+{
+    while (! m_done)
+    {
+        midilong delta;
+        if (! read_varinum(delta) || m_pos >= m_size)
+            break;
+
+        m_running_time += midipulse(delta);
+
+        midibyte status = m_data.get()[m_pos];
+        if ((status & 0x80) == 0x00)        /* running status               */
+            status = m_status;
+        else
+            ++m_pos;
+
+        m_status = status;
+        m.m_tick = scaled(m_running_time);
+        m.m_bpm = 0.0;
+        m.m_status = status;
+        m.m_d0 = m.m_d1 = 0;
+
+        midibyte eventcode = status & EVENT_CLEAR_CHAN_MASK;
+        midibyte channel = status & EVENT_GET_CHAN_MASK;
+        switch (eventcode)
+        {
+        case EVENT_NOTE_OFF:
+        case EVENT_NOTE_ON:
+        case EVENT_AFTERTOUCH:
+        case EVENT_CONTROL_CHANGE:
+        case EVENT_PITCH_WHEEL:
+
+            if (! read_byte(m.m_d0) || ! read_byte(m.m_d1))
+                return false;
+
+            if (is_note_off_velocity(eventcode, m.m_d1))
+                m.m_status = EVENT_NOTE_OFF | channel;
+
+            return true;
+
+        case EVENT_PROGRAM_CHANGE:
+        case EVENT_CHANNEL_PRESSURE:
+
+            return read_byte(m.m_d0);
+
+        case EVENT_MIDI_REALTIME:
+
+            if (status == EVENT_MIDI_META)
+            {
+                midibyte mtype;
+                midilong len;
+                if (! read_byte(mtype) || ! read_varinum(len))
+                    return false;
+
+                if (mtype == EVENT_META_END_OF_TRACK)
+                {
+                    m_done = true;
+                }
+                else if (mtype == EVENT_META_SET_TEMPO && len == 3)
+                {
+                    midibyte bt[3];
+                    if (! read_byte(bt[0]) || ! read_byte(bt[1]))
+                        return false;
+
+                    if (! read_byte(bt[2]))
+                        return false;
+
+                    m.m_bpm = bpm_from_bytes(bt);
+                    if (m.m_bpm > 0.0)
+                        return true;
+                }
+                else
+                    (void) skip(len);
+            }
+            else if (status == EVENT_MIDI_SYSEX)
+            {
+                midibyte check;
+                if (! read_byte(check))
+                    return false;
+
+                if (check < 0x7D || check > 0x7F)   /* not a special ID */
+                {
+                    midilong len;
+                    --m_pos;                        /* put byte back    */
+                    if (read_varinum(len))
+                        (void) skip(len);
+                }
+            }
+            else
+                m_done = true;
+            break;
+
+        default:
+
+            m_done = true;
+            break;
+        }
+    }
+    m_done = true;
+    return false;
+}
+
+/**
+ *  Reads one byte, unless the data is used up.
+ *
+ * \param [out] b
+ *      Receives the byte.
+ *
+ * \return
+ *      Returns false, and ends the decoding, at the end of the data.
+ */
+
+bool
+event_stream::read_byte (midibyte & b)
+{
+    if (m_pos < m_size)
+    {
+        b = m_data.get()[m_pos++];
+        return true;
+    }
+    m_done = true;
+    return false;
+}
+
+/**
+ *  Reads a variable-length value, as midifile::read_varinum() does.
+ *
+ * \param [out] value
+ *      Receives the value.
+ *
+ * \return
+ *      Returns false if the data ends in the middle of the value.
+ */
+
+bool
+event_stream::read_varinum (midilong & value)
+{
+    midibyte c;
+    value = 0;
+    do
+    {
+        if (! read_byte(c))
+            return false;
+
+        value = (value << 7) + (c & 0x7F);
+
+    } while ((c & 0x80) != 0x00);
+    return true;
+}
+
+/**
+ *  Skips the data of an event.
+ *
+ * \param count
+ *      The number of bytes to skip.
+ *
+ * \return
+ *      Returns false, and ends the decoding, if there are not that many
+ *      bytes left.
+ */
+
+bool
+event_stream::skip (midilong count)
+{
+    if (count <= m_size - m_pos)
+    {
+        m_pos += count;
+        return true;
+    }
+    m_pos = m_size;
+    m_done = true;
+    return false;
+}
+
+}           // namespace seq64
+
+/*
+ * event_stream.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,247 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          event_summary.cpp
+ *
+ *  This module defines the zoom-dependent summary of the events of a
+ *  sequence.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the event_summary.hpp module for the overview.
+ */
+
+#include "event_summary.hpp"            /* seq64::event_summary             */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Default constructor.  The summary starts out empty, and is filled by the
+ *  first call to update_notes().
+ */
+
+event_summary::event_summary ()
+ :
+    m_seq           (nullptr),
+    m_version       (0),
+    m_event_count   (0),
+    m_length        (0),
+    m_bucket_ticks  (0),
+    m_notes         ()
+{
+    // Empty body
+}
+
+/**
+ *  Decides if a view of a sequence is dense enough to be drawn from a
+ *  summary.  This is the case when the sequence averages more than
+ *  SEQ64_LOD_EVENTS_PER_PIXEL events in each pixel column.
+ *
+ * \param s
+ *      The sequence to be drawn.
+ *
+ * \param ticks_per_pixel
+ *      The zoom of the view.
+ *
+ * \return
+ *      Returns true if the view should draw from a summary.
+ */
+
+bool
+event_summary::use_summary (const sequence & s, midipulse ticks_per_pixel)
+{
+    midipulse len = s.get_length();
+    if (len <= 0 || ticks_per_pixel <= 0)
+        return false;
+
+    midipulse pixels = len / ticks_per_pixel + 1;
+    return midipulse(s.event_count()) > pixels * SEQ64_LOD_EVENTS_PER_PIXEL;
+}
+
+/**
+ *  Brings the summary of the notes of a sequence up to date.  Each linked
+ *  note marks its row in every bucket from its Note On to its Note Off,
+ *  including notes that wrap around the end of the pattern.  Unlinked Note
+ *  Ons and Offs mark only their own bucket.
+ *
+ *  Zooming out by a whole factor, with the events unchanged, does not look
+ *  at the events again:  the existing buckets are merged, which gives the
+ *  same result as a rebuild.
+ *
+ * \param s
+ *      The sequence.  Its notes are read from its render snapshot.
+ *
+ * \param bucket_ticks
+ *      The ticks per bucket, normally the zoom of the view.
+ *
+ * \return
+ *      Returns true if the summary was rebuilt or merged, false if it was
+ *      current.
+ */
+
+bool
+event_summary::update_notes (const sequence & s, midipulse bucket_ticks)
+{
+    if (bucket_ticks < 1)
+        bucket_ticks = 1;
+
+    bool same = same_events(s);
+    if (same && bucket_ticks == m_bucket_ticks)
+        return false;
+
+    if (same && bucket_ticks > m_bucket_ticks &&
+        (bucket_ticks % m_bucket_ticks) == 0)
+    {
+        merge(bucket_ticks);
+        return true;
+    }
+
+    stamp(s, bucket_ticks);
+    m_notes.assign(m_length / m_bucket_ticks + 1, notes());
+
+    int last = int(m_notes.size()) - 1;
+    render_snapshot::pointer snap = s.snapshot();
+    const render_snapshot::Notes & notelist = snap->notes();
+    render_snapshot::Notes::const_iterator ni;
+    for (ni = notelist.begin(); ni != notelist.end(); ++ni)
+    {
+        int note = ni->key;
+        if (ni->type == DRAW_TEMPO || note < 0 || note >= c_num_keys)
+            continue;
+
+        int b0 = bucket_of(ni->tick_s);
+        if (ni->type == DRAW_NORMAL_LINKED)
+        {
+            int b1 = bucket_of(ni->tick_f);
+            if (ni->tick_f >= ni->tick_s)
+            {
+                for (int b = b0; b <= b1; ++b)
+                    m_notes[b].set(note);
+            }
+            else                                    /* wraps around     */
+            {
+                for (int b = b0; b <= last; ++b)
+                    m_notes[b].set(note);
+
+                for (int b = 0; b <= b1; ++b)
+                    m_notes[b].set(note);
+            }
+        }
+        else
+            m_notes[b0].set(note);
+    }
+    return true;
+}
+
+/**
+ *  Forgets the summary, freeing its memory.  The next update rebuilds it.
+ */
+
+void
+event_summary::clear ()
+{
+    m_seq = nullptr;
+    m_bucket_ticks = 0;
+    m_notes.clear();
+}
+
+/**
+ *  Checks if the summary was built from the events the sequence has now,
+ *  whatever the bucket size.
+ */
+
+bool
+event_summary::same_events (const sequence & s) const
+{
+    return
+        m_seq == &s && m_bucket_ticks > 0 &&
+        m_version == s.edit_version() &&
+        m_event_count == s.event_count() && m_length == s.get_length();
+}
+
+/**
+ *  Merges the buckets into buckets a whole number of times as large.  Each
+ *  new bucket is the union of the old buckets it covers.  A tick falls in
+ *  old bucket b and in new bucket b / factor, so this matches a rebuild,
+ *  including the clamping of the last bucket.
+ *
+ * \param bucket_ticks
+ *      The new ticks per bucket, a multiple of m_bucket_ticks.
+ */
+
+void
+event_summary::merge (midipulse bucket_ticks)
+{
+    size_t factor = size_t(bucket_ticks / m_bucket_ticks);
+    size_t count = m_notes.size();
+    for (size_t b = 0; b < count; ++b)
+    {
+        if ((b % factor) == 0)
+            m_notes[b / factor] = m_notes[b];   /* b / factor <= b      */
+        else
+            m_notes[b / factor] |= m_notes[b];
+    }
+    m_notes.resize(count > 0 ? (count - 1) / factor + 1 : 0);
+    m_bucket_ticks = bucket_ticks;
+}
+
+/**
+ *  Records what the summary is about to be built from.
+ */
+
+void
+event_summary::stamp (const sequence & s, midipulse bucket_ticks)
+{
+    m_seq = &s;
+    m_version = s.edit_version();
+    m_event_count = s.event_count();
+    m_length = s.get_length();              /* not clamped; see same_events() */
+    m_bucket_ticks = bucket_ticks;
+}
+
+/**
+ *  Converts a tick to a bucket index, clamped to the buckets present.
+ */
+
+int
+event_summary::bucket_of (midipulse tick) const
+{
+    int last = bucket_count() - 1;
+    int result = tick > 0 ? int(tick / m_bucket_ticks) : 0 ;
+    return result > last ? last : result ;
+}
+
+}           // namespace seq64
+
+/*
+ * event_summary.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
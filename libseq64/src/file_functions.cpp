@@ -7,7 +7,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2015-11-20
- * \updates       2018-06-08
+ * \updates       2018-09-08
  * \version       $Revision$
  *
  *    We basically include only the functions we need for Sequencer64, not
@@ -15,7 +15,7 @@
  *    project.
  */
 
-#include <algorithm>                    /* std::replace() function          */
+#include <algorithm>                    /* std::replace(), std::sort()      */
 #include <cctype>                       /* std::toupper() function          */
 #include <stdlib.h>                     /* realpath(3) or _fullpath()       */
 #include <string.h>                     /* strlen() etc.                    */
@@ -46,6 +46,7 @@ typedef struct _stat stat_t;
 
 #else                                   /* non-Microsoft stuff follows      */
 
+#include <dirent.h>                     /* opendir(), readdir()             */
 #include <unistd.h>
 
 #define S_ACCESS     access
@@ -520,6 +521,74 @@ file_extension_match (const std::string & path, const std::string & target)
     return strcasecompare(ext, target);
 }
 
+/**
+ *  Gets the names of the files in a directory.  Subdirectories are neither
+ *  listed nor searched.
+ *
+ * \param dirpath
+ *      Provides the name of the directory.
+ *
+ * \param [out] filenames
+ *      The full path of each file found is appended to this vector, in
+ *      alphabetical order.
+ *
+ * \return
+ *      Returns true if the directory could be read.
+ */
+
+bool
+list_directory
+(
+    const std::string & dirpath,
+    std::vector<std::string> & filenames
+)
+{
+    std::string prefix = dirpath;
+    if (! prefix.empty() && prefix[prefix.length() - 1] != '/')
+        prefix += "/";
+
+    std::vector<std::string> found;
+
+#if defined _MSC_VER
+
+    struct _finddata_t fileinfo;
+    std::string pattern = prefix + "*";
+    intptr_t handle = _findfirst(pattern.c_str(), &fileinfo);
+    bool result = handle != -1;
+    if (result)
+    {
+        do
+        {
+            if ((fileinfo.attrib & _A_SUBDIR) == 0)
+                found.push_back(prefix + fileinfo.name);
+        }
+        while (_findnext(handle, &fileinfo) == 0);
+        _findclose(handle);
+    }
+
+#else
+
+    DIR * dir = opendir(dirpath.c_str());
+    bool result = not_nullptr(dir);
+    if (result)
+    {
+        struct dirent * entry;
+        while (not_nullptr(entry = readdir(dir)))
+        {
+            std::string path = prefix + entry->d_name;
+            if (! file_is_directory(path))      /* also skips "." and ".."  */
+                found.push_back(path);
+        }
+        closedir(dir);
+    }
+
+#endif
+
+    std::sort(found.begin(), found.end());
+    filenames.insert(filenames.end(), found.begin(), found.end());
+    return result;
+}
+
 }           // namespace seq64
 
 /*
@@ -0,0 +1,200 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          lazy_loader.cpp
+ *
+ *  This module defines the background thread that decodes the events of
+ *  patterns loaded with "-o lazy".
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the lazy_loader.hpp module for the overview.
+ */
+
+#include <chrono>                       /* std::chrono::milliseconds        */
+
+#include "lazy_loader.hpp"              /* seq64::lazy_loader               */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Principal constructor.  Does not start the thread; see prefetch().
+ *
+ * \param p
+ *      The performance whose sequences are to be loaded.
+ */
+
+lazy_loader::lazy_loader (perform & p)
+ :
+    m_perform       (p),
+    m_wanted        (),
+    m_any_wanted    (false),
+    m_stop          (false),
+    m_load_mutex    (),
+    m_thread_mutex  (),
+    m_wakeup        (),
+    m_thread        ()
+{
+    for (int s = 0; s < c_max_sequence; ++s)
+        m_wanted[s].store(false, std::memory_order_relaxed);
+}
+
+/**
+ *  Stops the thread, if it is running.
+ */
+
+lazy_loader::~lazy_loader ()
+{
+    stop();
+}
+
+/**
+ *  Asks for the events of a sequence.  This function only sets two atomic
+ *  flags, and does not wake up the thread, so it never blocks, and is safe
+ *  to call from the output thread.  The thread sees the request the next
+ *  time it polls.
+ *
+ * \param seq
+ *      The number of the sequence.
+ */
+
+void
+lazy_loader::request (int seq)
+{
+    if (seq >= 0 && seq < c_max_sequence)
+    {
+        m_wanted[seq].store(true);
+        m_any_wanted.store(true);
+    }
+}
+
+/**
+ *  Asks for the events of a range of sequences, normally a screen-set, and
+ *  wakes up the thread.  The thread is started here if any sequence of the
+ *  performance is still waiting for its events, since the output thread can
+ *  only post requests.  Called from the GUI or control thread.  The
+ *  sequences streamed with "-o stream=kb" are left alone, since they can be
+ *  played without their events.
+ *
+ * \param first
+ *      The first sequence of the range.
+ *
+ * \param count
+ *      The number of sequences in the range.
+ */
+
+void
+lazy_loader::prefetch (int first, int count)
+{
+    bool pending = false;
+    for (int s = 0; s < c_max_sequence; ++s)
+    {
+        const sequence * seq = m_perform.get_sequence(s);
+        if (not_nullptr(seq) && seq->events_pending() && ! seq->streaming())
+        {
+            pending = true;
+            if (s >= first && s < first + count)
+                request(s);
+        }
+    }
+    if (pending)
+    {
+        std::lock_guard<std::mutex> lock(m_thread_mutex);
+        if (! m_thread.joinable() && ! m_stop)
+            m_thread = std::thread(&lazy_loader::run, this);
+    }
+    if (m_any_wanted)
+        m_wakeup.notify_one();
+}
+
+/**
+ *  Tells the thread to exit, and waits for it.  Called before the
+ *  performance deletes its sequences.
+ */
+
+void
+lazy_loader::stop ()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_thread_mutex);
+        m_stop = true;
+    }
+    m_wakeup.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/**
+ *  The thread loop.  Sleeps until woken up, or for at most
+ *  SEQ64_LAZY_LOADER_POLL_MS, then loads the events of every sequence that
+ *  was asked for, in order of sequence number.  Each load holds
+ *  m_load_mutex, so that the sequence cannot be deleted in the middle of
+ *  it.
+ */
+
+void
+lazy_loader::run ()
+{
+    while (! m_stop)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_thread_mutex);
+            if (! m_stop && ! m_any_wanted)
+            {
+                m_wakeup.wait_for
+                (
+                    lock, std::chrono::milliseconds(SEQ64_LAZY_LOADER_POLL_MS)
+                );
+            }
+        }
+        if (m_any_wanted.exchange(false))
+        {
+            for (int s = 0; s < c_max_sequence && ! m_stop; ++s)
+            {
+                if (m_wanted[s].exchange(false))
+                {
+                    automutex locker(m_load_mutex);
+                    sequence * seq = m_perform.get_sequence(s);
+                    if (not_nullptr(seq))
+                        (void) seq->load_events();
+                }
+            }
+        }
+    }
+}
+
+}           // namespace seq64
+
+/*
+ * lazy_loader.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
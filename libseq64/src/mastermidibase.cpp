@@ -37,6 +37,7 @@
 #include "easy_macros.h"
 #include "event.hpp"                    /* seq64::event                     */
 #include "mastermidibase.hpp"           /* seq64::mastermidibase            */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"                 /* seq64::sequence                  */
 #include "settings.hpp"                 /* seq64::rc()                      */
 
@@ -79,6 +80,7 @@ mastermidibase::mastermidibase
     m_vector_sequence   (),             /* stazed feature                   */
     m_filter_by_channel (false),        /* set based on configuration       */
     m_seq               (nullptr),
+    m_events_played     (0),
     m_mutex             ()
 {
     // Empty body now
@@ -246,6 +248,7 @@ mastermidibase::set_beats_per_minute (midibpm bpm)
 void
 mastermidibase::flush ()
 {
+    rt_trace_span span("mastermidibase::flush");
     automutex locker(m_mutex);
     api_flush();
 }
@@ -319,6 +322,7 @@ mastermidibase::play (bussbyte bus, event * e24, midibyte channel)
 {
     automutex locker(m_mutex);
     m_outbus_array.play(bus, e24, channel);
+    m_events_played.fetch_add(1, std::memory_order_relaxed);
 }
 
 /**
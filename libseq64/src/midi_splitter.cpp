@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-11-24
- * \updates       2018-08-05
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  We have recently updated this module to put Set Tempo events into the
@@ -107,7 +107,9 @@ midi_splitter::increment (int channel)
 
 /**
  *  Logs the main sequence (an SMF 0 track) for later usage in splitting the
- *  track.
+ *  track.  Its events are already sorted by the parser, but not yet linked,
+ *  so they are linked here, since the main sequence is added to the
+ *  performance as is.
  *
  * /param seq
  *      The main sequence to be logged.
@@ -126,7 +128,7 @@ midi_splitter::log_main_sequence (sequence & seq, int seqnum)
     bool result;
     if (is_nullptr(m_smf0_main_sequence))
     {
-        seq.sort_events();
+        seq.verify_and_link();
         m_smf0_main_sequence = &seq;
         m_smf0_seq_number = seqnum;
         infoprint("SMF 0 main sequence logged");
@@ -153,6 +155,10 @@ midi_splitter::log_main_sequence (sequence & seq, int seqnum)
  *  one channel it contains.  In fact, we just want to keep it in pattern slot
  *  number 16, to keep it out of the way.
  *
+ *  The SMF 0 track is scanned only once, by route_events(), which hands
+ *  each event to the buffer of every channel that gets it.  Each buffer is
+ *  then moved into its new sequence in one step.
+ *
  * \param p
  *      Provides a reference to the perform object into which sequences/tracks
  *      are to be added.
@@ -177,6 +183,13 @@ midi_splitter::split (perform & p, int screenset, int ppqn)
     {
         if (m_smf0_channels_count > 0)
         {
+            event_list channel_events[SEQ64_MIDI_CHANNEL_MAX];
+            midipulse channel_lengths[SEQ64_MIDI_CHANNEL_MAX];
+            route_events
+            (
+                *m_smf0_main_sequence, channel_events, channel_lengths
+            );
+
             int seqnum = screenset * usr().seqs_in_set();
             for (int chan = 0; chan < SEQ64_MIDI_CHANNEL_MAX; ++chan, ++seqnum)
             {
@@ -184,12 +197,21 @@ midi_splitter::split (perform & p, int screenset, int ppqn)
                 {
                     /*
                      * The master MIDI buss must be set before the split,
-                     * otherwise the null pointer causes a segfault.
+                     * otherwise the null pointer causes a segfault.  It is
+                     * still null if the performance was never launched, as
+                     * in seq64bench and "seq64cli --batch".
                      */
 
                     sequence * s = new sequence(ppqn);
-                    s->set_master_midi_bus(&p.master_bus());
-                    if (split_channel(*m_smf0_main_sequence, s, chan))
+                    s->set_master_midi_bus(p.master_bus_pointer());
+                    if
+                    (
+                        split_channel
+                        (
+                            *m_smf0_main_sequence, s, chan,
+                            channel_events[chan], channel_lengths[chan]
+                        )
+                    )
                     {
                         p.add_sequence(s, seqnum);
 #ifdef SEQ64_USE_DEBUG_OUTPUT
@@ -208,9 +230,18 @@ midi_splitter::split (perform & p, int screenset, int ppqn)
 }
 
 /**
- *  This function splits the given sequence into a new sequence, for the given
- *  channel found in the SMF 0 track.  It is called for each possible channel,
- *  resulting in multiple passes over the SMF 0 track.
+ *  Scans the SMF 0 track once, appending each event to the buffer of every
+ *  channel that should get it:
+ *
+ *      -   A SysEx event goes to every channel.
+ *      -   Any other Meta event goes to channel 0 only.  So far, we use only
+ *          the Tempo Meta events there.
+ *      -   A channel event goes to its own channel, or, if it has no
+ *          channel, to every channel.
+ *
+ *  Only the channels found by increment() are filled.  Since the main
+ *  sequence is sorted by log_main_sequence(), each buffer is filled in time
+ *  order, and needs no sorting.
  *
  *  Note that the events that are read from the MIDI file have delta times.
  *  Sequencer64 converts these delta times to cumulative times.    We
@@ -218,6 +249,62 @@ midi_splitter::split (perform & p, int screenset, int ppqn)
  *  when saving the sequences to a file.  This is done in
  *  midi_container::fill().
  *
+ * \param main_seq
+ *      This parameter is the whole SMF 0 track that was read from the MIDI
+ *      file.
+ *
+ * \param [out] channel_events
+ *      An array of SEQ64_MIDI_CHANNEL_MAX empty event lists, which receive the
+ *      events of each channel.
+ *
+ * \param [out] channel_lengths
+ *      An array of SEQ64_MIDI_CHANNEL_MAX values, which receive the time-stamp
+ *      of the last event of each channel, or 0 if it got no events.
+ */
+
+void
+midi_splitter::route_events
+(
+    const sequence & main_seq,
+    event_list * channel_events,
+    midipulse * channel_lengths
+)
+{
+    for (int chan = 0; chan < SEQ64_MIDI_CHANNEL_MAX; ++chan)
+        channel_lengths[chan] = 0;
+
+    const event_list & evl = main_seq.events();
+    for (event_list::const_iterator i = evl.begin(); i != evl.end(); ++i)
+    {
+        const event & er = DREF(i);
+        int first = 0;                              /* range of channels    */
+        int last = SEQ64_MIDI_CHANNEL_MAX - 1;
+        if (er.is_ex_data())
+        {
+            if (! er.is_sysex())
+                last = 0;                           /* Meta:  channel 0     */
+        }
+        else if (er.get_channel() != EVENT_NULL_CHANNEL)
+        {
+            first = last = int(er.get_channel());
+            if (first >= SEQ64_MIDI_CHANNEL_MAX)
+                continue;                           /* cannot happen        */
+        }
+        for (int chan = first; chan <= last; ++chan)
+        {
+            if (m_smf0_channels[chan])
+            {
+                (void) channel_events[chan].append_sorted(er);
+                channel_lengths[chan] = er.get_timestamp();
+            }
+        }
+    }
+}
+
+/**
+ *  This function makes a new sequence for the given channel found in the SMF
+ *  0 track, from the events gathered for it by route_events().
+ *
  *  We have to accumulate the delta times in order to be able to set the
  *  length of the sequence in pulses.
  *
@@ -229,18 +316,21 @@ midi_splitter::split (perform & p, int screenset, int ppqn)
  *
  * \param main_seq
  *      This parameter is the whole SMF 0 track that was read from the MIDI
- *      file.  It contains all of the channel data that needs to be split into
- *      separate sequences.
+ *      file.  Only its name and buss are used here.
  *
  * \param s
  *      Provides the new sequence that needs to have its settings made, and
  *      all of the selected channel events added to it.
  *
  * \param channel
- *      Provides the MIDI channel number (re 0) that marks the channel data
- *      the needs to be extracted and added to the new sequence.  If this
- *      channel is 0, then we need to add certain Meta events to this
- *      sequence, as well.  So far we support only Tempo Meta events.
+ *      Provides the MIDI channel number (re 0) of the new sequence.
+ *
+ * \param evl
+ *      The events of the channel, in time order.  They are moved into the
+ *      new sequence, leaving this list empty.
+ *
+ * \param length_in_ticks
+ *      The time-stamp of the last event of the channel.
  *
  * \return
  *      Returns true if at least one event got added.   If none were added,
@@ -253,10 +343,11 @@ midi_splitter::split_channel
 (
     const sequence & main_seq,
     sequence * s,
-    int channel
+    int channel,
+    event_list & evl,
+    midipulse length_in_ticks
 )
 {
-    bool result = false;
     char tmp[32];
     if (main_seq.name().empty())
     {
@@ -275,35 +366,16 @@ midi_splitter::split_channel
     s->set_midi_bus(main_seq.get_midi_bus());
     s->zero_markers();
 
-    midipulse length_in_ticks = 0;      /* an accumulator of delta times    */
-    const event_list & evl = main_seq.events();
-    for (event_list::const_iterator i = evl.begin(); i != evl.end(); ++i)
-    {
-        const event & er = DREF(i);
-        if (er.is_ex_data())
-        {
-            if (channel == 0 || er.is_sysex())
-            {
-                length_in_ticks = er.get_timestamp();
-                if (s->add_event(er))
-                    result = true;      /* an event got added               */
-            }
-        }
-        else if (er.check_channel(channel))
-        {
-            length_in_ticks = er.get_timestamp();
-            if (s->add_event(er))
-                result = true;          /* an event got added               */
-        }
-    }
+    bool result = evl.count() > 0;          /* an event got added           */
+    s->swap_events(evl);
 
     /*
      * No triggers to add.  Whew!  And setting the length is now a no-brainer,
      * since the tick value is that of the last logged event in the sequence.
+     * The events are already sorted; set_length() links them.
      */
 
     s->set_length(length_in_ticks);
-    s->sort_events();
     return result;
 }
 
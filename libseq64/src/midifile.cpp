@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-03
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  For a quick guide to the MIDI format, see, for example:
@@ -63,16 +63,26 @@
  *      -   Proprietary SeqSpec data.
  */
 
+#include <algorithm>                    /* std::min()                       */
+#include <cstdio>                       /* std::rename(), std::remove()     */
+#include <cstring>                      /* std::memchr()                    */
 #include <fstream>                      /* std::ifstream and std::ofstream  */
-#include <memory>                       /* std::unique_ptr<>                */
+#include <functional>                   /* std::bind()                      */
+#include <memory>                       /* std::unique_ptr<>, shared_ptr<>  */
+#include <thread>                       /* std::thread                      */
 
 #include "app_limits.h"                 /* SEQ64_USE_MIDI_VECTOR            */
 #include "calculations.hpp"             /* seq64::bpm_from_tempo_us()       */
+#include "event_stream.hpp"             /* seq64::event_stream              */
 #include "file_functions.hpp"           /* seq64::get_full_path()           */
 #include "perform.hpp"                  /* must precede midifile.hpp !      */
 #include "midifile.hpp"                 /* seq64::midifile                  */
+#include "platform_macros.h"            /* PLATFORM_WINDOWS                 */
 #include "sequence.hpp"                 /* seq64::sequence                  */
+#include "sequence_builder.hpp"         /* seq64::sequence_builder          */
+#include "session_snapshot.hpp"         /* seq64::session_snapshot          */
 #include "settings.hpp"                 /* seq64::rc() and choose_ppqn()    */
+#include "song_saver.hpp"               /* seq64::song_image                */
 #include "wrkfile.hpp"                  /* seq64::wrkfile class             */
 
 #ifdef SEQ64_USE_MIDI_VECTOR
@@ -140,6 +150,7 @@ midifile::midifile
     m_error_is_fatal            (false),
     m_disable_reported          (false),
     m_pos                       (0),
+    m_base_pos                  (0),
     m_name                      (name),
     m_data                      (),
     m_char_list                 (),
@@ -159,7 +170,69 @@ midifile::midifile
     m_use_scaled_ppqn           (true),
     m_ppqn                      (choose_ppqn(ppqn)),    /* can be 0     */
     m_file_ppqn                 (m_ppqn),               /* for now      */
-    m_smf0_splitter             ()
+    m_smf0_splitter             (),
+    m_parse_threads             (SEQ64_PARSE_THREADS_AUTO),
+    m_lazy_events               (false),
+    m_stream_bytes              (0),
+    m_has_mute_groups           (false),
+    m_has_global_bgs            (false),
+    m_has_tempo_track           (false),
+    m_isolated                  (false),
+    m_music_key                 (usr().seqedit_key()),
+    m_music_scale               (usr().seqedit_scale()),
+    m_bg_sequence               (usr().seqedit_bgsequence())
+{
+    // no other code needed
+}
+
+/**
+ *  Track-reader constructor.  Makes a reader that holds a copy of one
+ *  track chunk of the parent's data, with the parent's PPQN settings, so
+ *  that the chunk can be decoded by parse_track() in a worker thread, with
+ *  its own read position and error status.  See parse_tracks_parallel().
+ *
+ * \param parent
+ *      The midifile that read the whole file.
+ *
+ * \param offset
+ *      The offset of the chunk data in the parent's data.
+ *
+ * \param length
+ *      The length of the chunk data.  The caller has checked that it lies
+ *      within the parent's data.
+ */
+
+midifile::midifile (const midifile & parent, size_t offset, size_t length)
+ :
+    m_mutex                     (),
+    m_file_size                 (length),
+    m_error_message             (),
+    m_error_is_fatal            (false),
+    m_disable_reported          (false),
+    m_pos                       (0),
+    m_base_pos                  (parent.m_base_pos + offset),
+    m_name                      (parent.m_name),
+    m_data
+    (
+        parent.m_data.begin() + offset, parent.m_data.begin() + offset + length
+    ),
+    m_char_list                 (),
+    m_new_format                (parent.m_new_format),
+    m_global_bgsequence         (parent.m_global_bgsequence),
+    m_use_scaled_ppqn           (parent.m_use_scaled_ppqn),
+    m_ppqn                      (parent.m_ppqn),
+    m_file_ppqn                 (parent.m_file_ppqn),
+    m_smf0_splitter             (),
+    m_parse_threads             (1),
+    m_lazy_events               (false),
+    m_stream_bytes              (0),
+    m_has_mute_groups           (false),
+    m_has_global_bgs            (false),
+    m_has_tempo_track           (false),
+    m_isolated                  (parent.m_isolated),
+    m_music_key                 (parent.m_music_key),
+    m_music_scale               (parent.m_music_scale),
+    m_bg_sequence               (parent.m_bg_sequence)
 {
     // no other code needed
 }
@@ -173,6 +246,37 @@ midifile::~midifile ()
     // empty body
 }
 
+/**
+ *  Keeps the global key, scale, and background sequence of the song in
+ *  this object, so that parsing a file does not change the values shown by
+ *  the application, and so that several files can be read at once.  Call
+ *  it before parse().
+ */
+
+void
+midifile::isolate ()
+{
+    m_isolated = true;
+}
+
+/**
+ *  Isolates this object, and takes the global key, scale, and background
+ *  sequence read by another isolated object.  Used to write the song read
+ *  by \a source with the same values.
+ *
+ * \param source
+ *      The midifile that parsed the song.
+ */
+
+void
+midifile::isolate (const midifile & source)
+{
+    m_isolated = true;
+    m_music_key = source.m_music_key;
+    m_music_scale = source.m_music_scale;
+    m_bg_sequence = source.m_bg_sequence;
+}
+
 /**
  *  Seeks to a new, absolute, position in the data stream.  All this function
  *  does is change the value of m_pos.  All of the file is already in memory.
@@ -289,7 +393,9 @@ midifile::read_byte_array (midibyte * b, size_t len)
 
 /**
  *  A overload function to simplify reading midi_control data from the MIDI
- *  file.  It uses a midistring object instead of a buffer.
+ *  file.  It uses a midistring object instead of a buffer.  The available
+ *  bytes are copied in one go.  If the data ends first, the string is cut
+ *  short, and the error is reported as in read_byte().
  *
  * \param b
  *      The midistring to receive the data.
@@ -309,12 +415,55 @@ midifile::read_byte_array (midistring & b, size_t len)
     b.clear();
     if (result)
     {
-        if (len > b.capacity())
-            b.reserve(len);
+        size_t avail = m_pos < m_file_size ? m_file_size - m_pos : 0 ;
+        size_t count = std::min(len, avail);
+        if (count > 0)
+        {
+            b.assign(&m_data[m_pos], count);            /* the bulk of it   */
+            m_pos += count;
+        }
+        if (count < len)
+            (void) read_byte();                         /* report the end   */
+    }
+    return result;
+}
 
-        for (size_t i = 0; i < len; ++i)
-            b.push_back(read_byte());
+/**
+ *  Reads a C-style string of at most the given length.  The reading stops
+ *  after the terminating null byte, if one is found within the length.
+ *  The string is copied from m_data in one go, rather than a byte at a
+ *  time.  Used for the strings of WRK files.
+ *
+ * \param maxlen
+ *      The maximum number of bytes to be read.  Use std::string::npos for a
+ *      string bounded only by its null byte.
+ *
+ * \return
+ *      Returns the string, without the null byte.  If the end of the data is
+ *      reached first, the string holds what was left, and the error is
+ *      reported as in read_byte().
+ */
+
+std::string
+midifile::read_cstring (size_t maxlen)
+{
+    std::string result;
+    size_t avail = m_pos < m_file_size ? m_file_size - m_pos : 0 ;
+    size_t len = std::min(maxlen, avail);
+    const void * nul = nullptr;
+    if (len > 0)
+    {
+        const midibyte * start = &m_data[m_pos];
+        nul = std::memchr(start, 0, len);
+        if (not_nullptr(nul))
+            len = size_t(static_cast<const midibyte *>(nul) - start);
+
+        result.assign(reinterpret_cast<const char *>(start), len);
+        m_pos += not_nullptr(nul) ? len + 1 : len ;
     }
+    if (is_nullptr(nul) && len < maxlen)
+        (void) read_byte();                     /* at the end, report it    */
+
     return result;
 }
 
@@ -368,26 +517,26 @@ midifile::read_gap (size_t sz)
 }
 
 /**
- *  Creates the stream input, reads it into the "buffer", and then closes
- *  the file.  No file buffering needed on these beefy machines!  :-)
- *  As a side-effect, also sets m_file_size.
+ *  Opens the file for reading, and checks its size.  As a side-effect, sets
+ *  m_file_size to the size of the whole file.
  *
  * \param tag
  *      Basically an informative string to denote what kind of file is being
  *      opened, "MIDI" or "WRK".
  *
+ * \param [out] file
+ *      The stream to be opened.  If true is returned, it is positioned at the
+ *      start of the file.
+ *
  * \return
  *      Returns true if the input stream was successfully opend on a good
  *      file.  Use it only if the return value is true.
  */
 
 bool
-midifile::grab_input_stream (const std::string & tag)
+midifile::open_input_stream (const std::string & tag, std::ifstream & file)
 {
-    std::ifstream file = std::ifstream
-    (
-        m_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate
-    );
+    file.open(m_name.c_str(), std::ios::in | std::ios::binary | std::ios::ate);
     m_error_is_fatal = false;
 
     bool result = file.is_open();
@@ -397,23 +546,9 @@ midifile::grab_input_stream (const std::string & tag)
         m_file_size = file.tellg();                 /* get the end offset   */
         printf("[Opened %s file, '%s']\n", tag.c_str(), path.c_str());
         if (m_file_size <= sizeof(long))
-        {
             result = set_error("Invalid file size... reading a directory?");
-        }
         else
-        {
             file.seekg(0, std::ios::beg);           /* seek to start        */
-            try
-            {
-                m_data.resize(m_file_size);         /* allocate more data   */
-                file.read((char *)(&m_data[0]), m_file_size);
-            }
-            catch (const std::bad_alloc & ex)
-            {
-                result = set_error("Memory allocation failed in midifile stream");
-            }
-            file.close();
-        }
     }
     else
     {
@@ -427,6 +562,80 @@ midifile::grab_input_stream (const std::string & tag)
     return result;
 }
 
+/**
+ *  Creates the stream input, reads it into the "buffer", and then closes
+ *  the file.  No file buffering needed on these beefy machines!  :-)
+ *  As a side-effect, also sets m_file_size.
+ *
+ * \param tag
+ *      Basically an informative string to denote what kind of file is being
+ *      opened, "MIDI" or "WRK".
+ *
+ * \return
+ *      Returns true if the input stream was successfully opend on a good
+ *      file.  Use it only if the return value is true.
+ */
+
+bool
+midifile::grab_input_stream (const std::string & tag)
+{
+    std::ifstream file;
+    bool result = open_input_stream(tag, file);
+    if (result)
+    {
+        try
+        {
+            m_data.resize(m_file_size);             /* allocate more data   */
+            file.read((char *)(&m_data[0]), m_file_size);
+        }
+        catch (const std::bad_alloc & ex)
+        {
+            result = set_error("Memory allocation failed in midifile stream");
+        }
+        file.close();
+    }
+    return result;
+}
+
+/**
+ *  Reads the next part of an open file into m_data, in place of what it
+ *  held, so that the read functions see only that part.  Used by wrkfile,
+ *  which reads the file one chunk at a time instead of all at once.  The
+ *  capacity of m_data is kept, so that it grows only to the size of the
+ *  largest chunk.
+ *
+ * \param file
+ *      The open file, positioned at the data to be read.
+ *
+ * \param offset
+ *      The offset of that data in the file, for error messages.
+ *
+ * \param length
+ *      The number of bytes to read.  The caller makes sure that it does not
+ *      go beyond the end of the file.
+ *
+ * \return
+ *      Returns the number of bytes read, which is less than \a length only if
+ *      the file could not be read.
+ */
+
+size_t
+midifile::read_window (std::istream & file, size_t offset, size_t length)
+{
+    size_t result = 0;
+    m_data.resize(length);
+    if (length > 0)
+    {
+        file.read((char *)(&m_data[0]), length);
+        result = size_t(file.gcount());
+        m_data.resize(result);
+    }
+    m_file_size = result;
+    m_pos = 0;
+    m_base_pos = offset;
+    return result;
+}
+
 /**
  *  This function opens a binary MIDI file and parses it into sequences
  *  and other application objects.
@@ -724,6 +933,15 @@ midifile::add_trigger (sequence & seq, midishort ppqn)
  *      don't know how to deal with it, so we just eat it.  If this happened
  *      on the first track, it is a fatal error.
  *
+ * Parallel parsing:
+ *
+ *      The events of each track are decoded by parse_track().  If the file
+ *      has at least SEQ64_PARALLEL_TRACKS_MIN tracks, and more than one
+ *      thread is allowed (see parse_threads()), the chunks are located
+ *      first, and parse_tracks_parallel() decodes them on several threads,
+ *      then adds them to the performance in file order.  SMF 0 files have
+ *      only one track, and are always parsed serially.
+ *
  * \param p
  *      Provides a reference to the perform object into which sequences/tracks
  *      are to be added.
@@ -757,483 +975,954 @@ midifile::parse_smf_1 (perform & p, int screenset, bool is_smf0)
         m_use_scaled_ppqn = file_ppqn() > 0;
 
     p.set_ppqn(ppqn());
+    if (! is_smf0 && parse_thread_count(NumTracks) > 1)
+    {
+        std::vector<track_chunk> chunks;
+        if (scan_tracks(NumTracks, chunks))
+            return parse_tracks_parallel(p, screenset, chunks);
+    }
     for (int track = 0; track < NumTracks; ++track)
     {
-        midipulse Delta;                            /* MIDI delta time      */
-        midipulse RunningTime;
-        midipulse CurrentTime = 0;
-        char TrackName[SEQ64_TRACKNAME_MAX];        /* track name from file */
         midilong ID = read_long();                  /* get track marker     */
         midilong TrackLength = read_long();         /* get track length     */
         if (ID == SEQ64_MTRK_TAG)                   /* magic number 'MTrk'  */
         {
-            bool timesig_set = false;               /* seq24 style wins     */
             midishort seqnum = 0;
-            midibyte status = 0;
-            midibyte laststatus;
-            midilong seqspec = 0;                   /* sequencer-specific   */
-            bool done = false;                      /* done for each track  */
+            track_meta meta;
             sequence * s = new sequence(ppqn());    /* create new sequence  */
-            midilong len;                           /* important counter!   */
-            midibyte d0, d1;                        /* was data[2];         */
             if (is_nullptr(s))
             {
                 set_error_dump("MIDI file parse: sequence allocation failed");
                 return false;
             }
             sequence & seq = *s;                /* references are nicer     */
-            seq.set_master_midi_bus(&p.master_bus());   /* set master buss  */
-            RunningTime = 0;                    /* reset time               */
-            while (! done)                      /* get each event in track  */
+            seq.set_master_midi_bus(p.master_bus_pointer());  /* set master buss */
+            size_t offset = m_pos;
+            bool lazy = lazy_track(TrackLength) && ! is_smf0;
+            bool ok = parse_track
+            (
+                seq, track, seqnum, meta, is_smf0, ! lazy
+            );
+            if (ok && lazy)
             {
-                event e;                        /* safer here, if "slower"  */
-                Delta = read_varinum();         /* get time delta           */
-                laststatus = status;
-                status = m_data[m_pos];         /* get next status byte     */
-                if ((status & 0x80) == 0x00)    /* is it a status bit ?     */
-                    status = laststatus;        /* no, it's running status  */
-                else
-                    ++m_pos;                    /* it's a status, increment */
-
-                e.set_status(status);           /* set the members in event */
+                size_t end = std::min(m_pos, m_file_size);
+                defer_track_events(seq, track, offset, end - offset);
+            }
 
-                /*
-                 *  See "PPQN" section in banner.
-                 */
+            apply_track_meta(p, seq, track, meta);
+            if (! ok)
+            {
+                delete s;
+                return false;
+            }
+            if (buss_override != SEQ64_BAD_BUSS)
+                seq.set_midi_bus(buss_override);
 
-                RunningTime += Delta;           /* add in the time          */
-                if (m_use_scaled_ppqn)         /* adjust time via ppqn     */
-                {
-                    CurrentTime = RunningTime * m_ppqn / m_file_ppqn;
-                    e.set_timestamp(CurrentTime);
-                }
-                else
-                {
-                    CurrentTime = RunningTime;
-                    e.set_timestamp(CurrentTime);
-                }
+            /*
+             * Sequence has been filled, add it to the performance or SMF 0
+             * splitter.
+             */
 
-                midibyte eventcode = status & EVENT_CLEAR_CHAN_MASK;   /* F0 */
-                midibyte channel = status & EVENT_GET_CHAN_MASK;       /* 0F */
-                switch (eventcode)
-                {
-                case EVENT_NOTE_OFF:          /* cases for 2-data-byte events */
-                case EVENT_NOTE_ON:
-                case EVENT_AFTERTOUCH:
-                case EVENT_CONTROL_CHANGE:
-                case EVENT_PITCH_WHEEL:
+            if (is_smf0)
+            {
+                (void) m_smf0_splitter.log_main_sequence(seq, seqnum);
+            }
+            else
+            {
+                finalize_sequence(p, seq, seqnum, screenset);
+            }
 
-                    d0 = read_byte();                     /* was data[0]      */
-                    d1 = read_byte();                     /* was data[1]      */
-                    if (is_note_off_velocity(eventcode, d1))
-                        e.set_status(EVENT_NOTE_OFF, channel); /* vel 0==off  */
+#ifdef PLATFORM_DEBUG_TMI
+            seq.print();
+#endif
+        }
+        else
+        {
+            if (track > 0)                              /* non-fatal later  */
+            {
+                (void) set_error_dump("Unsupported MIDI track ID, skipping...", ID);
+            }
+            else                                        /* fatal in 1st one */
+            {
+                result = set_error_dump
+                (
+                    "Unsupported MIDI track ID on first track.", ID
+                );
+                break;
+            }
+            m_pos += TrackLength;
+        }
+    }                                                   /* for each track   */
+    return result;
+}
 
-                    e.set_data(d0, d1);                   /* set data and add */
+/**
+ *  Decodes the events of one MTrk chunk into a sequence.  This is the inner
+ *  loop of the seq24 parser; see parse_smf_1() for the notes on the events.
+ *  It reads from m_pos, which must be at the first event of the track, and
+ *  stops after the End-of-Track event.  It does not touch the performance:
+ *  the settings that belong to the performance are left in \a meta, to be
+ *  applied by apply_track_meta().  This lets the tracks of a file be
+ *  decoded in parallel; see parse_tracks_parallel().
+ *
+ * \param seq
+ *      The new sequence to fill.
+ *
+ * \param track
+ *      The number of the track in the file.  Time signatures from track 0
+ *      also apply to the performance.
+ *
+ * \param [out] seqnum
+ *      Set to the sequence number, if the track has one.
+ *
+ * \param [out] meta
+ *      Receives the tempo and time signatures meant for the performance.
+ *
+ * \param is_smf0
+ *      True if the file is in SMF 0 format, so that the channels found are
+ *      counted for splitting.
+ *
+ * \param events
+ *      If false, the events are read but not added to the sequence.  Only
+ *      the settings, name, triggers, and length of the track are kept.  The
+ *      events are decoded later; see defer_track_events().  The events are
+ *      collected in a sequence_builder, and are committed to the sequence,
+ *      sorted, at the End-of-Track event.  They are not linked; see
+ *      link_sequence().
+ *
+ * \return
+ *      Returns true if the track was decoded.  Otherwise, the error is in
+ *      m_error_message.
+ */
 
-                    /*
-                     * Replaced seq.add_event() with seq.append_event().  The
-                     * latter doesn't sort events; sort after we get them all.
-                     * Also, it is kind of weird we change the channel for the
-                     * whole sequence here.
-                     */
+bool
+midifile::parse_track
+(
+    sequence & seq, int track, midishort & seqnum,
+    track_meta & meta, bool is_smf0, bool events
+)
+{
+    sequence_builder builder;                       /* unlocked, unsorted   */
+    midipulse Delta;                                /* MIDI delta time      */
+    midipulse RunningTime = 0;
+    midipulse CurrentTime = 0;
+    char TrackName[SEQ64_TRACKNAME_MAX];            /* track name from file */
+    bool timesig_set = false;                       /* seq24 style wins     */
+    midibyte status = 0;
+    midibyte laststatus;
+    midilong seqspec = 0;                           /* sequencer-specific   */
+    bool done = false;                              /* done for each track  */
+    midilong len;                                   /* important counter!   */
+    midibyte d0, d1;                                /* was data[2];         */
+    while (! done)                      /* get each event in track  */
+    {
+        event e;                        /* safer here, if "slower"  */
+        Delta = read_varinum();         /* get time delta           */
+        if (at_end())                   /* no End-of-Track event    */
+            return set_error_dump("Track data ends without End-of-Track");
+
+        laststatus = status;
+        status = m_data[m_pos];         /* get next status byte     */
+        if ((status & 0x80) == 0x00)    /* is it a status bit ?     */
+            status = laststatus;        /* no, it's running status  */
+        else
+            ++m_pos;                    /* it's a status, increment */
 
-                    seq.append_event(e);                  /* does not sort    */
-                    seq.set_midi_channel(channel);        /* set MIDI channel */
-                    if (is_smf0)
-                        m_smf0_splitter.increment(channel);
-                    break;
+        e.set_status(status);           /* set the members in event */
 
-                case EVENT_PROGRAM_CHANGE:    /* cases for 1-data-byte events */
-                case EVENT_CHANNEL_PRESSURE:
+        /*
+         *  See "PPQN" section in banner.
+         */
 
-                    d0 = read_byte();                   /* was data[0]      */
-                    e.set_data(d0);                     /* set data and add */
+        RunningTime += Delta;           /* add in the time          */
+        if (m_use_scaled_ppqn)         /* adjust time via ppqn     */
+        {
+            CurrentTime = RunningTime * m_ppqn / m_file_ppqn;
+            e.set_timestamp(CurrentTime);
+        }
+        else
+        {
+            CurrentTime = RunningTime;
+            e.set_timestamp(CurrentTime);
+        }
 
-                    /*
-                     * We replace seq.add_event() with seq.append_event().
-                     * The latter doesn't sort events; they're sorted after we
-                     * read them all.
-                     */
+        midibyte eventcode = status & EVENT_CLEAR_CHAN_MASK;   /* F0 */
+        midibyte channel = status & EVENT_GET_CHAN_MASK;       /* 0F */
+        switch (eventcode)
+        {
+        case EVENT_NOTE_OFF:          /* cases for 2-data-byte events */
+        case EVENT_NOTE_ON:
+        case EVENT_AFTERTOUCH:
+        case EVENT_CONTROL_CHANGE:
+        case EVENT_PITCH_WHEEL:
 
-                    seq.append_event(e);                /* does not sort    */
-                    seq.set_midi_channel(channel);      /* set midi channel */
-                    if (is_smf0)
-                        m_smf0_splitter.increment(channel);
-                    break;
+            d0 = read_byte();                     /* was data[0]      */
+            d1 = read_byte();                     /* was data[1]      */
+            if (is_note_off_velocity(eventcode, d1))
+                e.set_status(EVENT_NOTE_OFF, channel); /* vel 0==off  */
 
-                case EVENT_MIDI_REALTIME:               /* 0xFn MIDI events */
+            e.set_data(d0, d1);                   /* set data and add */
 
-                    if (status == EVENT_MIDI_META)      /* 0xFF             */
-                    {
-                        midibyte mtype = read_byte();   /* get meta type    */
-                        len = read_varinum();           /* if 0 catch later */
-                        switch (mtype)
-                        {
-                        case EVENT_META_SEQ_NUMBER:     /* FF 00 02 ss      */
+            /*
+             * The builder doesn't sort events; they are sorted once, at
+             * the end of the track.  Also, it is kind of weird we change
+             * the channel for the whole sequence here.
+             */
 
-                            if (! checklen(len, mtype))
-                                return false;
+            if (events)
+                builder.append(e);                /* does not sort    */
+            seq.set_midi_channel(channel);        /* set MIDI channel */
+            if (is_smf0)
+                m_smf0_splitter.increment(channel);
+            break;
 
-                            seqnum = read_short();
-                            break;
+        case EVENT_PROGRAM_CHANGE:    /* cases for 1-data-byte events */
+        case EVENT_CHANNEL_PRESSURE:
 
-                        case EVENT_META_TRACK_NAME:     /* FF 03 len text   */
+            d0 = read_byte();                   /* was data[0]      */
+            e.set_data(d0);                     /* set data and add */
 
-                            if (! checklen(len, mtype))
-                                return false;
+            if (events)
+                builder.append(e);                /* does not sort    */
+            seq.set_midi_channel(channel);      /* set midi channel */
+            if (is_smf0)
+                m_smf0_splitter.increment(channel);
+            break;
 
-                            if (len > SEQ64_TRACKNAME_MAX)
-                                len = SEQ64_TRACKNAME_MAX;
+        case EVENT_MIDI_REALTIME:               /* 0xFn MIDI events */
 
-                            for (int i = 0; i < int(len); ++i)
-                                TrackName[i] = char(read_byte());
+            if (status == EVENT_MIDI_META)      /* 0xFF             */
+            {
+                midibyte mtype = read_byte();   /* get meta type    */
+                len = read_varinum();           /* if 0 catch later */
+                switch (mtype)
+                {
+                case EVENT_META_SEQ_NUMBER:     /* FF 00 02 ss      */
 
-                            TrackName[len] = '\0';
-                            seq.set_name(TrackName);
-                            break;
+                    if (! checklen(len, mtype))
+                        return false;
 
-                        case EVENT_META_END_OF_TRACK:   /* FF 2F 00         */
+                    seqnum = read_short();
+                    break;
 
-                            /*
-                             *  if (Delta == 0) ++CurrentTime;
-                             */
+                case EVENT_META_TRACK_NAME:     /* FF 03 len text   */
 
-                            seq.set_length(CurrentTime, false);
-                            seq.zero_markers();
-                            done = true;
-                            break;
+                    if (! checklen(len, mtype))
+                        return false;
 
-                        case EVENT_META_SET_TEMPO:      /* FF 51 03 tttttt  */
-
-                            if (! checklen(len, mtype))
-                                return false;
-
-                            if (len == 3)
-                            {
-                                /*
-                                 * See "Tempo events" in the function banner.
-                                 */
-
-                                midibyte bt[4];
-                                bt[0] = read_byte();                // tt
-                                bt[1] = read_byte();                // tt
-                                bt[2] = read_byte();                // tt
-                                bt[3] = 0;
-
-                                double tt = tempo_us_from_bytes(bt);
-                                if (tt > 0)
-                                {
-                                    static bool gotfirst = false;
-                                    if (track == 0)
-                                    {
-                                        midibpm bpm = bpm_from_tempo_us(tt);
-                                        if (! gotfirst)
-                                        {
-                                            gotfirst = true;
-                                            p.set_beats_per_minute(bpm);
-                                            p.us_per_quarter_note(int(tt));
-                                            seq.us_per_quarter_note(int(tt));
-                                        }
-                                    }
-
-                                    bool ok = e.append_meta_data(mtype, bt, 3);
-                                    if (ok)
-                                        seq.append_event(e);    /* new 0.93 */
-                                }
-                            }
-                            else
-                                m_pos += len;           /* eat it           */
-                            break;
+                    if (len > SEQ64_TRACKNAME_MAX)
+                        len = SEQ64_TRACKNAME_MAX;
 
-                        case EVENT_META_TIME_SIGNATURE: /* FF 58 04 n d c b */
-
-                            if (! checklen(len, mtype))
-                                return false;
-
-                            if ((len == 4) && ! timesig_set)
-                            {
-                                int bpm = int(read_byte());         // nn
-                                int logbase2 = int(read_byte());    // dd
-                                int cc = read_byte();               // cc
-                                int bb = read_byte();               // bb
-                                int bw = beat_pow2(logbase2);
-                                seq.set_beats_per_bar(bpm);
-                                seq.set_beat_width(bw);
-                                seq.clocks_per_metronome(cc);
-                                seq.set_32nds_per_quarter(bb);
-                                if (track == 0)
-                                {
-                                    p.set_beats_per_bar(bpm);
-                                    p.set_beat_width(bw);
-                                    p.clocks_per_metronome(cc);
-                                    p.set_32nds_per_quarter(bb);
-                                }
-
-                                midibyte bt[4];
-                                bt[0] = midibyte(bpm);
-                                bt[1] = midibyte(logbase2);
-                                bt[2] = midibyte(cc);
-                                bt[3] = midibyte(bb);
-
-                                bool ok = e.append_meta_data(mtype, bt, 4);
-                                if (ok)
-                                    seq.append_event(e);        /* new 0.93 */
-                            }
-                            else
-                                m_pos += len;           /* eat it           */
-                            break;
+                    for (int i = 0; i < int(len); ++i)
+                        TrackName[i] = char(read_byte());
 
-#ifdef USE_KEY_SIGNATURE_DATA
+                    TrackName[len] = '\0';
+                    seq.set_name(TrackName);
+                    break;
 
-                        /*
-                         * Commented out, now unhandled meta events are
-                         * created for saving to the output file later.
-                         */
+                case EVENT_META_END_OF_TRACK:   /* FF 2F 00         */
 
-                        case EVENT_META_KEY_SIGNATURE:  /* FF 59 00         */
+                    /*
+                     *  if (Delta == 0) ++CurrentTime;
+                     */
 
-                            if (len == 2)
-                            {
-                                midibyte bt[2];
-                                bt[0] = read_byte();            /* #/b no.  */
-                                bt[1] = read_byte();            /* min/maj  */
+                    if (events)
+                        builder.commit(seq);    /* one lock, one sort   */
 
-                                bool ok = e.append_meta_data(mtype, bt, 2);
-                                if (ok)
-                                    seq.append_event(e);
-                            }
-                            break;
+                    seq.set_length(CurrentTime, false, false);
+                    seq.zero_markers();
+                    done = true;
+                    break;
 
-#endif  // USE_KEY_SIGNATURE_DATA
+                case EVENT_META_SET_TEMPO:      /* FF 51 03 tttttt  */
 
-                        case EVENT_META_SEQSPEC:          /* FF F7 = SeqSpec  */
-
-                            if (len > 4)                  /* FF 7F len data   */
-                            {
-                                seqspec = read_long();
-                                len -= 4;
-                            }
-                            else if (! checklen(len, mtype))
-                                return false;
-
-                            if (seqspec == c_midibus)
-                            {
-                                seq.set_midi_bus(read_byte());
-                                --len;
-                            }
-                            else if (seqspec == c_midich)
-                            {
-                                midibyte channel = read_byte();
-                                seq.set_midi_channel(channel);
-                                if (is_smf0)
-                                    m_smf0_splitter.increment(channel);
-
-                                --len;
-                            }
-                            else if (seqspec == c_timesig)
-                            {
-                                timesig_set = true;
-                                int bpm = int(read_byte());
-                                int bw = int(read_byte());
-                                seq.set_beats_per_bar(bpm);
-                                seq.set_beat_width(bw);
-                                p.set_beats_per_bar(bpm);
-                                p.set_beat_width(bw);
-                                len -= 2;
-                            }
-                            else if (seqspec == c_triggers)
-                            {
-                                printf("Old-style triggers event encountered\n");
-                                int num_triggers = len / 4;
-                                for (int i = 0; i < num_triggers; i += 2)
-                                {
-                                    midilong on = read_long();
-                                    midilong length = read_long() - on;
-                                    len -= 8;
-                                    seq.add_trigger(on, length, 0, false);
-                                }
-                            }
-                            else if (seqspec == c_triggers_new)
-                            {
-                                int num_triggers = len / 12;
-                                midishort p = m_use_scaled_ppqn ?
-                                    m_file_ppqn : 0 ;
-
-                                for (int i = 0; i < num_triggers; ++i)
-                                {
-                                    len -= 12;
-                                    add_trigger(seq, p);
-                                }
-                            }
-                            else if (seqspec == c_musickey)
-                            {
-                                seq.musical_key(read_byte());
-                                --len;
-                            }
-                            else if (seqspec == c_musicscale)
-                            {
-                                seq.musical_scale(read_byte());
-                                --len;
-                            }
-                            else if (seqspec == c_backsequence)
-                            {
-                                seq.background_sequence(int(read_long()));
-                                len -= 4;
-                            }
-                            else if (seqspec == c_transpose)
-                            {
-                                seq.set_transposable(read_byte() != 0);
-                                --len;
-                            }
-                            else if (seqspec == c_seq_color)
-                            {
-                                seq.color(read_byte());
-                                --len;
-                            }
-                            else if (SEQ64_IS_PROPTAG(seqspec))
-                            {
-                                (void) set_error_dump
-                                (
-                                    "Unsupported track SeqSpec, skipping...",
-                                    seqspec
-                                );
-                            }
-                            m_pos += len;               /* eat the rest     */
-                            break;
+                    if (! checklen(len, mtype))
+                        return false;
 
+                    if (len == 3)
+                    {
                         /*
-                         * Handled in the "default" clause.
-                         *
-                         * case EVENT_META_TEXT_EVENT:      // FF 01 ...
-                         * case EVENT_META_COPYRIGHT:       // FF 02 ...
-                         * case EVENT_META_INSTRUMENT:      // FF 04 ...
-                         * case EVENT_META_LYRIC:           // FF 05 ...
-                         * case EVENT_META_MARKER:          // FF 06 ...
-                         * case EVENT_META_CUE_POINT:       // FF 07 ...
-                         * case EVENT_META_MIDI_CHANNEL:    // FF 20 ...
-                         * case EVENT_META_MIDI_PORT:       // FF 21 ...
-                         * case EVENT_META_SMPTE_OFFSET:    // FF 54 ...
+                         * See "Tempo events" in the function banner.
                          */
 
-                        default:
+                        midibyte bt[4];
+                        bt[0] = read_byte();                // tt
+                        bt[1] = read_byte();                // tt
+                        bt[2] = read_byte();                // tt
+                        bt[3] = 0;
+
+                        double tt = tempo_us_from_bytes(bt);
+                        if (tt > 0)
+                        {
+                            if (meta.tempo_us == 0.0)
+                                meta.tempo_us = tt;
 
-                            if (checklen(len, mtype))
-                            {
-                                std::vector<midibyte> bt;
-                                for (int i = 0; i < int(len); ++i)
-                                    bt.push_back(read_byte());
+                            bool ok = e.append_meta_data(mtype, bt, 3);
+                            if (ok && events)
+                                builder.append(e);      /* new 0.93 */
+                        }
+                    }
+                    else
+                        m_pos += len;           /* eat it           */
+                    break;
 
-                                bool ok = e.append_meta_data(mtype, bt);
-                                if (ok)
-                                    seq.append_event(e);
+                case EVENT_META_TIME_SIGNATURE: /* FF 58 04 n d c b */
 
-                                // Obsolete:
-                                // for (int i = 0; i < int(len); ++i)
-                                //     (void) read_byte(); /* ignore the rest  */
-                            }
-                            else
-                                return false;
+                    if (! checklen(len, mtype))
+                        return false;
 
-                            break;
+                    if ((len == 4) && ! timesig_set)
+                    {
+                        int bpm = int(read_byte());         // nn
+                        int logbase2 = int(read_byte());    // dd
+                        int cc = read_byte();               // cc
+                        int bb = read_byte();               // bb
+                        int bw = beat_pow2(logbase2);
+                        seq.set_beats_per_bar(bpm);
+                        seq.set_beat_width(bw);
+                        seq.clocks_per_metronome(cc);
+                        seq.set_32nds_per_quarter(bb);
+                        if (track == 0)
+                        {
+                            meta.timesig = true;
+                            meta.beats_per_bar = bpm;
+                            meta.beat_width = bw;
+                            meta.clocks_per_metronome = cc;
+                            meta.thirtyseconds = bb;
                         }
+
+                        midibyte bt[4];
+                        bt[0] = midibyte(bpm);
+                        bt[1] = midibyte(logbase2);
+                        bt[2] = midibyte(cc);
+                        bt[3] = midibyte(bb);
+
+                        bool ok = e.append_meta_data(mtype, bt, 4);
+                        if (ok && events)
+                            builder.append(e);          /* new 0.93 */
                     }
-                    else if (status == EVENT_MIDI_SYSEX)    /* 0xF0 */
+                    else
+                        m_pos += len;           /* eat it           */
+                    break;
+
+#ifdef USE_KEY_SIGNATURE_DATA
+
+                /*
+                 * Commented out, now unhandled meta events are
+                 * created for saving to the output file later.
+                 */
+
+                case EVENT_META_KEY_SIGNATURE:  /* FF 59 00         */
+
+                    if (len == 2)
                     {
-                        /*
-                         * Some files do not properly encode SysEx messages;
-                         * see the function banner for notes.
-                         */
+                        midibyte bt[2];
+                        bt[0] = read_byte();            /* #/b no.  */
+                        bt[1] = read_byte();            /* min/maj  */
 
-                        midibyte check = read_byte();
-                        if (is_sysex_special_id(check))
+                        bool ok = e.append_meta_data(mtype, bt, 2);
+                        if (ok && events)
+                            builder.append(e);
+                    }
+                    break;
+
+#endif  // USE_KEY_SIGNATURE_DATA
+
+                case EVENT_META_SEQSPEC:          /* FF F7 = SeqSpec  */
+
+                    if (len > 4)                  /* FF 7F len data   */
+                    {
+                        seqspec = read_long();
+                        len -= 4;
+                    }
+                    else if (! checklen(len, mtype))
+                        return false;
+
+                    if (seqspec == c_midibus)
+                    {
+                        seq.set_midi_bus(read_byte());
+                        --len;
+                    }
+                    else if (seqspec == c_midich)
+                    {
+                        midibyte channel = read_byte();
+                        seq.set_midi_channel(channel);
+                        if (is_smf0)
+                            m_smf0_splitter.increment(channel);
+
+                        --len;
+                    }
+                    else if (seqspec == c_timesig)
+                    {
+                        timesig_set = true;
+                        int bpm = int(read_byte());
+                        int bw = int(read_byte());
+                        seq.set_beats_per_bar(bpm);
+                        seq.set_beat_width(bw);
+                        meta.seqspec_timesig = true;
+                        meta.seqspec_beats_per_bar = bpm;
+                        meta.seqspec_beat_width = bw;
+                        len -= 2;
+                    }
+                    else if (seqspec == c_triggers)
+                    {
+                        printf("Old-style triggers event encountered\n");
+                        int num_triggers = len / 4;
+                        for (int i = 0; i < num_triggers; i += 2)
                         {
-                            /*
-                             * TMI: "SysEx ID byte = 7D to 7F");
-                             */
+                            midilong on = read_long();
+                            midilong length = read_long() - on;
+                            len -= 8;
+                            seq.add_trigger(on, length, 0, false);
                         }
-                        else                            /* handle normally  */
+                    }
+                    else if (seqspec == c_triggers_new)
+                    {
+                        int num_triggers = len / 12;
+                        midishort p = m_use_scaled_ppqn ?
+                            m_file_ppqn : 0 ;
+
+                        for (int i = 0; i < num_triggers; ++i)
                         {
-                            --m_pos;                    /* put byte back    */
-                            len = read_varinum();       /* sysex            */
-#ifdef USE_SYSEX_PROCESSING
-                            int bcount = 0;
-                            while (len--)
-                            {
-                                midibyte b = read_byte();
-                                ++bcount;
-                                if (! e.append_sysex(b)) /* SysEx end byte? */
-                                    break;
-                            }
-                            m_pos += len;               /* skip the rest    */
-#else
-                            m_pos += len;               /* skip it          */
-                            if (m_data[m_pos-1] != 0xF7)
-                            {
-                                (void) set_error_dump
-                                (
-                                    "SysEx terminator byte F7 not found"
-                                );
-                            }
-#endif
+                            len -= 12;
+                            add_trigger(seq, p);
                         }
                     }
-                    else
+                    else if (seqspec == c_musickey)
+                    {
+                        seq.musical_key(read_byte());
+                        --len;
+                    }
+                    else if (seqspec == c_musicscale)
                     {
-                        return set_error_dump
+                        seq.musical_scale(read_byte());
+                        --len;
+                    }
+                    else if (seqspec == c_backsequence)
+                    {
+                        seq.background_sequence(int(read_long()));
+                        len -= 4;
+                    }
+                    else if (seqspec == c_transpose)
+                    {
+                        seq.set_transposable(read_byte() != 0);
+                        --len;
+                    }
+                    else if (seqspec == c_seq_color)
+                    {
+                        seq.color(read_byte());
+                        --len;
+                    }
+                    else if (SEQ64_IS_PROPTAG(seqspec))
+                    {
+                        (void) set_error_dump
                         (
-                            "Unexpected meta code", midilong(status)
+                            "Unsupported track SeqSpec, skipping...",
+                            seqspec
                         );
                     }
+                    m_pos += len;               /* eat the rest     */
                     break;
 
+                /*
+                 * Handled in the "default" clause.
+                 *
+                 * case EVENT_META_TEXT_EVENT:      // FF 01 ...
+                 * case EVENT_META_COPYRIGHT:       // FF 02 ...
+                 * case EVENT_META_INSTRUMENT:      // FF 04 ...
+                 * case EVENT_META_LYRIC:           // FF 05 ...
+                 * case EVENT_META_MARKER:          // FF 06 ...
+                 * case EVENT_META_CUE_POINT:       // FF 07 ...
+                 * case EVENT_META_MIDI_CHANNEL:    // FF 20 ...
+                 * case EVENT_META_MIDI_PORT:       // FF 21 ...
+                 * case EVENT_META_SMPTE_OFFSET:    // FF 54 ...
+                 */
+
                 default:
 
-                    return set_error_dump
-                    (
-                        "Unsupported MIDI event", midilong(status)
-                    );
+                    if (! checklen(len, mtype))
+                        return false;
+
+                    if (! events)
+                    {
+                        m_pos += len;           /* eat it           */
+                    }
+                    else
+                    {
+                        std::vector<midibyte> bt;
+                        for (int i = 0; i < int(len); ++i)
+                            bt.push_back(read_byte());
+
+                        bool ok = e.append_meta_data(mtype, bt);
+                        if (ok && events)
+                            builder.append(e);
+
+                        // Obsolete:
+                        // for (int i = 0; i < int(len); ++i)
+                        //     (void) read_byte(); /* ignore the rest  */
+                    }
                     break;
                 }
-            }                          /* while not done loading Trk chunk */
+            }
+            else if (status == EVENT_MIDI_SYSEX)    /* 0xF0 */
+            {
+                /*
+                 * Some files do not properly encode SysEx messages;
+                 * see the function banner for notes.
+                 */
 
-            if (buss_override != SEQ64_BAD_BUSS)
-                seq.set_midi_bus(buss_override);
+                midibyte check = read_byte();
+                if (is_sysex_special_id(check))
+                {
+                    /*
+                     * TMI: "SysEx ID byte = 7D to 7F");
+                     */
+                }
+                else                            /* handle normally  */
+                {
+                    --m_pos;                    /* put byte back    */
+                    len = read_varinum();       /* sysex            */
+#ifdef USE_SYSEX_PROCESSING
+                    int bcount = 0;
+                    while (len--)
+                    {
+                        midibyte b = read_byte();
+                        ++bcount;
+                        if (! e.append_sysex(b)) /* SysEx end byte? */
+                            break;
+                    }
+                    m_pos += len;               /* skip the rest    */
+#else
+                    m_pos += len;               /* skip it          */
+                    if (m_pos <= m_file_size && m_data[m_pos-1] != 0xF7)
+                    {
+                        (void) set_error_dump
+                        (
+                            "SysEx terminator byte F7 not found"
+                        );
+                    }
+#endif
+                }
+            }
+            else
+            {
+                return set_error_dump
+                (
+                    "Unexpected meta code", midilong(status)
+                );
+            }
+            break;
 
-            /*
-             * Sequence has been filled, add it to the performance or SMF 0
-             * splitter.
-             */
+        default:
 
-            if (is_smf0)
+            return set_error_dump
+            (
+                "Unsupported MIDI event", midilong(status)
+            );
+            break;
+        }
+    }                          /* while not done loading Trk chunk */
+    return true;
+}
+
+/**
+ *  Hands the performance settings found in a track to the performance, as
+ *  the seq24 parser did while reading the track.  As before, only the
+ *  first tempo of track 0, in the first file read into the performance,
+ *  sets the tempo; the time signatures set the performance's values every
+ *  time.
+ *
+ * \param p
+ *      The performance to receive the settings.
+ *
+ * \param seq
+ *      The sequence decoded from the track.
+ *
+ * \param track
+ *      The number of the track in the file.
+ *
+ * \param meta
+ *      The settings found by parse_track().
+ */
+
+void
+midifile::apply_track_meta
+(
+    perform & p, sequence & seq, int track, const track_meta & meta
+)
+{
+    if (track == 0 && meta.tempo_us > 0.0 && ! p.m_file_tempo_set)
+    {
+        p.m_file_tempo_set = true;
+        p.set_beats_per_minute(bpm_from_tempo_us(meta.tempo_us));
+        p.us_per_quarter_note(int(meta.tempo_us));
+        seq.us_per_quarter_note(int(meta.tempo_us));
+    }
+    if (meta.timesig)
+    {
+        p.set_beats_per_bar(meta.beats_per_bar);
+        p.set_beat_width(meta.beat_width);
+        p.clocks_per_metronome(meta.clocks_per_metronome);
+        p.set_32nds_per_quarter(meta.thirtyseconds);
+    }
+    if (meta.seqspec_timesig)
+    {
+        p.set_beats_per_bar(meta.seqspec_beats_per_bar);
+        p.set_beat_width(meta.seqspec_beat_width);
+    }
+}
+
+/**
+ *  Decides how many threads to use in parsing an SMF 1 file.
+ *
+ * \param numtracks
+ *      The number of tracks given in the header of the file.
+ *
+ * \return
+ *      Returns 1 if the file has fewer than SEQ64_PARALLEL_TRACKS_MIN
+ *      tracks, or if m_parse_threads asks for the serial parse.  Otherwise,
+ *      returns the number of threads, never more than the number of tracks.
+ */
+
+int
+midifile::parse_thread_count (int numtracks) const
+{
+    int result = m_parse_threads;
+    if (result == SEQ64_PARSE_THREADS_AUTO)
+        result = int(std::thread::hardware_concurrency());  /* 0 if unknown */
+
+    if (numtracks < SEQ64_PARALLEL_TRACKS_MIN || result < 1)
+        result = 1;
+
+    return std::min(result, numtracks);
+}
+
+/**
+ *  Locates the track chunks of an SMF 1 file, using only their length
+ *  fields, so that the tracks can be decoded independently.  The serial
+ *  parser does not need the length of an MTrk chunk, since it reads up to
+ *  the End-of-Track event.  So, if the length fields do not fit the file,
+ *  the layout is not used, and the caller falls back to the serial parse,
+ *  which reports the errors as before.
+ *
+ * \param numtracks
+ *      The number of tracks given in the header of the file.
+ *
+ * \param [out] chunks
+ *      Receives one entry per chunk.  Cleared if false is returned.
+ *
+ * \return
+ *      Returns true if every chunk lies within the file and the first chunk
+ *      is an MTrk chunk.  In that case m_pos is left after the last chunk;
+ *      otherwise it is left at the first chunk.
+ */
+
+bool
+midifile::scan_tracks (int numtracks, std::vector<track_chunk> & chunks)
+{
+    size_t start = m_pos;
+    bool result = true;
+    chunks.clear();
+    chunks.reserve(numtracks);
+    for (int track = 0; track < numtracks; ++track)
+    {
+        if (m_pos + 2 * sizeof(midilong) > m_file_size)
+        {
+            result = false;                         /* truncated header     */
+            break;
+        }
+
+        track_chunk tc;
+        tc.id = read_long();
+        tc.length = size_t(read_long());
+        tc.offset = m_pos;
+        tc.seq = nullptr;
+        tc.seqnum = 0;
+        tc.ok = false;
+        tc.error_is_fatal = false;
+        if (tc.length > m_file_size - tc.offset)
+        {
+            result = false;                         /* bad length field     */
+            break;
+        }
+        if (track == 0 && tc.id != SEQ64_MTRK_TAG)
+        {
+            result = false;                         /* let serial report it */
+            break;
+        }
+        m_pos += tc.length;
+        chunks.push_back(tc);
+    }
+    if (! result)
+    {
+        chunks.clear();
+        m_pos = start;
+    }
+    return result;
+}
+
+/**
+ *  Decodes the tracks located by scan_tracks() on a pool of threads, then
+ *  adds them to the performance in file order, just as the serial parser
+ *  would have.  The performance settings of each track are applied in
+ *  order.  The first track that fails stops the loading, and the tracks
+ *  before it are kept.  The error left in m_error_message is the last one
+ *  the serial parser would have reported.
+ *
+ *  Each worker decodes, sorts, and links whole tracks.  A sequence is not
+ *  shared with anything until it is added to the performance, so the only
+ *  shared state is the atomic track counter.
+ *
+ *  If a thread cannot be started, the workers already started are kept, and
+ *  this thread decodes whatever tracks they do not take.  With no workers
+ *  at all, that is simply serial parsing.  Every started worker is joined.
+ *
+ * \param p
+ *      The performance into which the sequences are added.
+ *
+ * \param screenset
+ *      The screen-set offset to be used when adding a sequence.
+ *
+ * \param chunks
+ *      The chunks found by scan_tracks().
+ *
+ * \return
+ *      Returns true if all tracks were decoded.
+ */
+
+bool
+midifile::parse_tracks_parallel
+(
+    perform & p, int screenset, std::vector<track_chunk> & chunks
+)
+{
+    bool result = true;
+    char buss_override = usr().midi_buss_override();
+    int count = int(chunks.size());
+    for (int track = 0; track < count; ++track)
+    {
+        track_chunk & tc = chunks[track];
+        if (tc.id == SEQ64_MTRK_TAG)
+        {
+            tc.seq = new sequence(ppqn());
+            tc.seq->set_master_midi_bus(p.master_bus_pointer());
+        }
+    }
+
+    std::atomic<int> next(0);
+    std::vector<std::thread> workers;
+    int threads = parse_thread_count(count);
+    try
+    {
+        workers.reserve(threads - 1);           /* no throw in push_back */
+        for (int t = 1; t < threads; ++t)           /* this thread works too */
+        {
+            workers.push_back
+            (
+                std::thread
+                (
+                    &midifile::decode_tracks, this,
+                    std::ref(chunks), std::ref(next)
+                )
+            );
+        }
+    }
+    catch (const std::exception & ex)       /* system_error, bad_alloc  */
+    {
+        errprint("could not start all track parsing threads");
+    }
+    decode_tracks(chunks, next);                    /* takes what is left   */
+    for
+    (
+        std::vector<std::thread>::iterator w = workers.begin();
+        w != workers.end(); ++w
+    )
+    {
+        w->join();
+    }
+
+    for (int track = 0; track < count; ++track)
+    {
+        track_chunk & tc = chunks[track];
+        if (! result)
+        {
+            delete tc.seq;                          /* serial stops earlier */
+            continue;
+        }
+        if (not_nullptr(tc.seq))
+        {
+            sequence & seq = *tc.seq;
+            if (! tc.error.empty())
+            {
+                m_error_message = tc.error;
+                m_error_is_fatal = tc.error_is_fatal;
+                m_disable_reported = true;
+            }
+            apply_track_meta(p, seq, track, tc.meta);
+            if (tc.ok)
             {
-                (void) m_smf0_splitter.log_main_sequence(seq, seqnum);
+                if (buss_override != SEQ64_BAD_BUSS)
+                    seq.set_midi_bus(buss_override);
+
+                int prefnum = tc.seqnum + screenset * usr().seqs_in_set();
+                p.add_sequence(&seq, prefnum);      /* already linked       */
             }
             else
             {
-                finalize_sequence(p, seq, seqnum, screenset);
+                delete tc.seq;
+                result = false;
             }
-
-#ifdef PLATFORM_DEBUG_TMI
-            seq.print();
-#endif
         }
         else
         {
-            if (track > 0)                              /* non-fatal later  */
-            {
-                (void) set_error_dump("Unsupported MIDI track ID, skipping...", ID);
-            }
-            else                                        /* fatal in 1st one */
+            m_pos = tc.offset;
+            (void) set_error_dump("Unsupported MIDI track ID, skipping...", tc.id);
+        }
+    }
+    if (result)
+        m_pos = chunks.back().offset + chunks.back().length;
+
+    return result;
+}
+
+/**
+ *  The work loop of the parsing threads.  Each pass takes the next track
+ *  and decodes it with a track reader of its own, until no tracks are
+ *  left.  A track that decodes is also sorted and linked here, since that
+ *  is the costliest part of loading a large track.
+ *
+ * \param chunks
+ *      The chunks found by scan_tracks(), with their sequences allocated.
+ *      Each thread writes only to the entries it takes.
+ *
+ * \param next
+ *      The index of the next track to take, shared by the threads.
+ */
+
+void
+midifile::decode_tracks
+(
+    std::vector<track_chunk> & chunks, std::atomic<int> & next
+)
+{
+    int count = int(chunks.size());
+    for (;;)
+    {
+        int track = next.fetch_add(1);
+        if (track >= count)
+            break;
+
+        track_chunk & tc = chunks[track];
+        if (not_nullptr(tc.seq))
+        {
+            midifile reader(*this, tc.offset, tc.length);
+            bool lazy = lazy_track(tc.length);
+            tc.ok = reader.parse_track
+            (
+                *tc.seq, track, tc.seqnum, tc.meta, false, ! lazy
+            );
+            if (tc.ok)
             {
-                result = set_error_dump
-                (
-                    "Unsupported MIDI track ID on first track.", ID
-                );
-                break;
+                if (lazy)
+                {
+                    size_t used = std::min(reader.m_pos, tc.length);
+                    defer_track_events(*tc.seq, track, tc.offset, used);
+                }
+
+                link_sequence(*tc.seq);
             }
-            m_pos += TrackLength;
+            tc.error = reader.m_error_message;
+            tc.error_is_fatal = reader.m_error_is_fatal;
         }
-    }                                                   /* for each track   */
+    }
+}
+
+/**
+ *  Arranges for the events of a track read with "-o lazy" to be decoded
+ *  later.  A track reader holding a copy of the track data is bound to
+ *  load_track_events() and handed to the sequence, which calls it the first
+ *  time the events are needed.  The reader goes away once they are loaded,
+ *  or when the sequence is deleted.
+ *
+ *  For a track long enough for "-o stream=kb", the sequence also gets an
+ *  event_stream over the data of the reader, so that it can be played
+ *  before the events are loaded.  The stream shares the reader, so the
+ *  track data is held only once.
+ *
+ * \param seq
+ *      The sequence read without its events.
+ *
+ * \param track
+ *      The number of the track in the file.
+ *
+ * \param offset
+ *      The offset of the first event of the track in the data.
+ *
+ * \param length
+ *      The number of bytes from the first event to the End-of-Track.
+ */
+
+void
+midifile::defer_track_events
+(
+    sequence & seq, int track, size_t offset, size_t length
+)
+{
+    std::shared_ptr<midifile> reader(new midifile(*this, offset, length));
+    seq.defer_events
+    (
+        std::bind
+        (
+            &midifile::load_track_events, reader, track, std::placeholders::_1
+        )
+    );
+    if (is_streamed(length))
+    {
+        std::shared_ptr<const midibyte> data(reader, reader->m_data.data());
+        seq.stream_events
+        (
+            std::make_shared<event_stream>
+            (
+                data, reader->m_data.size(), m_ppqn,
+                m_use_scaled_ppqn ? m_file_ppqn : 0
+            )
+        );
+    }
+}
+
+/**
+ *  Decodes the events of a track reader made by defer_track_events().
+ *  This is the same parse as the normal one, so the events are the same.
+ *  The settings that parse_track() also applies to the scratch sequence
+ *  were already applied when the file was read, and are ignored here.
+ *
+ * \param track
+ *      The number of the track in the file.
+ *
+ * \param scratch
+ *      The empty sequence to receive the events.  See
+ *      sequence::load_events().
+ *
+ * \return
+ *      Returns true if the track was decoded.
+ */
+
+bool
+midifile::load_track_events (int track, sequence & scratch)
+{
+    midishort seqnum = 0;
+    track_meta meta;
+    m_pos = 0;
+    m_error_message.clear();
+    m_error_is_fatal = false;
+    bool result = parse_track
+    (
+        scratch, track, seqnum, meta, false, true
+    );
+    if (! result)
+    {
+        errprint(m_error_message.c_str());
+    }
     return result;
 }
 
@@ -1247,7 +1936,7 @@ midifile::initialize_sequence (perform & p)
     sequence * result = new sequence(ppqn());
     if (not_nullptr(result))
     {
-        result->set_master_midi_bus(&p.master_bus());   /* set master buss  */
+        result->set_master_midi_bus(p.master_bus_pointer());    /* master buss */
     }
     return result;
 }
@@ -1264,19 +1953,34 @@ midifile::finalize_sequence
     int seqnum,
     int screenset
 )
+{
+    int preferred_seqnum = seqnum + screenset * usr().seqs_in_set();
+    link_sequence(seq);
+    p.add_sequence(&seq, preferred_seqnum);
+}
+
+/**
+ *  Pads a newly read sequence to at least one measure, and links its Note
+ *  On and Note Off events.  The events are already sorted, since the
+ *  importers commit them with a sequence_builder.  This touches only the
+ *  sequence, so parse_tracks_parallel() does it in the worker threads.
+ *
+ * \param seq
+ *      The sequence to prepare.
+ */
+
+void
+midifile::link_sequence (sequence & seq)
 {
     midipulse barlength = seq.get_ppqn() * seq.get_beats_per_bar();
     if (seq.get_length() < barlength)   /* pad the sequence to a measure    */
-        seq.set_length(barlength, false);
+        seq.set_length(barlength, false, false);
 
-    int preferred_seqnum = seqnum + screenset * usr().seqs_in_set();
-    seq.sort_events();                  /* sort the events now              */
 #if USE_NEW_VERSION
     seq.apply_length(tempo, ppqn, bw, measures);
 #else
     seq.set_length();                   /* final verify_and_link()          */
 #endif
-    p.add_sequence(&seq, preferred_seqnum);
 }
 
 /**
@@ -1524,7 +2228,13 @@ midifile::parse_proprietary_track (perform & p, int file_size)
             for (int buss = 0; buss < busscount; ++buss)
             {
                 bussbyte clocktype = read_byte();
-                p.master_bus().set_clock(bussbyte(buss), (clock_e)(clocktype));
+                if (not_nullptr(p.master_bus_pointer()))
+                {
+                    p.master_bus().set_clock
+                    (
+                        bussbyte(buss), (clock_e)(clocktype)
+                    );
+                }
             }
         }
         seqspec = parse_prop_header(file_size);
@@ -1570,6 +2280,7 @@ midifile::parse_proprietary_track (perform & p, int file_size)
             long len = read_long();                     /* always 1024      */
             if (len > 0)
             {
+                m_has_mute_groups = true;
                 if (c_max_sequence != len)              /* c_gmute_tracks   */
                 {
                     result = set_error_dump("Corrupt data in mute-group section");
@@ -1618,20 +2329,32 @@ midifile::parse_proprietary_track (perform & p, int file_size)
         seqspec = parse_prop_header(file_size);
         if (seqspec == c_musickey)
         {
+            m_has_global_bgs = true;
             int key = int(read_byte());
-            usr().seqedit_key(key);
+            if (m_isolated)
+                m_music_key = key;
+            else
+                usr().seqedit_key(key);
         }
         seqspec = parse_prop_header(file_size);
         if (seqspec == c_musicscale)
         {
+            m_has_global_bgs = true;
             int scale = int(read_byte());
-            usr().seqedit_scale(scale);
+            if (m_isolated)
+                m_music_scale = scale;
+            else
+                usr().seqedit_scale(scale);
         }
         seqspec = parse_prop_header(file_size);
         if (seqspec == c_backsequence)
         {
+            m_has_global_bgs = true;
             int seqnum = int(read_long());
-            usr().seqedit_bgsequence(seqnum);
+            if (m_isolated)
+                m_bg_sequence = seqnum;
+            else
+                usr().seqedit_bgsequence(seqnum);
         }
 
         /*
@@ -1691,7 +2414,10 @@ midifile::parse_proprietary_track (perform & p, int file_size)
         {
             int tempotrack = int(read_long());
             if (tempotrack > 0)
+            {
                 p.set_tempo_track_number(tempotrack);
+                m_has_tempo_track = true;
+            }
         }
 
 #ifdef USE_KEPLER34_SEQUENCE_COLOR       // DO NOT ENABLE, see SEQ64_SHOW_COLOR_PALETTE
@@ -2107,6 +2833,10 @@ midifile::prop_item_size (long data_length) const
  *  from its container.  Not an issue, but can make a file slightly different
  *  for no reason.
  *
+ *  This function captures the song and writes it in the calling thread.
+ *  The File / Save commands use save_midi_file() instead, which leaves the
+ *  writing to the song_saver thread.
+ *
  * \param p
  *      Provides the object that will contain and manage the entire
  *      performance.
@@ -2124,6 +2854,44 @@ midifile::prop_item_size (long data_length) const
 
 bool
 midifile::write (perform & p, bool doseqspec)
+{
+    song_image image;
+    bool result = capture(p, image, doseqspec);
+    if (result)
+        result = write(image, p);
+
+    if (result)
+        p.is_modified(false);           /* it worked, tell perform about it */
+
+    return result;
+}
+
+/**
+ *  Takes what write() needs from the performance:  a copy of each active
+ *  sequence, made by sequence::save_assign(), and the proprietary track,
+ *  which is small, already encoded.  Each sequence is locked only while it
+ *  is copied.  Called in the thread that owns the performance (normally the
+ *  GUI thread), since the proprietary track reads the mute groups and the
+ *  notepads.
+ *
+ * \param p
+ *      Provides the performance to be saved.
+ *
+ * \param [out] image
+ *      Receives the copies, the encoded proprietary track, and the settings
+ *      of this midifile, so that another midifile can write it later.
+ *
+ * \param doseqspec
+ *      If true, the Sequencer64-specific SeqSpec sections are to be written.
+ *
+ * \return
+ *      Returns true if the PPQN is valid and there is at least one track to
+ *      write.  If false is returned, then m_error_message will contain a
+ *      description of the error.
+ */
+
+bool
+midifile::capture (perform & p, song_image & image, bool doseqspec)
 {
     automutex locker(m_mutex);
     bool result = m_ppqn >= SEQ64_MINIMUM_PPQN && m_ppqn <= SEQ64_MAXIMUM_PPQN;
@@ -2133,98 +2901,157 @@ midifile::write (perform & p, bool doseqspec)
 
     if (result)
     {
-        int numtracks = 0;
-        for (int i = 0; i < p.sequence_high(); ++i)
+        image.m_filename = m_name;
+        image.m_ppqn = m_ppqn;
+        image.m_oldformat = ! m_new_format;
+        image.m_globalbgs = m_global_bgsequence;
+        image.m_doseqspec = doseqspec;
+        for (int track = 0; track < p.sequence_high(); ++track)
         {
-            if (p.is_active(i))
-                ++numtracks;             /* count number of active tracks   */
+            if (p.is_active(track))
+            {
+                const sequence * s = p.get_sequence(track);
+                if (not_nullptr(s))
+                {
+                    song_image::track t;
+                    t.number = track;
+                    t.seq = new sequence(m_ppqn);
+                    t.seq->save_assign(*s);
+                    image.m_tracks.push_back(t);
+                }
+            }
         }
-        result = numtracks > 0;
+        result = ! image.m_tracks.empty();
         if (result)
         {
-            bool result = write_header(numtracks);
-            if (result)
+            if (doseqspec)
             {
-                if (doseqspec)
-                    printf("[Writing Sequencer64 MIDI file, %d ppqn]\n", m_ppqn);
+                result = write_proprietary_track(p);
+                if (result)
+                    image.m_seqspec.swap(m_char_list);
                 else
-                    printf("[Writing normal MIDI file, %d ppqn]\n", m_ppqn);
+                    m_error_message = "Error, could not write SeqSpec track";
             }
-            else
-                m_error_message = "Error, failed to write header to MIDI file";
         }
         else
             m_error_message = "Error, no patterns/tracks available to write";
     }
+    return result;
+}
 
-    /*
-     * Write out the active tracks.  The value of c_max_sequence is 1024.
-     * Note that we don't need to check the sequence pointer.
-     */
+/**
+ *  Encodes the tracks of a captured song, and writes the file.  Touches
+ *  neither the performance nor the original sequences, and so can be
+ *  called by the song_saver thread while the song is being played and
+ *  edited.
+ *
+ * \param image
+ *      The song captured by capture().  Its tracks are written in order,
+ *      followed by its proprietary track, if any.
+ *
+ * \param p
+ *      The performance, needed only by midi_container::fill(), which reads
+ *      nothing from it that capture() did not.
+ *
+ * \return
+ *      Returns true if the file was written.  If false is returned, then
+ *      m_error_message will contain a description of the error.
+ */
 
+bool
+midifile::write (const song_image & image, const perform & p)
+{
+    automutex locker(m_mutex);
+    m_error_message.clear();
+    bool result = write_header(int(image.m_tracks.size()));
     if (result)
     {
-        for (int track = 0; track < p.sequence_high(); ++track)
-        {
-            if (p.is_active(track))
-            {
-                sequence * s = p.get_sequence(track);
-                if (not_nullptr(s))
-                {
-                    sequence & seq = *s;
+        if (image.m_doseqspec)
+            printf("[Writing Sequencer64 MIDI file, %d ppqn]\n", m_ppqn);
+        else
+            printf("[Writing normal MIDI file, %d ppqn]\n", m_ppqn);
 
+        for
+        (
+            std::vector<song_image::track>::const_iterator t =
+                image.m_tracks.begin();
+            t != image.m_tracks.end(); ++t
+        )
+        {
 #if defined SEQ64_USE_MIDI_VECTOR
-                    midi_vector lst(seq);
+            midi_vector lst(*t->seq);
 #else
-                    midi_list lst(seq);
+            midi_list lst(*t->seq);
 #endif
 
-                    /*
-                     * midi_container::fill() also handles the time-signature
-                     * and tempo meta events, if they are not part of the
-                     * file's MIDI data.  All the events are put into the
-                     * container, and then the container's bytes are written
-                     * out below.
-                     */
+            /*
+             * midi_container::fill() also handles the time-signature and
+             * tempo meta events, if they are not part of the file's MIDI
+             * data.  All the events are put into the container, and then the
+             * container's bytes are written out below.
+             */
 
-                    lst.fill(track, p, doseqspec);
-                    write_track(lst);
-                }
-            }
+            lst.fill(t->number, p, image.m_doseqspec);
+            write_track(lst);
         }
-    }
-    if (result && doseqspec)
-    {
-        result = write_proprietary_track(p);
+        m_char_list.insert
+        (
+            m_char_list.end(), image.m_seqspec.begin(), image.m_seqspec.end()
+        );
+        result = write_file();
         if (! result)
-            m_error_message = "Error, could not write SeqSpec track";
+            m_error_message = "Error opening MIDI file for writing";
     }
-    if (result)
+    else
+        m_error_message = "Error, no patterns/tracks available to write";
+
+    return result;
+}
+
+/**
+ *  Writes the bytes gathered in m_char_list to the file, and empties the
+ *  list.  The bytes are written to a temporary file, which is then renamed
+ *  to the name of the MIDI file, so that a crash or a full disk in the
+ *  middle of a save leaves the old file intact.
+ *
+ * \return
+ *      Returns true if the file was written and renamed.
+ */
+
+bool
+midifile::write_file ()
+{
+    bool result = false;
+    std::string temp = m_name + ".tmp";
     {
         std::ofstream file
         (
-            m_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc
+            temp.c_str(), std::ios::out | std::ios::binary | std::ios::trunc
         );
         if (file.is_open())
         {
             char file_buffer[SEQ64_MIDI_LINE_MAX];  /* enable bufferization */
             file.rdbuf()->pubsetbuf(file_buffer, sizeof file_buffer);
-            std::list<midibyte>::iterator it;
+            std::list<midibyte>::const_iterator it;
             for (it = m_char_list.begin(); it != m_char_list.end(); ++it)
             {
-                char c = *it;
+                const char c = *it;
                 file.write(&c, 1);
             }
-            m_char_list.clear();
-        }
-        else
-        {
-            m_error_message = "Error opening MIDI file for writing";
-            result = false;
+            file.close();
+            result = ! file.fail();
         }
     }
+    m_char_list.clear();
     if (result)
-        p.is_modified(false);           /* it worked, tell perform about it */
+    {
+#ifdef PLATFORM_WINDOWS
+        (void) remove(m_name.c_str());          /* rename() won't clobber   */
+#endif
+        result = rename(temp.c_str(), m_name.c_str()) == 0;
+    }
+    if (! result)
+        (void) remove(temp.c_str());
 
     return result;
 }
@@ -2331,6 +3158,7 @@ midifile::write_song (perform & p)
                 if (not_nullptr(s))
                 {
                     sequence & seq = *s;
+                    (void) seq.load_events();   /* if read with "-o lazy"   */
 
 #if defined SEQ64_USE_MIDI_VECTOR
                     midi_vector lst(seq);
@@ -2392,28 +3220,9 @@ midifile::write_song (perform & p)
     }
     if (result)
     {
-        std::ofstream file
-        (
-            m_name.c_str(), std::ios::out | std::ios::binary | std::ios::trunc
-        );
-        if (file.is_open())
-        {
-            char file_buffer[SEQ64_MIDI_LINE_MAX];  /* enable bufferization */
-            file.rdbuf()->pubsetbuf(file_buffer, sizeof file_buffer);
-
-            std::list<midibyte>::const_iterator it;
-            for (it = m_char_list.begin(); it != m_char_list.end(); ++it)
-            {
-                const char c = *it;
-                file.write(&c, 1);
-            }
-            m_char_list.clear();
-        }
-        else
-        {
+        result = write_file();
+        if (! result)
             m_error_message = "Error opening MIDI file for exporting";
-            result = false;
-        }
     }
 
     /*
@@ -2556,12 +3365,17 @@ midifile::write_proprietary_track (perform & p)
     {
         if (m_global_bgsequence)
         {
+            int key = m_isolated ? m_music_key : usr().seqedit_key() ;
+            int scale = m_isolated ? m_music_scale : usr().seqedit_scale() ;
+            int bgseq = m_isolated ?
+                m_bg_sequence : usr().seqedit_bgsequence() ;
+
             write_prop_header(c_musickey, 1);               /* control tag+1 */
-            write_byte(midibyte(usr().seqedit_key()));      /* key change    */
+            write_byte(midibyte(key));                      /* key change    */
             write_prop_header(c_musicscale, 1);             /* control tag+1 */
-            write_byte(midibyte(usr().seqedit_scale()));    /* scale change  */
+            write_byte(midibyte(scale));                    /* scale change  */
             write_prop_header(c_backsequence, 4);           /* control tag+4 */
-            write_long(long(usr().seqedit_bgsequence()));   /* background    */
+            write_long(long(bgseq));                        /* background    */
         }
         write_prop_header(c_perf_bp_mes, 4);                /* control tag+4 */
         write_long(long(p.get_beats_per_bar()));            /* perfedit BPM  */
@@ -2750,7 +3564,11 @@ bool
 midifile::set_error_dump (const std::string & msg)
 {
     char temp[32];
-    snprintf(temp, sizeof temp, "Near offset 0x%lx: ", (unsigned long)(m_pos));
+    snprintf
+    (
+        temp, sizeof temp, "Near offset 0x%lx: ",
+        (unsigned long)(m_base_pos + m_pos)
+    );
     std::string result = temp;
     result += msg;
     fprintf(stderr, "%s\n", result.c_str());
@@ -2783,7 +3601,7 @@ midifile::set_error_dump (const std::string & msg, unsigned long value)
     snprintf
     (
         temp, sizeof temp, "Near offset 0x%lx, bad value %lu (0x%lx): ",
-        (unsigned long)(m_pos), value, value
+        (unsigned long)(m_base_pos + m_pos), value, value
     );
     std::string result = temp;
     result += msg;
@@ -2796,7 +3614,9 @@ midifile::set_error_dump (const std::string & msg, unsigned long value)
 
 /**
  *  A global function to unify the opening of a MIDI or WRK file.  It also
- *  handles PPQN discovery.
+ *  handles PPQN discovery.  With "-o snapshot", a MIDI file is rebuilt from
+ *  its session_snapshot when that matches the file; otherwise the file is
+ *  parsed, and the snapshot is written for the next time.
  *
  * \param [in,out] p
  *      Provides the performance object to update with information read from
@@ -2830,38 +3650,93 @@ open_midi_file
 )
 {
     bool is_wrk = file_extension_match(fn, "wrk");
+    bool result = false;
+    int fileppqn = SEQ64_DEFAULT_PPQN;
+    std::unique_ptr<session_snapshot> snap;
+    if (usr().option_snapshot() && ! is_wrk)
+    {
+        snap.reset(new session_snapshot(fn, ppqn));
+        p.clear_all();
+        result = snap->read(p, fileppqn);   /* no parsing if it matches     */
+    }
+    if (! result)
+    {
+        /*
+         * TODO:  tighten up wrkfile/midifile handling re PPQN!!!
+         */
 
-    /*
-     * TODO:  tighten up wrkfile/midifile handling re PPQN!!!
-     */
+        midifile * fp = is_wrk ?
+            new wrkfile(fn, ppqn) : new midifile(fn, ppqn) ;
+        std::unique_ptr<midifile> f(fp);
+        p.clear_all();                      /* also drops a partial snapshot */
 
-    midifile * fp = is_wrk ?  new wrkfile(fn, ppqn) : new midifile(fn, ppqn) ;
-    std::unique_ptr<midifile> f(fp);
-    p.clear_all();
+        f->lazy_events(usr().option_lazy_load());
+        f->stream_bytes(size_t(usr().option_stream_kb()) * 1024);
+        result = f->parse(p, 0);
+        if (result)
+        {
+            fileppqn = f->ppqn();
+            if (snap)
+            {
+                unsigned items = 0;
+                if (f->has_mute_groups())
+                    items |= session_snapshot::ITEM_MUTE_GROUPS;
+
+                if (f->has_global_bgs())
+                    items |= session_snapshot::ITEM_GLOBAL_BGS;
 
-    bool result = f->parse(p, 0);
+                if (f->has_tempo_track())
+                    items |= session_snapshot::ITEM_TEMPO_TRACK;
+
+                bool ok = snap->write(p, fileppqn, items);
+                if (! ok && ! snap->error_message().empty())
+                {
+                    errprint(snap->error_message().c_str());
+                }
+            }
+        }
+        else
+        {
+            errmsg = f->error_message();
+            if (f->error_is_fatal())
+                rc().remove_recent_file(fn);
+        }
+    }
     if (result)
     {
+        p.prefetch_screenset(p.screenset());    /* if "-o lazy"         */
         if (ppqn != SEQ64_USE_FILE_PPQN)    /* preserve this in the parent  */
-            ppqn = f->ppqn();               /* get & return file PPQN       */
+            ppqn = fileppqn;                /* get & return file PPQN       */
 
-        usr().file_ppqn(f->ppqn());         /* save the value from the file */
+        usr().file_ppqn(fileppqn);          /* save the value from the file */
         p.set_ppqn(choose_ppqn());          /* set chosen PPQN for MIDI     */
         rc().last_used_dir(fn.substr(0, fn.rfind("/") + 1));
         rc().filename(fn);
         rc().add_recent_file(fn);           /* from Oli Kester's Kepler34   */
     }
-    else
-    {
-        errmsg = f->error_message();
-        if (f->error_is_fatal())
-            rc().remove_recent_file(fn);
-    }
     return result;
 }
 
 /**
+ *  A global function to unify the saving of a MIDI file, used by the File /
+ *  Save commands.  The song is captured here, and the file is written by
+ *  the song_saver thread of the performance, so that a large song does not
+ *  hold up the GUI.  The performance is marked as saved at once; if the
+ *  write fails, perform::check_saves() reports it and marks the performance
+ *  as modified again.
  *
+ * \param [in,out] p
+ *      Provides the performance object to be saved.
+ *
+ * \param fn
+ *      The name of the file.  If empty, rc().filename() is used.
+ *
+ * \param [out] errmsg
+ *      Receives the reason the song could not be captured, if false is
+ *      returned.
+ *
+ * \return
+ *      Returns true if the song was captured and queued for writing.
  */
 
 bool
@@ -2885,9 +3760,11 @@ save_midi_file
         bool legacy = rc().legacy_format();
         bool glob = usr().global_seq_feature();
         midifile f(fname, ppqn, legacy, glob);
-        result = f.write(p);
+        std::unique_ptr<song_image> image(new song_image);
+        result = f.capture(p, *image);
         if (result)
         {
+            p.save_song(image.release());   /* written in the background    */
             rc().filename(fname);
             rc().add_recent_file(rc().filename());
         }
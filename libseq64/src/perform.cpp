@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom and others
  * \date          2015-07-24
- * \updates       2018-08-06
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This class is probably the single most important class in Sequencer64, as
@@ -161,6 +161,8 @@
 #include "keystroke.hpp"
 #include "midibus.hpp"
 #include "perform.hpp"
+#include "rt_safe.hpp"                  /* seq64::rt_lock_memory() etc.     */
+#include "rt_trace.hpp"                 /* seq64::rt_trace, rt_trace_span   */
 #include "settings.hpp"                 /* seq64::rc()                      */
 
 #if defined PLATFORM_WINDOWS
@@ -286,12 +288,18 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_playback_mode             (false),
     m_ppqn                      (choose_ppqn(ppqn)),    /* may change later */
     m_bpm                       (SEQ64_DEFAULT_BPM),    /* now a double     */
+    m_pending_bpm               (SEQ64_DEFAULT_BPM),
     m_beats_per_bar             (SEQ64_DEFAULT_BEATS_PER_MEASURE),
     m_beat_width                (SEQ64_DEFAULT_BEAT_WIDTH),
     m_clocks_per_metronome      (24),
     m_32nds_per_quarter         (8),
     m_us_per_quarter_note       (tempo_us_from_bpm(SEQ64_DEFAULT_BPM)),
     m_master_bus                (nullptr),
+    m_rt_stats                  (),
+    m_changes                   (),
+    m_commands                  (),
+    m_lazy_loader               (*this),
+    m_song_saver                (*this),
     m_filter_by_channel         (false),                /* "rc" option      */
     m_master_clocks             (),                     /* vector<clock_e>  */
     m_master_inputs             (),                     /* vector<bool>     */
@@ -312,6 +320,7 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_midi_cc_off               (),         // midi_control []
     m_control_status            (0),
     m_screenset                 (0),        // vice m_playscreen
+    m_pending_screenset         (0),
     m_screenset_offset          (0),
     m_playscreen                (0),        // vice m_screenset
     m_playscreen_offset         (0),
@@ -323,6 +332,7 @@ perform::perform (gui_assistant & mygui, int ppqn)
     m_edit_sequence             (-1),
 #endif
     m_is_modified               (false),
+    m_file_tempo_set            (false),
 #ifdef SEQ64_SONG_BOX_SELECT
     m_selected_seqs             (),                     // Selection, std::set
 #endif
@@ -377,6 +387,8 @@ perform::perform (gui_assistant & mygui, int ppqn)
 
 perform::~perform ()
 {
+    m_song_saver.stop();                            /* finish the saves     */
+    m_lazy_loader.stop();                           /* before the deletes   */
     m_inputing = m_outputing = m_is_running = false;
     m_condition_var.signal();                       /* signal end of play   */
     if (m_out_thread_launched)
@@ -410,7 +422,9 @@ void
 perform::set_ppqn (int p)
 {
     m_ppqn = p;
-    m_master_bus->set_ppqn(p);
+    if (not_nullptr(m_master_bus))
+        m_master_bus->set_ppqn(p);
+
 #ifdef SEQ64_JACK_SUPPORT
     m_jack_asst.set_ppqn(p);
 #endif
@@ -482,6 +496,10 @@ perform::create_master_bus ()
  *      Provides the PPQN value, which is either the default value (192) or is
  *      read from the "user" configuration file.
  *
+ *  If "-o trace=filename" was given, tracing is turned on here, before the
+ *  threads are started, and the calling (GUI) thread is named "main".
+ *  Likewise, if "-o rtsafe" was given, the process memory is locked here.
+ *
  * \todo
  *      We probably need a bpm parameter for consistency at some point.
  */
@@ -489,6 +507,16 @@ perform::create_master_bus ()
 void
 perform::launch (int ppqn)
 {
+    if (! usr().option_tracefile().empty())
+    {
+        rt_trace::enable();
+        rt_trace::thread_name("main");
+    }
+    if (usr().option_rtsafe())
+    {
+        rt_guard_abort(usr().option_rtsafe_abort());
+        (void) rt_lock_memory();
+    }
     if (create_master_bus())                /* also calls set_port_statuses()   */
     {
 
@@ -524,6 +552,11 @@ perform::launch (int ppqn)
  *  Also gets the settings made/changed while the application was running from
  *  the mastermidibase class to here.  This action is the converse of calling
  *  the set_port_statuses() function defined in the mastermidibase module.
+ *
+ *  Finally, shows the output-thread statistics if the --stats option is in
+ *  force, and writes them if "-o stats=filename" was given.  Likewise writes
+ *  the trace if "-o trace=filename" was given, and reports any heap
+ *  allocations caught by the "-o rtsafe" guard.
  */
 
 void
@@ -532,6 +565,53 @@ perform::finish ()
     (void) deinit_jack_transport();
     if (not_nullptr(m_master_bus))
         m_master_bus->get_port_statuses(m_master_clocks, m_master_inputs);
+
+    if (rc().stats())
+        m_rt_stats.show(stdout);
+
+    std::string statsfile = usr().option_statsfile();
+    if (! statsfile.empty())
+        (void) write_statistics(statsfile);
+
+    std::string tracefile = usr().option_tracefile();
+    if (! tracefile.empty())
+    {
+        if (rt_trace::write(tracefile))
+            printf("[Wrote trace to '%s']\n", tracefile.c_str());
+        else
+            printf("? Could not write trace to '%s'\n", tracefile.c_str());
+    }
+    if (usr().option_rtsafe() && rt_guard_violations() > 0)
+    {
+        printf
+        (
+            "? %lu heap allocations on real-time threads during playback\n",
+            rt_guard_violations()
+        );
+    }
+}
+
+/**
+ *  Writes the output-thread statistics to a file.  This can be called at any
+ *  time from any thread except the output thread, even while playing.
+ *
+ * \param filename
+ *      The name of the destination file, which is overwritten.
+ *
+ * \return
+ *      Returns true if the file could be written.
+ */
+
+bool
+perform::write_statistics (const std::string & filename) const
+{
+    bool result = m_rt_stats.write(filename);
+    if (result)
+        printf("[Wrote statistics to '%s']\n", filename.c_str());
+    else
+        printf("? Could not write statistics to '%s'\n", filename.c_str());
+
+    return result;
 }
 
 #ifdef SEQ64_SONG_BOX_SELECT
@@ -1206,17 +1286,50 @@ perform::mute_group_offset (int trackoffset)
     return result;
 }
 
+/**
+ * \setter m_mode_group
+ *      While the engine is running, the change is posted, so that the
+ *      mute-group commands already queued see the old value.
+ */
+
+void
+perform::set_mode_group_mute ()
+{
+    if (post_command(COMMAND_MODE_GROUP, 0, true))
+        return;
+
+    m_mode_group = true;
+}
+
+/**
+ * \setter m_mode_group
+ *      Unsets this member.  Posted like set_mode_group_mute().
+ */
+
+void
+perform::unset_mode_group_mute ()
+{
+    if (post_command(COMMAND_MODE_GROUP, 0, false))
+        return;
+
+    m_mode_group = false;
+}
+
 /**
  *  Sets the group-mute mode, then the group-learn mode, then notifies all of
  *  the notification subscribers.  This function is called via a MIDI control
  *  c_midi_control_mod_glearn and via the group-learn keystroke.
+ *
+ *  The subscribers are user-interface objects, so they are notified by the
+ *  calling thread; only the mode change is posted to the engine.
  */
 
 void
 perform::set_mode_group_learn ()
 {
-    set_mode_group_mute();                              /* m_mode_group=true */
-    m_mode_group_learn = true;
+    if (! post_command(COMMAND_MODE_GROUP_LEARN, 0, true))
+        apply_group_learn(true);
+
     for (size_t x = 0; x < m_notify.size(); ++x)
         m_notify[x]->on_grouplearnchange(true);
 }
@@ -1238,7 +1351,26 @@ perform::unset_mode_group_learn ()
     for (size_t x = 0; x < m_notify.size(); ++x)
         m_notify[x]->on_grouplearnchange(false);
 
-    m_mode_group_learn = false;
+    if (! post_command(COMMAND_MODE_GROUP_LEARN, 0, false))
+        apply_group_learn(false);
+}
+
+/**
+ *  Changes the group-learn mode for set_mode_group_learn() and
+ *  unset_mode_group_learn().  Turning learning on also turns on the
+ *  group-mute mode.
+ *
+ * \param flag
+ *      The new value of m_mode_group_learn.
+ */
+
+void
+perform::apply_group_learn (bool flag)
+{
+    if (flag)
+        m_mode_group = true;
+
+    m_mode_group_learn = flag;
 }
 
 /**
@@ -1319,6 +1451,9 @@ perform::set_and_copy_mute_group (int mutegroup)
 void
 perform::mute_group_tracks ()
 {
+    if (post_command(COMMAND_MUTE_GROUP_TRACKS))
+        return;
+
     if (m_mode_group)
     {
         for (int g = 0; g < m_max_sets; ++g)
@@ -1352,6 +1487,9 @@ perform::mute_group_tracks ()
 void
 perform::select_and_mute_group (int group)
 {
+    if (post_command(COMMAND_SELECT_MUTE_GROUP, group))
+        return;
+
     set_and_copy_mute_group(group);
     mute_group_tracks();
 }
@@ -1401,6 +1539,9 @@ perform::clear_mute_groups ()
 void
 perform::mute_all_tracks (bool flag)
 {
+    if (post_command(COMMAND_MUTE_ALL_TRACKS, 0, flag))
+        return;
+
     for (int i = 0; i < m_sequence_high; ++i)       /* m_sequence_max       */
     {
         if (is_active(i))
@@ -1422,6 +1563,9 @@ perform::mute_all_tracks (bool flag)
 void
 perform::toggle_all_tracks ()
 {
+    if (post_command(COMMAND_TOGGLE_ALL_TRACKS))
+        return;
+
     for (int i = 0; i < m_sequence_high; ++i)
     {
         if (is_active(i))
@@ -1450,6 +1594,9 @@ perform::toggle_playing_tracks ()
     if (song_start_mode())
         return;
 
+    if (post_command(COMMAND_TOGGLE_PLAYING_TRACKS))
+        return;
+
     if (are_any_armed())
     {
         if (m_armed_saved)
@@ -1568,6 +1715,9 @@ perform::set_song_mute (mute_op_t op)
 void
 perform::mute_screenset (int ss, bool flag)
 {
+    if (post_command(COMMAND_MUTE_SCREENSET, ss, flag))
+        return;
+
     int seq = screenset_offset(ss);
     for (int i = 0; i < m_seqs_in_set; ++i, ++seq)
     {
@@ -1847,6 +1997,7 @@ perform::delete_sequence (int seq)
         set_active(seq, false);
         if (! m_seqs[seq]->get_editing())           /* clarify this!        */
         {
+            automutex locker(m_lazy_loader.load_mutex());
             m_seqs[seq]->set_playing(false);
             delete m_seqs[seq];
             m_seqs[seq] = nullptr;
@@ -2065,6 +2216,9 @@ perform::is_dirty_names (int seq)
  *  changed the beats per minute.  This setting does get saved to the MIDI
  *  file, with the c_bpmtag.
  *
+ *  The clamped value is stored in m_pending_bpm before the change is posted
+ *  to the engine, so that pending_beats_per_minute() reflects it at once.
+ *
  * \param bpm
  *      Provides the beats/minute value to be set.  It is clamped, if
  *      necessary, between the values SEQ64_MINIMUM_BPM to SEQ64_MAXIMUM_BPM.
@@ -2080,6 +2234,10 @@ perform::set_beats_per_minute (midibpm bpm)
     else if (bpm > SEQ64_MAXIMUM_BPM)
         bpm = SEQ64_MAXIMUM_BPM;
 
+    m_pending_bpm.store(bpm);
+    if (post_command(COMMAND_SET_BPM, 0, false, bpm))
+        return;
+
     if (bpm != m_bpm)
     {
 
@@ -2096,9 +2254,12 @@ perform::set_beats_per_minute (midibpm bpm)
 
 #endif
 
-        m_master_bus->set_beats_per_minute(bpm);
+        if (not_nullptr(m_master_bus))
+            m_master_bus->set_beats_per_minute(bpm);
+
         m_us_per_quarter_note = tempo_us_from_bpm(bpm);
         m_bpm = bpm;
+        post_change(CHANGE_TRANSPORT);
 
         /*
          * Do we need to adjust the BPM of all of the sequences, including the
@@ -2121,7 +2282,7 @@ perform::set_beats_per_minute (midibpm bpm)
 midibpm
 perform::decrement_beats_per_minute ()
 {
-    midibpm result = get_beats_per_minute() - usr().bpm_step_increment();
+    midibpm result = pending_beats_per_minute() - usr().bpm_step_increment();
     set_beats_per_minute(result);
     return result;
 }
@@ -2137,7 +2298,7 @@ perform::decrement_beats_per_minute ()
 midibpm
 perform::increment_beats_per_minute ()
 {
-    midibpm result = get_beats_per_minute() + usr().bpm_step_increment();
+    midibpm result = pending_beats_per_minute() + usr().bpm_step_increment();
     set_beats_per_minute(result);
     return result;
 }
@@ -2156,7 +2317,7 @@ perform::increment_beats_per_minute ()
 midibpm
 perform::page_decrement_beats_per_minute ()
 {
-    midibpm result = get_beats_per_minute() - usr().bpm_page_increment();
+    midibpm result = pending_beats_per_minute() - usr().bpm_page_increment();
     set_beats_per_minute(result);
     return result;
 }
@@ -2175,7 +2336,7 @@ perform::page_decrement_beats_per_minute ()
 midibpm
 perform::page_increment_beats_per_minute ()
 {
-    midibpm result = get_beats_per_minute() + usr().bpm_page_increment();
+    midibpm result = pending_beats_per_minute() + usr().bpm_page_increment();
     set_beats_per_minute(result);
     return result;
 }
@@ -2190,6 +2351,9 @@ perform::page_increment_beats_per_minute ()
  *  0 to any pattern from 0 to 1023.  This is done in the File / Options /
  *  MIDI Clock tab, and is saved to the "rc" file.
  *
+ *  The tempo logged is the one just set, even if the engine has not yet
+ *  applied it; see pending_beats_per_minute().
+ *
  * \return
  *      Returns true if the tempo-track sequence exists.
  */
@@ -2202,7 +2366,7 @@ perform::log_current_tempo ()
 	if (result)
 	{
 		midipulse tick = get_tick();
-		midibpm bpm = get_beats_per_minute();
+		midibpm bpm = pending_beats_per_minute();    /* maybe not applied */
 		seq64::event e = create_tempo_event(tick, bpm);   /* event.cpp */
 		if (seq->add_event(e))
         {
@@ -2231,7 +2395,7 @@ perform::log_current_tempo ()
 int
 perform::decrement_screenset (int amount)
 {
-    int result = screenset() - amount;
+    int result = pending_screenset() - amount;
     return set_screenset(result);
 }
 
@@ -2250,7 +2414,7 @@ perform::decrement_screenset (int amount)
 int
 perform::increment_screenset (int amount)
 {
-    int result = screenset() + amount;
+    int result = pending_screenset() + amount;
     return set_screenset(result);
 }
 
@@ -2513,7 +2677,8 @@ perform::get_screenset_notepad (int screenset) const
  *
  * \return
  *      Returns the actual final value of the screen-set that was set, i.e. the
- *      m_screenset member value.
+ *      m_pending_screenset member value.  While the engine is running,
+ *      m_screenset catches up with it in the next output frame.
  */
 
 int
@@ -2524,13 +2689,33 @@ perform::set_screenset (int ss)
     else if (ss >= m_max_sets)
         ss = 0;
 
-    if ((ss != m_screenset) && is_screenset_valid(ss))
+    if ((ss != pending_screenset()) && is_screenset_valid(ss))
+    {
+        m_pending_screenset.store(ss);
+        prefetch_screenset(ss);                 /* for "-o lazy", not in RT */
+        if (! post_command(COMMAND_SET_SCREENSET, ss))
+            apply_screenset(ss);
+    }
+    return pending_screenset();
+}
+
+/**
+ *  Makes the screen-set change asked for by set_screenset().
+ *
+ * \param ss
+ *      The index of the new screen-set, already validated.
+ */
+
+void
+perform::apply_screenset (int ss)
+{
+    if (ss != m_screenset)
     {
         m_screenset = ss;
         m_screenset_offset = screenset_offset(ss);
         unset_queued_replace();                 /* clear this new feature   */
+        post_change(CHANGE_SCREENSET);
     }
-    return m_screenset;
 }
 
 /**
@@ -2555,6 +2740,9 @@ perform::set_screenset (int ss)
 void
 perform::set_playing_screenset ()
 {
+    if (post_command(COMMAND_PLAYING_SCREENSET))
+        return;
+
     for (int s = 0; s < m_seqs_in_set; ++s)
     {
         int source = m_playscreen_offset + s;
@@ -2564,6 +2752,7 @@ perform::set_playing_screenset ()
     m_playscreen = m_screenset;
     m_playscreen_offset = screenset_offset(m_playscreen);
     mute_group_tracks();
+    post_change(CHANGE_SCREENSET);
 }
 
 /**
@@ -2586,6 +2775,7 @@ perform::set_playing_screenset ()
 void
 perform::play (midipulse tick)
 {
+    rt_trace_span span("perform::play");
     set_tick(tick);
     for (int seq = 0; seq < m_sequence_high; ++seq)
     {
@@ -2846,6 +3036,8 @@ perform::start_playing (bool songmode)
     songmode = songmode || song_start_mode();
     if (songmode)
     {
+        load_triggered_events();                /* for "-o lazy"            */
+
        /*
         * Allow to start at key-p position if set; for cosmetic reasons,
         * to stop transport line flicker on start, position to the left
@@ -2868,6 +3060,83 @@ perform::start_playing (bool songmode)
     start(songmode);                                    /* song mode       */
 }
 
+/**
+ *  Decodes, at once, the events of every sequence that has triggers, for a
+ *  file loaded with "-o lazy".  Song mode plays whatever the triggers call
+ *  for, with no chance to ask for the events first, so they are decoded
+ *  before playback starts.  This does nothing for a file loaded normally,
+ *  nor for a sequence streamed with "-o stream=kb", which can play as is.
+ */
+
+void
+perform::load_triggered_events ()
+{
+    for (int s = 0; s < m_sequence_high; ++s)
+    {
+        sequence * seq = get_sequence(s);
+        if (not_nullptr(seq) && seq->events_pending() && ! seq->streaming())
+        {
+            if (seq->trigger_count() > 0)
+                (void) seq->load_events();
+        }
+    }
+}
+
+/**
+ *  Asks the lazy_loader to decode the events of the given screen-set in the
+ *  background, for a file loaded with "-o lazy".  Called when the file is
+ *  loaded, and when the screen-set changes.
+ *
+ * \param ss
+ *      The screen-set whose sequences are wanted.
+ */
+
+void
+perform::prefetch_screenset (int ss)
+{
+    if (is_screenset_valid(ss))
+        m_lazy_loader.prefetch(screenset_offset(ss), m_seqs_in_set);
+}
+
+/**
+ *  Hands a song captured by midifile::capture() to the song_saver thread,
+ *  and marks the performance as saved.  Called by save_midi_file().
+ *
+ * \param image
+ *      The captured song.  The song_saver takes ownership of it.
+ */
+
+void
+perform::save_song (song_image * image)
+{
+    is_modified(false);
+    m_song_saver.save(image);
+}
+
+/**
+ *  Does the periodic work of the background saves.  Starts an autosave, if
+ *  one is due, and reports a save that failed.  Called from the timer of
+ *  the main window.
+ *
+ * \param [out] errmsg
+ *      Receives the error message of the failed save, if true is returned.
+ *
+ * \return
+ *      Returns true if a save failed since the last call.  The performance
+ *      is then marked as modified again, since the song was not saved.
+ */
+
+bool
+perform::check_saves (std::string & errmsg)
+{
+    m_song_saver.autosave();
+    bool result = m_song_saver.check_error(errmsg);
+    if (result)
+        is_modified(true);
+
+    return result;
+}
+
 /**
  *  Encapsulates behavior needed by perfedit.  Note that we moved some of the
  *  code from perfedit::set_jack_mode() [the seq32 version] to this function.
@@ -3103,6 +3372,7 @@ perform::inner_start (bool songmode)
 
         is_running(true);
         m_condition_var.signal();
+        post_change(CHANGE_TRANSPORT);
     }
     m_condition_var.unlock();
 }
@@ -3129,6 +3399,7 @@ perform::inner_stop (bool midiclock)
     is_running(false);
     reset_sequences();
     m_usemidiclock = midiclock;
+    post_change(CHANGE_TRANSPORT);
 }
 
 /**
@@ -3251,7 +3522,8 @@ perform::reset_sequences (bool pause)
         if (is_active(s))
             (m_seqs[s]->*f)(m_playback_mode);           /* (new parameter)  */
     }
-    m_master_bus->flush();                              /* flush MIDI buss  */
+    if (not_nullptr(m_master_bus))
+        m_master_bus->flush();                          /* flush MIDI buss  */
 }
 
 /**
@@ -3609,6 +3881,164 @@ perform::deinit_jack_transport ()
 #endif
 }
 
+/**
+ *  Posts a state change for the output thread to apply at the start of its
+ *  next frame, so that the GUI and input threads no longer change the
+ *  sequences and the mute state while the output thread is reading them.
+ *  The public functions that make such changes call this first, and return
+ *  if it returns true; otherwise, they go on to make the change directly.
+ *
+ *  When the engine is not running, nothing picks up the commands, so they
+ *  are applied here, in order, by the calling thread.
+ *
+ * \param command
+ *      The kind of change.
+ *
+ * \param value
+ *      The sequence, group, or control status, if applicable.
+ *
+ * \param flag
+ *      The on/off parameter, if applicable.
+ *
+ * \param bpm
+ *      The tempo, for COMMAND_SET_BPM.
+ *
+ * \return
+ *      Returns true if the command was posted.  Returns false if it is to
+ *      be applied by the caller:  in the output thread, while commands are
+ *      being applied, or if the queue is full.
+ */
+
+bool
+perform::post_command (command_t command, int value, bool flag, midibpm bpm)
+{
+    if (rt_command_queue::is_engine_thread())
+        return false;
+
+    rt_command c;
+    c.m_command = command;
+    c.m_value = value;
+    c.m_flag = flag;
+    c.m_bpm = bpm;
+    if (! m_commands.push(c))
+    {
+        errprint("command queue full, applying change directly");
+        return false;
+    }
+    if (! is_running())
+        apply_commands();
+
+    return true;
+}
+
+/**
+ *  Applies all of the posted commands.  Called by the output thread at the
+ *  start of each frame, and by post_command() when the engine is not
+ *  running.  If another thread is already applying them, this function
+ *  returns at once; that thread checks the queue again before it lets go.
+ *  The commands are applied as if in the output thread, so that they are
+ *  not posted again.
+ */
+
+void
+perform::apply_commands ()
+{
+    while (m_commands.acquire())
+    {
+        bool engine = rt_command_queue::is_engine_thread();
+        rt_command_queue::engine_thread(true);
+
+        rt_command c;
+        while (m_commands.pop(c))
+            apply_command(c);
+
+        rt_command_queue::engine_thread(engine);
+        m_commands.release();
+        if (m_commands.empty())
+            break;
+    }
+}
+
+/**
+ *  Applies one command by calling the function that posted it.
+ *
+ * \param c
+ *      The command to apply.
+ */
+
+void
+perform::apply_command (const rt_command & c)
+{
+    switch (c.m_command)
+    {
+    case COMMAND_SEQUENCE_TOGGLE:
+        apply_playing_toggle(c.m_value);
+        break;
+
+    case COMMAND_SEQUENCE_CHANGE:
+        sequence_playing_change(c.m_value, c.m_flag);
+        break;
+
+    case COMMAND_MUTE_GROUP_TRACKS:
+        mute_group_tracks();
+        break;
+
+    case COMMAND_SELECT_MUTE_GROUP:
+        select_and_mute_group(c.m_value);
+        break;
+
+    case COMMAND_PLAYING_SCREENSET:
+        set_playing_screenset();
+        break;
+
+    case COMMAND_MUTE_ALL_TRACKS:
+        mute_all_tracks(c.m_flag);
+        break;
+
+    case COMMAND_TOGGLE_ALL_TRACKS:
+        toggle_all_tracks();
+        break;
+
+    case COMMAND_TOGGLE_PLAYING_TRACKS:
+        toggle_playing_tracks();
+        break;
+
+    case COMMAND_SET_CONTROL_STATUS:
+        set_sequence_control_status(c.m_value);
+        break;
+
+    case COMMAND_UNSET_CONTROL_STATUS:
+        unset_sequence_control_status(c.m_value);
+        break;
+
+    case COMMAND_MODE_GROUP:
+        if (c.m_flag)
+            set_mode_group_mute();
+        else
+            unset_mode_group_mute();
+        break;
+
+    case COMMAND_MODE_GROUP_LEARN:
+        apply_group_learn(c.m_flag);
+        break;
+
+    case COMMAND_SET_SCREENSET:
+        apply_screenset(c.m_value);
+        break;
+
+    case COMMAND_MUTE_SCREENSET:
+        mute_screenset(c.m_value, c.m_flag);
+        break;
+
+    case COMMAND_SET_BPM:
+        set_beats_per_minute(c.m_bpm);
+        break;
+
+    default:
+        break;
+    }
+}
+
 /**
  *  Performance output function.  This function is called by the free function
  *  output_thread_func().  Here's how it works:
@@ -3630,7 +4060,13 @@ perform::deinit_jack_transport ()
 void
 perform::output_func ()
 {
-    while (m_outputing)         /* PERHAPS we should LOCK this variable */
+    bool rtsafe = usr().option_rtsafe();
+    if (rtsafe)
+        rt_prefault_stack();
+
+    rt_trace::thread_name("output");
+    rt_command_queue::engine_thread(true);
+    while (m_outputing)                 /* atomic, cleared to stop thread   */
     {
         m_condition_var.lock();
         while (! is_running())
@@ -3644,18 +4080,10 @@ perform::output_func ()
 #ifdef PLATFORM_WINDOWS
         long last;                          // beginning time
         long current;                       // current time
-#ifdef SEQ64_STATISTICS_SUPPORT
-        long stats_loop_start = 0;
-        long stats_loop_finish = 0;
-#endif
         long delta;                         // difference between last & current
 #else                                       // not Windows
         struct timespec last;               // beginning time
         struct timespec current;            // current time
-#ifdef SEQ64_STATISTICS_SUPPORT
-        struct timespec stats_loop_start;
-        struct timespec stats_loop_finish;
-#endif
         struct timespec delta;              // difference between last & current
 #endif
 
@@ -3692,30 +4120,15 @@ perform::output_func ()
         pad.js_delta_tick_frac = 0L;        // from seq24 0.9.3, long value
 
         /*
-         * Not sure that we really need this feature.  Will have to see if
-         * anyone wants it.  This is currently not a complete commenting out
-         * of the feature at this time.
+         * Timing statistics are always gathered into m_rt_stats; recording
+         * them is lock-free and allocation-free.  They accumulate from
+         * launch() on.  The clock count tracks when pad.js_total_tick
+         * crosses a MIDI clock boundary; it restarts with each playback so
+         * that a stop/start gap is not counted as a clock interval.
          */
 
-#ifdef SEQ64_STATISTICS_SUPPORT
-        midipulse stats_total_tick = 0;
-        long stats_loop_index = 0;
-        long stats_min = 0x7FFFFFFF;
-        long stats_max = 0;
-        long stats_avg = 0;
-        long stats_last_clock_us = 0;
-        long stats_clock_width_us = 0;
-        long stats_all[100];                // why 100?
-        long stats_clock[100];
-        if (rc().stats())                   // \change ca 2016-01-24
-        {
-            for (int i = 0; i < 100; ++i)
-            {
-                stats_all[i] = 0;
-                stats_clock[i] = 0;
-            }
-        }
-#endif  // SEQ64_STATISTICS_SUPPORT
+        long stats_clock_count = -1;
+        uint64_t stats_last_clock_us = 0;
 
         /*
          * If we are in the performance view (song editor), we care about
@@ -3745,28 +4158,12 @@ perform::output_func ()
 
         int ppqn = m_master_bus->get_ppqn();
 
-#ifdef SEQ64_STATISTICS_SUPPORT
-
-#ifdef PLATFORM_WINDOWS
-        last = timeGetTime();                   // get start time position
-        if (rc().stats())
-            stats_last_clock_us = last * 1000;
-#else
-        clock_gettime(CLOCK_REALTIME, &last);   // get start time position
-        if (rc().stats())
-            stats_last_clock_us = (last.tv_sec*1000000) + (last.tv_nsec/1000);
-#endif
-
-#else   // SEQ64_STATISTICS_SUPPORT
-
 #ifdef PLATFORM_WINDOWS
         last = timeGetTime();                   // get start time position
 #else
         clock_gettime(CLOCK_REALTIME, &last);   // get start time position
 #endif
 
-#endif  // SEQ64_STATISTICS_SUPPORT
-
         while (is_running())
         {
             /**
@@ -3777,16 +4174,17 @@ perform::output_func ()
              * -# Play from current tick to prebuffer.
              */
 
-#ifdef SEQ64_STATISTICS_SUPPORT
-            if (rc().stats())
-            {
-#ifdef PLATFORM_WINDOWS
-                stats_loop_start = timeGetTime();
-#else
-                clock_gettime(CLOCK_REALTIME, &stats_loop_start);
-#endif
-            }
-#endif  // SEQ64_STATISTICS_SUPPORT
+            uint64_t stats_loop_start = rt_microseconds();
+            unsigned long stats_events = m_master_bus->events_played();
+
+            /*
+             * Apply the state changes posted since the last frame.  Any
+             * allocating bookkeeping, such as song recording of a toggle,
+             * was done by the posting thread, so this is guarded, too.
+             */
+
+            rt_guard_allocations(rtsafe);           /* no heap from here on */
+            apply_commands();
 
             /*
              * Get the delta time.
@@ -4002,39 +4400,34 @@ perform::output_func ()
 
                 m_master_bus->emit_clock(midipulse(pad.js_clock_tick));
 
-#ifdef SEQ64_STATISTICS_SUPPORT
-                if (rc().stats())
+                /*
+                 * If one or more MIDI clock boundaries (c_ppqn / 24) were
+                 * crossed in this frame, record the time since the last
+                 * crossing, split evenly among the clocks.
+                 */
+
+                int ct = clock_ticks_from_ppqn(m_ppqn);
+                if (ct > 0)
                 {
-                    while (stats_total_tick <= pad.js_total_tick)
+                    long clockcount = long(pad.js_total_tick) / ct;
+                    if (clockcount != stats_clock_count)
                     {
-                        /*
-                         * Uses inline function for c_ppqn / 24.  Checks to see
-                         * if there was a tick.  What's up with the constants
-                         * 100 and 300?
-                         */
+                        uint64_t now_us = rt_microseconds();
+                        bool ok = stats_clock_count >= 0 &&
+                            clockcount > stats_clock_count;
 
-                        int ct = clock_ticks_from_ppqn(m_ppqn);
-                        if ((stats_total_tick % ct) == 0)
+                        if (ok)
                         {
-#ifdef PLATFORM_WINDOWS
-                            long current_us = current * 1000;
-#else
-                            long current_us = (current.tv_sec * 1000000) +
-                                (current.tv_nsec / 1000);
-#endif
-                            stats_clock_width_us = current_us-stats_last_clock_us;
-                            stats_last_clock_us = current_us;
-
-                            int index = stats_clock_width_us / 300;
-                            if (index >= 100)
-                                index = 99;
-
-                            stats_clock[index]++;
+                            uint64_t clocks = clockcount - stats_clock_count;
+                            m_rt_stats.clock_interval().record
+                            (
+                                (now_us - stats_last_clock_us) / clocks
+                            );
                         }
-                        stats_total_tick++;
+                        stats_clock_count = clockcount;
+                        stats_last_clock_us = now_us;
                     }
                 }
-#endif  // SEQ64_STATISTICS_SUPPORT
             }
 
             /**
@@ -4076,8 +4469,16 @@ perform::output_func ()
             if (next_clock_delta_us < (c_thread_trigger_width_us * 2.0))
                 delta_us = long(next_clock_delta_us);
 
+            uint64_t stats_now = rt_microseconds();
+            m_rt_stats.loop_duration().record(stats_now - stats_loop_start);
+            m_rt_stats.events_per_frame().record
+            (
+                m_master_bus->events_played() - stats_events
+            );
+            m_rt_stats.count_frame();
             if (delta_us > 0)
             {
+                uint64_t stats_wake = stats_now + uint64_t(delta_us);
 #ifdef PLATFORM_WINDOWS
                 delta = delta_us / 1000;
                 Sleep(delta);
@@ -4086,83 +4487,20 @@ perform::output_func ()
                 delta.tv_nsec = (delta_us % 1000000) * 1000;
                 nanosleep(&delta, NULL);    /* nanosleep() is Linux */
 #endif
+                stats_now = rt_microseconds();
+                m_rt_stats.wakeup_lateness().record
+                (
+                    stats_now > stats_wake ? stats_now - stats_wake : 0
+                );
             }
-#ifdef SEQ64_STATISTICS_SUPPORT
             else
-            {
-                if (rc().stats())
-                {
-                    errprint("Underrun");
-                }
-            }
-#endif  // SEQ64_STATISTICS_SUPPORT
-
-#ifdef SEQ64_STATISTICS_SUPPORT
-            if (rc().stats())
-            {
-#ifdef PLATFORM_WINDOWS
-                stats_loop_finish = timeGetTime();
-                delta = stats_loop_finish - stats_loop_start;
-                long delta_us = delta * 1000;
-#else
-                clock_gettime(CLOCK_REALTIME, &stats_loop_finish);
-                delta.tv_sec  = stats_loop_finish.tv_sec-stats_loop_start.tv_sec;
-                delta.tv_nsec = stats_loop_finish.tv_nsec-stats_loop_start.tv_nsec;
-                long delta_us = (delta.tv_sec*1000000) + (delta.tv_nsec/1000);
-#endif
-                int index = delta_us / 100;         // why the 100?
-                if (index >= 100)
-                    index = 99;
-
-                stats_all[index]++;
-                if (delta_us > stats_max)
-                    stats_max = delta_us;
-
-                if (delta_us < stats_min)
-                    stats_min = delta_us;
-
-                stats_avg += delta_us;
-                stats_loop_index++;
-                if (stats_loop_index > 200)         // what is 200?
-                {
-                    stats_loop_index = 0;
-                    stats_avg /= 200;
-                    printf
-                    (
-                        "stats_avg[%ld]us stats_min[%ld]us stats_max[%ld]us\n",
-                        stats_avg, stats_min, stats_max
-                    );
-                    stats_min = 0x7FFFFFFF;
-                    stats_max = 0;
-                    stats_avg = 0;
-                }
-            }
-#endif  // SEQ64_STATISTICS_SUPPORT
+                m_rt_stats.count_underrun();
 
+            rt_guard_allocations(false);
             if (pad.js_jack_stopped)
                 inner_stop();
         }
-#ifdef SEQ64_STATISTICS_SUPPORT
-        if (rc().stats())
-        {
-            printf("\n\n-- trigger width --\n");
-            for (int i = 0; i < 100; ++i)
-            {
-                printf("[%3d][%8ld]\n", i * 100, stats_all[i]);
-            }
-            printf("\n\n-- clock width --\n");
-
-            midibpm bpm  = m_master_bus->get_beats_per_minute();
-            printf
-            (
-                "optimal: [%d us]\n", int(clock_tick_duration_bogus(bpm, m_ppqn))
-            );
-            for (int i = 0; i < 100; ++i)
-            {
-                printf("[%3d][%8ld]\n", i * 300, stats_clock[i]);
-            }
-        }
-#endif  // SEQ64_STATISTICS_SUPPORT
+        apply_commands();                   /* the ones posted while stopping */
 
         /*
          * Disabling this setting allows all of the progress bars (seqroll,
@@ -4213,6 +4551,7 @@ perform::output_func ()
 #endif
 
     }
+    rt_command_queue::engine_thread(false);
     pthread_exit(0);
 }
 
@@ -5120,13 +5459,28 @@ void
 perform::input_func ()
 {
     event ev;
-    while (m_inputing)              /* perhaps we should lock this variable */
+    bool rtsafe = usr().option_rtsafe();
+    if (rtsafe)
+        rt_prefault_stack();
+
+    rt_trace::thread_name("input");
+    while (m_inputing)              /* atomic, cleared to stop thread   */
     {
         if (m_master_bus->poll_for_midi() > 0)
         {
             do
             {
-                if (m_master_bus->get_midi_event(&ev))
+                /*
+                 * In RT-safe mode, receiving the event must not allocate.
+                 * Handling it may, since recording inserts into the
+                 * sequence's event list.
+                 */
+
+                rt_trace_span span("perform::input_func");
+                rt_guard_allocations(rtsafe);
+                bool gotevent = m_master_bus->get_midi_event(&ev);
+                rt_guard_allocations(false);
+                if (gotevent)
                 {
                     /*
                      * Used when starting from the beginning of the song.
@@ -5494,6 +5848,9 @@ perform::clear_current_screenset ()
 void
 perform::set_sequence_control_status (int status)
 {
+    if (post_command(COMMAND_SET_CONTROL_STATUS, status))
+        return;
+
     if (status & c_status_snapshot)
         save_playing_state();
 
@@ -5515,6 +5872,9 @@ perform::set_sequence_control_status (int status)
 void
 perform::unset_sequence_control_status (int status)
 {
+    if (post_command(COMMAND_UNSET_CONTROL_STATUS, status))
+        return;
+
     if (status & c_status_snapshot)
         restore_playing_state();
 
@@ -5569,6 +5929,10 @@ perform::unset_queued_replace (bool clearbits)
  *  This function now also supports the new queued-replace (queued-solo)
  *  feature.
  *
+ *  The state change itself is posted to the engine; see
+ *  apply_playing_toggle().  The song-recording triggers are added here,
+ *  by the calling thread; see song_record_toggle().
+ *
  * \param seq
  *      The sequence number of the sequence to be potentially toggled.
  *      This value must be a valid and active sequence number. If in
@@ -5582,6 +5946,35 @@ perform::sequence_playing_toggle (int seq)
 {
     sequence * s = get_sequence(seq);
     if (not_nullptr(s))                     // if (is_active(seq))
+    {
+        if (! s->streaming())
+            (void) s->load_events();        /* for "-o lazy", not in RT     */
+
+#ifdef SEQ64_SONG_RECORDING
+        if (song_recording())
+            song_record_toggle(s);          /* allocates, so not in RT      */
+#endif
+
+        if (! post_command(COMMAND_SEQUENCE_TOGGLE, seq))
+            apply_playing_toggle(seq);
+    }
+}
+
+/**
+ *  Does the part of sequence_playing_toggle() that changes the playing,
+ *  queued, or one-shot state, as per the current value of m_control_status.
+ *  This part is applied by the output thread when the engine is running,
+ *  and does not allocate.
+ *
+ * \param seq
+ *      The sequence number of the sequence to be toggled.
+ */
+
+void
+perform::apply_playing_toggle (int seq)
+{
+    sequence * s = get_sequence(seq);
+    if (not_nullptr(s))
     {
         bool is_queue = (m_control_status & c_status_queue) != 0;
         bool is_replace = (m_control_status & c_status_replace) != 0;
@@ -5635,53 +6028,68 @@ perform::sequence_playing_toggle (int seq)
 
         /*
          * If we're in song playback, temporarily block the events until the
-         * next sequence boundary. And if we're recording, add "Live" sequence
-         * playback changes to the Song/Performance data as triggers.
-         *
-         * \todo
-         *      Would be nice to delay song-recording start to the next queue,
-         *      if queuing is active for this sequence.
+         * next sequence boundary.
          */
 
         if (m_playback_mode)
             s->song_playback_block(true);
 
-        if (song_recording())
-        {
-            midipulse seq_length = s->get_length();
-            midipulse tick = get_tick();
-            bool trigger_state = s->get_trigger_state(tick);
-            if (trigger_state)              /* if sequence already playing  */
-            {
-                /*
-                 * If this play is us recording live, end the new trigger
-                 * block here.
-                 */
+#endif
+    }
+}
 
-                if (s->song_recording())
-                {
-                    s->song_recording_stop(tick);
-                }
-                else        /* ...else need to trim block already in place  */
-                {
-                    s->exact_split_trigger(tick);
-                    s->delete_trigger(tick);
-                }
-            }
-            else            /* if not playing, start recording a new strip  */
-            {
-                if (m_song_record_snap)     /* snap to length of sequence   */
-                    tick -= tick % seq_length;
+#ifdef SEQ64_SONG_RECORDING
 
-                push_trigger_undo();
-                s->song_recording_start(tick, m_song_record_snap);
-            }
+/**
+ *  Adds the "Live" playback change of a sequence to the Song/Performance
+ *  data as triggers, while we are recording.  Adding and splitting
+ *  triggers, and saving them for undo, allocates, so this is done by the
+ *  thread that toggles the sequence, before the toggle itself is posted to
+ *  the engine.
+ *
+ * 	odo
+ *      Would be nice to delay song-recording start to the next queue,
+ *      if queuing is active for this sequence.
+ *
+ * \param s
+ *      The sequence about to be toggled.
+ */
+
+void
+perform::song_record_toggle (sequence * s)
+{
+    midipulse seq_length = s->get_length();
+    midipulse tick = get_tick();
+    bool trigger_state = s->get_trigger_state(tick);
+    if (trigger_state)                      /* if sequence already playing  */
+    {
+        /*
+         * If this play is us recording live, end the new trigger block
+         * here.
+         */
+
+        if (s->song_recording())
+        {
+            s->song_recording_stop(tick);
         }
-#endif  // SEQ64_SONG_RECORDING
+        else            /* ...else need to trim block already in place      */
+        {
+            s->exact_split_trigger(tick);
+            s->delete_trigger(tick);
+        }
+    }
+    else                /* if not playing, start recording a new strip      */
+    {
+        if (m_song_record_snap)             /* snap to length of sequence   */
+            tick -= tick % seq_length;
 
+        push_trigger_undo();
+        s->song_recording_start(tick, m_song_record_snap);
     }
 }
 
+#endif  // SEQ64_SONG_RECORDING
+
 /**
  *  A helper function for determining if the mode group is in force, the
  *  playing screenset is the same as the current screenset, and the sequence
@@ -5722,6 +6130,9 @@ perform::seq_in_playing_screen (int seq)
 void
 perform::sequence_playing_change (int seq, bool on)
 {
+    if (post_command(COMMAND_SEQUENCE_CHANGE, seq, on))
+        return;
+
     sequence * s = get_sequence(seq);
     if (not_nullptr(s))
     {
@@ -6899,6 +7310,7 @@ perform::set_tick (midipulse tick)
 #endif  // PLATFORM_DEBUG_TMI
 
     m_tick = tick;
+    m_changes.post_playhead(tick);
 
     /*
      * \change ca 2017-12-30 Issue #123
@@ -0,0 +1,119 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          render_snapshot.cpp
+ *
+ *  This module defines the immutable copy of the drawable notes of a
+ *  sequence.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the render_snapshot.hpp module for the overview.
+ */
+
+#include "app_limits.h"                 /* SEQ64_MAX_DATA_VALUE             */
+#include "calculations.hpp"             /* seq64::tempo_to_note_value()     */
+#include "event_list.hpp"               /* seq64::event_list                */
+#include "render_snapshot.hpp"          /* seq64::render_snapshot           */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Builds the snapshot with one pass over the events, following the same
+ *  rules as sequence::get_next_note_event().  The caller must hold the
+ *  sequence mutex, as sequence::snapshot() does.
+ *
+ * \param evl
+ *      The events of the sequence.
+ *
+ * \param length
+ *      The length of the sequence, used as the end of an unlinked tempo
+ *      event.
+ *
+ * \param version
+ *      The edit version of the sequence.
+ */
+
+render_snapshot::render_snapshot
+(
+    const event_list & evl, midipulse length, unsigned long version
+) :
+    m_version   (version),
+    m_length    (length),
+    m_notes     (),
+    m_lowest    (SEQ64_MAX_DATA_VALUE),
+    m_highest   (-1)
+{
+    m_notes.reserve(evl.count());
+    for (event_list::const_iterator i = evl.begin(); i != evl.end(); ++i)
+    {
+        const event & e = DREF(i);
+        bool isnoteon = e.is_note_on();
+        bool islinked = e.is_linked();
+        note n;
+        n.tick_s = e.get_timestamp();
+        n.tick_f = 0;
+        n.key = e.get_note();
+        n.velocity = e.get_note_velocity();
+        n.selected = e.is_selected();
+        if (isnoteon && islinked)
+        {
+            n.tick_f = e.get_linked()->get_timestamp();
+            n.type = DRAW_NORMAL_LINKED;
+        }
+        else if (isnoteon)
+            n.type = DRAW_NOTE_ON;
+        else if (e.is_note_off() && ! islinked)
+            n.type = DRAW_NOTE_OFF;
+        else if (e.is_tempo())
+        {
+            n.key = int(tempo_to_note_value(e.tempo()));
+            n.tick_f = islinked ? e.get_linked()->get_timestamp() : length ;
+            n.type = DRAW_TEMPO;
+        }
+        else
+            continue;                           /* linked Note Off, etc.    */
+
+        if (n.key < m_lowest)
+            m_lowest = n.key;
+
+        if (n.key > m_highest)
+            m_highest = n.key;
+
+        m_notes.push_back(n);
+    }
+}
+
+}           // namespace seq64
+
+/*
+ * render_snapshot.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,198 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_command.cpp
+ *
+ *  This module defines the queue of commands that the user interface and
+ *  the control surfaces send to the engine.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The ring follows the well-known bounded queue of Dmitry Vyukov.  A
+ *  producer claims a position by a compare-and-swap on m_enqueue_pos, fills
+ *  the cell, and then publishes it by storing position + 1 in the cell's
+ *  sequence number.  The consumer takes a cell only once it sees that
+ *  number, and frees it by storing position + size.
+ */
+
+#include "rt_command.hpp"               /* seq64::rt_command_queue          */
+
+/**
+ *  The mask for turning a position into a cell index.
+ */
+
+#define SEQ64_RT_COMMAND_QUEUE_MASK     (SEQ64_RT_COMMAND_QUEUE_SIZE - 1)
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  True in the thread that applies the commands, normally the output
+ *  thread.  A command posted from that thread is applied at once.
+ */
+
+static thread_local bool s_engine_thread = false;
+
+/**
+ *  Principal constructor.  Every cell starts out free for the producer
+ *  whose position matches its index.
+ */
+
+rt_command_queue::rt_command_queue ()
+ :
+    m_cells         (),
+    m_enqueue_pos   (0),
+    m_dequeue_pos   (0),
+    m_consumer      (false),
+    m_overflows     (0)
+{
+    for (std::size_t i = 0; i < SEQ64_RT_COMMAND_QUEUE_SIZE; ++i)
+        m_cells[i].m_sequence.store(i, std::memory_order_relaxed);
+}
+
+/**
+ *  Posts a command.  Safe to call from any number of threads at once:  no
+ *  locks and no allocation.
+ *
+ * \param c
+ *      The command to be copied into the queue.
+ *
+ * \return
+ *      Returns false if the queue is full, in which case the caller must
+ *      deal with the command some other way.
+ */
+
+bool
+rt_command_queue::push (const rt_command & c)
+{
+    std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        cell & slot = m_cells[pos & SEQ64_RT_COMMAND_QUEUE_MASK];
+        std::size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+        if (diff == 0)
+        {
+            if
+            (
+                m_enqueue_pos.compare_exchange_weak
+                (
+                    pos, pos + 1, std::memory_order_relaxed
+                )
+            )
+            {
+                slot.m_command = c;
+                slot.m_sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            m_overflows.fetch_add(1, std::memory_order_relaxed);
+            return false;                   /* the queue is full            */
+        }
+        else
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    }
+}
+
+/**
+ *  Takes the oldest command.  Meant to be called only by the thread that
+ *  got true from acquire().
+ *
+ * \param [out] c
+ *      Receives the command.
+ *
+ * \return
+ *      Returns false if the queue is empty, or if the oldest command is
+ *      still being written by its producer.
+ */
+
+bool
+rt_command_queue::pop (rt_command & c)
+{
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    cell & slot = m_cells[pos & SEQ64_RT_COMMAND_QUEUE_MASK];
+    std::size_t seq = slot.m_sequence.load(std::memory_order_acquire);
+    if (seq != pos + 1)
+        return false;
+
+    c = slot.m_command;
+    m_dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    slot.m_sequence.store
+    (
+        pos + SEQ64_RT_COMMAND_QUEUE_SIZE, std::memory_order_release
+    );
+    return true;
+}
+
+/**
+ * \return
+ *      Returns true if no command is waiting.  A command being posted at
+ *      the same time may or may not be seen.
+ */
+
+bool
+rt_command_queue::empty () const
+{
+    std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    const cell & slot = m_cells[pos & SEQ64_RT_COMMAND_QUEUE_MASK];
+    return slot.m_sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+/**
+ *  Marks the calling thread as the engine thread, or not.
+ *
+ * \param flag
+ *      True for the output thread while it runs.
+ */
+
+void
+rt_command_queue::engine_thread (bool flag)
+{
+    s_engine_thread = flag;
+}
+
+/**
+ * \return
+ *      Returns true if the calling thread is the engine thread.
+ */
+
+bool
+rt_command_queue::is_engine_thread ()
+{
+    return s_engine_thread;
+}
+
+}           // namespace seq64
+
+/*
+ * rt_command.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
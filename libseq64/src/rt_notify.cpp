@@ -0,0 +1,202 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_notify.cpp
+ *
+ *  This module defines the coalesced change notifications posted by the
+ *  engine for the user interface.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The wake-up byte is written only when the pending mask goes from empty
+ *  to non-empty, so the pipe never holds more than a few bytes, and a
+ *  process with no GUI (seq64cli) never fills it.
+ */
+
+#include "platform_macros.h"            /* PLATFORM_WINDOWS                 */
+#include "rt_notify.hpp"                /* seq64::rt_notify                 */
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>                      /* fcntl(), O_NONBLOCK              */
+#include <unistd.h>                     /* pipe(), read(), write()          */
+#endif
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Principal constructor.  Creates the wake-up pipe, with both ends
+ *  non-blocking, so that neither the poster nor the GUI can ever wait on it.
+ *  The default playhead step is a sixty-fourth note at the default PPQN.
+ */
+
+rt_notify::rt_notify ()
+ :
+    m_pending       (0),
+    m_sequences     (),
+    m_playhead      (0),
+    m_playhead_step (SEQ64_DEFAULT_PPQN / 16),
+    m_wake_fd       ()
+{
+    for (int s = 0; s < c_max_sequence; ++s)
+        m_sequences[s].store(false, std::memory_order_relaxed);
+
+    m_wake_fd[0] = m_wake_fd[1] = -1;
+
+#ifndef PLATFORM_WINDOWS
+    if (pipe(m_wake_fd) == 0)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            (void) fcntl(m_wake_fd[i], F_SETFL, O_NONBLOCK);
+            (void) fcntl(m_wake_fd[i], F_SETFD, FD_CLOEXEC);
+        }
+    }
+    else
+        m_wake_fd[0] = m_wake_fd[1] = -1;
+#endif
+}
+
+/**
+ *  Closes the pipe.
+ */
+
+rt_notify::~rt_notify ()
+{
+#ifndef PLATFORM_WINDOWS
+    for (int i = 0; i < 2; ++i)
+    {
+        if (m_wake_fd[i] >= 0)
+            (void) close(m_wake_fd[i]);
+    }
+#endif
+}
+
+/**
+ *  Posts a change.  Safe to call from any thread, including the output
+ *  thread:  no locks, no allocation, and at most one non-blocking write().
+ *
+ * \param change
+ *      The kind of change.
+ *
+ * \param seq
+ *      The number of the sequence that changed, or -1 if the change is not
+ *      about a particular sequence.
+ */
+
+void
+rt_notify::post (change_t change, int seq)
+{
+    if (seq >= 0 && seq < c_max_sequence)
+        m_sequences[seq].store(true, std::memory_order_relaxed);
+
+    unsigned previous = m_pending.fetch_or
+    (
+        unsigned(change), std::memory_order_release
+    );
+    if (previous == 0 && change != CHANGE_NONE)
+    {
+#ifndef PLATFORM_WINDOWS
+        if (m_wake_fd[1] >= 0)
+        {
+            char byte = 0;
+            (void) write(m_wake_fd[1], &byte, 1);
+        }
+#endif
+    }
+}
+
+/**
+ *  Posts a playhead change, but only if the position moved by at least
+ *  m_playhead_step ticks (in either direction) since the last one posted.
+ *
+ * \param tick
+ *      The new song position.
+ */
+
+void
+rt_notify::post_playhead (midipulse tick)
+{
+    midipulse last = m_playhead.load(std::memory_order_relaxed);
+    midipulse delta = tick > last ? tick - last : last - tick ;
+    if (delta >= playhead_step())
+    {
+        m_playhead.store(tick, std::memory_order_relaxed);
+        post(CHANGE_PLAYHEAD);
+    }
+}
+
+/**
+ *  Takes all of the pending changes, clearing them, and empties the pipe.
+ *  Meant to be called only by the GUI thread.  The pipe is emptied before
+ *  the mask is taken, so that a change posted in between causes one more
+ *  (possibly empty) wake-up, rather than being missed.
+ *
+ * \param sequences
+ *      If not null, an array of c_max_sequence booleans that is set to true
+ *      for each sequence that changed, and false for the rest.  If null, the
+ *      sequence flags are left pending.
+ *
+ * \return
+ *      Returns the or'ed change_t values, or CHANGE_NONE.
+ */
+
+unsigned
+rt_notify::drain (bool * sequences)
+{
+#ifndef PLATFORM_WINDOWS
+    if (m_wake_fd[0] >= 0)
+    {
+        char buffer[64];
+        while (read(m_wake_fd[0], buffer, sizeof buffer) > 0)
+        {
+            // empty the pipe
+        }
+    }
+#endif
+    unsigned result = m_pending.exchange(0, std::memory_order_acquire);
+    if (not_nullptr(sequences))
+    {
+        for (int s = 0; s < c_max_sequence; ++s)
+        {
+            sequences[s] = m_sequences[s].exchange
+            (
+                false, std::memory_order_relaxed
+            );
+        }
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * rt_notify.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
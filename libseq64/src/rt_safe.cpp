@@ -0,0 +1,235 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_safe.cpp
+ *
+ *  This module defines the memory locking and allocation guard of the
+ *  RT-safe mode.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-05
+ * \updates       2018-09-05
+ * \license       GNU GPLv2 or above
+ *
+ *  The allocation guard works by replacing the global operator new, and so
+ *  is compiled only if configured with --enable-rtguard (SEQ64_RTSAFE_GUARD).
+ *  Otherwise, the guard functions are still present, but no allocation is
+ *  ever flagged, and the allocator of the application is left alone.
+ */
+
+#include <atomic>
+#include <new>                          /* std::bad_alloc, std::nothrow_t   */
+#include <stdio.h>
+#include <stdlib.h>                     /* malloc(), abort()                */
+#include <string.h>                     /* strlen()                         */
+
+#include "platform_macros.h"            /* PLATFORM_WINDOWS                 */
+#include "rt_safe.hpp"                  /* seq64::rt_lock_memory() etc.     */
+#include "seq64_features.h"             /* SEQ64_RTSAFE_GUARD               */
+
+#ifdef PLATFORM_WINDOWS
+#include <io.h>                         /* _write()                         */
+#define STDERR_WRITE(s)     _write(2, s, unsigned(strlen(s)))
+#else
+#include <sys/mman.h>                   /* mlockall()                       */
+#include <unistd.h>                     /* write()                          */
+#define STDERR_WRITE(s)     (void) write(2, s, strlen(s))
+#endif
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  True while the calling thread is doing real-time work.  Each thread has
+ *  its own flag, so the GUI thread is never flagged.
+ */
+
+static thread_local bool s_rt_guarded = false;
+
+/**
+ *  If true, the first guarded allocation aborts the application.
+ */
+
+static std::atomic<bool> s_rt_abort(false);
+
+/**
+ *  The number of guarded allocations seen so far, on all threads.
+ */
+
+static std::atomic<unsigned long> s_rt_violations(0);
+
+/**
+ *  Locks all current and future pages of the process into RAM, so that
+ *  playback never waits for a page to be swapped back in.  This needs the
+ *  "memlock" limit to be raised (e.g. in /etc/security/limits.d/ for the
+ *  "audio" group), as is usually done for JACK.
+ *
+ * \return
+ *      Returns true if the memory could be locked.
+ */
+
+bool
+rt_lock_memory ()
+{
+#ifdef PLATFORM_WINDOWS
+    printf("? Memory locking not supported on this platform\n");
+    return false;
+#else
+    bool result = mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+    if (result)
+        printf("[Memory locked]\n");
+    else
+        printf("? mlockall() failed; check the memlock limit\n");
+
+    return result;
+#endif
+}
+
+/**
+ *  Touches SEQ64_RT_STACK_PREFAULT bytes of the calling thread's stack, one
+ *  page at a time, so that a later deep call does not take a page fault.
+ *  Call it at the start of each real-time thread, after rt_lock_memory().
+ */
+
+void
+rt_prefault_stack ()
+{
+    volatile char stack[SEQ64_RT_STACK_PREFAULT];
+    for (int i = 0; i < SEQ64_RT_STACK_PREFAULT; i += 1024)
+        stack[i] = 0;
+
+    (void) stack[0];                    /* keep the compiler from nagging   */
+}
+
+/**
+ *  Raises or lowers the allocation guard for the calling thread.
+ *
+ * \param guard
+ *      If true, any operator new call from this thread will be flagged.
+ */
+
+void
+rt_guard_allocations (bool guard)
+{
+    s_rt_guarded = guard;
+}
+
+/**
+ *  Sets whether a guarded allocation aborts the application.
+ *
+ * \param abortit
+ *      If true, abort() is called on the first guarded allocation.
+ */
+
+void
+rt_guard_abort (bool abortit)
+{
+    s_rt_abort.store(abortit);
+}
+
+/**
+ *  Called by the replacement operator new.  If the calling thread has its
+ *  guard up, counts the violation.  The first one is reported on stderr
+ *  with write(), which does not allocate, and aborts if so requested.  The
+ *  guard is dropped while doing this, to avoid any recursion.
+ */
+
+void
+rt_check_allocation ()
+{
+    if (s_rt_guarded)
+    {
+        s_rt_guarded = false;
+        unsigned long count = s_rt_violations.fetch_add(1);
+        if (count == 0 || s_rt_abort.load())
+            STDERR_WRITE("? heap allocation on a real-time thread\n");
+
+        if (s_rt_abort.load())
+            abort();
+
+        s_rt_guarded = true;
+    }
+}
+
+/**
+ *  Gets the number of guarded allocations.  Always 0 unless the guard is
+ *  built in.
+ *
+ * \return
+ *      Returns the count of operator new calls made by guarded threads.
+ */
+
+unsigned long
+rt_guard_violations ()
+{
+    return s_rt_violations.load();
+}
+
+}           // namespace seq64
+
+#ifdef SEQ64_RTSAFE_GUARD
+
+/*
+ *  Replacements for the global allocation functions.  The default operator
+ *  delete calls free(), so it does not need to be replaced.
+ */
+
+void *
+operator new (std::size_t size)
+{
+    seq64::rt_check_allocation();
+    void * result = malloc(size > 0 ? size : 1);
+    if (result == NULL)
+        throw std::bad_alloc();
+
+    return result;
+}
+
+void *
+operator new [] (std::size_t size)
+{
+    return operator new(size);
+}
+
+void *
+operator new (std::size_t size, const std::nothrow_t &) noexcept
+{
+    seq64::rt_check_allocation();
+    return malloc(size > 0 ? size : 1);
+}
+
+void *
+operator new [] (std::size_t size, const std::nothrow_t & nt) noexcept
+{
+    return operator new(size, nt);
+}
+
+#endif      // SEQ64_RTSAFE_GUARD
+
+/*
+ * rt_safe.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,359 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_statistics.cpp
+ *
+ *  This module defines lock-free counters and histograms for timing the
+ *  output thread.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-03
+ * \updates       2018-09-03
+ * \license       GNU GPLv2 or above
+ *
+ *  See the rt_statistics.hpp module for the description of the histogram
+ *  buckets.  Only record() and the counters are meant to be called from the
+ *  output thread; show() and write() do I/O and belong in another thread.
+ */
+
+#include "platform_macros.h"            /* PLATFORM_WINDOWS                 */
+
+#ifdef PLATFORM_WINDOWS
+#include <windows.h>                    /* timeGetTime()                    */
+#else
+#include <time.h>                       /* clock_gettime()                  */
+#endif
+
+#include "rt_statistics.hpp"            /* seq64::rt_statistics             */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Gets a monotonic time in microseconds.  On Windows this has only
+ *  millisecond resolution, just like the timeGetTime() calls in the output
+ *  thread.
+ *
+ * \return
+ *      Returns the current time in microseconds from an arbitrary start.
+ */
+
+uint64_t
+rt_microseconds ()
+{
+#ifdef PLATFORM_WINDOWS
+    return uint64_t(timeGetTime()) * 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec) * 1000000 + uint64_t(ts.tv_nsec / 1000);
+#endif
+}
+
+/**
+ *  Principal constructor.  All of the buckets start out empty.
+ *
+ * \param name
+ *      The name of the histogram, for display.
+ *
+ * \param units
+ *      The units of the values, for display.
+ */
+
+rt_histogram::rt_histogram (const std::string & name, const std::string & units)
+ :
+    m_name      (name),
+    m_units     (units),
+    m_count     (0),
+    m_sum       (0),
+    m_min       (UINT64_MAX),
+    m_max       (0),
+    m_buckets   ()
+{
+    reset();
+}
+
+/**
+ *  Calculates the bucket in which a value is tallied.  Small values map
+ *  directly to their own bucket.  Larger values use the position of the
+ *  highest set bit to pick the power-of-two range, and the next
+ *  sm_sub_bucket_bits bits to pick the bucket within that range.
+ *
+ * \param value
+ *      The value to be located.
+ *
+ * \return
+ *      Returns the bucket index, from 0 to sm_bucket_count - 1.
+ */
+
+int
+rt_histogram::bucket_index (uint64_t value)
+{
+    if (value < uint64_t(2 * sm_sub_buckets))
+        return int(value);
+
+    if (value > 0xFFFFFFFFULL)
+        return sm_bucket_count - 1;
+
+    int msb = 0;
+    for (uint64_t v = value; v > 1; v >>= 1)
+        ++msb;
+
+    int shift = msb - sm_sub_bucket_bits;
+    return shift * sm_sub_buckets + int(value >> shift);
+}
+
+/**
+ *  Calculates the smallest value that falls into the given bucket.  This is
+ *  the inverse of bucket_index().
+ *
+ * \param index
+ *      The bucket number.
+ *
+ * \return
+ *      Returns the lower bound of the bucket.
+ */
+
+uint64_t
+rt_histogram::bucket_lower (int index)
+{
+    if (index < 2 * sm_sub_buckets)
+        return uint64_t(index);
+
+    int shift = index / sm_sub_buckets - 1;
+    int sub = index % sm_sub_buckets;
+    return uint64_t(sm_sub_buckets + sub) << shift;
+}
+
+/**
+ *  Records a value.  Safe to call from the real-time thread:  no locks, no
+ *  allocation.  If more than one thread records into the same histogram,
+ *  the minimum and maximum are still kept correctly by the compare-exchange
+ *  loops.
+ *
+ * \param value
+ *      The value to be tallied.
+ */
+
+void
+rt_histogram::record (uint64_t value)
+{
+    m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+
+    uint64_t low = m_min.load(std::memory_order_relaxed);
+    while (value < low)
+    {
+        if (m_min.compare_exchange_weak(low, value, std::memory_order_relaxed))
+            break;
+    }
+
+    uint64_t high = m_max.load(std::memory_order_relaxed);
+    while (value > high)
+    {
+        if (m_max.compare_exchange_weak(high, value, std::memory_order_relaxed))
+            break;
+    }
+}
+
+/**
+ *  Clears all of the tallies.  Values recorded concurrently with a reset
+ *  may be partly lost, which is acceptable.
+ */
+
+void
+rt_histogram::reset ()
+{
+    for (int i = 0; i < sm_bucket_count; ++i)
+        m_buckets[i].store(0, std::memory_order_relaxed);
+
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_min.store(UINT64_MAX, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Calculates an approximate percentile.  The result is the lower bound of
+ *  the bucket holding the given fraction of the values, clamped to the
+ *  recorded maximum.
+ *
+ * \param pct
+ *      The percentile, from 0.0 to 100.0.
+ *
+ * \return
+ *      Returns the value at that percentile, or 0 if nothing was recorded.
+ */
+
+uint64_t
+rt_histogram::percentile (double pct) const
+{
+    uint64_t total = 0;
+    for (int i = 0; i < sm_bucket_count; ++i)
+        total += m_buckets[i].load(std::memory_order_relaxed);
+
+    if (total == 0)
+        return 0;
+
+    uint64_t target = uint64_t(double(total) * pct / 100.0 + 0.5);
+    if (target == 0)
+        target = 1;
+
+    uint64_t running = 0;
+    for (int i = 0; i < sm_bucket_count; ++i)
+    {
+        running += m_buckets[i].load(std::memory_order_relaxed);
+        if (running >= target)
+        {
+            uint64_t result = bucket_lower(i);
+            uint64_t high = maximum();
+            return result > high ? high : result ;
+        }
+    }
+    return maximum();
+}
+
+/**
+ *  Writes a summary line and then the non-empty buckets.  Each bucket line
+ *  shows the range of values [low, high) and the count.
+ *
+ * \param fp
+ *      The destination; not checked for null.
+ */
+
+void
+rt_histogram::show (FILE * fp) const
+{
+    fprintf
+    (
+        fp,
+        "%s (%s): count %llu min %llu mean %.1f p50 %llu p90 %llu "
+        "p99 %llu p99.9 %llu max %llu\n",
+        m_name.c_str(), m_units.c_str(),
+        (unsigned long long) count(), (unsigned long long) minimum(), mean(),
+        (unsigned long long) percentile(50.0),
+        (unsigned long long) percentile(90.0),
+        (unsigned long long) percentile(99.0),
+        (unsigned long long) percentile(99.9),
+        (unsigned long long) maximum()
+    );
+    for (int i = 0; i < sm_bucket_count; ++i)
+    {
+        uint64_t c = m_buckets[i].load(std::memory_order_relaxed);
+        if (c > 0)
+        {
+            fprintf
+            (
+                fp, "    [%10llu, %10llu) %10llu\n",
+                (unsigned long long) bucket_lower(i),
+                (unsigned long long) bucket_lower(i + 1),
+                (unsigned long long) c
+            );
+        }
+    }
+}
+
+/**
+ *  Principal constructor.
+ */
+
+rt_statistics::rt_statistics ()
+ :
+    m_loop_duration     ("loop duration", "us"),
+    m_wakeup_lateness   ("wake-up lateness", "us"),
+    m_clock_interval    ("MIDI clock interval", "us"),
+    m_events_per_frame  ("events per frame", "events"),
+    m_frames            (0),
+    m_underruns         (0)
+{
+    // no code
+}
+
+/**
+ *  Clears all of the statistics.  Not called by the output thread; the
+ *  statistics accumulate from launch() on unless a caller resets them.
+ */
+
+void
+rt_statistics::reset ()
+{
+    m_loop_duration.reset();
+    m_wakeup_lateness.reset();
+    m_clock_interval.reset();
+    m_events_per_frame.reset();
+    m_frames.store(0, std::memory_order_relaxed);
+    m_underruns.store(0, std::memory_order_relaxed);
+}
+
+/**
+ *  Writes all of the statistics in a readable format.
+ *
+ * \param fp
+ *      The destination; not checked for null.
+ */
+
+void
+rt_statistics::show (FILE * fp) const
+{
+    fprintf(fp, "frames: %llu\n", (unsigned long long) frames());
+    fprintf(fp, "underruns: %llu\n", (unsigned long long) underruns());
+    m_loop_duration.show(fp);
+    m_wakeup_lateness.show(fp);
+    m_clock_interval.show(fp);
+    m_events_per_frame.show(fp);
+}
+
+/**
+ *  Writes all of the statistics to a file.  Not to be called from the output
+ *  thread.
+ *
+ * \param filename
+ *      The full path to the file, which is overwritten.
+ *
+ * \return
+ *      Returns true if the file could be opened.
+ */
+
+bool
+rt_statistics::write (const std::string & filename) const
+{
+    FILE * fp = fopen(filename.c_str(), "w");
+    bool result = fp != NULL;
+    if (result)
+    {
+        show(fp);
+        fclose(fp);
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * rt_statistics.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,255 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          rt_trace.cpp
+ *
+ *  This module defines the per-thread span tracer.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-04
+ * \updates       2018-09-04
+ * \license       GNU GPLv2 or above
+ *
+ *  Each thread gets its buffer the first time it records a span or names
+ *  itself, by atomically claiming the next slot.  The span storage for a
+ *  slot is allocated in thread_name(), which each traced thread calls before
+ *  it starts its real-time work, so that the output thread never allocates.
+ *  A thread that records spans without naming itself first is not traced.
+ */
+
+#include <new>                          /* std::nothrow                     */
+#include <stdio.h>
+
+#include "rt_statistics.hpp"            /* seq64::rt_microseconds()         */
+#include "rt_trace.hpp"                 /* seq64::rt_trace                  */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Static members.
+ */
+
+std::atomic<bool> rt_trace::sm_enabled(false);
+std::atomic<int> rt_trace::sm_thread_count(0);
+uint64_t rt_trace::sm_start_time = 0;
+rt_trace::buffer rt_trace::sm_buffers[rt_trace::sm_max_threads];
+
+/**
+ *  Turns on tracing.  Call this from the main thread before launching the
+ *  other threads.  Tracing cannot be turned off again, except by exiting.
+ */
+
+void
+rt_trace::enable ()
+{
+    if (! enabled())
+    {
+        sm_start_time = rt_microseconds();
+        sm_enabled.store(true, std::memory_order_release);
+    }
+}
+
+/**
+ *  Gets the calling thread's buffer, claiming a slot for it if it has none
+ *  yet.
+ *
+ * \return
+ *      Returns a pointer to the buffer, or a null pointer if all of the slots
+ *      are in use.
+ */
+
+rt_trace::buffer *
+rt_trace::thread_buffer ()
+{
+    static thread_local buffer * s_buffer = nullptr;
+    static thread_local bool s_claimed = false;
+    if (! s_claimed)
+    {
+        s_claimed = true;
+        int index = sm_thread_count.fetch_add(1);
+        if (index < sm_max_threads)
+        {
+            s_buffer = &sm_buffers[index];
+            s_buffer->m_name = nullptr;
+            s_buffer->m_count.store(0, std::memory_order_relaxed);
+            s_buffer->m_spans = nullptr;
+        }
+    }
+    return s_buffer;
+}
+
+/**
+ *  Names the calling thread in the trace, and allocates its span storage.
+ *  Does nothing if tracing is not enabled.
+ *
+ * \param name
+ *      The name of the thread, a string literal such as "output".
+ */
+
+void
+rt_trace::thread_name (const char * name)
+{
+    if (enabled())
+    {
+        buffer * b = thread_buffer();
+        if (b != nullptr)
+        {
+            b->m_name = name;
+            if (b->m_spans == nullptr)
+                b->m_spans = new (std::nothrow) span[sm_buffer_size];
+        }
+    }
+}
+
+/**
+ *  Records a span in the calling thread's buffer, overwriting the oldest one
+ *  if the buffer is full.
+ *
+ * \param name
+ *      The name of the span, a string literal.
+ *
+ * \param start
+ *      The start time, from rt_microseconds().
+ *
+ * \param end
+ *      The end time, from rt_microseconds().
+ */
+
+void
+rt_trace::record (const char * name, uint64_t start, uint64_t end)
+{
+    buffer * b = thread_buffer();
+    if (b != nullptr && b->m_spans != nullptr)
+    {
+        uint64_t n = b->m_count.load(std::memory_order_relaxed);
+        span & s = b->m_spans[n % sm_buffer_size];
+        s.name = name;
+        s.start = start;
+        s.duration = end > start ? end - start : 0 ;
+        b->m_count.store(n + 1, std::memory_order_release);
+    }
+}
+
+/**
+ *  Writes all of the buffered spans as a Chrome trace JSON file, as
+ *  complete ("X") events, with a thread-name metadata ("M") event for each
+ *  thread.  Best done after the threads have stopped; otherwise the oldest
+ *  span of a busy thread might be overwritten while it is being written.
+ *
+ * \param filename
+ *      The name of the destination file, which is overwritten.
+ *
+ * \return
+ *      Returns true if tracing was enabled and the file could be written.
+ */
+
+bool
+rt_trace::write (const std::string & filename)
+{
+    if (! enabled())
+        return false;
+
+    FILE * fp = fopen(filename.c_str(), "w");
+    if (fp == NULL)
+        return false;
+
+    int threads = sm_thread_count.load();
+    if (threads > sm_max_threads)
+        threads = sm_max_threads;
+
+    const char * separator = "\n";
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for (int t = 0; t < threads; ++t)
+    {
+        const buffer & b = sm_buffers[t];
+        if (b.m_spans == nullptr)
+            continue;
+
+        fprintf
+        (
+            fp, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, "
+            "\"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+            separator, t + 1, b.m_name != nullptr ? b.m_name : "thread"
+        );
+        separator = ",\n";
+
+        uint64_t count = b.m_count.load(std::memory_order_acquire);
+        uint64_t first = count > uint64_t(sm_buffer_size) ?
+            count - sm_buffer_size : 0 ;
+
+        for (uint64_t i = first; i < count; ++i)
+        {
+            const span & s = b.m_spans[i % sm_buffer_size];
+            uint64_t ts = s.start > sm_start_time ? s.start - sm_start_time : 0;
+            fprintf
+            (
+                fp, "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, "
+                "\"tid\": %d, \"ts\": %llu, \"dur\": %llu}",
+                separator, s.name, t + 1,
+                (unsigned long long) ts, (unsigned long long) s.duration
+            );
+        }
+    }
+    fprintf(fp, "\n]}\n");
+    return fclose(fp) == 0;
+}
+
+/**
+ *  Starts a span, if tracing is enabled.
+ *
+ * \param name
+ *      The name of the span, a string literal such as "sequence::play".
+ */
+
+rt_trace_span::rt_trace_span (const char * name)
+ :
+    m_name  (nullptr),
+    m_start (0)
+{
+    if (rt_trace::enabled())
+    {
+        m_name = name;
+        m_start = rt_microseconds();
+    }
+}
+
+/**
+ *  Ends the span and records it.
+ */
+
+rt_trace_span::~rt_trace_span ()
+{
+    if (m_name != nullptr)
+        rt_trace::record(m_name, m_start, rt_microseconds());
+}
+
+}           // namespace seq64
+
+/*
+ * rt_trace.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
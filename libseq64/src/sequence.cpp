@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The functionality of this class also includes handling some of the
@@ -44,9 +44,11 @@
 #include <string.h>                     /* C::memset()                      */
 
 #include "calculations.hpp"
+#include "event_stream.hpp"             /* seq64::event_stream              */
 #include "mastermidibus.hpp"
 #include "perform.hpp"
 #include "scales.h"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 #include "settings.hpp"                 /* seq64::rc()                      */
 
@@ -111,6 +113,7 @@ sequence::sequence (int ppqn)
     m_notes_on                  (0),
     m_master_bus                (nullptr),
     m_playing_notes             (),             // an array
+    m_transposed_event          (),
     m_was_playing               (false),
     m_playing                   (false),
     m_recording                 (false),
@@ -134,6 +137,13 @@ sequence::sequence (int ppqn)
     m_dirty_edit                (true),
     m_dirty_perf                (true),
     m_dirty_names               (true),
+    m_edit_version              (0),
+    m_snapshot                  (),
+    m_event_loader              (),
+    m_events_pending            (false),
+    m_load_mutex                (),
+    m_stream                    (),
+    m_streaming                 (false),
     m_editing                   (false),
     m_raise                     (false),
     m_status                    (0),
@@ -215,7 +225,14 @@ sequence::partial_assign (const sequence & rhs)
 {
     if (this != &rhs)
     {
+        (void) const_cast<sequence &>(rhs).load_events();   /* not m_mutex */
+        automutex loadlocker(m_load_mutex);
+        m_event_loader = nullptr;           /* our own are being replaced   */
+        m_events_pending = false;
+        m_streaming = false;
+
         automutex locker(m_mutex);
+        m_stream.reset();
         m_parent        = rhs.m_parent;             /* a pointer, careful!  */
         m_events        = rhs.m_events;
         m_triggers      = rhs.m_triggers;
@@ -234,9 +251,153 @@ sequence::partial_assign (const sequence & rhs)
 
         zero_markers();                             /* reset to tick 0      */
         verify_and_link();
+        ++m_edit_version;
     }
 }
 
+/**
+ *  Copies what midi_container::fill() writes to a MIDI file:  the events,
+ *  the triggers, and the settings of the sequence.  The copy is detached
+ *  (it has no parent, buss, or links), and is meant only to be written out
+ *  by the song_saver thread.  The source is locked only while its members
+ *  are copied, which is much shorter than the encoding of the track.
+ *
+ * \threadsafe
+ *
+ * \param rhs
+ *      Provides the sequence to be copied.  Its events are decoded first,
+ *      if it was read with "-o lazy".
+ */
+
+void
+sequence::save_assign (const sequence & rhs)
+{
+    if (this != &rhs)
+    {
+        (void) const_cast<sequence &>(rhs).load_events();   /* not m_mutex */
+        automutex locker(rhs.m_mutex);
+        m_events                    = rhs.m_events;
+        m_triggers.m_triggers       = rhs.m_triggers.m_triggers;
+        m_midi_channel              = rhs.m_midi_channel;
+        m_transposable              = rhs.m_transposable;
+        m_bus                       = rhs.m_bus;
+        m_name                      = rhs.m_name;
+        m_ppqn                      = rhs.m_ppqn;
+        m_length                    = rhs.m_length;
+        m_seq_color                 = rhs.m_seq_color;
+        m_time_beats_per_measure    = rhs.m_time_beats_per_measure;
+        m_time_beat_width           = rhs.m_time_beat_width;
+        m_musical_key               = rhs.m_musical_key;
+        m_musical_scale             = rhs.m_musical_scale;
+        m_background_sequence       = rhs.m_background_sequence;
+    }
+}
+
+/**
+ *  Hands the decoding of the events to a loader, for a sequence read with
+ *  "-o lazy".  The sequence is added to the performance with its settings
+ *  and triggers, but with no events.  The events are decoded the first time
+ *  they are needed; see load_events().
+ *
+ * \param loader
+ *      The function that decodes the events into a scratch sequence.  It
+ *      holds whatever it needs, such as a copy of the track data.
+ */
+
+void
+sequence::defer_events (const event_loader & loader)
+{
+    automutex locker(m_load_mutex);
+    m_event_loader = loader;
+    m_events_pending = bool(loader);
+}
+
+/**
+ *  Has the events of a sequence read with "-o stream=kb" played from the
+ *  track data, until they are loaded.  Call it after defer_events().
+ *  Playing the sequence then no longer asks for the events to be loaded;
+ *  see set_playing() and play().
+ *
+ * \param stream
+ *      The stream made from the same track data as the loader.
+ */
+
+void
+sequence::stream_events (const std::shared_ptr<event_stream> & stream)
+{
+    automutex loadlocker(m_load_mutex);
+    automutex locker(m_mutex);
+    m_stream = m_events_pending ? stream : nullptr ;
+    m_streaming = bool(m_stream);
+}
+
+/**
+ *  Decodes the events deferred by defer_events(), if that has not been done
+ *  yet.  Called before the events are played, drawn, edited, copied, or
+ *  saved.  Once the events are loaded, this function costs one atomic load.
+ *
+ *  The events are decoded, sorted, and linked in a scratch sequence, without
+ *  holding m_mutex, so that playback and drawing are not held up.  Only the
+ *  exchange of the event lists is done under m_mutex.  Events added in the
+ *  meantime (say, by recording) are merged in, and are linked again.
+ *
+ *  Do not call this function while holding m_mutex, since the thread that
+ *  is loading the events needs it at the end.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns false if the events could not be decoded.  In that case the
+ *      sequence is left empty, and the loader is not tried again.
+ */
+
+bool
+sequence::load_events ()
+{
+    if (! m_events_pending)
+        return true;
+
+    automutex loadlocker(m_load_mutex);
+    if (! m_events_pending)                 /* another thread loaded them   */
+        return true;
+
+    sequence scratch(m_ppqn);
+    bool result = m_event_loader(scratch);
+    if (result)
+    {
+        midipulse len = get_length();
+        scratch.m_events.sort();
+        scratch.m_events.verify_and_link(len);
+
+        automutex locker(m_mutex);
+        bool relink = m_events.count() > 0;
+        if (relink)
+            scratch.m_events.merge(m_events);
+
+        m_events.swap(scratch.m_events);
+        if (relink || len != m_length)
+            m_events.verify_and_link(m_length);
+
+        m_iterator_draw = m_events.begin(); /* old one is in scratch now    */
+
+        ++m_edit_version;                   /* redraw, drop event iterators */
+        m_events_pending = false;
+        m_streaming = false;
+        m_stream.reset();
+        set_dirty_mp();
+    }
+    else
+    {
+        errprint("pattern events could not be decoded");
+        automutex locker(m_mutex);
+        m_events_pending = false;
+        m_streaming = false;
+        m_stream.reset();
+    }
+    m_event_loader = nullptr;               /* frees the track data         */
+    return result;
+}
+
 /**
  *  Modifies the undo-hold container.
  *
@@ -302,6 +463,7 @@ sequence::event_count () const
 void
 sequence::push_undo (bool hold)
 {
+    (void) load_events();                   /* an edit is coming            */
     automutex locker(m_mutex);
     if (hold)
         m_events_undo.push(m_events_undo_hold);     // stazed
@@ -332,6 +494,7 @@ sequence::pop_undo ()
     {
         m_events_redo.push(m_events);           // move to triggers module?
         m_events = m_events_undo.top();
+        ++m_edit_version;                       /* new container    */
         m_events_undo.pop();
         verify_and_link();
         unselect();
@@ -357,6 +520,7 @@ sequence::pop_redo ()
     {
         m_events_undo.push(m_events);
         m_events = m_events_redo.top();
+        ++m_edit_version;                       /* new container    */
         m_events_redo.pop();
         verify_and_link();
         unselect();
@@ -589,6 +753,7 @@ sequence::select_even_or_odd_notes (int note_len, bool even)
 {
     int result = 0;
     automutex locker(m_mutex);
+    ++m_edit_version;
     unselect();
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
@@ -672,6 +837,7 @@ sequence::select_note_events
 {
     int result = 0;
     automutex locker(m_mutex);
+    ++m_edit_version;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & e = DREF(i);
@@ -862,6 +1028,7 @@ sequence::select_event_handle
 )
 {
     int result = 0;
+    ++m_edit_version;
     bool have_selection = false;
     if (status == EVENT_NOTE_ON)                    // use a function!
     {
@@ -1013,6 +1180,7 @@ sequence::select_linked (midipulse tick_s, midipulse tick_f, midibyte status)
 {
     int result = 0;
     automutex locker(m_mutex);
+    ++m_edit_version;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & e = DREF(i);
@@ -1113,6 +1281,8 @@ sequence::toggle_queued ()
     m_off_from_snap = true;
 #endif
     set_dirty_mp();
+    if (not_nullptr(m_parent))
+        m_parent->post_change(CHANGE_MUTE, m_seq_number);
 }
 
 /**
@@ -1135,6 +1305,9 @@ sequence::toggle_queued ()
  *  function.  Its return value and side-effects tell if there's a change in
  *  playing based on triggers, and provides the ticks that bracket it.
  *
+ *  For a long track read with "-o stream=kb", the events that are not
+ *  loaded yet are played by play_stream(), straight from the track data.
+ *
  * \param tick
  *      Provides the current end-tick value.  The tick comes in as a global
  *      tick.
@@ -1162,6 +1335,7 @@ sequence::play
 #endif
 )
 {
+    rt_trace_span span("sequence::play");   /* includes the wait for lock   */
     automutex locker(m_mutex);
     bool trigger_turning_off = false;       /* turn off after in-frame play */
     midipulse start_tick = m_last_tick;     /* modified in triggers::play() */
@@ -1198,6 +1372,15 @@ sequence::play
         midipulse times_played = m_last_tick / m_length;
         midipulse offset_base = times_played * m_length;
         int transpose = get_transposable() ? m_parent->get_transpose() : 0 ;
+        if (m_stream)                       /* "-o stream", not loaded yet  */
+        {
+            play_stream
+            (
+                start_tick_offset - offset_base,
+                end_tick_offset - offset_base, transpose
+            );
+        }
+
         event_list::iterator e = m_events.begin();
         while (e != m_events.end())
         {
@@ -1207,9 +1390,9 @@ sequence::play
             {
                 if (transpose != 0 && er.is_note()) /* includes Aftertouch  */
                 {
-                    event transposed_event = er;    /* assign ALL members   */
-                    transposed_event.transpose_note(transpose);
-                    put_event_on_bus(transposed_event);
+                    m_transposed_event = er;        /* assign ALL members   */
+                    m_transposed_event.transpose_note(transpose);
+                    put_event_on_bus(m_transposed_event);
                 }
                 else
                 {
@@ -1286,7 +1469,9 @@ sequence::remove (event_list::iterator i)
     event & er = DREF(i);
     if (er.is_note_off() && m_playing_notes[er.get_note()] > 0)
     {
-        m_master_bus->play(m_bus, &er, m_midi_channel);
+        if (not_nullptr(m_master_bus))
+            m_master_bus->play(m_bus, &er, m_midi_channel);
+
         --m_playing_notes[er.get_note()];                   // ugh
     }
     m_events.remove(i);                                     // erase(i)
@@ -1338,6 +1523,7 @@ bool
 sequence::remove_marked ()
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
 
 #ifdef LAYK_PULL_REQUEST_95
 
@@ -1397,6 +1583,7 @@ void
 sequence::remove_selected ()
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
     if (m_events.mark_selected())
     {
         m_events_undo.push(m_events);           /* push_undo() without lock */
@@ -1666,6 +1853,7 @@ sequence::select_note_events
 {
     int result = 0;
     automutex locker(m_mutex);
+    ++m_edit_version;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & er = DREF(i);
@@ -1872,6 +2060,7 @@ sequence::select_events
 {
     int result = 0;
     automutex locker(m_mutex);
+    ++m_edit_version;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
         event & er = DREF(i);
@@ -1934,6 +2123,7 @@ void
 sequence::select_all ()
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
     m_events.select_all();
 }
 
@@ -1947,6 +2137,7 @@ void
 sequence::unselect ()
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
     m_events.unselect_all();
 }
 
@@ -3305,6 +3496,63 @@ sequence::append_event (const event & er)
     return m_events.append(er);     /* does *not* sort, too time-consuming */
 }
 
+/**
+ *  Exchanges the whole event list of the sequence with the given list, under
+ *  one lock, and with one dirty notification.  Meant for filling a new
+ *  sequence in bulk, instead of calling add_event() for each event.  The
+ *  events are not sorted or linked here; see set_length().
+ *
+ * \threadsafe
+ *
+ * \param evl
+ *      Provides the new events, already in time order.  On return, it holds
+ *      the old events of the sequence, normally none.
+ */
+
+void
+sequence::swap_events (event_list & evl)
+{
+    automutex locker(m_mutex);
+    m_events.swap(evl);
+    reset_draw_marker();
+    set_dirty();
+}
+
+/**
+ *  Stores a batch of events collected by a sequence_builder, under one lock
+ *  and with one dirty notification.  If the sequence is empty, as it is
+ *  when a file is imported, the two lists are simply exchanged.  Otherwise
+ *  the new events are merged into the existing ones.  Either way, no event
+ *  is copied.
+ *
+ * \threadsafe
+ *
+ * \param events
+ *      Provides the events, already sorted by sequence_builder::commit().
+ *      On return, it holds the old events of the sequence, if it was empty,
+ *      or nothing.
+ *
+ * \param link
+ *      If true, verify_and_link() is called for the new events.  The
+ *      importers leave that to the final set_length() call.
+ */
+
+void
+sequence::commit_events (event_list & events, bool link)
+{
+    automutex locker(m_mutex);
+    if (m_events.count() == 0)
+        m_events.swap(events);              /* takes the flags along, too   */
+    else
+        m_events.merge(events, false);      /* already sorted               */
+
+    if (link)
+        verify_and_link();
+
+    reset_draw_marker();
+    set_dirty();
+}
+
 /**
  *  Adds a event of a given status value and data values, at a given tick
  *  location.
@@ -3439,6 +3687,7 @@ sequence::check_loop_reset ()
 bool
 sequence::stream_event (event & ev)
 {
+    rt_trace_span span("sequence::stream_event");
     automutex locker(m_mutex);
     bool result = channels_match(ev);           /* set if channel matches   */
     if (result)
@@ -3535,6 +3784,9 @@ sequence::stream_event (event & ev)
  *  false in is_dirty_main(); m_dirty_names is set to false in
  *  is_dirty_perf().
  *
+ *  Also bumps m_edit_version, which is never reset, for views that cache
+ *  drawings of the sequence, and posts the change to the user interface.
+ *
  * \threadunsafe
  */
 
@@ -3542,6 +3794,9 @@ void
 sequence::set_dirty_mp ()
 {
     m_dirty_names = m_dirty_main = m_dirty_perf = true;
+    ++m_edit_version;
+    if (not_nullptr(m_parent))
+        m_parent->post_change(CHANGE_SEQUENCE, m_seq_number);
 }
 
 /**
@@ -3654,8 +3909,11 @@ sequence::play_note_on (int note)
     event e;
     e.set_status(EVENT_NOTE_ON);
     e.set_data(note, midibyte(m_note_on_velocity));      // SEQ64_MIDI_COUNT_MAX-1
-    m_master_bus->play(m_bus, &e, m_midi_channel);
-    m_master_bus->flush();
+    if (not_nullptr(m_master_bus))
+    {
+        m_master_bus->play(m_bus, &e, m_midi_channel);
+        m_master_bus->flush();
+    }
 }
 
 /**
@@ -3676,8 +3934,11 @@ sequence::play_note_off (int note)
     event e;
     e.set_status(EVENT_NOTE_OFF);
     e.set_data(note, midibyte(m_note_off_velocity));
-    m_master_bus->play(m_bus, &e, m_midi_channel);
-    m_master_bus->flush();
+    if (not_nullptr(m_master_bus))
+    {
+        m_master_bus->play(m_bus, &e, m_midi_channel);
+        m_master_bus->flush();
+    }
 }
 
 /**
@@ -4369,7 +4630,12 @@ sequence::pause (bool song_mode)
  *
  * \warning
  *      This iterator is shared by about four GUI object, and they might
- *      interfere with each other!
+ *      interfere with each other!  Drawing code should use snapshot()
+ *      instead.
+ *
+ *  This function does not call load_events(), since nearly all of its
+ *  callers hold m_mutex; load_events() resets the marker itself once the
+ *  events are decoded.
  *
  * \threadsafe
  */
@@ -4411,6 +4677,65 @@ sequence::reset_draw_trigger_marker ()
     m_triggers.reset_draw_trigger_marker();
 }
 
+/**
+ *  Gets the render snapshot of the current version of the notes.  If the
+ *  latest snapshot is current, it is returned without taking the mutex.
+ *  Otherwise a new one is built under the mutex, with one pass over the
+ *  events, and published for the other views.  So the mutex is taken once
+ *  per change of the sequence, not once per event drawn by each view.
+ *
+ *  The version is read again under the mutex, since an edit can happen
+ *  between the check and the lock.  Another view might have built the
+ *  snapshot in the meantime, so that is checked, too.
+ *
+ *  If the events of a sequence loaded with "-o lazy" have not been decoded
+ *  yet, they are decoded first.  That is only the filling of a cache, so
+ *  this function is still const.  A sequence read with "-o stream=kb" is
+ *  not decoded just to be drawn, since that would undo the streaming of
+ *  every track in view.  Until its events are loaded for some other reason,
+ *  such as editing, it is drawn from an empty snapshot, as an empty
+ *  pattern.  load_events() bumps the edit version, so the notes appear
+ *  once the events are loaded.
+ *
+ * \threadsafe
+ *
+ * \return
+ *      Returns a shared pointer to a snapshot that is never modified, and
+ *      that stays valid for as long as the caller keeps the pointer.
+ */
+
+render_snapshot::pointer
+sequence::snapshot () const
+{
+    if (m_events_pending && ! m_streaming)  /* drawn before first decoded   */
+        (void) const_cast<sequence *>(this)->load_events();
+
+    render_snapshot::pointer result = std::atomic_load(&m_snapshot);
+    if
+    (
+        ! result || result->version() != edit_version() ||
+        result->length() != get_length()
+    )
+    {
+        automutex locker(m_mutex);
+        unsigned long version = edit_version();
+        result = std::atomic_load(&m_snapshot);
+        if
+        (
+            ! result || result->version() != version ||
+            result->length() != m_length
+        )
+        {
+            result = std::make_shared<const render_snapshot>
+            (
+                m_events, m_length, version
+            );
+            std::atomic_store(&m_snapshot, result);
+        }
+    }
+    return result;
+}
+
 /**
  *  A new function provided so that we can find the minimum and maximum notes
  *  with only one (not two) traversal of the event list.
@@ -4769,6 +5094,7 @@ void
 sequence::remove_all ()
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
     m_events.clear();
     m_events.unmodify();
 }
@@ -4997,6 +5323,8 @@ sequence::set_playing (bool p)
         m_playing = p;
         if (! p)
             off_playing_notes();
+        else if (m_events_pending && ! m_streaming && not_nullptr(m_parent))
+            m_parent->request_events(m_seq_number);     /* does not block   */
 
 #ifdef PLATFORM_DEBUG_TMI
         if (p)
@@ -5011,6 +5339,8 @@ sequence::set_playing (bool p)
 #ifdef SEQ64_SONG_RECORDING
     m_one_shot = false;
 #endif
+    if (not_nullptr(m_parent))
+        m_parent->post_change(CHANGE_MUTE, m_seq_number);
 }
 
 /**
@@ -5300,8 +5630,9 @@ sequence::print_triggers () const
 
 /**
  *  Takes an event that this sequence is holding, and places it on the MIDI
- *  buss.  This function does not bother checking if m_master_bus is a null
- *  pointer.
+ *  buss.  If m_master_bus is null, as it is for a perform object that has
+ *  not been launched (e.g. in the seq64bench program), the event is
+ *  still counted in m_playing_notes but is not sent anywhere.
  *
  * \param ev
  *      The event to put on the buss.
@@ -5325,7 +5656,7 @@ sequence::put_event_on_bus (event & ev)
         else
             m_playing_notes[note]--;
     }
-    if (! skip)
+    if (! skip && not_nullptr(m_master_bus))
     {
         /*
          * \change ca 2016-03-19
@@ -5339,8 +5670,77 @@ sequence::put_event_on_bus (event & ev)
 }
 
 /**
- *  Sends a note-off event for all active notes.  This function does not
- *  bother checking if m_master_bus is a null pointer.
+ *  The play() loop for a sequence read with "-o stream=kb" whose events are
+ *  not loaded.  The events of the frame are taken from m_stream, which
+ *  decodes them from the track data just ahead of the playhead.  As in the
+ *  event-list loop, the frame is checked against the pattern once per
+ *  pass, and can wrap around the end of the pattern.  Since each frame
+ *  starts where the last one ended, the seek usually costs nothing.
+ *
+ *  The first pass is usually a whole pattern past the events, since play()
+ *  adds the trigger offset.  That pass is skipped.  Seeking past the last
+ *  event and back again would make the stream decode from an index mark
+ *  twice in every frame, which made streamed playback slower than the
+ *  event list for short tracks.
+ *
+ * \threadunsafe
+ *      Called by play(), which holds m_mutex.
+ *
+ * \param start_tick
+ *      The first tick of the frame, relative to the pattern, as in play().
+ *
+ * \param end_tick
+ *      The last tick of the frame, relative to the pattern.
+ *
+ * \param transpose
+ *      The transposition to apply to the notes, or 0.
+ */
+
+void
+sequence::play_stream (midipulse start_tick, midipulse end_tick, int transpose)
+{
+    if (m_length <= 0 || m_stream->count() == 0)
+        return;
+
+    event ev;
+    midipulse last = m_stream->last_tick();
+    while (end_tick >= 0)                           /* once per pass        */
+    {
+        if (start_tick > last)                      /* nothing in this pass */
+        {
+            start_tick -= m_length;
+            end_tick -= m_length;
+            continue;
+        }
+        m_stream->seek(start_tick > 0 ? start_tick : 0);
+
+        const event_stream::message * m;
+        while (not_nullptr(m = m_stream->next(end_tick)))
+        {
+            if (m->m_status == EVENT_MIDI_META)     /* Set Tempo only       */
+            {
+                if (not_nullptr(m_parent))
+                    m_parent->set_beats_per_minute(m->m_bpm);
+            }
+            else
+            {
+                ev.set_timestamp(m->m_tick);
+                ev.set_status(m->m_status);
+                ev.set_data(m->m_d0, m->m_d1);
+                if (transpose != 0 && ev.is_note())
+                    ev.transpose_note(transpose);
+
+                put_event_on_bus(ev);
+            }
+        }
+        start_tick -= m_length;                     /* for another go at it */
+        end_tick -= m_length;
+    }
+}
+
+/**
+ *  Sends a note-off event for all active notes.  If there is no master
+ *  buss, the playing-note counts are simply cleared.
  *
  * \threadsafe
  */
@@ -5356,12 +5756,15 @@ sequence::off_playing_notes ()
         {
             e.set_status(EVENT_NOTE_OFF);
             e.set_data(x, midibyte(127));               /* or is 0 better?  */
-            m_master_bus->play(m_bus, &e, m_midi_channel);
+            if (not_nullptr(m_master_bus))
+                m_master_bus->play(m_bus, &e, m_midi_channel);
+
             if (m_playing_notes[x] > 0)
                 m_playing_notes[x]--;
         }
     }
-    m_master_bus->flush();
+    if (not_nullptr(m_master_bus))
+        m_master_bus->flush();
 }
 
 /**
@@ -5395,6 +5798,7 @@ sequence::select_events
 )
 {
     automutex locker(m_mutex);
+    ++m_edit_version;
     midibyte d0, d1;
     for (event_list::iterator i = m_events.begin(); i != m_events.end(); ++i)
     {
@@ -5855,6 +6259,89 @@ sequence::copy_events (const event_list & newevents)
     modify();
 }
 
+/**
+ *  Removes one event, given by its position in the event container, as
+ *  obtained by a caller walking the container (e.g. the event editor's
+ *  index).  Unlike copy_events(), this touches only the one event, so it
+ *  stays cheap for very long patterns.  The note links are rebuilt, since
+ *  the event might have been linked to another.
+ *
+ *  The position is only good as long as the container has not changed
+ *  since it was obtained, so the caller also passes the edit_version() of
+ *  that moment.  If the pattern was edited in the meantime (say, by
+ *  recording or an undo), nothing is removed.
+ *
+ * \threadsafe
+ *
+ * \param ei
+ *      The position of the event to remove.
+ *
+ * \param version
+ *      The edit_version() at the time \a ei was obtained.
+ *
+ * \return
+ *      Returns true if the event was removed.
+ */
+
+bool
+sequence::remove_event (event_list::const_iterator ei, unsigned long version)
+{
+    automutex locker(m_mutex);
+    bool result = version == edit_version();
+    if (result)
+    {
+        remove(m_events.unconst(ei));
+        verify_and_link();
+        reset_draw_marker();
+        set_dirty();
+    }
+    return result;
+}
+
+/**
+ *  Replaces one event, given by its position in the event container, with
+ *  a new event, which is sorted into place near the old one.  Both steps
+ *  are done under one lock, so the output thread never sees the pattern
+ *  without the event, and the notes are linked only once.
+ *
+ * \threadsafe
+ *
+ * \param ei
+ *      The position of the event to replace.
+ *
+ * \param version
+ *      The edit_version() at the time \a ei was obtained.  See
+ *      remove_event().
+ *
+ * \param e
+ *      The new event, which is copied.
+ *
+ * \return
+ *      Returns true if the old event was replaced by the new one.
+ */
+
+bool
+sequence::replace_event
+(
+    event_list::const_iterator ei, unsigned long version, const event & e
+)
+{
+    automutex locker(m_mutex);
+    bool result = version == edit_version();
+    if (result)
+    {
+        event_list::iterator i = m_events.unconst(ei);
+        event_list::iterator next = i;
+        ++next;
+        remove(i);
+        (void) m_events.insert_near(next, e);
+        verify_and_link();
+        reset_draw_marker();
+        set_dirty();
+    }
+    return result;
+}
+
 /**
  * \setter m_parent
  *      Sets the "parent" of this sequence, so that it can get some extra
@@ -5986,6 +6473,8 @@ sequence::toggle_one_shot ()
     m_one_shot = ! m_one_shot;
     m_one_shot_tick = m_last_tick - mod_last_tick() + m_length;
     m_off_from_snap = true;
+    if (not_nullptr(m_parent))
+        m_parent->post_change(CHANGE_MUTE, m_seq_number);
 }
 
 /**
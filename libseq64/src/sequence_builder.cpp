@@ -0,0 +1,98 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          sequence_builder.cpp
+ *
+ *  This module defines the class for filling a sequence in bulk.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the sequence_builder.hpp module for the overview.
+ */
+
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "sequence_builder.hpp"         /* seq64::sequence_builder          */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Default constructor.
+ */
+
+sequence_builder::sequence_builder ()
+ :
+    m_events    ()
+{
+    // Empty body
+}
+
+/**
+ *  Sorts the collected events, hands them to the sequence, and empties the
+ *  builder for the next sequence.
+ *
+ *  The events are appended and sorted by the same event_list functions
+ *  that sequence::append_event() and sequence::sort_events() use, so events
+ *  with the same time and rank end up in the same order as before.
+ *
+ * \param seq
+ *      The sequence to receive the events.
+ *
+ * \param link
+ *      If true, the Note On and Note Off events are linked as well.  The
+ *      importers leave that to midifile::link_sequence(), which must first
+ *      pad the sequence to its final length.
+ */
+
+void
+sequence_builder::commit (sequence & seq, bool link)
+{
+    m_events.sort();                        /* relinks nodes, no copies */
+    seq.commit_events(m_events, link);
+    clear();
+}
+
+/**
+ *  Drops the collected events, if any are left, and the tempo and time
+ *  signature flags that came with them.
+ */
+
+void
+sequence_builder::clear ()
+{
+    event_list empty;
+    m_events.swap(empty);
+}
+
+}           // namespace seq64
+
+/*
+ * sequence_builder.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
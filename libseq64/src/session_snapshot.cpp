@@ -0,0 +1,808 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          session_snapshot.cpp
+ *
+ *  This module defines the binary snapshot of the performance as loaded
+ *  from a MIDI file.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the session_snapshot.hpp module for the overview.  The layout of
+ *  the file, all in the byte order of the machine, is:
+ *
+ *      -   The header:  the magic string, the version, a byte-order mark,
+ *          the content hash, and the PPQN of the patterns.
+ *      -   The song settings:  tempo, time signature, screen-set notepads,
+ *          and, if the MIDI file had them, the mute groups, the global
+ *          key, scale, and background sequence, and the tempo track.
+ *      -   The number of patterns, then each pattern:  its slot, settings,
+ *          name, triggers, and events.  Each event is one fixed-size
+ *          event_record, followed by its SysEx or Meta data, if any.
+ *
+ *  The snapshot is written to a temporary file that is then renamed, so a
+ *  crash while writing never leaves a truncated snapshot behind.  In any
+ *  case, every read is bounds-checked, and a snapshot that does not read
+ *  cleanly is ignored.
+ */
+
+#include <fstream>                      /* std::ifstream                    */
+#include <stdio.h>                      /* fopen(), rename(), etc.          */
+#include <string.h>                     /* memcpy(), memcmp()               */
+#include <unordered_map>                /* std::unordered_map               */
+#include <vector>                       /* std::vector                      */
+
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "platform_macros.h"            /* PLATFORM_WINDOWS                 */
+#include "session_snapshot.hpp"         /* seq64::session_snapshot          */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "settings.hpp"                 /* seq64::rc() and usr()            */
+
+#ifndef PLATFORM_WINDOWS
+#include <fcntl.h>                      /* open()                           */
+#include <sys/mman.h>                   /* mmap(), munmap()                 */
+#include <sys/stat.h>                   /* fstat()                          */
+#include <unistd.h>                     /* close()                          */
+#endif
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The first eight bytes of every snapshot.
+ */
+
+static const char s_magic[8] = { 'S', 'E', 'Q', '6', '4', 'S', 'N', 'P' };
+
+/**
+ *  Written as a 32-bit value, so that a snapshot from a machine with the
+ *  other byte order is recognized and ignored.
+ */
+
+static const unsigned s_byte_order = 0x01020304;
+
+/**
+ *  The on-disk form of one event.  The fields are ordered so that the
+ *  structure has no padding, and it is copied in and out with memcpy(), so
+ *  the mapping needs no particular alignment.
+ */
+
+struct event_record
+{
+    long long timestamp;                /**< The time-stamp in pulses.      */
+    int link;                           /**< Index of linked event, or -1.  */
+    unsigned exlength;                  /**< Bytes of SysEx/Meta data.      */
+    midibyte status;                    /**< The status without channel.    */
+    midibyte channel;                   /**< The channel, or the Meta type. */
+    midibyte d0;                        /**< The first data byte.           */
+    midibyte d1;                        /**< The second data byte.          */
+    midibyte selected;                  /**< Non-zero if selected.          */
+    midibyte padding[3];                /**< Zeroes.                        */
+};
+
+/**
+ *  The starting value of a 64-bit FNV-1a hash.
+ */
+
+static const unsigned long long s_fnv_basis = 14695981039346656037ULL;
+
+/**
+ *  Adds the 64-bit FNV-1a hash of a block of bytes to a running hash.
+ *
+ * \param hash
+ *      The running hash, started at s_fnv_basis.
+ *
+ * \param data
+ *      The bytes to hash.
+ *
+ * \param size
+ *      The number of bytes.
+ *
+ * \return
+ *      Returns the new running hash.
+ */
+
+static unsigned long long
+s_fnv_hash (unsigned long long hash, const void * data, size_t size)
+{
+    const unsigned char * bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ *  Appends bytes to the snapshot being written.
+ */
+
+static void
+s_put (std::vector<char> & buf, const void * data, size_t size)
+{
+    const char * bytes = static_cast<const char *>(data);
+    buf.insert(buf.end(), bytes, bytes + size);
+}
+
+/**
+ *  Appends a 32-bit integer to the snapshot being written.
+ */
+
+static void
+s_put_int (std::vector<char> & buf, int value)
+{
+    s_put(buf, &value, sizeof value);
+}
+
+/**
+ *  Appends a 64-bit integer to the snapshot being written.
+ */
+
+static void
+s_put_long (std::vector<char> & buf, long long value)
+{
+    s_put(buf, &value, sizeof value);
+}
+
+/**
+ *  Appends a length-prefixed string to the snapshot being written.
+ */
+
+static void
+s_put_string (std::vector<char> & buf, const std::string & s)
+{
+    s_put_int(buf, int(s.size()));
+    s_put(buf, s.data(), s.size());
+}
+
+/**
+ *  A read position in a mapped snapshot.  Once a read runs off the end,
+ *  ok is false, and every later read returns zeroes.
+ */
+
+struct snapshot_cursor
+{
+    const char * pos;                   /**< The next byte to read.         */
+    const char * end;                   /**< One past the last byte.        */
+    bool ok;                            /**< False after any overrun.       */
+};
+
+/**
+ *  Copies bytes out of the snapshot, or zeroes if they are not there.
+ */
+
+static bool
+s_get (snapshot_cursor & c, void * data, size_t size)
+{
+    if (c.ok && size_t(c.end - c.pos) >= size)
+    {
+        memcpy(data, c.pos, size);
+        c.pos += size;
+    }
+    else
+    {
+        c.ok = false;
+        memset(data, 0, size);
+    }
+    return c.ok;
+}
+
+/**
+ *  Reads a 32-bit integer from the snapshot.
+ */
+
+static int
+s_get_int (snapshot_cursor & c)
+{
+    int value;
+    (void) s_get(c, &value, sizeof value);
+    return value;
+}
+
+/**
+ *  Reads a 64-bit integer from the snapshot.
+ */
+
+static long long
+s_get_long (snapshot_cursor & c)
+{
+    long long value;
+    (void) s_get(c, &value, sizeof value);
+    return value;
+}
+
+/**
+ *  Reads a length-prefixed string from the snapshot.
+ */
+
+static std::string
+s_get_string (snapshot_cursor & c)
+{
+    std::string result;
+    int len = s_get_int(c);
+    if (c.ok && len >= 0 && len <= int(c.end - c.pos))
+    {
+        result.assign(c.pos, size_t(len));
+        c.pos += len;
+    }
+    else
+        c.ok = false;
+
+    return result;
+}
+
+/**
+ *  Principal constructor.  Hashes the MIDI file, and works out the name of
+ *  its snapshot, which is derived from the path of the MIDI file, so that
+ *  each file has one snapshot, replaced whenever the file changes.
+ *
+ * \param midifilename
+ *      The full path to the MIDI file.
+ *
+ * \param ppqn
+ *      The PPQN asked for when opening the file.  The patterns are scaled
+ *      to it, so a snapshot made with another PPQN does not match.
+ */
+
+session_snapshot::session_snapshot (const std::string & midifilename, int ppqn)
+ :
+    m_name          (),
+    m_hash          (0),
+    m_error_message ()
+{
+    unsigned long long namehash = s_fnv_hash
+    (
+        s_fnv_basis, midifilename.data(), midifilename.size()
+    );
+    char tmp[32];
+    snprintf(tmp, sizeof tmp, "%016llx", namehash);
+    m_name = rc().home_config_directory() + "session-" + tmp + ".snapshot";
+
+    std::ifstream file(midifilename.c_str(), std::ios::in | std::ios::binary);
+    if (file.is_open())
+    {
+        int version = SEQ64_SNAPSHOT_VERSION;
+        int buss = int(usr().midi_buss_override());
+        unsigned long long hash = s_fnv_basis;
+        hash = s_fnv_hash(hash, &version, sizeof version);
+        hash = s_fnv_hash(hash, &ppqn, sizeof ppqn);
+        hash = s_fnv_hash(hash, &buss, sizeof buss);
+
+        std::vector<char> chunk(65536);
+        while (file)
+        {
+            file.read(&chunk[0], std::streamsize(chunk.size()));
+            hash = s_fnv_hash(hash, &chunk[0], size_t(file.gcount()));
+        }
+        m_hash = hash != 0 ? hash : 1 ;     /* zero means "no hash"     */
+    }
+}
+
+/**
+ *  Rebuilds the performance from the snapshot, if the snapshot matches the
+ *  MIDI file.  The snapshot is memory-mapped where the platform allows it,
+ *  and read into memory otherwise.  The caller should clear the performance
+ *  first, and again if this function fails, since a snapshot that turns out
+ *  to be damaged part way through can leave some patterns behind.
+ *
+ * \param p
+ *      The performance to fill.
+ *
+ * \param [out] fileppqn
+ *      Set to the PPQN of the patterns, as midifile::ppqn() would be after
+ *      parsing the MIDI file.
+ *
+ * \return
+ *      Returns true if the performance was rebuilt from the snapshot.
+ */
+
+bool
+session_snapshot::read (perform & p, int & fileppqn)
+{
+    bool result = false;
+    m_error_message.clear();
+    if (m_hash == 0)
+    {
+        m_error_message = "MIDI file not readable";
+        return false;
+    }
+
+#ifndef PLATFORM_WINDOWS
+    int fd = open(m_name.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            size_t size = size_t(st.st_size);
+            void * map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                const char * data = static_cast<const char *>(map);
+                result = load(p, data, size, fileppqn);
+                (void) munmap(map, size);
+            }
+            else
+                m_error_message = "cannot map snapshot";
+        }
+        (void) close(fd);
+    }
+    else
+        m_error_message = "no snapshot";
+#else
+    std::ifstream file(m_name.c_str(), std::ios::in | std::ios::binary);
+    if (file.is_open())
+    {
+        std::vector<char> data
+        (
+            (std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>()
+        );
+        if (! data.empty())
+            result = load(p, &data[0], data.size(), fileppqn);
+    }
+    else
+        m_error_message = "no snapshot";
+#endif
+
+    return result;
+}
+
+/**
+ *  Does the work of read() on the bytes of the snapshot.  The header is
+ *  checked before anything is added to the performance.  Each pattern is
+ *  rebuilt completely before it is added.  The events go into the event
+ *  list in their stored order, and are linked by index, so no sort or link
+ *  pass is made.
+ *
+ * \param p
+ *      The performance to fill.
+ *
+ * \param data
+ *      The bytes of the snapshot.
+ *
+ * \param size
+ *      The number of bytes.
+ *
+ * \param [out] fileppqn
+ *      Set to the PPQN of the patterns.
+ *
+ * \return
+ *      Returns true if the whole snapshot was read.
+ */
+
+bool
+session_snapshot::load
+(
+    perform & p, const char * data, size_t size, int & fileppqn
+)
+{
+    snapshot_cursor c;
+    c.pos = data;
+    c.end = data + size;
+    c.ok = true;
+
+    char magic[sizeof s_magic];
+    (void) s_get(c, magic, sizeof magic);
+    int version = s_get_int(c);
+    unsigned order = unsigned(s_get_int(c));
+    unsigned long long hash = (unsigned long long)(s_get_long(c));
+    if
+    (
+        ! c.ok || memcmp(magic, s_magic, sizeof magic) != 0 ||
+        version != SEQ64_SNAPSHOT_VERSION || order != s_byte_order
+    )
+    {
+        m_error_message = "snapshot format not supported";
+        return false;
+    }
+    if (hash != m_hash)
+    {
+        m_error_message = "snapshot is stale";
+        return false;
+    }
+
+    int ppqn = s_get_int(c);
+    unsigned items = unsigned(s_get_int(c));
+    midibpm bpm;
+    (void) s_get(c, &bpm, sizeof bpm);
+
+    long upqn = long(s_get_long(c));
+    int beats = s_get_int(c);
+    int width = s_get_int(c);
+    int clocks = s_get_int(c);
+    int thirtyseconds = s_get_int(c);
+    int notepads = s_get_int(c);
+    std::vector<std::string> notes;
+    for (int s = 0; c.ok && s < notepads; ++s)
+        notes.push_back(s_get_string(c));
+
+    bool mutes[c_max_groups][c_seqs_in_set];
+    bool mutepresent = false;
+    if (items & ITEM_MUTE_GROUPS)
+    {
+        for (int g = 0; g < c_max_groups; ++g)
+        {
+            for (int k = 0; k < c_seqs_in_set; ++k)
+            {
+                midibyte m = 0;
+                (void) s_get(c, &m, sizeof m);
+                mutes[g][k] = m != 0;
+                if (mutes[g][k])
+                    mutepresent = true;
+            }
+        }
+    }
+
+    int key = 0, scale = 0, bgsequence = 0;
+    if (items & ITEM_GLOBAL_BGS)
+    {
+        key = s_get_int(c);
+        scale = s_get_int(c);
+        bgsequence = s_get_int(c);
+    }
+
+    int tempotrack = 0;
+    if (items & ITEM_TEMPO_TRACK)
+        tempotrack = s_get_int(c);
+
+    int seqcount = s_get_int(c);
+    if (! c.ok || ppqn <= 0 || seqcount < 0 || seqcount > c_max_sequence)
+    {
+        m_error_message = "snapshot header damaged";
+        return false;
+    }
+
+    std::vector<event *> stored;
+    for (int n = 0; n < seqcount; ++n)
+    {
+        int slot = s_get_int(c);
+        midipulse length = midipulse(s_get_long(c));
+        int buss = s_get_int(c);
+        int channel = s_get_int(c);
+        int transposable = s_get_int(c);
+        int seqkey = s_get_int(c);
+        int seqscale = s_get_int(c);
+        int seqbg = s_get_int(c);
+        int color = s_get_int(c);
+        int seqbeats = s_get_int(c);
+        int seqwidth = s_get_int(c);
+        int seqclocks = s_get_int(c);
+        int seq32nds = s_get_int(c);
+        long sequpqn = long(s_get_long(c));
+        std::string name = s_get_string(c);
+        int triggercount = s_get_int(c);
+        if (! c.ok || triggercount < 0)
+            break;
+
+        sequence * s = new sequence(ppqn);
+        sequence & seq = *s;
+        seq.set_master_midi_bus(p.master_bus_pointer());
+        seq.set_name(name);
+        seq.set_midi_bus(char(buss));
+        seq.set_midi_channel(midibyte(channel));
+        seq.set_transposable(transposable != 0);
+        seq.musical_key(seqkey);
+        seq.musical_scale(seqscale);
+        seq.background_sequence(seqbg);
+        seq.color(color);
+        seq.set_beats_per_bar(seqbeats);
+        seq.set_beat_width(seqwidth);
+        seq.clocks_per_metronome(seqclocks);
+        seq.set_32nds_per_quarter(seq32nds);
+        seq.us_per_quarter_note(sequpqn);
+        seq.set_length(length, false, false);       /* nothing to link yet  */
+        for (int t = 0; c.ok && t < triggercount; ++t)
+        {
+            midipulse on = midipulse(s_get_long(c));
+            midipulse off = midipulse(s_get_long(c));
+            midipulse offset = midipulse(s_get_long(c));
+            if (c.ok)
+                seq.add_trigger(on, off - on + 1, offset, false);
+        }
+
+        int eventcount = s_get_int(c);
+        if (! c.ok || eventcount < 0)
+        {
+            delete s;
+            c.ok = false;
+            break;
+        }
+
+        event_list & evl = seq.events();
+        stored.assign(size_t(eventcount), nullptr);
+        std::vector<int> links(size_t(eventcount), -1);
+        for (int i = 0; i < eventcount; ++i)
+        {
+            event_record r;
+            if (! s_get(c, &r, sizeof r) || r.exlength > size_t(c.end - c.pos))
+            {
+                c.ok = false;
+                break;
+            }
+
+            event e;
+            e.set_timestamp(midipulse(r.timestamp));
+            e.set_status(r.status, r.channel);
+            e.set_data(r.d0, r.d1);
+            if (r.exlength > 0)
+            {
+                const midibyte * ex = reinterpret_cast<const midibyte *>(c.pos);
+                e.get_sysex().assign(ex, ex + r.exlength);
+                c.pos += r.exlength;
+            }
+            if (r.selected != 0)
+                e.select();
+
+            stored[i] = &evl.append_sorted(e);
+            links[i] = r.link;
+        }
+        if (! c.ok)
+        {
+            delete s;
+            break;
+        }
+        for (int i = 0; i < eventcount; ++i)
+        {
+            int j = links[i];
+            if (j >= 0 && j < eventcount)
+                stored[i]->link(stored[j]);
+        }
+        p.add_sequence(s, slot);
+    }
+    if (! c.ok)
+    {
+        m_error_message = "snapshot damaged";
+        return false;
+    }
+
+    /*
+     * The song settings go in last, in the order the parser sets them.
+     */
+
+    p.set_beats_per_minute(bpm);
+    p.us_per_quarter_note(upqn);
+    p.set_beats_per_bar(beats);
+    p.set_beat_width(width);
+    p.clocks_per_metronome(clocks);
+    p.set_32nds_per_quarter(thirtyseconds);
+    for (int s = 0; s < int(notes.size()); ++s)
+        p.set_screenset_notepad(s, notes[s], true);     /* load time    */
+
+    if (items & ITEM_MUTE_GROUPS)
+    {
+        for (int g = 0; g < c_max_groups; ++g)
+        {
+            p.select_group_mute(g);
+            for (int k = 0; k < c_seqs_in_set; ++k)
+                p.set_group_mute_state(k, mutes[g][k]);
+        }
+        if (mutepresent)
+            p.midi_mute_group_present(true);
+    }
+    if (items & ITEM_GLOBAL_BGS)
+    {
+        usr().seqedit_key(key);
+        usr().seqedit_scale(scale);
+        usr().seqedit_bgsequence(bgsequence);
+    }
+    if (items & ITEM_TEMPO_TRACK)
+        p.set_tempo_track_number(tempotrack);
+
+    fileppqn = ppqn;
+    return true;
+}
+
+/**
+ *  Writes the snapshot of the performance just loaded from the MIDI file.
+ *  Call it right after parsing, before anything is edited.  If any pattern
+ *  still has its events pending, as with "-o lazy", nothing is written,
+ *  since that would decode every pattern here.
+ *
+ * \param p
+ *      The performance to save.
+ *
+ * \param fileppqn
+ *      The PPQN of the patterns, midifile::ppqn().
+ *
+ * \param items
+ *      The item_t values for the optional song settings that the MIDI file
+ *      provided.
+ *
+ * \return
+ *      Returns true if the snapshot was written.  Returns false, with no
+ *      error message, if the patterns are not all decoded.
+ */
+
+bool
+session_snapshot::write (perform & p, int fileppqn, unsigned items)
+{
+    m_error_message.clear();
+    if (m_hash == 0)
+    {
+        m_error_message = "MIDI file not readable";
+        return false;
+    }
+
+    std::vector<char> buf;
+    s_put(buf, s_magic, sizeof s_magic);
+    s_put_int(buf, SEQ64_SNAPSHOT_VERSION);
+    s_put_int(buf, int(s_byte_order));
+    s_put_long(buf, (long long)(m_hash));
+    s_put_int(buf, fileppqn);
+    s_put_int(buf, int(items));
+
+    midibpm bpm = p.get_beats_per_minute();
+    s_put(buf, &bpm, sizeof bpm);
+    s_put_long(buf, p.us_per_quarter_note());
+    s_put_int(buf, p.get_beats_per_bar());
+    s_put_int(buf, p.get_beat_width());
+    s_put_int(buf, p.clocks_per_metronome());
+    s_put_int(buf, p.get_32nds_per_quarter());
+    s_put_int(buf, c_max_sets);
+    for (int s = 0; s < c_max_sets; ++s)
+        s_put_string(buf, p.get_screenset_notepad(s));
+
+    if (items & ITEM_MUTE_GROUPS)
+    {
+        for (int g = 0; g < c_max_groups; ++g)
+        {
+            p.select_group_mute(g);
+            for (int k = 0; k < c_seqs_in_set; ++k)
+            {
+                midibyte m = p.get_group_mute_state(k) ? 1 : 0 ;
+                s_put(buf, &m, sizeof m);
+            }
+        }
+    }
+    if (items & ITEM_GLOBAL_BGS)
+    {
+        s_put_int(buf, usr().seqedit_key());
+        s_put_int(buf, usr().seqedit_scale());
+        s_put_int(buf, usr().seqedit_bgsequence());
+    }
+    if (items & ITEM_TEMPO_TRACK)
+        s_put_int(buf, p.get_tempo_track_number());
+
+    int seqcount = 0;
+    for (int s = 0; s < p.sequence_high(); ++s)
+    {
+        if (p.is_active(s))
+        {
+            sequence * sp = p.get_sequence(s);
+            if (not_nullptr(sp) && sp->events_pending())
+                return false;                       /* do not decode it     */
+
+            ++seqcount;
+        }
+    }
+    s_put_int(buf, seqcount);
+
+    std::unordered_map<const event *, int> index;
+    for (int s = 0; s < p.sequence_high(); ++s)
+    {
+        sequence * sp = p.get_sequence(s);
+        if (! p.is_active(s) || is_nullptr(sp))
+            continue;
+
+        const sequence & seq = *sp;
+        const event_list & evl = sp->events();      /* none are pending     */
+        s_put_int(buf, s);
+        s_put_long(buf, seq.get_length());
+        s_put_int(buf, int(seq.get_midi_bus()));
+        s_put_int(buf, int(seq.get_midi_channel()));
+        s_put_int(buf, seq.get_transposable() ? 1 : 0);
+        s_put_int(buf, int(seq.musical_key()));
+        s_put_int(buf, int(seq.musical_scale()));
+        s_put_int(buf, seq.background_sequence());
+        s_put_int(buf, seq.color());
+        s_put_int(buf, seq.get_beats_per_bar());
+        s_put_int(buf, seq.get_beat_width());
+        s_put_int(buf, seq.clocks_per_metronome());
+        s_put_int(buf, seq.get_32nds_per_quarter());
+        s_put_long(buf, seq.us_per_quarter_note());
+        s_put_string(buf, seq.name());
+
+        triggers::List trigs = seq.get_triggers();
+        s_put_int(buf, int(trigs.size()));
+        for
+        (
+            triggers::List::const_iterator t = trigs.begin();
+            t != trigs.end(); ++t
+        )
+        {
+            s_put_long(buf, t->tick_start());
+            s_put_long(buf, t->tick_end());
+            s_put_long(buf, t->offset());
+        }
+
+        index.clear();
+        int i = 0;
+        for (event_list::const_iterator e = evl.begin(); e != evl.end(); ++e)
+            index[&DREF(e)] = i++;
+
+        s_put_int(buf, i);
+        for (event_list::const_iterator e = evl.begin(); e != evl.end(); ++e)
+        {
+            const event & ev = DREF(e);
+            event_record r;
+            memset(&r, 0, sizeof r);
+            r.timestamp = ev.get_timestamp();
+            r.link = -1;
+            if (ev.is_linked())
+            {
+                std::unordered_map<const event *, int>::const_iterator li =
+                    index.find(ev.get_linked());
+
+                if (li != index.end())
+                    r.link = li->second;
+            }
+            r.exlength = unsigned(ev.get_sysex_size());
+            r.status = ev.get_status();
+            r.channel = ev.get_channel();
+            ev.get_data(r.d0, r.d1);
+            r.selected = ev.is_selected() ? 1 : 0 ;
+            s_put(buf, &r, sizeof r);
+            if (r.exlength > 0)
+                s_put(buf, &ev.get_sysex()[0], r.exlength);
+        }
+    }
+
+    std::string temp = m_name + ".tmp";
+    FILE * fp = fopen(temp.c_str(), "wb");
+    if (is_nullptr(fp))
+    {
+        m_error_message = "cannot create " + temp;
+        return false;
+    }
+
+    bool result = fwrite(&buf[0], 1, buf.size(), fp) == buf.size();
+    result = (fclose(fp) == 0) && result;
+    if (result)
+    {
+#ifdef PLATFORM_WINDOWS
+        (void) remove(m_name.c_str());              /* rename() won't clobber */
+#endif
+        result = rename(temp.c_str(), m_name.c_str()) == 0;
+    }
+    if (! result)
+    {
+        (void) remove(temp.c_str());
+        m_error_message = "cannot write " + m_name;
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * session_snapshot.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -0,0 +1,327 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          song_saver.cpp
+ *
+ *  This module defines the background thread that writes MIDI files for
+ *  File / Save and for the autosave.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the song_saver.hpp module for the overview.
+ */
+
+#include "midifile.hpp"                 /* seq64::midifile                  */
+#include "perform.hpp"                  /* seq64::perform                   */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "settings.hpp"                 /* seq64::rc() and usr()            */
+#include "song_saver.hpp"               /* seq64::song_saver                */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Default constructor.  The image is filled in by midifile::capture().
+ */
+
+song_image::song_image ()
+ :
+    m_filename      (),
+    m_ppqn          (SEQ64_DEFAULT_PPQN),
+    m_oldformat     (false),
+    m_globalbgs     (true),
+    m_doseqspec     (true),
+    m_user_save     (true),
+    m_tracks        (),
+    m_seqspec       ()
+{
+    // Empty body
+}
+
+/**
+ *  Deletes the sequence copies.
+ */
+
+song_image::~song_image ()
+{
+    for
+    (
+        std::vector<track>::iterator t = m_tracks.begin();
+        t != m_tracks.end(); ++t
+    )
+    {
+        delete t->seq;
+    }
+}
+
+/**
+ *  Principal constructor.  Does not start the thread; see save().
+ *
+ * \param p
+ *      The performance whose songs are to be saved.
+ */
+
+song_saver::song_saver (perform & p)
+ :
+    m_perform       (p),
+    m_queue         (),
+    m_writing       (false),
+    m_error_message (),
+    m_stop          (false),
+    m_last_autosave (std::chrono::steady_clock::now()),
+    m_mutex         (),
+    m_wakeup        (),
+    m_thread        ()
+{
+    // Empty body
+}
+
+/**
+ *  Writes whatever is still queued, then stops the thread.
+ */
+
+song_saver::~song_saver ()
+{
+    stop();
+}
+
+/**
+ *  Queues a captured song for writing, and starts the thread if it is not
+ *  running yet.  Saves are written in the order they are queued.
+ *
+ * \param image
+ *      The song captured by midifile::capture().  The song_saver takes
+ *      ownership of it.
+ */
+
+void
+song_saver::save (song_image * image)
+{
+    if (not_nullptr(image))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stop)
+        {
+            delete image;                       /* too late, shutting down  */
+            return;
+        }
+        m_queue.push_back(image);
+        if (! m_thread.joinable())
+            m_thread = std::thread(&song_saver::run, this);
+    }
+    m_wakeup.notify_one();
+}
+
+/**
+ * \return
+ *      Returns true if a song is queued or being written.
+ */
+
+bool
+song_saver::busy ()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_writing || ! m_queue.empty();
+}
+
+/**
+ *  Hands over the error of the last save that failed, if any.  Called
+ *  periodically by the GUI, by way of perform::check_saves(), since the
+ *  save itself returns before the file is written.
+ *
+ * \param [out] errmsg
+ *      Receives the error message, if true is returned.
+ *
+ * \return
+ *      Returns true if a save failed since the last call.
+ */
+
+bool
+song_saver::check_error (std::string & errmsg)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    bool result = ! m_error_message.empty();
+    if (result)
+    {
+        errmsg = m_error_message;
+        m_error_message.clear();
+    }
+    return result;
+}
+
+/**
+ *  Captures the song to its autosave file, if "-o autosave=secs" is in
+ *  force, that many seconds have passed since the last autosave, the song
+ *  has unsaved changes, and no save is in progress.  Must be called from
+ *  the GUI thread, like any other save.  The song is not marked as saved.
+ */
+
+void
+song_saver::autosave ()
+{
+    int secs = usr().option_autosave();
+    if (secs > 0)
+    {
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now();
+
+        if (now - m_last_autosave >= std::chrono::seconds(secs))
+        {
+            m_last_autosave = now;
+            if (m_perform.is_modified() && ! busy())
+            {
+                midifile f
+                (
+                    autosave_filename(rc().filename()), m_perform.get_ppqn(),
+                    rc().legacy_format(), usr().global_seq_feature()
+                );
+                song_image * image = new song_image;
+                if (f.capture(m_perform, *image))
+                {
+                    image->m_user_save = false;
+                    save(image);
+                }
+                else
+                    delete image;                   /* e.g. no patterns     */
+            }
+        }
+    }
+}
+
+/**
+ *  Tells the thread to exit once the queue is empty, and waits for it.
+ *  Called before the performance deletes its sequences, so that a save
+ *  made just before exiting is not lost.
+ */
+
+void
+song_saver::stop ()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wakeup.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+/**
+ *  The thread loop.  Takes the oldest song from the queue, and writes it
+ *  without holding m_mutex.  An error is kept for check_error(), and is
+ *  shown on the console as well, in case no GUI is left to report it.
+ */
+
+void
+song_saver::run ()
+{
+    for (;;)
+    {
+        song_image * image = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (m_queue.empty() && ! m_stop)
+                m_wakeup.wait(lock);
+
+            if (m_queue.empty())
+                break;                              /* stopped and drained  */
+
+            image = m_queue.front();
+            m_queue.pop_front();
+            m_writing = true;
+        }
+
+        midifile f
+        (
+            image->m_filename, image->m_ppqn,
+            image->m_oldformat, image->m_globalbgs
+        );
+        bool ok = f.write(*image, m_perform);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_writing = false;
+            if (! ok)
+                m_error_message = image->m_filename + ": " + f.error_message();
+        }
+        if (! ok)
+        {
+            errprint(f.error_message().c_str());
+        }
+        delete image;
+    }
+}
+
+/**
+ *  Makes the name of the autosave file for a MIDI file, by inserting
+ *  ".autosave" before its extension, so that "song.midi" is autosaved to
+ *  "song.autosave.midi".  An unnamed song is autosaved to
+ *  "autosave.midi" in the configuration directory.
+ *
+ * \param filename
+ *      The name of the MIDI file, normally rc().filename().
+ *
+ * \return
+ *      Returns the name of the autosave file.
+ */
+
+std::string
+autosave_filename (const std::string & filename)
+{
+    std::string result;
+    if (filename.empty())
+    {
+        result = rc().home_config_directory() + "autosave.midi";
+    }
+    else
+    {
+        std::string::size_type slash = filename.find_last_of("/\\");
+        std::string::size_type dot = filename.find_last_of(".");
+        if
+        (
+            dot == std::string::npos || dot == 0 ||
+            (slash != std::string::npos && dot < slash)
+        )
+        {
+            result = filename + ".autosave.midi";
+        }
+        else
+        {
+            result = filename.substr(0, dot) + ".autosave";
+            result += filename.substr(dot);
+        }
+    }
+    return result;
+}
+
+}           // namespace seq64
+
+/*
+ * song_saver.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
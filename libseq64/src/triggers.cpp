@@ -510,8 +510,12 @@ triggers::intersect (midipulse position)
  *  necessary, or the trigger's end is moved to tickto plus the length
  *  parameter, if necessary.
  *
- *  Then this new trigger is added, and the function breaks from the search
- *  loop.
+ *  If the grown trigger does not touch any other trigger, it is changed in
+ *  place, as add() would leave it.  This is the usual case, and it does not
+ *  allocate, which matters because sequence::play() grows the trigger of a
+ *  song-recorded sequence in every output frame.  Otherwise, the grown
+ *  trigger is added, so that add() trims the others, and the function
+ *  breaks from the search loop.
  *
  * \param tickfrom
  *      The desired from-value back which to expand the trigger, if necessary.
@@ -539,7 +543,30 @@ triggers::grow (midipulse tickfrom, midipulse tickto, midipulse len)
             if (calcend > ender)
                 ender = calcend;
 
-            add(start, ender - start + 1, it->offset());
+            bool overlap = false;
+            List::iterator i = m_triggers.begin();
+            for ( ; i != m_triggers.end(); ++i)
+            {
+                if (i == it)
+                    continue;
+
+                if (i->tick_start() <= ender && i->tick_end() >= start)
+                {
+                    overlap = true;
+                    break;
+                }
+            }
+            if (overlap)
+            {
+                add(start, ender - start + 1, it->offset());
+            }
+            else
+            {
+                unselect(*it);                  /* as add() would leave it  */
+                it->offset(adjust_offset(it->offset()));
+                it->tick_start(start);
+                it->tick_end(ender);
+            }
             break;
         }
     }
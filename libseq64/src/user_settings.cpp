@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-23
- * \updates       2018-08-02
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Note that this module also sets the remaining legacy global variables, so
@@ -218,6 +218,14 @@ user_settings::user_settings ()
     m_user_option_daemonize     (false),
     m_user_use_logfile          (false),
     m_user_option_logfile       (),
+    m_user_option_statsfile     (),
+    m_user_option_tracefile     (),
+    m_user_option_rtsafe        (false),
+    m_user_option_rtsafe_abort  (false),
+    m_user_option_lazy_load     (false),
+    m_user_option_snapshot      (false),
+    m_user_option_autosave      (0),
+    m_user_option_stream_kb     (0),
     m_work_around_play_image    (false),
     m_work_around_transpose_image (false),
 
@@ -327,6 +335,14 @@ user_settings::user_settings (const user_settings & rhs)
     m_user_option_daemonize     (rhs.m_user_option_daemonize),
     m_user_use_logfile          (rhs.m_user_use_logfile),
     m_user_option_logfile       (rhs.m_user_option_logfile),
+    m_user_option_statsfile     (rhs.m_user_option_statsfile),
+    m_user_option_tracefile     (rhs.m_user_option_tracefile),
+    m_user_option_rtsafe        (rhs.m_user_option_rtsafe),
+    m_user_option_rtsafe_abort  (rhs.m_user_option_rtsafe_abort),
+    m_user_option_lazy_load     (rhs.m_user_option_lazy_load),
+    m_user_option_snapshot      (rhs.m_user_option_snapshot),
+    m_user_option_autosave      (rhs.m_user_option_autosave),
+    m_user_option_stream_kb     (rhs.m_user_option_stream_kb),
     m_work_around_play_image    (rhs.m_work_around_play_image),
     m_work_around_transpose_image (rhs.m_work_around_transpose_image),
 
@@ -436,6 +452,14 @@ user_settings::operator = (const user_settings & rhs)
         m_user_option_daemonize = rhs.m_user_option_daemonize;
         m_user_use_logfile = rhs.m_user_use_logfile;
         m_user_option_logfile = rhs.m_user_option_logfile;
+        m_user_option_statsfile = rhs.m_user_option_statsfile;
+        m_user_option_tracefile = rhs.m_user_option_tracefile;
+        m_user_option_rtsafe = rhs.m_user_option_rtsafe;
+        m_user_option_rtsafe_abort = rhs.m_user_option_rtsafe_abort;
+        m_user_option_lazy_load = rhs.m_user_option_lazy_load;
+        m_user_option_snapshot = rhs.m_user_option_snapshot;
+        m_user_option_autosave = rhs.m_user_option_autosave;
+        m_user_option_stream_kb = rhs.m_user_option_stream_kb;
         m_work_around_play_image = rhs.m_work_around_play_image;
         m_work_around_transpose_image = rhs.m_work_around_transpose_image;
 
@@ -519,6 +543,14 @@ user_settings::set_defaults ()
     m_user_option_daemonize = false;
     m_user_use_logfile = false;
     m_user_option_logfile.clear();
+    m_user_option_statsfile.clear();
+    m_user_option_tracefile.clear();
+    m_user_option_rtsafe = false;
+    m_user_option_rtsafe_abort = false;
+    m_user_option_lazy_load = false;
+    m_user_option_snapshot = false;
+    m_user_option_autosave = 0;
+    m_user_option_stream_kb = 0;
     m_work_around_play_image = false;
     m_work_around_transpose_image = false;
     m_user_ui_key_height = 12;
@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-03
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Note that the parse function has some code that is not yet enabled.
@@ -35,6 +35,7 @@
  */
 
 #include <iostream>
+#include <sstream>                      /* std::ostringstream           */
 
 #include "globals.h"
 #include "file_functions.hpp"           /* seq64::strip_quotes()        */
@@ -134,7 +135,7 @@ userfile::parse (perform & /* p */)
         fprintf(stderr, "? error opening [%s]\n", m_name.c_str());
         return false;
     }
-    file.seekg(0, std::ios::beg);                       /* seek to start    */
+    index_lines(file);                                  /* read it all      */
 
     /*
      * [comments]
@@ -143,7 +144,7 @@ userfile::parse (perform & /* p */)
      * read an optional comment block.
      */
 
-    if (line_after(file, "[comments]"))                 /* gets first line  */
+    if (line_after("[comments]"))                       /* gets first line  */
     {
         usr().clear_comments();
         do
@@ -151,7 +152,7 @@ userfile::parse (perform & /* p */)
             usr().append_comment_line(m_line);
             usr().append_comment_line("\n");
 
-        } while (next_data_line(file));
+        } while (next_data_line());
     }
 
     /*
@@ -169,7 +170,7 @@ userfile::parse (perform & /* p */)
          */
 
         int buses = 0;
-        if (line_after(file, "[user-midi-bus-definitions]"))
+        if (line_after("[user-midi-bus-definitions]"))
             sscanf(m_line, "%d", &buses);               /* atavistic!       */
 
         /*
@@ -179,18 +180,18 @@ userfile::parse (perform & /* p */)
         for (int bus = 0; bus < buses; ++bus)
         {
             std::string label = make_section_name("user-midi-bus", bus);
-            if (! line_after(file, label))
+            if (! line_after(label))
                 break;
 
             if (usr().add_bus(m_line))
             {
-                (void) next_data_line(file);
+                (void) next_data_line();
                 int instruments = 0;
                 sscanf(m_line, "%d", &instruments);     /* no. of channels  */
                 for (int j = 0; j < instruments; ++j)
                 {
                     int channel, instrument;
-                    (void) next_data_line(file);
+                    (void) next_data_line();
                     sscanf(m_line, "%d %d", &channel, &instrument);
                     usr().set_bus_instrument(bus, channel, instrument);
                 }
@@ -211,7 +212,7 @@ userfile::parse (perform & /* p */)
      */
 
     int instruments = 0;
-    if (line_after(file, "[user-instrument-definitions]"))
+    if (line_after("[user-instrument-definitions]"))
         sscanf(m_line, "%d", &instruments);
 
     /*
@@ -221,19 +222,19 @@ userfile::parse (perform & /* p */)
     for (int i = 0; i < instruments; ++i)
     {
         std::string label = make_section_name("user-instrument", i);
-        if (! line_after(file, label))
+        if (! line_after(label))
             break;
 
         if (usr().add_instrument(m_line))
         {
             char ccname[SEQ64_LINE_MAX];
             int ccs = 0;
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &ccs);
             for (int j = 0; j < ccs; ++j)
             {
                 int c = 0;
-                if (! next_data_line(file))
+                if (! next_data_line())
                     break;
 
                 ccname[0] = 0;                              // clear the buffer
@@ -287,40 +288,40 @@ userfile::parse (perform & /* p */)
     if (! rc().legacy_format())
     {
         int scratch = 0;
-        if (line_after(file, "[user-interface-settings]"))
+        if (line_after("[user-interface-settings]"))
         {
             sscanf(m_line, "%d", &scratch);
             usr().grid_style(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().grid_brackets(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().mainwnd_rows(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().mainwnd_cols(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().max_sets(scratch);            /* should ignore this setting */
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().mainwid_border(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().mainwid_spacing(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().control_height(scratch);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().zoom(scratch);
 
@@ -330,7 +331,7 @@ userfile::parse (perform & /* p */)
              * stored in the MIDI file, not in the "user" configuration file.
              */
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().global_seq_feature(scratch != 0);
 
@@ -339,21 +340,21 @@ userfile::parse (perform & /* p */)
              * versus new font.
              */
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().use_new_font(scratch != 0);
 
-            (void) next_data_line(file);
+            (void) next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().allow_two_perfedits(scratch != 0);
 
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().perf_h_page_increment(scratch);
             }
 
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().perf_v_page_increment(scratch);
@@ -365,22 +366,22 @@ userfile::parse (perform & /* p */)
              *  have older Sequencer64 "user" configuration files.
              */
 
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);             /* now an int   */
                 usr().progress_bar_colored(scratch);        /* pick a color */
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     usr().progress_bar_thick(scratch != 0);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     if (scratch <= 1)                       /* boolean?     */
                     {
                         usr().inverse_colors(scratch != 0);
-                        if (next_data_line(file))
+                        if (next_data_line())
                             sscanf(m_line, "%d", &scratch); /* get redraw   */
                     }
                     if (scratch < SEQ64_MINIMUM_REDRAW)
@@ -390,30 +391,30 @@ userfile::parse (perform & /* p */)
 
                     usr().window_redraw_rate(scratch);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     if (scratch <= 1)                       /* boolean?     */
                         usr().use_more_icons(scratch != 0);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     if (scratch > 0 && scratch <= SEQ64_MAINWID_BLOCK_ROWS_MAX)
                         usr().block_rows(scratch);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     if (scratch > 0 && scratch <= SEQ64_MAINWID_BLOCK_COLS_MAX)
                         usr().block_columns(scratch);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     sscanf(m_line, "%d", &scratch);
                     usr().block_independent(scratch != 0);
                 }
-                if (next_data_line(file))
+                if (next_data_line())
                 {
                     float scale = 1.0f;
                     sscanf(m_line, "%f", &scale);
@@ -455,57 +456,57 @@ userfile::parse (perform & /* p */)
 
     if (! rc().legacy_format())
     {
-        if (line_after(file, "[user-midi-settings]"))
+        if (line_after("[user-midi-settings]"))
         {
             int scratch = 0;
             sscanf(m_line, "%d", &scratch);
             usr().midi_ppqn(scratch);
 
-            next_data_line(file);
+            next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().midi_beats_per_bar(scratch);
 
             float beatspm;
-            next_data_line(file);
+            next_data_line();
             sscanf(m_line, "%f", &beatspm);
             usr().midi_beats_per_minute(midibpm(beatspm));
 
-            next_data_line(file);
+            next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().midi_beat_width(scratch);
 
-            next_data_line(file);
+            next_data_line();
             sscanf(m_line, "%d", &scratch);
             usr().midi_buss_override(char(scratch));
 
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().velocity_override(scratch);
             }
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().bpm_precision(scratch);
             }
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 float inc;
                 sscanf(m_line, "%f", &inc);
                 usr().bpm_step_increment(midibpm(inc));
             }
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 float inc;
                 sscanf(m_line, "%f", &inc);
                 usr().bpm_page_increment(midibpm(inc));
             }
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%f", &beatspm);
                 usr().midi_bpm_minimum(midibpm(beatspm));
             }
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%f", &beatspm);
                 usr().midi_bpm_maximum(midibpm(beatspm));
@@ -516,14 +517,14 @@ userfile::parse (perform & /* p */)
          * -o special options support.
          */
 
-        if (line_after(file, "[user-options]"))
+        if (line_after("[user-options]"))
         {
             int scratch = 0;
             sscanf(m_line, "%d", &scratch);
             usr().option_daemonize(scratch != 0);
 
             char temp[256];
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%s", temp);
                 std::string logfile = std::string(temp);
@@ -542,12 +543,12 @@ userfile::parse (perform & /* p */)
          * Work-arounds for sticky issues
          */
 
-        if (line_after(file, "[user-work-arounds]"))
+        if (line_after("[user-work-arounds]"))
         {
             int scratch = 0;
             sscanf(m_line, "%d", &scratch);
             usr().work_around_play_image(scratch != 0);
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().work_around_transpose_image(scratch != 0);
@@ -558,12 +559,12 @@ userfile::parse (perform & /* p */)
          * [user-ui-tweaks]
          */
 
-        if (line_after(file, "[user-ui-tweaks]"))
+        if (line_after("[user-ui-tweaks]"))
         {
             int scratch = 0;
             sscanf(m_line, "%d", &scratch);
             usr().key_height(scratch);
-            if (next_data_line(file))
+            if (next_data_line())
             {
                 sscanf(m_line, "%d", &scratch);
                 usr().use_new_seqedit(scratch != 0);
@@ -594,12 +595,7 @@ userfile::parse (perform & /* p */)
 bool
 userfile::write (const perform & /* a_perf */ )
 {
-    std::ofstream file(m_name.c_str(), std::ios::out | std::ios::trunc);
-    if (! file.is_open())
-    {
-        fprintf(stderr, "? error opening [%s] for writing\n", m_name.c_str());
-        return false;
-    }
+    std::ostringstream file;                    /* see write_text() below   */
     dump_setting_summary();
 
     /*
@@ -1294,8 +1290,7 @@ userfile::write (const perform & /* a_perf */ )
         << "\n#\n"
         << "# vim: sw=4 ts=4 wm=4 et ft=sh\n"   /* ft=sh for nice colors */
         ;
-    file.close();
-    return true;
+    return write_text(file.str());
 }
 
 }           // namespace seq64
@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-06-04
- * \updates       2018-07-31
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  For a quick guide to the WRK format, see, for example:
@@ -151,6 +151,9 @@ wrkfile::wrkfile
 ) :
     midifile        (name, ppqn),
     m_wrk_data      (),
+    m_input         (),
+    m_input_size    (0),
+    m_input_pos     (0),
     m_perform       (nullptr),
     m_screen_set    (-1),
     m_importing     (false),
@@ -160,7 +163,9 @@ wrkfile::wrkfile
     m_track_channel (-1),
     m_track_count   (0),
     m_track_time    (0),
-    m_current_seq   (nullptr)
+    m_current_seq   (nullptr),
+    m_seq_channel   (-1),
+    m_builder       ()
 {
     //
 }
@@ -192,18 +197,33 @@ wrkfile::not_supported (const std::string & tag)
 }
 
 /**
- *  Read the chunk raw data (undecoded).
+ *  Reads the next bytes of the WRK file into the midifile buffer, in place
+ *  of the previous ones, for the read functions to decode.  The buffer
+ *  holds only one chunk (or chunk header) at a time, so the memory used is
+ *  bounded by the largest chunk, not by the size of the file.
  *
- *  Sequencer64 status: Not handled.
+ * \param length
+ *      Provides the number of bytes to be read.  It is cut to the bytes left
+ *      in the file, so that a corrupted chunk length cannot allocate more
+ *      than that.
  *
- * \param sz
- *      Provides the number of raw data bytes to be read.
+ * \return
+ *      Returns the number of bytes read.
  */
 
-void
-wrkfile::read_raw_data (int sz)
+size_t
+wrkfile::read_input (size_t length)
 {
-    read_byte_array(m_wrk_data.m_lastChunkData, sz);
+    size_t left = m_input_size - m_input_pos;
+    if (length > left)
+        length = left;
+
+    size_t result = read_window(m_input, m_input_pos, length);
+    m_input_pos += result;
+    if (result < length)
+        m_input_pos = m_input_size;         /* read error, give up the rest */
+
+    return result;
 }
 
 /**
@@ -309,7 +329,8 @@ wrkfile::read_32_bit ()
 
 /**
  *  Reads a string.  Unicode will be handled, eventually.  Compared this
- *  function to midifile::read_byte_array().
+ *  function to midifile::read_byte_array().  The bytes are copied in one go
+ *  by midifile::read_cstring(), which stops after a null byte.
  *
  * \param len
  *      Provides the length to be read.
@@ -324,14 +345,7 @@ wrkfile::read_string (int len)
     std::string s;
     if (len > 0)
     {
-        std::string data;
-        midibyte c = 0xff;
-        for (int i = 0; i < len && c != 0; ++i)
-        {
-            c = read_byte();
-            if (c != 0)
-                data.push_back(static_cast<char>(c));   // CAREFUL!!!
-        }
+        std::string data = read_cstring(size_t(len));
 #ifdef USE_UNICODE_SUPPORT
         if (is_nullptr(m_wrk_data.m_codec))
             s = std::string(data);
@@ -360,15 +374,7 @@ std::string
 wrkfile::read_var_string ()
 {
     std::string result;
-    std::string data;
-    midibyte b;
-    do
-    {
-        b = read_byte();
-        if (b != 0)
-            data.push_back(static_cast<char>(b));   // CAREFUL!!!
-    }
-    while (b != 0);
+    std::string data = read_cstring(std::string::npos);
 
 #ifdef USE_UNICODE_SUPPORT
     if (is_nullptr(m_wrk_data.m_codec))
@@ -395,14 +401,22 @@ wrkfile::read_var_string ()
  *
  *  Note that the filename is set during the construction of this
  *  object.
+ *
+ *  Unlike a MIDI file, the WRK file is not read into memory all at once.
+ *  The header, and then each chunk, is read into the midifile buffer as it
+ *  is needed; see read_input() and read_chunk().
  */
 
 bool
 wrkfile::parse (perform & p, int screenset, bool importing)
 {
-    bool result = grab_input_stream(std::string("WRK"));
+    bool result = open_input_stream(std::string("WRK"), m_input);
     if (result)
     {
+        m_input_size = file_size();     /* the whole file, before chunking  */
+        m_input_pos = 0;
+        (void) read_input(CakewalkHeader.length() + 3);
+
         std::string hdr = read_string(int(CakewalkHeader.length()));
         result = hdr == CakewalkHeader;
     }
@@ -424,9 +438,9 @@ wrkfile::parse (perform & p, int screenset, bool importing)
         {
             ck_id = read_chunk();
         }
-        while (ck_id != WC_END_CHUNK && ! at_end());
+        while (ck_id != WC_END_CHUNK && ! input_done());
 
-        if (! at_end())
+        if (! input_done())
             result = set_error("Corrupted WRK file.");
         else
             End_chunk();
@@ -434,6 +448,9 @@ wrkfile::parse (perform & p, int screenset, bool importing)
     else
         result = set_error("Invalid WRK file format.");
 
+    if (m_input.is_open())
+        m_input.close();
+
     return result;
 }
 
@@ -596,6 +613,7 @@ wrkfile::next_track
         m_current_seq = initialize_sequence(*m_perform);
         m_current_seq->set_midi_channel(channel); /* channel, whole trk */
         m_current_seq->set_name(trackname);
+        m_seq_channel = int(midibyte(channel));
     }
 }
 
@@ -608,7 +626,8 @@ wrkfile::finalize_track ()
 {
     if (not_nullptr(m_current_seq))     /* a sequence currently exists  */
     {
-        m_current_seq->set_length(m_track_time);
+        m_builder.commit(*m_current_seq);
+        m_current_seq->set_length(m_track_time, true, false);
         finalize_sequence
         (
             *m_perform, *m_current_seq, m_track_number, m_screen_set
@@ -616,6 +635,25 @@ wrkfile::finalize_track ()
     }
 }
 
+/**
+ *  Gives the channel of an event to the current sequence, if it differs
+ *  from the one the sequence already has.  This avoids locking the sequence
+ *  for every event, now that the events themselves are added in bulk.
+ *
+ * \param channel
+ *      The channel of the event.
+ */
+
+void
+wrkfile::set_seq_channel (midibyte channel)
+{
+    if (int(channel) != m_seq_channel)
+    {
+        m_seq_channel = int(channel);
+        m_current_seq->set_midi_channel(channel);
+    }
+}
+
 /**
  * Emitted after reading the global variables chunk:
  *
@@ -854,7 +892,7 @@ wrkfile::NoteArray (int track, int events)
                     e.set_status(EVENT_NOTE_OFF, channel);
 
                 e.set_data(d0, d1);
-                m_current_seq->append_event(e);
+                m_builder.append(e);
                 if (eventcode == EVENT_NOTE_ON && ! isnoteoff)
                 {
                     event e;
@@ -862,9 +900,9 @@ wrkfile::NoteArray (int track, int events)
                     e.set_timestamp(timemax);
                     e.set_status(EVENT_NOTE_OFF, channel);
                     e.set_data(d0, 0);
-                    m_current_seq->append_event(e);
+                    m_builder.append(e);
                 }
-                m_current_seq->set_midi_channel(channel);
+                set_seq_channel(channel);
                 if (timemax > m_track_time)
                     m_track_time = timemax;
                 break;
@@ -876,8 +914,8 @@ wrkfile::NoteArray (int track, int events)
                 // Q_EMIT signalWRKChanPress(track, time, channel, d0);
 
                 e.set_data(d0);
-                m_current_seq->append_event(e);
-                m_current_seq->set_midi_channel(channel);
+                m_builder.append(e);
+                set_seq_channel(channel);
 
                 /*
                  * if (is_smf0)
@@ -892,8 +930,8 @@ wrkfile::NoteArray (int track, int events)
 
                 value = (d1 << 7) + d0 - 8192;
                 e.set_data(d0, d1);
-                m_current_seq->append_event(e);
-                m_current_seq->set_midi_channel(channel);
+                m_builder.append(e);
+                set_seq_channel(channel);
 
                 /*
                  * if (is_smf0)
@@ -948,7 +986,7 @@ wrkfile::NoteArray (int track, int events)
             event e;
             e.set_status(EVENT_CONTROL_CHANGE, channel);
             e.set_data(EVENT_CTRL_EXPRESSION, d1);
-            m_current_seq->append_event(e);
+            m_builder.append(e);
         }
         else if (status == 6)               /* not supported in Sequencer64     */
         {
@@ -1154,7 +1192,7 @@ wrkfile::Stream_chunk ()
                 e.set_status(EVENT_NOTE_OFF, channel);
 
             e.set_data(d0, d1);
-            m_current_seq->append_event(e);
+            m_builder.append(e);
             if (eventcode == EVENT_NOTE_ON && ! isnoteoff)
             {
                 event e;
@@ -1162,9 +1200,9 @@ wrkfile::Stream_chunk ()
                 e.set_timestamp(timemax);
                 e.set_status(EVENT_NOTE_OFF, channel);
                 e.set_data(d0, 0);
-                m_current_seq->append_event(e);
+                m_builder.append(e);
             }
-            m_current_seq->set_midi_channel(channel);
+            set_seq_channel(channel);
             if (timemax > m_track_time)
                 m_track_time = timemax;
 
@@ -1182,8 +1220,8 @@ wrkfile::Stream_chunk ()
             // Q_EMIT signalWRKChanPress(track, time, channel, d0);
 
             e.set_data(d0);
-            m_current_seq->append_event(e);
-            m_current_seq->set_midi_channel(channel);
+            m_builder.append(e);
+            set_seq_channel(channel);
 
             /*
              * if (is_smf0)
@@ -1198,8 +1236,8 @@ wrkfile::Stream_chunk ()
 
             value = (d1 << 7) + d0 - 8192;                      // hmmmm
             e.set_data(d0, d1);
-            m_current_seq->append_event(e);
-            m_current_seq->set_midi_channel(channel);
+            m_builder.append(e);
+            set_seq_channel(channel);
 
             /*
              * if (is_smf0)
@@ -1358,7 +1396,7 @@ wrkfile::MeterKey_chunk ()
                 bt[1] = 0;                  /* indicates a major key        */
                 bool ok = e.append_meta_data(EVENT_META_KEY_SIGNATURE, bt, 2);
                 if (ok)
-                    m_current_seq->append_event(e);
+                    m_builder.append(e);
             }
         }
     }
@@ -1468,7 +1506,7 @@ wrkfile::Tempo_chunk (int factor)
         if (ok)
         {
             e.set_timestamp(time);
-            m_current_seq->append_event(e);
+            m_builder.append(e);
         }
     }
 }
@@ -1702,7 +1740,7 @@ wrkfile::TrackPatch ()
     event e;
     e.set_status(EVENT_PROGRAM_CHANGE, m_track_channel);
     e.set_data(patch);
-    m_current_seq->append_event(e);
+    m_builder.append(e);
 }
 
 /**
@@ -1792,19 +1830,22 @@ wrkfile::VariableRecord (int max)
  *      -  data chunk data (not decoded)
  *
  * void signalWRKUnknownChunk(int type, const QByteArray& data);
+ *
+ *  The chunk data is what the midifile buffer holds, so its size is given by
+ *  file_size().
  */
 
 void
 wrkfile::Unknown (int id)
 {
-    // Q_EMIT signalWRKUnknownChunk(id, m_wrk_data.m_lastChunkData);
+    // Q_EMIT signalWRKUnknownChunk(id, chunk data);
 
     if (rc().show_midi())
     {
         printf
         (
             "Unknown     : id %d (%d bytes, not shown)\n",
-            id, int(m_wrk_data.m_lastChunkData.size())
+            id, int(file_size())
         );
     }
 }
@@ -2022,7 +2063,7 @@ wrkfile::TrackVol ()
     event e;
     e.set_status(EVENT_CONTROL_CHANGE, m_track_channel);
     e.set_data(EVENT_CTRL_VOLUME, midibyte(vol));
-    m_current_seq->append_event(e);
+    m_builder.append(e);
 }
 
 /**
@@ -2157,20 +2198,30 @@ wrkfile::End_chunk ()
 }
 
 /**
+ *  Reads the next chunk of the WRK file into the midifile buffer, and
+ *  decodes it.  The chunk ID and length are read first, then the chunk data
+ *  alone, so that the decoding function cannot read beyond its chunk.  If it
+ *  tries to (a chunk written by another version of Cakewalk can be shorter
+ *  than expected), it reads zeroes, silently.  Only a chunk cut short by the
+ *  end of the file is reported as an error.
  *
+ * \return
+ *      Returns the chunk ID.
  */
 
 int
 wrkfile::read_chunk ()
 {
+    (void) read_input(1);
     int ck = int(read_byte());
     if (ck != WC_END_CHUNK)
     {
-        int ck_len = read_32_bit();
-        size_t start_pos = get_file_pos();
-        size_t final_pos = start_pos + ck_len;
-        read_raw_data(ck_len);
-        read_seek(start_pos);       // TODO: check the return value
+        (void) read_input(4);
+        size_t ck_len = size_t(read_32_bit());
+        bool quiet = read_input(ck_len) == ck_len && ! disable_reported();
+        if (quiet)
+            disable_reported(true);
+
         switch (ck)
         {
         case WC_TRACK_CHUNK:
@@ -2230,7 +2281,7 @@ wrkfile::read_chunk ()
             break;
 
         case WC_VARIABLE_CHUNK:
-            VariableRecord(ck_len); // record identifier & variable data
+            VariableRecord(int(ck_len)); // record ID & variable data
             break;
 
         case WC_NTRACK_CHUNK:
@@ -2289,7 +2340,8 @@ wrkfile::read_chunk ()
             Unknown(ck);
             break;
         }
-        read_seek(final_pos);           // TODO: check the return value
+        if (quiet)
+            disable_reported(false);
     }
     return ck;
 }
@@ -82,6 +82,13 @@ private:
 
     struct pollfd * m_poll_descriptors;
 
+    /**
+     *  The ALSA MIDI decoder used by api_get_midi_event().  It is created
+     *  once, in the constructor, rather than for every event received.
+     */
+
+    snd_midi_event_t * m_midi_decoder;
+
 public:
 
     mastermidibus
@@ -100,6 +100,12 @@
 namespace seq64
 {
 
+/**
+ *  The size of the buffer for decoding incoming ALSA events into MIDI bytes.
+ */
+
+#define SEQ64_MIDI_DECODE_SIZE      0x1000
+
 /**
  *  The mastermidibus default constructor fills the array with our busses.
  *
@@ -119,7 +125,8 @@ mastermidibus::mastermidibus (int ppqn, midibpm bpm)
     mastermidibase          (ppqn, bpm),
     m_alsa_seq              (nullptr),
     m_num_poll_descriptors  (0),
-    m_poll_descriptors      (nullptr)
+    m_poll_descriptors      (nullptr),
+    m_midi_decoder          (nullptr)
 {
     /*
      * Open the sequencer client.  This line of code results in a loss of
@@ -149,6 +156,8 @@ mastermidibus::mastermidibus (int ppqn, midibpm bpm)
 
     snd_seq_set_client_name(m_alsa_seq, SEQ64_PACKAGE); /* "sequencer64"    */
     m_queue = snd_seq_alloc_queue(m_alsa_seq);          /* protected member */
+    if (snd_midi_event_new(SEQ64_MIDI_DECODE_SIZE, &m_midi_decoder) < 0)
+        m_midi_decoder = nullptr;
 
 #ifdef SEQ64_LASH_SUPPORT
 
@@ -193,6 +202,11 @@ mastermidibus::~mastermidibus ()
         delete [] m_poll_descriptors;
         m_poll_descriptors = nullptr;
     }
+    if (not_nullptr(m_midi_decoder))
+    {
+        snd_midi_event_free(m_midi_decoder);
+        m_midi_decoder = nullptr;
+    }
 }
 
 /**
@@ -649,7 +663,7 @@ mastermidibus::api_get_midi_event (event * inev)
     snd_seq_event_t * ev;
     bool sysex = false;
     bool result = false;
-    midibyte buffer[0x1000];                /* temporary buffer for MIDI data */
+    midibyte buffer[SEQ64_MIDI_DECODE_SIZE];    /* temp buffer for MIDI data  */
     snd_seq_event_input(m_alsa_seq, &ev);
     if (! rc().manual_alsa_ports())
     {
@@ -679,8 +693,11 @@ mastermidibus::api_get_midi_event (event * inev)
     if (result)
         return false;
 
-    snd_midi_event_t * midi_ev;                     /* for ALSA MIDI parser  */
-    snd_midi_event_new(sizeof(buffer), &midi_ev);   /* make ALSA MIDI parser */
+    snd_midi_event_t * midi_ev = m_midi_decoder;   /* ALSA MIDI parser     */
+    if (is_nullptr(midi_ev))
+        return false;
+
+    snd_midi_event_reset_decode(midi_ev);
     long bytes = snd_midi_event_decode(midi_ev, buffer, sizeof(buffer), ev);
     if (bytes <= 0)                                 /* happens at startup    */
         return false;
@@ -732,7 +749,6 @@ mastermidibus::api_get_midi_event (event * inev)
         else
             sysex = false;
     }
-    snd_midi_event_free(midi_ev);
     return true;
 }
 
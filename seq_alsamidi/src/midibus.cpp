@@ -44,6 +44,14 @@
 namespace seq64
 {
 
+/**
+ *  Defines the size of the MIDI event buffer, which should be large enough to
+ *  accomodate the largest MIDI message to be encoded.
+ *  A local define for visibility.
+ */
+
+#define SEQ64_MIDI_EVENT_SIZE_MAX   10
+
 /**
  *  Creates a normal ALSA MIDI port, which will correspond to an existing
  *  system ALSA port, such as one provided by Timidity.  Provides a
@@ -123,9 +131,11 @@ midibus::midibus
     m_dest_addr_port    (destport),     // actually the port ID
     m_local_addr_client (localclient),
     m_local_addr_port   (-1),
-    m_input_port_name   (rc().app_client_name() + " in")
+    m_input_port_name   (rc().app_client_name() + " in"),
+    m_midi_encoder      (nullptr)
 {
-    // Functionality moved into the base class
+    if (snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &m_midi_encoder) < 0)
+        m_midi_encoder = nullptr;
 }
 
 /**
@@ -178,18 +188,21 @@ midibus::midibus
     m_dest_addr_port    (SEQ64_NO_PORT),
     m_local_addr_client (localclient),
     m_local_addr_port   (SEQ64_NO_PORT),
-    m_input_port_name   (rc().app_client_name() + " in")
+    m_input_port_name   (rc().app_client_name() + " in"),
+    m_midi_encoder      (nullptr)
 {
-    // Functionality moved to the base class
+    if (snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &m_midi_encoder) < 0)
+        m_midi_encoder = nullptr;
 }
 
 /**
- *  A rote empty destructor.
+ *  Frees the ALSA MIDI encoder.
  */
 
 midibus::~midibus()
 {
-    // empty body
+    if (not_nullptr(m_midi_encoder))
+        snd_midi_event_free(m_midi_encoder);
 }
 
 /**
@@ -441,19 +454,12 @@ midibus::api_deinit_in ()
     return true;
 }
 
-/**
- *  Defines the size of the MIDI event buffer, which should be large enough to
- *  accomodate the largest MIDI message to be encoded.
- *  A local define for visibility.
- */
-
-#define SEQ64_MIDI_EVENT_SIZE_MAX   10
-
 /**
  *  This play() function takes a native event, encodes it to an ALSA MIDI
  *  sequencer event, sets the broadcasting to the subscribers, sets the
  *  direct-passing mode to send the event without queueing, and puts it in the
- *  queue.
+ *  queue.  The encoder is created once by the constructor, and reset here,
+ *  so this function does not allocate.
  *
  * \threadsafe
  *
@@ -473,13 +479,13 @@ midibus::api_play (event * e24, midibyte channel)
     buffer[0] += (channel & 0x0F);
     e24->get_data(buffer[1], buffer[2]);            /* set MIDI data        */
 
-    snd_midi_event_t * midi_ev;                     /* ALSA MIDI parser     */
-    snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &midi_ev);
+    if (is_nullptr(m_midi_encoder))
+        return;
 
     snd_seq_event_t ev;
     snd_seq_ev_clear(&ev);                          /* clear event          */
-    snd_midi_event_encode(midi_ev, buffer, 3, &ev); /* encode 3 raw bytes   */
-    snd_midi_event_free(midi_ev);                   /* free the parser      */
+    snd_midi_event_reset_encode(m_midi_encoder);    /* no running status    */
+    snd_midi_event_encode(m_midi_encoder, buffer, 3, &ev);
     snd_seq_ev_set_source(&ev, m_local_addr_port);  /* set source           */
     snd_seq_ev_set_subs(&ev);
     snd_seq_ev_set_direct(&ev);                     /* it is immediate      */
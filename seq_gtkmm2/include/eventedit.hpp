@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-12-05
- * \updates       2016-07-28
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The Event Editor complements the Pattern (Sequence) Editor by allowing the
@@ -178,6 +178,7 @@ private:
     void handle_delete ();
     void handle_insert ();
     void handle_modify ();
+    void handle_locate ();
     void handle_save ();
     void handle_cancel ();
 
@@ -28,13 +28,16 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2015-12-05
- * \updates       2017-07-30
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
- *  This class supports the left side of the Event Editor window.
+ *  This class supports the left side of the Event Editor window.  It no
+ *  longer works on a full copy of the sequence; it draws the visible lines
+ *  from an editable_events_view, which makes rows only for those lines, and
+ *  applies each edit directly to the sequence.
  */
 
-#include "editable_events.hpp"          /* seq64::editable_events container  */
+#include "editable_events_view.hpp"     /* seq64::editable_events_view      */
 #include "gui_drawingarea_gtk2.hpp"
 
 /**
@@ -88,12 +91,12 @@ private:
     sequence & m_seq;
 
     /**
-     *  Holds the editable events for this sequence.  This container is what
-     *  is edited, and any changes made to it are not saved to the container
-     *  until the user pushes the "save" button.
+     *  Provides the index of the events of this sequence, and makes the
+     *  editable events for the lines shown.  Edits made through it are
+     *  applied to the sequence immediately, each one undoable.
      */
 
-    editable_events m_event_container;
+    editable_events_view m_events;
 
     /**
      *  Provides the number of the characters in the name box.  Pretty much
@@ -139,13 +142,6 @@ private:
 
     int m_event_count;
 
-    /**
-     *  Holds the previous length of the edited sequence, in MIDI pulses, so
-     *  that we can detect changes in the length of the sequence.
-     */
-
-    midipulse m_last_max_timestamp;
-
     /**
      *  Holds the current number of measures, for display purposes.
      */
@@ -177,7 +173,7 @@ private:
     /**
      *  The index of the event that is 0th in the visible list of events.
      *  It is used in numbering the events that are shown in the event-slot
-     *  frame.  Do not confuse it with m_current_index, which is relative to
+     *  frame, and in getting their rows from m_events.  Do not confuse it with m_current_index, which is relative to
      *  the frame, not the container-beginning.
      */
 
@@ -185,33 +181,12 @@ private:
 
     /**
      *  Indicates the index of the current event within the frame.
-     *  This event will also be pointed to by the m_current_event iterator.
      *  Do not confuse it with m_top_index, which is relative to the
      *  container-beginning, not the frame.
      */
 
     int m_current_index;
 
-    /**
-     *  Provides the top "pointer" to the start of the editable-events section
-     *  that is being shown in the user-interface.
-     */
-
-    editable_events::iterator m_top_iterator;
-
-    /**
-     *  Provides the bottom "pointer" to the end of the editable-events section
-     *  that is being shown in the user-interface.
-     */
-
-    editable_events::iterator m_bottom_iterator;
-
-    /**
-     *  Provides the "pointer" to the event currently in focus.
-     */
-
-    editable_events::iterator m_current_iterator;
-
     /**
      *  Indicates the event index that matches the index value of the vertical
      *  pager.
@@ -239,12 +214,12 @@ public:
     }
 
     /**
-     * \getter m_event_container.get_length()
+     * \getter m_events.get_length()
      */
 
-    midipulse get_length () const
+    midipulse get_length ()
     {
-        return m_event_container.get_length();
+        return m_events.get_length();
     }
 
     /**
@@ -339,12 +314,8 @@ private:
     }
 
     bool load_events ();
-    void set_current_event
-    (
-        const editable_events::iterator ei,
-        int index,
-        bool full_redraw = true
-    );
+    void adjust_frame ();
+    void set_current_event (int index, bool full_redraw = true);
     bool insert_event (const editable_event & edev);
     bool insert_event
     (
@@ -362,6 +333,7 @@ private:
         const std::string & evdata1
     );
     bool save_events ();
+    bool locate_time (const std::string & evtimestamp);
     void select_event
     (
         int event_index = SEQ64_NULL_EVENT_INDEX,
@@ -378,18 +350,12 @@ private:
 
     void enqueue_draw ();
     int convert_y (int y);
-    void draw_event (editable_events::iterator ei, int index);
+    void draw_event (int index);
     void draw_events ();
     void change_vert ();
     void page_movement (int new_value);
-    void page_topper (editable_events::iterator newcurrent);
-    int decrement_top ();
-    int increment_top ();
-    int decrement_current ();
-    int increment_current ();
-    int decrement_bottom ();
-    int increment_bottom ();
-    int calculate_measures () const;
+    void page_topper (int row, bool at_top = false);
+    int calculate_measures ();
 
 private:    // Gtk callbacks
 
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-21
- * \updates       2018-02-25
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  We've added a number of wrapper functions for the "draw-rectangle",
@@ -46,6 +46,8 @@
  *  And there are still a number of other Gtk/Gdk functions we could wrap.
  */
 
+#include <vector>                       /* std::vector                      */
+
 #include "font.hpp"                     /* font_render() function           */
 #include "gui_palette_gtk2.hpp"         /* #include <gtkmm/drawingarea.h>   */
 
@@ -343,6 +345,42 @@ protected:
         m_gc->set_line_attributes(width, ls, Gdk::CAP_NOT_LAST, Gdk::JOIN_MITER);
     }
 
+    /**
+     *  Restricts all drawing done with the graphics context to a rectangle,
+     *  until clear_clip() is called.  Used to redraw only the strip exposed
+     *  by scroll_pixmap().
+     *
+     * \param x
+     *      The x coordinate of the rectangle.
+     *
+     * \param y
+     *      The y coordinate of the rectangle.
+     *
+     * \param w
+     *      The width of the rectangle.
+     *
+     * \param h
+     *      The height of the rectangle.
+     */
+
+    void set_clip (int x, int y, int w, int h)
+    {
+        Gdk::Rectangle r(x, y, w, h);
+        m_gc->set_clip_rectangle(r);
+    }
+
+    /**
+     *  Removes the restriction set by set_clip().  A null clip mask means
+     *  "no clipping" to GDK.
+     */
+
+    void clear_clip ()
+    {
+        m_gc->set_clip_mask(Glib::RefPtr<Gdk::Bitmap>());
+    }
+
+    void scroll_pixmap (Glib::RefPtr<Gdk::Pixmap> & pixmap, int dx, int dy);
+
     /**
      *  A small wrapper function to draw a line on the window.
      *
@@ -461,6 +499,12 @@ protected:
         const Color & c, int x1, int y1, int x2, int y2
     );
 
+    void draw_segments
+    (
+        Glib::RefPtr<Gdk::Drawable> & drawable,
+        const Color & c, std::vector<GdkSegment> & segments
+    );
+
     /**
      *  A small wrapper function for readability in string-drawing to the
      *  window.
@@ -0,0 +1,162 @@
+#ifndef SEQ64_GUI_NOTIFIER_GTK2_HPP
+#define SEQ64_GUI_NOTIFIER_GTK2_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          gui_notifier_gtk2.hpp
+ *
+ *  This module declares the object that turns the engine's change
+ *  notifications into redraw "frames" for the gtkmm windows.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  This is the gtkmm counterpart of the Qt qsnotifier.  Instead of each
+ *  window running its own redraw timeout, mainwnd, perfedit, and seqedit
+ *  attach their timeout callbacks to the frame signal of the single
+ *  gui_notifier_gtk2, created by mainwnd.  A frame is scheduled, at most
+ *  one redraw period later, when the engine posts a change (see the
+ *  rt_notify module) or when the user presses a key, clicks, scrolls, or
+ *  drags the mouse.  When nothing happens, no timeout runs at all.
+ */
+
+#include <gdk/gdk.h>                    /* GdkEvent                     */
+#include <glibmm/main.h>                /* Glib::IOCondition            */
+#include <sigc++/sigc++.h>              /* sigc::signal, sigc::slot     */
+
+#include "globals.h"                    /* c_max_sequence               */
+
+/*
+ * Do not document the namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Drains the engine's change notifications and emits the frame signal.
+ */
+
+class gui_notifier_gtk2
+{
+
+private:
+
+    /**
+     *  The single notifier, if one has been created.  Windows created
+     *  without one fall back to their own timeouts.
+     */
+
+    static gui_notifier_gtk2 * sm_instance;
+
+    /**
+     *  The performance object whose changes are drained.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  The read end of the engine's wake-up pipe, or -1 if the platform has
+     *  no pipe, in which case the frame timeout simply runs all of the time.
+     */
+
+    int m_wake_fd;
+
+    /**
+     *  The signal emitted for each frame.  The slots are the old timeout
+     *  callbacks; their return values are ignored.
+     */
+
+    sigc::signal<bool> m_signal_frame;
+
+    /**
+     *  The watch on the wake-up pipe.  Disconnected from the wake-up until
+     *  the frame is emitted, since it would otherwise fire continuously
+     *  while the byte is unread.
+     */
+
+    sigc::connection m_io_connect;
+
+    /**
+     *  The single-shot timeout that delays a frame by up to one redraw
+     *  period, to coalesce all of the changes made in that period.
+     *  Connected only while a frame is scheduled.
+     */
+
+    sigc::connection m_frame_connect;
+
+    /**
+     *  The redraw period, in milliseconds.
+     */
+
+    int m_redraw_period_ms;
+
+    /**
+     *  The changes drained for the frame being emitted.
+     */
+
+    unsigned m_changes;
+
+    /**
+     *  The sequences changed in the frame being emitted.
+     */
+
+    bool m_sequences[c_max_sequence];
+
+public:
+
+    gui_notifier_gtk2 (perform & p);
+    ~gui_notifier_gtk2 ();
+
+    static sigc::connection attach
+    (
+        const sigc::slot<bool> & callback, int interval
+    );
+    static unsigned current_changes ();
+    static bool sequence_changed (int seq);
+
+private:
+
+    void watch ();
+    void schedule ();
+    bool wake (Glib::IOCondition condition);
+    bool emit_frame ();
+
+    static void filter_event (GdkEvent * ev, gpointer data);
+
+    gui_notifier_gtk2 (const gui_notifier_gtk2 &);              /* no copy  */
+    gui_notifier_gtk2 & operator = (const gui_notifier_gtk2 &); /* no copy  */
+
+};          // class gui_notifier_gtk2
+
+}           // namespace seq64
+
+#endif      // SEQ64_GUI_NOTIFIER_GTK2_HPP
+
+/*
+ * gui_notifier_gtk2.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
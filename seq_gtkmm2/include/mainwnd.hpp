@@ -98,6 +98,7 @@ namespace Gtk
 
 namespace seq64
 {
+    class gui_notifier_gtk2;
     class maintime;
     class options;
     class perfedit;
@@ -490,11 +491,25 @@ private:
     bool m_is_running;
 
     /**
-     *  Provides a timeout handler.
+     *  Turns the engine's change notifications into redraw frames for this
+     *  window, the song editors, and the pattern editors.
+     */
+
+    gui_notifier_gtk2 * m_notifier;
+
+    /**
+     *  Provides the redraw handler, called for each frame of m_notifier.
      */
 
     sigc::connection m_timeout_connect;
 
+    /**
+     *  Provides the handler for the checks that must run even while the
+     *  GUI is idle, and so cannot wait for a frame.
+     */
+
+    sigc::connection m_check_connect;
+
 #ifdef SEQ64_MAINWND_TAP_BUTTON
 
     /**
@@ -656,6 +671,7 @@ private:
     void toggle_playing ();
 
     bool timer_callback ();
+    bool check_callback ();
     int set_screenset (int screenset);
 
 #ifdef SEQ64_MAINWND_TAP_BUTTON
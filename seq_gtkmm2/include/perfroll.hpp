@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
@@ -396,9 +396,24 @@ protected:
     void convert_x (int x, midipulse & tick);
     void snap_x (int & x);
     void snap_y (int & y);
-    void draw_sequence_on (int seqnum);         /* perform::SeqOperation    */
+    void draw_sequence_on (int seqnum, int x0, int x1);
     void draw_background_on (int seqnum);
     void draw_drawable_row (int y);
+    void scroll_and_draw (int dx, int dy);
+    void draw_area (int x, int y, int w, int h);
+
+    /**
+     *  Draws the triggers of a sequence across the whole width of the
+     *  window.
+     *
+     * \param seqnum
+     *      The sequence to draw.
+     */
+
+    void draw_sequence_on (int seqnum)          /* perform::SeqOperation    */
+    {
+        draw_sequence_on(seqnum, 0, m_window_x);
+    }
 
 #ifdef SEQ64_SONG_BOX_SELECT
 
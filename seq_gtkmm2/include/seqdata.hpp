@@ -29,7 +29,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-06-02
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The data pane is the drawing-area below the seqedit's event area, and
@@ -37,6 +37,7 @@
  *  The height of the vertical lines is editable via the mouse.
  */
 
+#include "data_lane.hpp"                /* seq64::data_lane                 */
 #include "globals.h"
 #include "gui_drawingarea_gtk2.hpp"
 #include "midibyte.hpp"                 /* seq64::midibyte typedef          */
@@ -157,6 +158,14 @@ private:
 
     bool m_dragging;
 
+    /**
+     *  The events being edited, reduced to one bar per pixel column.  It is
+     *  rebuilt only when the sequence, zoom, or kind of event changes;
+     *  scrolling only changes which of its bars are drawn.
+     */
+
+    data_lane m_lane;
+
 public:
 
     seqdata (sequence & seq, perform & p, int zoom, Gtk::Adjustment & hadjust);
@@ -28,7 +28,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  We are currently moving toward making this class a base class.
@@ -37,6 +37,7 @@
  *  progress bar during playback.  See the seqroll::m_progress_follow member.
  */
 
+#include "event_summary.hpp"            /* seq64::event_summary     */
 #include "globals.h"
 #include "gui_drawingarea_gtk2.hpp"
 #include "rect.hpp"                     /* seq64::rect class        */
@@ -299,6 +300,16 @@ protected:
 
     int m_scroll_offset_y;
 
+    /**
+     *  The scroll offsets, in pixels, at which m_background and m_pixmap
+     *  were last drawn or scrolled, or -1 if they have not been drawn.
+     *  change_horz() and change_vert() compare them to the new offsets, so
+     *  that the pixmaps can be scrolled instead of redrawn.
+     */
+
+    int m_drawn_scroll_x;
+    int m_drawn_scroll_y;
+
     /**
      *  Provides the current scroll page in which the progress bar resides.
      */
@@ -357,6 +368,15 @@ protected:
 
     midibyte m_cc;
 
+    /**
+     *  Per-pixel summaries of the notes of the sequence and of the
+     *  background sequence, drawn instead of the individual notes when the
+     *  pattern is very dense at the current zoom.
+     */
+
+    event_summary m_summary;
+    event_summary m_background_summary;
+
 public:
 
     seqroll
@@ -439,12 +459,15 @@ public:
     void update_pixmap ();
     void update_sizes ();
     void update_background ();
+    void draw_background (int x0, int x1);
     void draw_background_on_pixmap ();
     void draw_events_on_pixmap ();
     void draw_selection_on_window ();
     void draw_progress_on_window ();
     void reset ();
     void update_and_draw (int force = false);
+    void scroll_and_draw ();
+    void draw_area (int x, int y, int w, int h);
     void redraw ();
     void redraw_events ();
     void start_paste ();
@@ -568,7 +591,25 @@ protected:
     (
         midipulse & tick_s, int & note_h, midipulse & tick_f, int & note_l
     );
-    void draw_events_on (Glib::RefPtr<Gdk::Drawable> draw);
+    void draw_events_on (Glib::RefPtr<Gdk::Drawable> draw, int x0, int x1);
+
+    /**
+     *  Draws the events across the whole width of the window.
+     *
+     * \param draw
+     *      The "drawable" area to draw on.
+     */
+
+    void draw_events_on (Glib::RefPtr<Gdk::Drawable> draw)
+    {
+        draw_events_on(draw, 0, m_window_x);
+    }
+
+    void draw_summary_on
+    (
+        Glib::RefPtr<Gdk::Drawable> draw, sequence & s,
+        event_summary & summary, midipulse starttick, midipulse endtick
+    );
     int idle_redraw ();
     int idle_progress ();
     void change_horz ();
@@ -108,15 +108,6 @@ private:
 
     // virtual void force_draw ();
 
-    /**
-     *  Simply returns true.
-     */
-
-    bool idle_progress ()
-    {
-        return true;
-    }
-
 private:          // callbacks
 
     void on_realize ();
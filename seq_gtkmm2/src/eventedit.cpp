@@ -25,15 +25,16 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-12-05
- * \updates       2018-03-25
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  * To consider:
  *
  *      -   Selecting multiple events?
  *      -   Looping over multiple events for play/stop?
- *      -   Undo?  Currently, one can only exit the dialog without saving the
- *          edits to the sequence.
+ *      -   Edits are now applied to the sequence as they are made, each
+ *          with its own undo entry, so they can be undone in the pattern
+ *          editor.  Closing the dialog no longer discards them.
  *
  * Current bugs to fix:
  *
@@ -287,8 +288,8 @@ eventedit::eventedit (perform & p, sequence & seq)
     add_tooltip
     (
         m_button_save,
-        "Save the edit.  Copies the edited events back to the sequence, "
-        "making them permanent, but does not close the dialog."
+        "Edits are applied to the sequence as they are made.  This button "
+        "marks the song as modified, but does not close the dialog."
     );
 
     m_button_cancel->set_label("Close");
@@ -299,9 +300,9 @@ eventedit::eventedit (perform & p, sequence & seq)
     add_tooltip
     (
         m_button_cancel,
-        "Abort the edit and close the dialog.  Any changes made in this "
-        "window are thrown away (without prompting), unless the Save button "
-        "was pressed."
+        "Close the dialog.  Changes made in this window have already been "
+        "applied to the sequence; use Undo in the pattern editor to revert "
+        "them."
     );
 
     char temptext[40];
@@ -383,7 +384,12 @@ eventedit::eventedit (perform & p, sequence & seq)
         "Timestamp field.  Currently only the 'measures:beats:divisions' "
         "format is supported. Measure and beat numbers start at 1, not 0. "
         "As a shortcut, the divisions number can be a dollar sign ($), "
-        "to indicate the PPQN value minus 1."
+        "to indicate the PPQN value minus 1.  Press Enter to jump to the "
+        "first event at or after this time."
+    );
+    m_entry_ev_timestamp->signal_activate().connect
+    (
+        sigc::mem_fun(*this, &eventedit::handle_locate)
     );
     m_editbox->pack_start(*m_entry_ev_timestamp, false, false);
 
@@ -700,6 +706,7 @@ eventedit::handle_delete ()
         m_button_del->set_sensitive(false);
         m_button_modify->set_sensitive(false);
     }
+    v_adjustment(m_eventslots->pager_index());
 }
 
 /**
@@ -751,14 +758,30 @@ eventedit::handle_modify ()
         std::string data1 = m_entry_ev_data_1->get_text();
         (void) m_eventslots->modify_current_event(ts, name, data0, data1);
         set_seq_count();
+        v_adjustment(m_eventslots->pager_index());
+    }
+}
+
+/**
+ *  Jumps to the first event at or after the time in the timestamp field.
+ *  Called when Enter is pressed in that field.
+ */
+
+void
+eventedit::handle_locate ()
+{
+    if (not_nullptr(m_eventslots))
+    {
+        std::string ts = m_entry_ev_timestamp->get_text();
+        if (m_eventslots->locate_time(ts))
+            v_adjustment(m_eventslots->pager_index());
     }
 }
 
 /**
- *  Handles saving the edited data back to the original sequence.
- *  The event list in the original sequence is cleared, and the editable
- *  events are converted to plain events, and added to the container, one by
- *  one.
+ *  Handles the Save button.  The edits have already been applied to the
+ *  sequence, one by one, so all that is left is to mark the song as
+ *  modified and clear the modified status of the dialog.
  *
  * \todo
  *      Could also support writing the events to a new sequence, for added
@@ -772,12 +795,13 @@ eventedit::handle_save ()
     {
         bool ok = m_eventslots->save_events();
         if (ok)
-            m_button_save->set_sensitive(false);
+            perf_modify();
     }
 }
 
 /**
- *  Cancels the edits and closes the dialog box.  In order for removing the
+ *  Closes the dialog box.  The edits have already been applied to the
+ *  sequence, so there is nothing to discard.  In order for removing the
  *  current-highlighting in the mainwd or perfedit windows, some of the work
  *  of handle_close() needs to be done here as well.
  */
@@ -979,11 +1003,13 @@ eventedit::on_key_press_event (GdkEventKey * ev)
         {
             result = true;
             m_eventslots->on_move_down();
+            v_adjustment(m_eventslots->pager_index());
         }
         else if (key == SEQ64_Up)
         {
             result = true;
             m_eventslots->on_move_up();
+            v_adjustment(m_eventslots->pager_index());
         }
         else if (key == SEQ64_Page_Down)
         {
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Chris Ahlstrom
  * \date          2015-12-05
- * \updates       2018-08-10
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This module is user-interface code.  It is loosely based on the workings
@@ -35,11 +35,11 @@
  *  test tune, where X stops the application and Gtk says it got a bad memory
  *  allocation.  So we need to page through the sequence.
  *
- *  Also note that, currently, the editable_events container does not support
- *  a verify_and_link() function like that of the event_list container.
- *  Eventually, we want to support that feature, so that we can delete a Note
- *  On event and have the corresponding Note Off event automatically deleted
- *  as well.
+ *  Paging used to walk a full editable copy of the sequence with iterators.
+ *  Now the frame is just a top index and a line count into an
+ *  editable_events_view, which indexes the sequence's own events and makes
+ *  editable events only for the lines drawn.  Edits go straight to the
+ *  sequence, where verify_and_link() keeps the note pairs linked.
  */
 
 #include <gtkmm/adjustment.h>
@@ -49,6 +49,7 @@
 #include "eventedit.hpp"
 #include "perform.hpp"
 #include "eventslots.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 
 /*
  * Do not document the namespace; it breaks Doxygen.
@@ -84,23 +85,19 @@ eventslots::eventslots
     gui_drawingarea_gtk2    (p, adjustment_dummy(), vadjust, 360, 10),
     m_parent                (parent),
     m_seq                   (seq),
-    m_event_container       (seq, p.get_beats_per_minute()),
+    m_events                (seq, p.get_beats_per_minute()),
     m_slots_chars           (64),
     m_char_w                (font_render().char_width()),
     m_setbox_w              (m_char_w),
     m_slots_x               (m_slots_chars * m_char_w),
     m_slots_y               (font_render().char_height() + 4),
     m_event_count           (0),
-    m_last_max_timestamp    (0),
     m_measures              (0),
     m_line_count            (0),
     m_line_maximum          (43),   /* need a way to calculate this value   */
     m_line_overlap          (5),
     m_top_index             (0),
     m_current_index         (SEQ64_NULL_EVENT_INDEX),   /* -1 */
-    m_top_iterator          (),
-    m_bottom_iterator       (),
-    m_current_iterator      (),
     m_pager_index           (0)
 {
     load_events();
@@ -108,61 +105,59 @@ eventslots::eventslots
 }
 
 /**
- *  Grabs the event list from the sequence and uses it to fill the
- *  editable-event list.  Determines how many events can be shown in the
- *  GUI [later] and adjusts the top and bottom editable-event iterators to
- *  show the first page of events.
+ *  Indexes the events of the sequence and sets up the frame to show the
+ *  first page of events.  No editable events are made here; they are made
+ *  as lines are drawn.
  *
  * \return
- *      Returns true if the event iterators were able to be set up as valid.
+ *      Returns true if the sequence has events to show.
  */
 
 bool
 eventslots::load_events ()
 {
-    bool result = m_event_container.load_events();
-    if (result)
-    {
-        m_event_count = m_event_container.count();
-        if (m_event_count > 0)
-        {
-            if (m_event_count < m_line_count)
-                m_line_count = m_event_count;
-            else
-                m_line_count = m_line_maximum;
+    m_top_index = m_pager_index = 0;
+    adjust_frame();
 
-            m_current_iterator = m_bottom_iterator =
-                m_top_iterator = m_event_container.begin();
-
-            for (int i = 0; i < m_line_count - 1; ++i)
-            {
-                if (increment_bottom() == SEQ64_NULL_EVENT_INDEX)
-                    break;
-            }
-        }
-        else
-            result = false;
-    }
-    if (! result)
-    {
-        m_line_count = 0;
-        m_current_iterator = m_bottom_iterator =
-            m_top_iterator = m_event_container.end();
-    }
+    bool result = m_event_count > 0;
+    m_current_index = result ? 0 : SEQ64_NULL_EVENT_INDEX ;
     return result;
 }
 
+/**
+ *  Brings the event count up to date with the sequence, which might have
+ *  been changed by an edit here or elsewhere, and keeps the frame within
+ *  the events.  The line count is the smaller of the event count and the
+ *  line maximum.
+ */
+
+void
+eventslots::adjust_frame ()
+{
+    m_event_count = m_events.count();
+    m_line_count = m_event_count < m_line_maximum ?
+        m_event_count : m_line_maximum ;
+
+    int maxtop = m_event_count - m_line_count;
+    if (m_top_index > maxtop)
+        m_top_index = maxtop;
+
+    if (m_top_index < 0)
+        m_top_index = 0;
+
+    if (m_current_index >= m_line_count)
+        m_current_index = m_line_count - 1;
+}
+
 /**
  *  Set the current event, which is the event that is highlighted.  Note in
  *  the snprintf() calls that the first digit is part of the data byte, so
  *  that translation is easier.
  *
- * \param ei
- *      The iterator that points to the event.
- *
  * \param index
  *      The index (re 0) of the event, starting at the top line of the frame.
- *      It is a frame index, not a container index.
+ *      It is a frame index, not a container index.  The caller makes sure
+ *      that it is valid.
  *
  * \param full_redraw
  *      If true (the default) does a full redraw of the frame.  Otherwise,
@@ -173,16 +168,11 @@ eventslots::load_events ()
  */
 
 void
-eventslots::set_current_event
-(
-    const editable_events::iterator ei,
-    int index,
-    bool full_redraw
-)
+eventslots::set_current_event (int index, bool full_redraw)
 {
     std::string data_0;
     std::string data_1;
-    const editable_event & ev = EEDREF(ei);
+    const editable_event & ev = m_events.row(m_top_index + index);
     if (ev.is_ex_data())
     {
         data_0 = ev.ex_data_string();
@@ -203,11 +193,10 @@ eventslots::set_current_event
         data_0, data_1
     );
     m_current_index = index;
-    m_current_iterator = ei;
     if (full_redraw)
         enqueue_draw();
     else
-        draw_event(m_current_iterator, m_current_index);
+        draw_event(m_current_index);
 }
 
 /**
@@ -247,30 +236,14 @@ eventslots::set_text
 }
 
 /**
- *  Inserts an event.  What actually happens here depends if the new event is
- *  before the frame, within the frame, or after the frame, based on the
- *  timestamp.  Also, we want to allow the lengthening of a sequence by
- *  inserting an event past its current length.  Especially useful for the
- *  tempo track.
- *
- *  If before the frame: To keep the previous events visible, we do not need
- *  to increment the iterators (insertion does not affect multimap iterators),
- *  but we do need to increment their indices.  The contents shown in the frame
- *  should not change.
- *
- *  If at the frame top:  The new timestamp equals the top timestamp. We don't
- *  know exactly where the new event goes in the multimap, but we do have an
- *  new event.
+ *  Inserts an event into the sequence, and moves the frame so that the new
+ *  event is shown and current.  We allow the lengthening of a sequence by
+ *  inserting an event past its current length, especially useful for the
+ *  tempo track; editable_events_view::insert() takes care of that.
  *
- *  If at the frame bottom:  TODO
- *
- *  If after the frame: No action needed if the bottom event is actually at
- *  the bottom of the frame.  But if the frame is not yet filled, we need to
- *  increment the bottom iterator, and its index.
- *
- * \note
- *      Actually, it is far easier to just adjust all the counts and iterators
- *      and redraw the screen, as done by the page_topper() function.
+ *  Since the frame is just a range of indices into the sequence, there is
+ *  no need to fix up any iterators here; the index is rebuilt on the next
+ *  access, and the new event is found by a binary search on its time stamp.
  *
  * \param edev
  *      The event to insert, prebuilt.
@@ -282,46 +255,12 @@ eventslots::set_text
 bool
 eventslots::insert_event (const editable_event & edev)
 {
-    bool result = m_event_container.add(edev);
+    bool result = m_events.insert(edev);
     if (result)
     {
-        m_event_count = m_event_container.count();
-        if (m_event_count == 1)
-        {
-            m_line_count = 1;           /* used in drawing in a bit */
-            m_top_index = 0;
-            m_current_index = 0;
-            m_top_iterator = m_current_iterator =
-                m_bottom_iterator = m_event_container.begin();
-
-            m_parent.set_dirty();
-            select_event(m_current_index);
-        }
-        else
-        {
-            /*
-             * This iterator is a short-lived [changed after the next add()
-             * call] pointer to the added event.  This check somehow breaks
-             * the redisplay of the modified event list.
-             *
-             * if (m_event_container.is_valid_iterator(nev))
-             */
-
-            editable_events::iterator nev = m_event_container.current_event();
-            m_parent.set_dirty();
-            page_topper(nev);
-        }
-
-        /*
-         * Now see if the timestamp of the new event is past the end of the
-         * sequence.  In this case, we will allow the sequence to increase in
-         * length.  We also need to account for any change in length.
-         */
-
-        if (get_length() > m_last_max_timestamp)
-        {
-            m_last_max_timestamp = get_length(); // m_parent.set_dirty();
-        }
+        adjust_frame();
+        m_parent.set_dirty();
+        page_topper(m_events.locate(edev));
     }
     return result;
 }
@@ -364,7 +303,7 @@ eventslots::insert_event
 )
 {
     seq64::event e;                                 /* new default event    */
-    editable_event edev(m_event_container, e);
+    editable_event edev(m_events.parent(), e);
     edev.set_status_from_string(evtimestamp, evname, evdata0, evdata1);
 
     /*
@@ -378,56 +317,14 @@ eventslots::insert_event
 }
 
 /**
- *  Deletes the current event, and makes adjustments due to that deletion.
- *
- *  To delete the current event, this function moves the current iterator to
- *  the next event, deletes the previously-current iterator, adjusts the event
- *  count and the bottom iterator, and redraws the pixmap.  The exact changes
- *  depend upon whether the deleted event was at the top of the visible frame,
- *  within the visible frame, or at the bottom the visible frame.  Note that
- *  only visible events can be the current event, and thus get deleted.
- *
-\verbatim
-         Event Index
-          0
-          1
-          2         Top
-          3  <--------- Top case: The new top iterator, index becomes 2
-          4
-          .
-          .         Inside of Visible Frame
-          .
-         43
-         44         Bottom
-         45  <--------- Top case: The new bottom iterator, index becomes 44
-         46             Bottom case: Same result
-\endverbatim
- *
- *  Basically, when an event is deleted, the frame (delimited by the
- *  event-index members) stays in place, while the frame iterators move to the
- *  previous event.  If the top of the frame would move to before the first
- *  event, then the frame must shrink.
+ *  Deletes the current event from the sequence, and makes adjustments due to
+ *  that deletion.
  *
- *  Top case: If the current iterator is the top (of the frame) iterator, then
- *  the top iterator needs to be incremented.  The new top event has the same
- *  index as the now-gone top event. The index of the bottom event is
- *  decremented, since an event before it is now gone.  The bottom iterator
- *  moves to the next event, which is now at the bottom of the frame.  The
- *  current event is treated like the top event.
- *
- *  Inside case: If the current iterator is in the middle of the frame, the top
- *  iterator and index remain unchanged.  The current iterator is incremented,
- *  but its index is now the same as the old bottom index.  Same for the bottom
- *  iterator.
- *
- *  Bottom case: If the current iterator (and bottom iterator) point to the
- *  last event in the frame, then both of them need to be
- *  decremented.  The frame needs to be moved up by one event, so that the
- *  current event remains at the bottom (it's just simpler to manage that way).
- *
- *  If there is no event after the bottom of the frame, the iterators that now
- *  point to end() must backtrack one event.  If the container becomes empty,
- *  then everything is invalidated.
+ *  The frame stays in place, and the event that followed the deleted event
+ *  becomes current, at the same line.  If the deleted event was the last
+ *  one, the previous event becomes current.  If the frame would then extend
+ *  past the last event, adjust_frame() moves it up, or shrinks it if there
+ *  are fewer events than lines.
  *
  * \return
  *      Returns true if the delete was possible.  If the container was empty
@@ -437,111 +334,39 @@ eventslots::insert_event
 bool
 eventslots::delete_current_event ()
 {
-    bool result = m_event_count > 0;
-    if (result)
-        result = m_current_iterator != m_event_container.end();
-
+    bool result = m_event_count > 0 && m_current_index >= 0;
     if (result)
     {
-        editable_events::iterator oldcurrent = m_current_iterator;
-        int oldcount = m_event_container.count();
-        if (oldcount > 1)
+        int row = m_top_index + m_current_index;
+        result = m_events.remove(row);
+        if (result)
         {
-            if (m_current_index == 0)
-            {
-                (void) increment_top();         /* bypass to-delete event   */
-                (void) increment_current();     /* ditto                    */
-                (void) increment_bottom();      /* next event up to bottom  */
-            }
-            else if (m_current_index == (m_line_count - 1))
+            m_parent.set_dirty();
+            adjust_frame();
+            result = m_event_count > 0;
+            if (result)
             {
-                /*
-                 * If we are before the last event in the event container, we
-                 * can increment the iterators.  Otherwise, we have to back
-                 * off by one so we are above the last event, which will be
-                 * deleted.
-                 */
-
-                if (m_current_index < (m_event_count - 1))
-                {
-                    (void) increment_current();
-                    (void) increment_bottom();
-                }
-                else
-                {
-                    /*
-                     * The frame must shrink.
-                     */
-
-                    m_current_index = decrement_current();
-                    (void) decrement_bottom();
-                    if (m_line_count > 0)
-                        --m_line_count;
-                }
+                if (row >= m_event_count)
+                    row = m_event_count - 1;
+
+                m_pager_index = m_top_index;
+                select_event(row - m_top_index);
             }
             else
             {
-                /*
-                 * \change ca 2016-05-18
-                 *      Try to avoid a crash deleting the last item again
-                 *      (since it is still visible).
-                 *
-                 * (void) increment_current();
-                 * (void) increment_bottom();
-                 */
-
-                if (increment_current() != SEQ64_NULL_EVENT_INDEX)
-                {
-                    (void) increment_bottom();
-                    m_bottom_iterator = m_event_container.end();
-                }
-                else            // if (m_current_index >= 0)  /* issues/26 */
-                    --m_current_index;
-            }
-        }
-
-        /*
-         * Has to be done after the adjustment, otherwise iterators are
-         * invalid and cannot be adjusted.  The remove() function validates
-         * the iterator before trying to delete it.
-         */
-
-        m_event_container.remove(oldcurrent);       /* wrapper for erase()  */
-
-        int newcount = m_event_container.count();
-        if (newcount == 0)
-        {
-            m_top_index = 0;
-            m_current_index = 0;
-            m_top_iterator = m_current_iterator =
-                m_bottom_iterator = m_event_container.end();
-        }
-
-        bool ok = newcount == (oldcount - 1);
-        if (ok)
-        {
-            m_parent.set_dirty();
-            m_event_count = newcount;
-            result = newcount > 0;
-            if (result)
-                select_event(m_current_index);
-            else
+                m_current_index = SEQ64_NULL_EVENT_INDEX;
                 select_event(SEQ64_NULL_EVENT_INDEX);
+            }
         }
     }
     return result;
 }
 
 /**
- *  Modifies the data in the currently-selected event.  If the timestamp has
- *  changed, however, we can't just modify the event in place.  Instead, we
- *  finish modifying the event, but tell the caller to delete and reinsert the
- *  new event (in its proper new location based on timestamp).
- *
- *  This function always copies the original event, modifiies the copy,
- *  deletes the original event, and inserts the "new" event into the
- *  editable-event container.  The insertion takes care of updating any length
- *  increase of the sequence.
+ *  Modifies the data in the currently-selected event.  This function copies
+ *  the current event, modifies the copy, and replaces the original event in
+ *  the sequence with it.  The sequence puts the event in its proper location
+ *  based on the timestamp, and the frame moves to show it there.
  *
  * \param evtimestamp
  *      Provides the new event time-stamp as edited by the user.
@@ -556,7 +381,7 @@ eventslots::delete_current_event ()
  *      Provides the second data byte as edited by the user.
  *
  * \return
- *      Returns true simply if the event-count is greater than 0.
+ *      Returns true if the event was modified.
  */
 
 bool
@@ -568,85 +393,64 @@ eventslots::modify_current_event
     const std::string & evdata1
 )
 {
-    bool result = m_event_count > 0;
-    if (result)
-       result =  m_current_iterator != m_event_container.end();
-
+    bool result = m_event_count > 0 && m_current_index >= 0;
     if (result)
     {
-        /*
-         * We need to make a copy here, because the iterator will get
-         * modified during the deletion-and-insertion process.
-         */
-
-        editable_event ev = EEDREF(m_current_iterator);
+        int row = m_top_index + m_current_index;
+        editable_event ev = m_events.row(row);
         if (! ev.is_ex_data())
             ev.set_channel(m_seq.get_midi_channel());   /* just in case     */
 
         ev.set_status_from_string(evtimestamp, evname, evdata0, evdata1);
-        result = delete_current_event();
+        result = m_events.modify(row, ev);
         if (result)
-            result = insert_event(ev);                  /* full karaoke add */
+        {
+            adjust_frame();
+            m_parent.set_dirty();
+            page_topper(m_events.locate(ev));
+        }
     }
     return result;
 }
 
 /**
- *  Writes the events back to the sequence.  Also sets the dirty flag for the
- *  sequence, via the sequence::add_event() function, but this doesn't seem to
- *  set the perform dirty flag.  So now we pass the modification buck to the
- *  parent, who passes it to the perform object.
- *
- *  We added a copy_events() function in the sequence class to replace
- *  add_event() for the purpose of reconstructing the events container for the
- *  sequence.  It is locked by a mutex, and so will not draw until all is
- *  done, preventing a nasty segfault (all segfaults are nasty).
- *
- *  We create a new plain event container here, and then passing it to the new
- *  locked/threadsafe sequence::copy_events() function that clears the
- *  sequence container and copies the events from the parameter container.
- *
- *  Note that this code will operate event if all events were deleted.
+ *  Formerly wrote the whole edited copy of the events back to the sequence.
+ *  Now every insertion, deletion, and modification is applied to the
+ *  sequence as it is made (with its own undo entry), so there is nothing
+ *  left to copy.
  *
  * \return
- *      Returns true if the operations succeeded.
+ *      Always returns true.
  */
 
 bool
 eventslots::save_events ()
 {
-    bool result = m_event_count >= 0 &&
-        m_event_count == m_event_container.count();
+    return true;
+}
+
+/**
+ *  Moves the frame to the first event at or after the given time, making it
+ *  the top and current event.  The event is found with a binary search of
+ *  the index, so this is fast even for very long sequences.
+ *
+ * \param evtimestamp
+ *      The time to jump to, in the format of the timestamp field.
+ *
+ * \return
+ *      Returns true if there was an event to jump to.
+ */
 
+bool
+eventslots::locate_time (const std::string & evtimestamp)
+{
+    midipulse tick = m_events.parent().string_to_pulses(evtimestamp);
+    int row = m_events.locate(tick);
+    bool result = row >= 0;
     if (result)
     {
-        event_list newevents;
-        for
-        (
-            editable_events::iterator ei = m_event_container.begin();
-            ei != m_event_container.end(); ++ei
-        )
-        {
-            /*
-             * Have to add the seq64 namespace to distinguish it from
-             * Gtk::Widget::event.
-             */
-
-            seq64::event e = EEDREF(ei);        /* actually a conversion    */
-            result = newevents.add(e);
-            if (! result)
-                break;
-        }
-        if (result)
-            result = newevents.count() == m_event_count;
-
-        if (result)
-        {
-            m_seq.copy_events(newevents);                   /* new function */
-            result = m_seq.event_count() == m_event_count;
-            if (result && m_last_max_timestamp > m_seq.get_length())
-                m_seq.set_length(m_last_max_timestamp);
-        }
+        adjust_frame();
+        page_topper(row, true);
     }
     return result;
 }
@@ -656,18 +460,11 @@ eventslots::save_events ()
  *  the Gtk::Adjustment object that the eventedit parent passes to the
  *  gui_drawingarea_gtk2 constructor.
  *
- *  The top-event and bottom-event indices (and their corresponding
- *  editable-event iterators) delimit the part of the event container that is
- *  displayed in the eventslots user-interface.  The top-event index starts at
- *  0, and the bottom-event is larger (initially, by 42 slots).
- *
- *  When the scroll-bar thumb moves up or down, we need to change both event
- *  indices and both event iterators by the corresponding amount.  Luckily,
- *  the std::multimap iterator is bidirectional.
- *
- *  Note that we may need to reduce the movement of events to a value less
- *  than a page; it can be limited backwards by the value of the top index,
- *  and forward by the value of the bottom index.
+ *  The top-event index and the line count delimit the part of the sequence
+ *  that is displayed in the eventslots user-interface.  The top-event index
+ *  starts at 0.  When the scroll-bar thumb moves up or down, the top-event
+ *  index simply becomes the new scroll-bar value, limited so that the frame
+ *  does not extend past the last event.
  */
 
 void
@@ -704,32 +501,8 @@ eventslots::page_movement (int new_value)
         m_pager_index = new_value;
         if (movement != 0)
         {
-            /*
-             * @change ca 2016-10-08
-             *      Issue #38.  We see a double-increment when moving the
-             *      scroll down one slot.  But if we don't do this, the event
-             *      indices at the left always start at 0 at the top of the
-             *      view, no matter what the page.  Weird!
-             */
-
-            m_top_index += movement;
-
-            if (movement > 0)
-            {
-                for (int i = 0; i < movement; ++i)
-                {
-                    (void) increment_top();
-                    (void) increment_bottom();
-                }
-            }
-            else if (movement < 0)
-            {
-                for (int i = 0; i < absmovement; ++i)
-                {
-                    (void) decrement_top();
-                    (void) decrement_bottom();
-                }
-            }
+            m_top_index = new_value;
+            adjust_frame();
 
             /*
              * Don't move the current event (highlighted) unless
@@ -737,99 +510,52 @@ eventslots::page_movement (int new_value)
              */
 
             if (absmovement > 1)
-                set_current_event(m_top_iterator, 0);
+                set_current_event(0);
             else
             {
-                set_current_event
-                (
-                    m_current_iterator, m_current_index + movement
-                );
+                int index = m_current_index - movement;
+                if (index < 0)
+                    index = 0;
+                else if (index >= m_line_count)
+                    index = m_line_count - 1;
+
+                set_current_event(index);
             }
         }
     }
 }
 
 /**
- *  Adjusts the vertical position of the frame according to the given new
- *  bottom iterator.  The adjustment is done "from scratch".  We've found page
- *  movement to be an insoluable problem in some editing circumstances.  So
- *  now we move to the inserted event, and make it the top event.
+ *  Adjusts the vertical position of the frame so that the given event is
+ *  shown, and makes it the current event.  The adjustment is done "from
+ *  scratch".  Always moving an inserted event to the top is a bit annoying,
+ *  so, by default, the frame is moved so that the event is at the bottom.
  *
- *  However, always moving an inserted event to the top is a bit annoying.  So
- *  now we backtrack so that the inserted event is at the bottom.
+ * \param row
+ *      Provides the index of the event, re 0 at the start of the sequence.
  *
- * \param newcurrent
- *      Provides the iterator to the event to be shown at the bottom of the
- *      frame.
+ * \param at_top
+ *      If true, the event is shown at the top of the frame, as for a jump
+ *      to a given time.  The frame cannot move past the last event, though.
  */
 
 void
-eventslots::page_topper (editable_events::iterator newcurrent)
+eventslots::page_topper (int row, bool at_top)
 {
-    bool ok = newcurrent != m_event_container.end();
-    if (ok)
-        ok = m_event_count > 0;
-
-    if (ok)
+    if (row >= 0 && row < m_event_count)
     {
-        editable_events::iterator ei = m_event_container.begin();
-        int botindex = 0;
-        while (ei != newcurrent)
-        {
-            ++botindex;
-            ++ei;
-            if (botindex == m_event_count)
-            {
-                ok = false;                     /* never found the event!   */
-                break;
-            }
-        }
         if (m_event_count <= m_line_maximum)    /* fewer events than lines  */
-        {
-            if (ok)
-            {
-                m_pager_index = 0;
-                m_top_index = 0;
-                m_top_iterator = m_event_container.begin();
-                m_line_count = m_event_count;
-                m_current_iterator = newcurrent;
-                m_current_index = botindex;
-            }
-        }
+            m_top_index = 0;
+        else if (at_top)
+            m_top_index = row;
         else
         {
-            m_line_count = line_maximum();
-            if (ok)
-            {
-                /*
-                 * Backtrack by up to m_line_maximum events so that the new
-                 * event is shown at the bottom or at its natural location; it
-                 * also needs to be the current event, for highlighting.
-                 * Count carefully!
-                 */
-
-                editable_events::iterator ei = m_event_container.begin();
-                int pageup = botindex - line_maximum();
-                if (pageup < 0)
-                {
-                    m_top_index = m_pager_index = pageup = 0;
-                }
-                else
-                {
-                    int countdown = pageup;
-                    while (countdown-- > 0)
-                        ++ei;
-
-                    m_top_index = m_pager_index = pageup + 1;   /* re map   */
-                }
-
-                m_top_iterator = ei;
-                m_current_iterator = newcurrent;
-                m_current_index = botindex - m_top_index;       /* re frame */
-            }
+            int pageup = row - line_maximum() + 1;
+            m_top_index = pageup < 0 ? 0 : pageup ;
         }
-        if (ok)
-            select_event(m_current_index);
+        adjust_frame();
+        m_pager_index = m_top_index;
+        select_event(row - m_top_index);
     }
 }
 
@@ -884,7 +610,7 @@ eventslots::enqueue_draw ()
  */
 
 void
-eventslots::draw_event (editable_events::iterator ei, int index)
+eventslots::draw_event (int index)
 {
     int yloc = m_slots_y * index;
     font::Color col = font::BLACK;
@@ -893,7 +619,7 @@ eventslots::draw_event (editable_events::iterator ei, int index)
         col = font::CYAN_ON_BLACK;      /* BLACK_ON_YELLOW, YELLOW_ON_BLACK */
     }
 
-    editable_event & evp = EEDREF(ei);
+    editable_event & evp = m_events.row(m_top_index + index);
     char tmp[16];
     snprintf(tmp, sizeof tmp, "%4d-", m_top_index + index);
     std::string temp = tmp;
@@ -931,7 +657,9 @@ eventslots::convert_y (int y)
 /**
  *  Draws all of the events in the current eventslots frame.
  *  It first clears the whole bitmap to white, so that no artifacts from the
- *  previous state of the frame are left behind.
+ *  previous state of the frame are left behind.  Only the rows of the lines
+ *  drawn (and a screenful on either side) are kept by m_events, so the
+ *  memory used does not depend on the size of the sequence.
  *
  *  Need to figure out how to calculate the number of displayable events.
  *
@@ -946,27 +674,18 @@ eventslots::draw_events ()
     int lx = m_slots_x;                             //  - 3 - m_setbox_w;
     int ly = m_slots_y * m_line_maximum;           // 42
     draw_rectangle(white(), x, y, lx, ly);          // clear the frame
-    if (m_event_count > 0)                          // m_line_maximum > 0
-    {
-        editable_events::iterator ei = m_top_iterator;
-        for (int ev = 0; ev < m_line_count; ++ev)
-        {
-            if (ei != m_event_container.end())
-            {
-                draw_event(ei, ev);
-                ++ei;
-            }
-            else
-                break;
-        }
-    }
+    adjust_frame();                                 // sequence may change
+    for (int ev = 0; ev < m_line_count; ++ev)
+        draw_event(ev);
+
+    m_events.trim(m_top_index, m_line_maximum);
 }
 
 /**
  *  Selects and highlights the event that is located in the frame at the given
  *  event index.  The event index is provided by converting the y-coordinate of
- *  the mouse pointer into a slot number, and then an event index (actually the
- *  slot-distance from the m_top_iterator.  Confusing, yes no?
+ *  the mouse pointer into a slot number, which is the distance from the top
+ *  line of the frame.
  *
  *  Note that, if the event index is negative, then we just queue up a draw
  *  operation, which should paint an empty frame -- the event container is
@@ -986,182 +705,15 @@ eventslots::select_event (int event_index, bool full_redraw)
 {
     bool ok = event_index != SEQ64_NULL_EVENT_INDEX;
     if (ok)
-        ok = (event_index < m_line_count);  // || (event_index == 0);
+        ok = event_index >= 0 && event_index < m_line_count;
 
     if (ok)
-    {
-        editable_events::iterator ei = m_top_iterator;
-        ok = ei != m_event_container.end();
-        if (ok && (event_index > 0))
-        {
-            int i = 0;
-            while (i++ < event_index)
-            {
-                ++ei;
-                ok = ei != m_event_container.end();
-                if (! ok)
-                    break;
-            }
-        }
-        if (ok)
-            set_current_event(ei, event_index, full_redraw);
-    }
-    else
-        enqueue_draw();                 /* for drawing an empty frame */
-}
+        ok = (m_top_index + event_index) < m_events.count();
 
-/**
- *  Decrements the top iterator, if possible.
- *
- * \return
- *      Returns 0, or SEQ64_NULL_EVENT_INDEX if the iterator could not be
- *      decremented.
- */
-
-int
-eventslots::decrement_top ()
-{
-    if (m_top_iterator != m_event_container.begin())
-    {
-        --m_top_iterator;
-        return m_top_index - 1;
-    }
-    else
-        return SEQ64_NULL_EVENT_INDEX;
-}
-
-/**
- *  Increments the top iterator, if possible.  Also handles the top-event
- *  index, so that the GUI can display the proper event numbers.
- *
- * \return
- *      Returns the top index, or SEQ64_NULL_EVENT_INDEX if the iterator could
- *      not be incremented, or would increment to the end of the container.
- */
-
-int
-eventslots::increment_top ()
-{
-    editable_events::iterator ei = m_top_iterator;
-    if (ei != m_event_container.end())
-    {
-        ++ei;
-        if (ei != m_event_container.end())
-        {
-            m_top_iterator = ei;
-            return m_top_index + 1;
-        }
-        else
-            return SEQ64_NULL_EVENT_INDEX;
-    }
-    else
-        return SEQ64_NULL_EVENT_INDEX;
-}
-
-/**
- *  Decrements the current iterator, if possible.
- *
- * \return
- *      Returns the decremented index, or SEQ64_NULL_EVENT_INDEX if the
- *      iterator could not be decremented.  Remember that the index ranges
- *      only from 0 to m_line_count-1, and that is enforced here.
- */
-
-int
-eventslots::decrement_current ()
-{
-    if (m_current_iterator != m_event_container.begin())
-    {
-        --m_current_iterator;
-        int result = m_current_index - 1;
-        if (result < 0)
-            result = 0;
-
-        return result;
-    }
-    else
-        return SEQ64_NULL_EVENT_INDEX;
-}
-
-/**
- *  Increments the current iterator, if possible.
- *
- * \return
- *      Returns the incremented index, or SEQ64_NULL_EVENT_INDEX if the
- *      iterator could not be incremented.  Remember that the index ranges
- *      only from 0 to m_line_count-1, and that is enforced here.
- */
-
-int
-eventslots::increment_current ()
-{
-    editable_events::iterator ei = m_current_iterator;
-    if (ei != m_event_container.end())
-    {
-        int result = SEQ64_NULL_EVENT_INDEX;
-        ++ei;
-        if (ei != m_event_container.end())
-        {
-            m_current_iterator = ei;
-            result = m_current_index + 1;
-            if (result >= m_line_count)
-                result = m_line_count - 1;
-        }
-        return result;
-    }
-    else
-        return SEQ64_NULL_EVENT_INDEX;
-}
-
-/**
- *  Decrements the bottom iterator, if possible.
- *
- * \return
- *      Returns 0, or SEQ64_NULL_EVENT_INDEX if the iterator could not be
- *      decremented.
- */
-
-int
-eventslots::decrement_bottom ()
-{
-    if (m_bottom_iterator != m_event_container.begin())
-    {
-        --m_bottom_iterator;
-        return 0;
-    }
+    if (ok)
+        set_current_event(event_index, full_redraw);
     else
-        return SEQ64_NULL_EVENT_INDEX;
-}
-
-/**
- *  Increments the bottom iterator, if possible.  There is an issue in paging
- *  down using the scrollbar where, at the bottom of the scrolling, the bottom
- *  iterator ends up bad.  Not yet sure how this happens, so for now we
- *  backtrack one event if this happens.
- *
- * \return
- *      Returns the incremented index, or SEQ64_NULL_EVENT_INDEX if the
- *      iterator could not be incremented.
- */
-
-int
-eventslots::increment_bottom ()
-{
-    int result = SEQ64_NULL_EVENT_INDEX;
-    if (m_bottom_iterator != m_event_container.end())
-    {
-        editable_events::iterator old = m_bottom_iterator++;
-        if (m_bottom_iterator != m_event_container.end())
-            result = 0;
-        else
-        {
-            m_bottom_iterator = old;        /* backtrack to initial value   */
-#ifdef SEQ64_USE_DEBUG_OUTPUT               /* PLATFORM_DEBUG               */
-            errprint("increment to bad bottom iterator");
-#endif
-        }
-    }
-    return result;
+        enqueue_draw();                 /* for drawing an empty frame */
 }
 
 /**
@@ -1206,6 +758,7 @@ eventslots::on_realize ()
 bool
 eventslots::on_expose_event (GdkEventExpose *)
 {
+    rt_trace_span span("eventslots::on_expose_event");
     draw_events();
     return true;
 }
@@ -1304,24 +857,16 @@ eventslots::on_move_up ()
 {
     if (m_current_index == 0)
     {
-        /*
-         * Doesn't work at the top of the frame after the bottom of the
-         * frame is hit.
-         *
-         * page_movement(m_top_index - 1);
-         */
-
-        int new_top_index = decrement_top();
-        if (new_top_index >= 0)
+        if (m_top_index > 0)
         {
-            m_top_index = new_top_index;
+            m_pager_index = --m_top_index;
             select_event(m_current_index);
         }
     }
     else if (m_current_index > 0)                   /* /issues/26           */
     {
         int old_index = m_current_index--;
-        draw_event(m_current_iterator, old_index);
+        draw_event(old_index);
         select_event(m_current_index, false);       /* no full redraw here  */
     }
 }
@@ -1337,27 +882,16 @@ eventslots::on_move_down ()
 {
     if (m_current_index == (m_line_count - 1))
     {
-        if (m_line_count == m_line_maximum)
+        if (m_top_index + m_line_count < m_event_count)
         {
-            /*
-             * Doesn't work at the bottom of the frame.
-             *
-             * (void) increment_current();
-             * page_topper(m_current_iterator);
-             */
-
-            int new_top_index = increment_top();
-            if (new_top_index >= 0)
-            {
-                m_top_index = new_top_index;
-                select_event(m_current_index);
-            }
+            m_pager_index = ++m_top_index;
+            select_event(m_current_index);
         }
     }
     else
     {
         int old_index = m_current_index++;
-        draw_event(m_current_iterator, old_index);
+        draw_event(old_index);
         select_event(m_current_index, false);   /* no full redraw here */
     }
 }
@@ -1400,7 +934,7 @@ void
 eventslots::on_frame_home ()
 {
     if (m_event_count > 0)
-        page_topper(m_event_container.begin());
+        page_topper(0, true);
 }
 
 /**
@@ -1411,11 +945,7 @@ void
 eventslots::on_frame_end ()
 {
     if (m_event_count > 0)
-    {
-        editable_events::iterator ei = m_event_container.end();
-        --ei;
-        page_topper(ei);
-    }
+        page_topper(m_event_count - 1);
 }
 
 /**
@@ -1427,7 +957,7 @@ eventslots::on_frame_end ()
  */
 
 int
-eventslots::calculate_measures () const
+eventslots::calculate_measures ()
 {
     midipulse unitmeasure = seq().unit_measure();
     return 1 + get_length() / unitmeasure;
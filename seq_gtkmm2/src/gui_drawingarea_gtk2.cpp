@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-09-21
- * \updates       2018-02-25
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  */
@@ -472,6 +472,70 @@ gui_drawingarea_gtk2::draw_line
     drawable->draw_line(m_gc, x1, y1, x2, y2);
 }
 
+/**
+ *  Draws a batch of unconnected lines on the drawable, in one call, after
+ *  setting the given foreground color.  Much cheaper than one draw_line()
+ *  call per line when there are many lines.
+ *
+ * \param drawable
+ *      Provides the Gdk::Drawable pointer needed to draw the lines.
+ *
+ * \param c
+ *      The foreground color in which to draw the lines.
+ *
+ * \param segments
+ *      The lines to draw.  Nothing is drawn if empty.
+ */
+
+void
+gui_drawingarea_gtk2::draw_segments
+(
+    Glib::RefPtr<Gdk::Drawable> & drawable,
+    const Color & c, std::vector<GdkSegment> & segments
+)
+{
+    if (! segments.empty())
+    {
+        m_gc->set_foreground(c);
+        drawable->draw_segments(m_gc, &segments[0], int(segments.size()));
+    }
+}
+
+/**
+ *  Moves the contents of a window-sized pixmap to follow a scroll of the
+ *  view, so that only the newly exposed strip needs to be drawn.  The strip
+ *  left behind holds stale pixels; the caller must redraw it.
+ *
+ * \param pixmap
+ *      The pixmap to scroll, normally m_pixmap or a window-sized background.
+ *
+ * \param dx
+ *      The number of pixels the view moved to the right.  The contents
+ *      move to the left by this amount.  Can be negative.
+ *
+ * \param dy
+ *      The number of pixels the view moved down.  Can be negative.
+ */
+
+void
+gui_drawingarea_gtk2::scroll_pixmap
+(
+    Glib::RefPtr<Gdk::Pixmap> & pixmap, int dx, int dy
+)
+{
+    int w = m_window_x - (dx >= 0 ? dx : -dx);
+    int h = m_window_y - (dy >= 0 ? dy : -dy);
+    if (w > 0 && h > 0)
+    {
+        pixmap->draw_drawable                   /* overlapping copy is okay */
+        (
+            m_gc, pixmap,
+            dx > 0 ? dx : 0, dy > 0 ? dy : 0,
+            dx < 0 ? -dx : 0, dy < 0 ? -dy : 0, w, h
+        );
+    }
+}
+
 /**
  *  For this GTK callback, on realization of window, initialize the shiz.
  *  It allocates any additional resources that weren't initialized in the
@@ -0,0 +1,291 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          gui_notifier_gtk2.cpp
+ *
+ *  This module defines the object that turns the engine's change
+ *  notifications into redraw "frames" for the gtkmm windows.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the gui_notifier_gtk2.hpp module for the overview.
+ */
+
+#include <gtk/gtk.h>                    /* gtk_main_do_event()          */
+#include <glibmm/main.h>                /* Glib::signal_io(), etc.      */
+
+#include "gui_notifier_gtk2.hpp"        /* seq64::gui_notifier_gtk2     */
+#include "perform.hpp"                  /* seq64::perform, rt_notify    */
+#include "settings.hpp"                 /* seq64::usr()                 */
+
+/*
+ * Do not document the namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The single notifier.
+ */
+
+gui_notifier_gtk2 * gui_notifier_gtk2::sm_instance = nullptr;
+
+/**
+ *  Principal constructor.  Sets up the watch on the engine's wake-up pipe,
+ *  and an event handler ahead of GTK's own, so that user input also
+ *  schedules a frame.  Any changes already pending are shown in the first
+ *  frame.
+ *
+ * \param p
+ *      The performance object.
+ */
+
+gui_notifier_gtk2::gui_notifier_gtk2 (perform & p)
+ :
+    m_perform           (p),
+    m_wake_fd           (p.changes().wake_fd()),
+    m_signal_frame      (),
+    m_io_connect        (),
+    m_frame_connect     (),
+    m_redraw_period_ms  (usr().window_redraw_rate()),
+    m_changes           (0),
+    m_sequences         ()                  // array
+{
+    if (m_wake_fd >= 0)
+    {
+        watch();
+        schedule();
+    }
+    else                                    /* poll forever if no pipe  */
+    {
+        m_frame_connect = Glib::signal_timeout().connect
+        (
+            sigc::mem_fun(*this, &gui_notifier_gtk2::emit_frame),
+            m_redraw_period_ms
+        );
+    }
+    gdk_event_handler_set(filter_event, this, NULL);
+    sm_instance = this;
+}
+
+/**
+ *  Gives the events back to GTK, drops the watch and the timeout, and
+ *  forgets the single instance.
+ */
+
+gui_notifier_gtk2::~gui_notifier_gtk2 ()
+{
+    gdk_event_handler_set((GdkEventFunc) gtk_main_do_event, NULL, NULL);
+    m_io_connect.disconnect();
+    m_frame_connect.disconnect();
+    if (sm_instance == this)
+        sm_instance = nullptr;
+}
+
+/**
+ *  Connects a window's timeout callback to the frame signal.  If there is
+ *  no notifier, this falls back to the old way of doing things, a
+ *  free-running timeout.
+ *
+ * \param callback
+ *      The callback, normally made by mem_fun() from the window's timeout
+ *      function.  It is disconnected automatically when the window is
+ *      destroyed.
+ *
+ * \param interval
+ *      The redraw interval, in milliseconds, for the fallback timeout.
+ *
+ * \return
+ *      Returns the connection, which the caller may keep to disconnect the
+ *      callback.
+ */
+
+sigc::connection
+gui_notifier_gtk2::attach (const sigc::slot<bool> & callback, int interval)
+{
+    if (not_nullptr(sm_instance))
+        return sm_instance->m_signal_frame.connect(callback);
+    else
+        return Glib::signal_timeout().connect(callback, interval);
+}
+
+/**
+ *  Gets the changes of the frame being emitted, for use by the callbacks.
+ *  Without a notifier, claims that everything changed, so that a window
+ *  never skips a redraw it would have done before.
+ *
+ * \return
+ *      Returns the or'ed change_t values.
+ */
+
+unsigned
+gui_notifier_gtk2::current_changes ()
+{
+    return not_nullptr(sm_instance) ? sm_instance->m_changes : ~0U ;
+}
+
+/**
+ *  Checks if a sequence changed in the frame being emitted.
+ *
+ * \param seq
+ *      The number of the sequence.
+ *
+ * \return
+ *      Returns true if the sequence changed, or if there is no notifier.
+ */
+
+bool
+gui_notifier_gtk2::sequence_changed (int seq)
+{
+    if (is_nullptr(sm_instance))
+        return true;
+
+    return seq >= 0 && seq < c_max_sequence && sm_instance->m_sequences[seq];
+}
+
+/**
+ *  Starts watching the wake-up pipe, unless it is already watched.
+ */
+
+void
+gui_notifier_gtk2::watch ()
+{
+    if (m_wake_fd >= 0 && ! m_io_connect.connected())
+    {
+        m_io_connect = Glib::signal_io().connect
+        (
+            sigc::mem_fun(*this, &gui_notifier_gtk2::wake),
+            m_wake_fd, Glib::IO_IN
+        );
+    }
+}
+
+/**
+ *  Starts the single-shot frame timeout, unless a frame is already
+ *  scheduled.
+ */
+
+void
+gui_notifier_gtk2::schedule ()
+{
+    if (! m_frame_connect.connected())
+    {
+        m_frame_connect = Glib::signal_timeout().connect
+        (
+            sigc::mem_fun(*this, &gui_notifier_gtk2::emit_frame),
+            m_redraw_period_ms
+        );
+    }
+}
+
+/**
+ *  Called when the engine writes to the wake-up pipe.  The pipe is emptied
+ *  in emit_frame(), by rt_notify::drain(); here we only need to schedule
+ *  the frame.
+ *
+ * \return
+ *      Always returns false, which removes the watch until emit_frame()
+ *      restores it.
+ */
+
+bool
+gui_notifier_gtk2::wake (Glib::IOCondition /*condition*/)
+{
+    schedule();
+    return false;
+}
+
+/**
+ *  Drains the pending changes and calls every attached callback.  Then
+ *  restores the watch on the wake-up pipe.
+ *
+ * \return
+ *      Returns false, so that the timeout fires only once, unless there is
+ *      no pipe, in which case the timeout polls forever.
+ */
+
+bool
+gui_notifier_gtk2::emit_frame ()
+{
+    m_changes = m_perform.changes().drain(m_sequences);
+    (void) m_signal_frame.emit();
+    m_changes = 0;
+    watch();
+    return m_wake_fd < 0;
+}
+
+/**
+ *  Sees every GDK event before GTK does, and schedules a frame for any user
+ *  input that might change what a window shows:  keys, clicks, the wheel,
+ *  and mouse drags.  Plain mouse motion is ignored.  The event is then
+ *  handed to GTK as usual.
+ *
+ * \param ev
+ *      The event.
+ *
+ * \param data
+ *      The notifier.
+ */
+
+void
+gui_notifier_gtk2::filter_event (GdkEvent * ev, gpointer data)
+{
+    gui_notifier_gtk2 * notifier = static_cast<gui_notifier_gtk2 *>(data);
+    switch (ev->type)
+    {
+    case GDK_KEY_PRESS:
+    case GDK_KEY_RELEASE:
+    case GDK_BUTTON_PRESS:
+    case GDK_2BUTTON_PRESS:
+    case GDK_3BUTTON_PRESS:
+    case GDK_BUTTON_RELEASE:
+    case GDK_SCROLL:
+
+        notifier->schedule();
+        break;
+
+    case GDK_MOTION_NOTIFY:
+
+        if (ev->motion.state & (GDK_BUTTON1_MASK | GDK_BUTTON2_MASK |
+                GDK_BUTTON3_MASK))
+        {
+            notifier->schedule();
+        }
+        break;
+
+    default:
+
+        break;
+    }
+    gtk_main_do_event(ev);
+}
+
+}           // namespace seq64
+
+/*
+ * gui_notifier_gtk2.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -41,6 +41,7 @@
 
 #include "maintime.hpp"                 /* seq64::maintime class            */
 #include "perform.hpp"                  /* seq64::perform class             */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 
 /**
  *  Static internal constants.  These will eventually be replaced by variables
@@ -140,6 +141,7 @@ maintime::idle_progress (midipulse ticks)
 bool
 maintime::on_expose_event (GdkEventExpose * /* ev */ )
 {
+    rt_trace_span span("maintime::on_expose_event");
     idle_progress(m_tick);               /* idle_progress(0); */
     return true;
 }
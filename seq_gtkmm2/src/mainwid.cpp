@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-03-31
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Note that this representation is, in a sense, inside the mainwnd
@@ -50,6 +50,7 @@
 #include "gui_key_tests.hpp"            /* is_ctrl_key(), etc.              */
 #include "mainwid.hpp"                  /* seq64::mainwid (patterns panel)  */
 #include "perform.hpp"                  /* seq64::perform music control     */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* seq64::usr()                     */
 
 /*
@@ -450,19 +451,14 @@ mainwid::draw_sequence_on_pixmap (int seqnum)
                 draw_rectangle_on_pixmap(fg_color(), x, y, lx, ly, false);
             }
 
+            render_snapshot::pointer snap = seq->snapshot();    // no locking
             int low_note;                                   // for side-effect
             int high_note;                                  // ditto
-            bool have_notes = seq->get_minmax_note_events(low_note, high_note);
+            bool have_notes = snap->minmax(low_note, high_note);
             if (have_notes)
             {
                 int height = high_note - low_note + 2;      // 2-pixel border
                 int len = seq->get_length();
-                midipulse tick_s;
-                midipulse tick_f;
-                int note;
-                bool selected;
-                int velocity;
-                draw_type_t dt;
                 Color drawcolor = fg_color();
                 Color eventcolor = fg_color();
                 if (! seq->get_transposable())
@@ -475,16 +471,14 @@ mainwid::draw_sequence_on_pixmap (int seqnum)
                  * Draw the note events in the sequence.
                  */
 
-                seq->reset_draw_marker();       /* reset container iterator */
-                do
+                const render_snapshot::Notes & notes = snap->notes();
+                render_snapshot::Notes::const_iterator ni;
+                for (ni = notes.begin(); ni != notes.end(); ++ni)
                 {
-                    dt = seq->get_next_note_event           /* side-effects */
-                    (
-                        tick_s, tick_f, note, selected, velocity
-                    );
-                    if (dt == DRAW_FIN)
-                        break;
-
+                    midipulse tick_s = ni->tick_s;
+                    midipulse tick_f = ni->tick_f;
+                    int note = ni->key;
+                    draw_type_t dt = ni->type;
                     int tick_s_x = tick_s * m_seqarea_seq_x / len;
                     int tick_f_x = tick_f * m_seqarea_seq_x / len;
                     int note_y;
@@ -532,8 +526,7 @@ mainwid::draw_sequence_on_pixmap (int seqnum)
                         set_line(Gdk::LINE_SOLID, 1);
                         drawcolor = eventcolor;
                     }
-
-                } while (dt != DRAW_FIN);
+                }
             }
         }
         else                                            /* sequence inactive */
@@ -700,7 +693,9 @@ mainwid::update_markers (int tick)
 /**
  *  Does the actual drawing of one pattern/sequence position marker, a
  *  vertical progress bar.  If the sequence has no events, this function
- *  doesn't bother drawing a position marker.
+ *  doesn't bother drawing a position marker.  If the slot is not dirty and
+ *  the marker would land on the same pixel column as last time, nothing is
+ *  drawn, so idle slots cost nothing per tick.
  *
  *  Note that, when Sequencer64 first comes up, and perform::is_dirty_main()
  *  is called, no sequences exist yet.  Also, currently the redraw() is hit
@@ -723,7 +718,8 @@ mainwid::update_markers (int tick)
 void
 mainwid::draw_marker_on_sequence (int seqnum, int tick)
 {
-    if (perf().is_dirty_main(seqnum))
+    bool dirty = perf().is_dirty_main(seqnum);
+    if (dirty)
         redraw(seqnum);
 
     if (perf().is_active(seqnum))           /* also checks for nullptr      */
@@ -751,6 +747,9 @@ mainwid::draw_marker_on_sequence (int seqnum, int tick)
         tick %= len;
 
         long tick_x = tick * m_seqarea_seq_x / len;
+        if (! dirty && tick_x == m_last_tick_x[seqnum])
+            return;                         /* marker has not moved         */
+
         int bar_x = rect_x + int(m_last_tick_x[seqnum]);
         int thickness = 1;
         if (usr().progress_bar_thick())
@@ -955,6 +954,7 @@ mainwid::on_realize ()
 bool
 mainwid::on_expose_event (GdkEventExpose * ev)
 {
+    rt_trace_span span("mainwid::on_expose_event");
     draw_drawable
     (
         ev->area.x, ev->area.y, ev->area.x, ev->area.y,
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-04
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The main window holds the menu and the main controls of the application,
@@ -99,6 +99,7 @@
 #include "globals.h"
 #include "gtk_helpers.h"
 #include "gui_key_tests.hpp"            /* is_ctrl_key(), etc.              */
+#include "gui_notifier_gtk2.hpp"        /* seq64::gui_notifier_gtk2         */
 #include "keys_perform.hpp"
 #include "keystroke.hpp"
 #include "maintime.hpp"
@@ -107,6 +108,7 @@
 #include "midifile.hpp"                 /* seq64::midifile, open_midi_file()*/
 #include "options.hpp"
 #include "perfedit.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "wrkfile.hpp"
 
 #if defined SEQ64_JE_PATTERN_PANEL_SCROLLBARS
@@ -391,7 +393,9 @@ mainwnd::mainwnd
     m_spinbutton_load_offset(nullptr),  /* created in file_import_dialog()  */
     m_entry_notes           (manage(new Gtk::Entry())),
     m_is_running            (false),
+    m_notifier              (new gui_notifier_gtk2(p)),
     m_timeout_connect       (),                     /* handler              */
+    m_check_connect         (),                     /* handler              */
 #ifdef SEQ64_MAINWND_TAP_BUTTON
     m_current_beats         (0),
     m_base_time_ms          (0),
@@ -1168,10 +1172,14 @@ mainwnd::mainwnd
     add_events(Gdk::KEY_PRESS_MASK | Gdk::KEY_RELEASE_MASK);
 #endif
 
-    m_timeout_connect = Glib::signal_timeout().connect
+    m_timeout_connect = gui_notifier_gtk2::attach
     (
         mem_fun(*this, &mainwnd::timer_callback), redraw_period_ms()
     );
+    m_check_connect = Glib::signal_timeout().connect
+    (
+        mem_fun(*this, &mainwnd::check_callback), SEQ64_SAVE_CHECK_PERIOD_MS
+    );
     show_all();                             /* works here as well           */
 
 #if defined SEQ64_JE_PATTERN_PANEL_SCROLLBARS
@@ -1245,6 +1253,10 @@ mainwnd::~mainwnd ()
 
     if (sm_sigpipe[1] != -1)
         close(sm_sigpipe[1]);
+
+    m_timeout_connect.disconnect();
+    m_check_connect.disconnect();
+    delete m_notifier;
 }
 
 /**
@@ -1338,9 +1350,10 @@ mainwnd::toggle_menu_mode ()
 #endif  // SEQ64_STAZED_MENU_BUTTONS
 
 /**
- *  This function is the GTK timer callback, used to draw our current time
+ *  This function is the redraw callback, used to draw our current time
  *  and BPM on_events (the main window).  It also supports the ALSA pause
- *  functionality.
+ *  functionality.  It is called for each frame of m_notifier, that is, only
+ *  when the engine posts a change or the user does something.
  *
  * \note
  *      When Sequencer64 first starts up, and no MIDI tune is loaded, the call
@@ -1358,6 +1371,7 @@ mainwnd::toggle_menu_mode ()
 bool
 mainwnd::timer_callback ()
 {
+    rt_trace_span span("mainwnd::timer_callback");
     midipulse tick = perf().get_tick();         /* use no get_start_tick()! */
     midibpm bpm = perf().get_beats_per_minute();
     update_markers(tick);
@@ -1482,6 +1496,34 @@ mainwnd::timer_callback ()
 #endif
     }
 
+    return true;
+}
+
+/**
+ *  This function is the GTK timer callback for the checks that must be
+ *  made even while nothing is redrawn:  autosaves, the errors of
+ *  background saves, and the reset of the tap button after a pause.
+ *  timer_callback() runs only when m_notifier has a frame to show, which
+ *  is never while the GUI is idle.
+ *
+ * 
+eturn
+ *      Always returns true, so that the callback is called repeatedly.
+ */
+
+bool
+mainwnd::check_callback ()
+{
+    std::string errmsg;
+    if (perf().check_saves(errmsg))         /* autosave, background errors  */
+    {
+        Gtk::MessageDialog errdialog
+        (
+            *this, errmsg, false, Gtk::MESSAGE_ERROR, Gtk::BUTTONS_OK, true
+        );
+        errdialog.run();
+    }
+
 #ifdef SEQ64_MAINWND_TAP_BUTTON
 
     if (m_current_beats > 0 && m_last_time_ms > 0)
@@ -2261,14 +2303,15 @@ mainwnd::choose_file ()
 }
 
 /**
- *  Saves the current state in a MIDI file.  We let midifile tell the perform
- *  that saving worked, so that the "is modified" flag can be cleared.  The
- *  midifile class is already a friend of perform.
+ *  Saves the current state in a MIDI file.  The song is captured here, and
+ *  written by the song_saver thread of the perform object, which clears the
+ *  "is modified" flag.  A failure to write the file is reported later, by
+ *  timer_callback().
  *
  *  Note that we do not support saving files in the Cakewalk WRK format.
  *
  * \return
- *      Returns true if the save succeeded.
+ *      Returns true if the song was captured for saving.
  */
 
 bool
@@ -53,6 +53,7 @@
 #include "gdk_basic_keys.h"
 #include "gtk_helpers.h"
 #include "gui_key_tests.hpp"            /* seq64::is_ctrl_key()             */
+#include "gui_notifier_gtk2.hpp"        /* seq64::gui_notifier_gtk2         */
 #include "keystroke.hpp"
 #include "perfedit.hpp"
 #include "perfnames.hpp"
@@ -777,7 +778,8 @@ perfedit::draw_sequences ()
  *  Handles a drawing timeout.  It redraws "dirty" sequences in the perfroll
  *  and the perfnames objects, and shows draw progress on the perfroll.  It
  *  also changes the pause/play image if the status of running has changed.
- *  This function is called frequently and continuously.  It will work for
+ *  This function is called for each redraw frame, which comes continuously
+ *  during playback, and otherwise only on changes.  It will work for
  *  both perfedit windows, if both are up.
  */
 
@@ -931,7 +933,8 @@ perfedit::set_transpose (int transpose)
 
 /**
  *  This callback function calls the base-class on_realize() function, and
- *  then connects the perfedit::timeout() function to the Glib
+ *  then attaches the perfedit::timeout() function to the redraw frames of
+ *  the gui_notifier_gtk2.  Without a notifier, it is connected to the Glib
  *  signal-timeout, with a redraw timeout of redraw_period_ms().
  */
 
@@ -939,7 +942,7 @@ void
 perfedit::on_realize ()
 {
     gui_window_gtk2::on_realize();
-    Glib::signal_timeout().connect
+    gui_notifier_gtk2::attach
     (
         mem_fun(*this, &perfedit::timeout), redraw_period_ms()
     );
@@ -51,6 +51,7 @@
 #include "perfedit.hpp"
 #include "perform.hpp"
 #include "perfnames.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* user_settings::seqs_in_set() */
 
 /*
@@ -351,6 +352,7 @@ perfnames::on_realize ()
 bool
 perfnames::on_expose_event (GdkEventExpose * /* ev */)
 {
+    rt_trace_span span("perfnames::on_expose_event");
     draw_sequences();
     return true;
 }
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The performance window allows automatic control of when each
@@ -55,6 +55,7 @@
 #include "perfedit.hpp"
 #include "perform.hpp"
 #include "perfroll.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 #include "settings.hpp"                 /* seq64::rc() or seq64::usr()  */
 
@@ -231,11 +232,15 @@ perfroll::change_horz ()
     long current_offset = long(m_hadjust.get_value()) * m_ticks_per_bar;
     if (m_4bar_offset != current_offset)
     {
+        int dx = int
+        (
+            current_offset / m_perf_scale_x - m_4bar_offset / m_perf_scale_x
+        );
 #ifdef SEQ64_SONG_BOX_SELECT
         m_scroll_offset_x = int(m_hadjust.get_value()) / m_zoom;
 #endif
         m_4bar_offset = current_offset;
-        enqueue_draw();
+        scroll_and_draw(dx, 0);
     }
 }
 
@@ -256,13 +261,92 @@ perfroll::change_vert ()
     int vvalue = int(m_vadjust.get_value());
     if (m_sequence_offset != vvalue)
     {
+        int dy = (vvalue - m_sequence_offset) * m_names_y;
         m_drop_y += (m_sequence_offset - vvalue) * m_names_y;
         m_sequence_offset = vvalue;
 #ifdef SEQ64_SONG_BOX_SELECT
         m_scroll_offset_y = int(m_vadjust.get_value()) * m_names_y;
 #endif
+        scroll_and_draw(0, dy);
+    }
+}
+
+/**
+ *  Brings the pixmap up to date after a scroll, by moving what is already
+ *  drawn and drawing only the strip that scrolls into view, then copies the
+ *  pixmap to the window.  Only this perfroll is redrawn; the time line and
+ *  the names follow the adjustments on their own.  If the view moved by a
+ *  window or more, all rows are redrawn via enqueue_draw().
+ *
+ * \param dx
+ *      The number of pixels the view moved to the right.
+ *
+ * \param dy
+ *      The number of pixels the view moved down.
+ */
+
+void
+perfroll::scroll_and_draw (int dx, int dy)
+{
+    bool canscroll = is_realized() && m_pixmap &&
+        abs(dx) < m_window_x && abs(dy) < m_window_y;
+
+    if (! canscroll)
+    {
         enqueue_draw();
+        return;
     }
+    scroll_pixmap(m_pixmap, dx, dy);
+    if (dx > 0)
+        draw_area(m_window_x - dx, 0, dx, m_window_y);
+    else if (dx < 0)
+        draw_area(0, 0, -dx, m_window_y);
+
+    if (dy > 0)
+        draw_area(0, m_window_y - dy, m_window_x, dy);
+    else if (dy < 0)
+        draw_area(0, 0, m_window_x, -dy);
+
+    draw_drawable(0, 0, 0, 0, m_window_x, m_window_y);
+#ifdef SEQ64_SONG_BOX_SELECT
+    if (m_box_select)
+        draw_selection_on_window();
+#endif
+}
+
+/**
+ *  Redraws the rows of the pixmap that cross a rectangle, clipped to the
+ *  rectangle, drawing only the triggers that overlap it.
+ *
+ * \param x
+ *      The x coordinate of the rectangle.
+ *
+ * \param y
+ *      The y coordinate of the rectangle.
+ *
+ * \param w
+ *      The width of the rectangle.
+ *
+ * \param h
+ *      The height of the rectangle.
+ */
+
+void
+perfroll::draw_area (int x, int y, int w, int h)
+{
+    int ys = y / m_names_y;
+    int yf = (y + h) / m_names_y;
+    set_clip(x, y, w, h);
+    for (int row = ys; row <= yf; ++row)
+    {
+        int seq = row + m_sequence_offset;
+        if (seq < m_sequence_max)           /* see on_expose_event() note   */
+        {
+            draw_background_on(seq);
+            draw_sequence_on(seq, x, x + w);
+        }
+    }
+    clear_clip();
 }
 
 /**
@@ -615,10 +699,22 @@ perfroll::auto_scroll_horz ()
  *      -#  The left hand side little sequence grab handle,
  *          or segment handle.
  *      -#  The right-side segment handle.
+ *
+ *  Triggers, and repetitions of the pattern within a trigger, that do not
+ *  overlap the given columns are skipped.
+ *
+ * \param seqnum
+ *      The sequence to draw.
+ *
+ * \param x0
+ *      The first column to draw.
+ *
+ * \param x1
+ *      The column after the last column to draw.
  */
 
 void
-perfroll::draw_sequence_on (int seqnum)
+perfroll::draw_sequence_on (int seqnum, int x0, int x1)
 {
     sequence * seq = perf().get_sequence(seqnum);
     if (not_nullptr(seq))
@@ -646,6 +742,8 @@ perfroll::draw_sequence_on (int seqnum)
                 int y = m_names_y * seqnum + 1;         // + 2
                 int h = m_names_y - 2;                  // - 4
                 x -= x_offset;                  /* adjust to screen coords  */
+                if (x + w < x0 || x > x1)
+                    continue;                   /* not in the columns drawn */
 
                 /**
                  *
@@ -706,21 +804,16 @@ perfroll::draw_sequence_on (int seqnum)
                         );
                     }
 
+                    bool visible = tickmarker_x <= x1 &&
+                        tickmarker_x + length_w >= x0;
+
+                    render_snapshot::pointer snap = seq->snapshot();
                     int low_note, high_note;            // for side-effects
-                    bool have_notes = seq->get_minmax_note_events
-                    (
-                        low_note, high_note             // side-effects
-                    );
-                    if (have_notes)
+                    bool have_notes = snap->minmax(low_note, high_note);
+                    if (have_notes && visible)
                     {
                         int height = high_note - low_note + 2;
                         int length = seq->get_length();
-                        midipulse tick_s;
-                        midipulse tick_f;
-                        int note;
-                        bool selected;
-                        int velocity;
-                        draw_type_t dt;
 
                         /*
                          * If a pattern is not transposable, draw it in red
@@ -733,16 +826,14 @@ perfroll::draw_sequence_on (int seqnum)
                         else
                             m_gc->set_foreground(red());
 
-                        seq->reset_draw_marker();       /* container iterator */
-                        do
+                        const render_snapshot::Notes & notes = snap->notes();
+                        render_snapshot::Notes::const_iterator ni;
+                        for (ni = notes.begin(); ni != notes.end(); ++ni)
                         {
-                            dt = seq->get_next_note_event   /* side-effects */
-                            (
-                                tick_s, tick_f, note, selected, velocity
-                            );
-                            if (dt == DRAW_FIN)
-                                break;
-
+                            midipulse tick_s = ni->tick_s;
+                            midipulse tick_f = ni->tick_f;
+                            int note = ni->key;
+                            draw_type_t dt = ni->type;
                             int mny = m_names_y - 6;
                             int note_y;
                             if (dt == DRAW_TEMPO)
@@ -807,7 +898,7 @@ perfroll::draw_sequence_on (int seqnum)
                                     set_line(Gdk::LINE_SOLID, 1);
                                 }
                             }
-                        } while (dt != DRAW_FIN);
+                        }
                     }
                     tickmarker += sequence_length;
                 }
@@ -845,7 +936,9 @@ perfroll::draw_background_on (int seqnum)
 }
 
 /**
- *  Redraws patterns/sequences that have been modified.
+ *  Redraws patterns/sequences that have been modified.  Only the rows of
+ *  the modified patterns are copied to the window, so that following the
+ *  progress of a large song does not copy the whole window at every tick.
  *
  * \change ca 2016-05-30
  *      Lets try not drawing sequences greater than the maximum, at all.
@@ -854,19 +947,17 @@ perfroll::draw_background_on (int seqnum)
 void
 perfroll::redraw_dirty_sequences ()
 {
-    bool draw = false;
     int yf = m_window_y / m_names_y;
     for (int y = 0; y <= yf; ++y)
     {
         int seq = y + m_sequence_offset;
         if (seq < m_sequence_max && perf().is_dirty_perf(seq))  /* see note */
         {
+            int ry = y * m_names_y;
             draw_sequence(seq);
-            draw = true;
+            draw_drawable(0, ry, 0, ry, m_window_x, m_names_y);
         }
     }
-    if (draw)
-        draw_drawable(0, 0, 0, 0, m_window_x, m_window_y);
 }
 
 /**
@@ -1152,6 +1243,7 @@ perfroll::on_realize ()
 bool
 perfroll::on_expose_event (GdkEventExpose * ev)
 {
+    rt_trace_span span("perfroll::on_expose_event");
     int ys = ev->area.y / m_names_y;
     int yf = (ev->area.y + ev->area.height) / m_names_y;
     for (int y = ys; y <= yf; ++y)
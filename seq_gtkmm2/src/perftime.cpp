@@ -41,6 +41,7 @@
 #include "perfedit.hpp"
 #include "perform.hpp"
 #include "perftime.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* seq64::choose_ppqn()         */
 
 /*
@@ -243,6 +244,7 @@ perftime::on_realize ()
 bool
 perftime::on_expose_event (GdkEventExpose * /* ev */ )
 {
+    rt_trace_span span("perftime::on_expose_event");
     draw_background();
     return true;
 }
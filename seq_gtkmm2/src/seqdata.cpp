@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-07-05
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The data area consists of vertical lines, with the height of each line
@@ -36,10 +36,12 @@
 
 #include <gtkmm/adjustment.h>
 
+#include "event_summary.hpp"            /* seq64::event_summary             */
 #include "font.hpp"
 #include "gdk_basic_keys.h"
 #include "gui_key_tests.hpp"            /* is_ctrl_key(), etc.          */
 #include "perform.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "seqdata.hpp"
 #include "sequence.hpp"
 
@@ -90,7 +92,8 @@ seqdata::seqdata
 #ifdef USE_STAZED_SEQDATA_EXTENSIONS
     m_drag_handle           (false),
 #endif
-    m_dragging              (false)
+    m_dragging              (false),
+    m_lane                  ()
 {
     set_flags(Gtk::CAN_FOCUS);
 }
@@ -198,25 +201,21 @@ seqdata::update_pixmap ()
 }
 
 /**
- *  Draws events on the given drawable object.  Very similar to seqevent ::
- *  draw_events_on().  And yet it doesn't handle zooming as well, must fix!
+ *  Draws events on the given drawable object.  The events come from the
+ *  data lane, which holds one bar per occupied pixel column, and only the
+ *  bars in the visible part of the pane are drawn.  The lines of each color
+ *  are drawn in one batch.
  *
  * Stazed:
  *
  *      For Note On there can be multiple events on the same vertical in which
  *      the selected item can be covered.  For Note On the selected item
- *      needs to be drawn last so it can be seen.  So, for other events the
- *      variable num_selected_events will be -1 for ALL_EVENTS. For Note On
- *      only, the variable will be the number of selected events. If 0 then
- *      only one pass is needed. If > 0 then two passes are needed, one for
- *      unselected (first), and one for selected (last).  For the first pass,
- *      if any events are selected, the selection type is EVENTS_UNSELECTED.
- *      For the second pass, it will be set to num_selected_events.
- *
- *  We now draw the data line for selected event in dark orange, instead of
- *  black.  We're not likely to adopt the Stazed convention of drawing in blue.
- *  Also, there seem to be some bugs in how the data selection works.  Needs
- *  more evaluation.
+ *      needs to be drawn last so it can be seen.
+ *
+ *  The selected lines are drawn last, in dark orange, up to the highest
+ *  selected value in the column, so that they are never covered.  We're not
+ *  likely to adopt the Stazed convention of drawing in blue.  The value
+ *  digits are skipped when the events are too dense for them to be read.
  *
  *  Also, if we decide to draw handle on each vertical data line, it would
  *  look nicer if a circle.
@@ -228,9 +227,6 @@ seqdata::update_pixmap ()
 void
 seqdata::draw_events_on (Glib::RefPtr<Gdk::Drawable> drawable)
 {
-    int starttick = m_scroll_offset_ticks;
-    int endtick = (m_window_x * m_zoom) + m_scroll_offset_ticks;
-
     /*
      * Add a black border.  However, not sure yet why we can't get a black
      * line at the bottom; what else is painting down there?
@@ -242,100 +238,73 @@ seqdata::draw_events_on (Glib::RefPtr<Gdk::Drawable> drawable)
     draw_rectangle(drawable, white_paint(), 1, 1, m_window_x-2, m_window_y-1);
     m_gc->set_foreground(black_paint());
 
-#ifdef USE_STAZED_SEQDATA_EXTENSIONS
-    int numselected = EVENTS_ALL;
-    int seltype = numselected;
-    if (m_status == EVENT_NOTE_ON)                  // iffy
-    {
-        numselected = m_seq.get_num_selected_events(m_status, m_cc);
-        if (numselected > 0)
-            seltype = EVENTS_UNSELECTED;
-    }
-    do
+    /*
+     *  The digits extend about one character to the right of a line, so a
+     *  bar just left of the pane can still show.
+     */
+
+    (void) m_lane.update(m_seq, m_zoom, m_status, m_cc);
+    const data_lane::Bars & bars = m_lane.bars();
+    int first = m_lane.first_at(m_scroll_offset_x - m_number_w - 2);
+    int last = m_lane.first_at(m_scroll_offset_x + m_window_x);
+    std::vector<GdkSegment> lines;
+    std::vector<GdkSegment> tempolines;
+    std::vector<GdkSegment> selectedlines;
+    lines.reserve(last > first ? last - first : 0);
+    for (int i = first; i < last; ++i)
     {
-#endif
+        const data_lane::bar & b = bars[i];
+        GdkSegment s;
+        s.x1 = s.x2 = b.x - m_scroll_offset_x + 1;
+        s.y1 = c_dataarea_y - b.high;
+        s.y2 = c_dataarea_y;
+        if (b.tempo)
+            tempolines.push_back(s);
+        else
+            lines.push_back(s);
 
-        event_list::const_iterator ev;
-        m_seq.reset_ex_iterator(ev);
-        while (m_seq.get_next_event_match(m_status, m_cc, ev))
+        if (b.selected_high >= 0)
         {
-            midipulse tick = ev->get_timestamp();
-            bool selected = ev->is_selected();
-            if (tick >= starttick && tick <= endtick)
-            {
-                int event_x = tick / m_zoom;        /* screen coordinate    */
-                int x = event_x - m_scroll_offset_x + 1;
-                int event_height;
-                Color paint = black_paint();
-                if (ev->is_tempo())
-                {
-                    event_height = int(tempo_to_note_value(ev->tempo()));
-                    paint = tempo_paint();
-                }
-                else if (ev->is_ex_data())
-                {
-                    /*
-                     * Do nothing for other Meta events at this time.  Don't
-                     * forget to increment the iterator now!
-                     */
-
-                    ++ev;                           /* now a must-do        */
-                    continue;
-                }
-                else
-                {
-                    midibyte d0, d1;
-                    ev->get_data(d0, d1);
-                    event_height = event::is_one_byte_msg(m_status) ? d0 : d1 ;
-                }
-                set_line(Gdk::LINE_SOLID, 2);       /* vertical event line  */
-                draw_line
-                (
-                    drawable, selected ? dark_orange() : paint,
-                    x, c_dataarea_y - event_height, x, c_dataarea_y
-                );
-
-                if (ev->is_tempo())
-                {
-                    draw_rectangle                  /* draw handle          */
-                    (
-                        drawable, selected ? dark_orange() : tempo_paint(),
-                        event_x - m_scroll_offset_x - 3,
-                        c_dataarea_y - event_height,
-                        c_data_handle_x,
-                        c_data_handle_y
-                    );
-                }
-
-#ifdef USE_STAZED_SEQDATA_EXTENSIONS
-                else
-                {
-                    draw_rectangle                  /* draw handle          */
-                    (
-                        drawable, selected ? dark_orange() : black_paint(),
-                        event_x - m_scroll_offset_x - 3,
-                        c_dataarea_y - event_height,
-                        c_data_handle_x,
-                        c_data_handle_y
-                    );
-                }
-#endif
+            s.y1 = c_dataarea_y - b.selected_high;
+            selectedlines.push_back(s);
+        }
+    }
+    set_line(Gdk::LINE_SOLID, 2);                   /* vertical event lines */
+    draw_segments(drawable, black_paint(), lines);
+    draw_segments(drawable, tempo_paint(), tempolines);
+    draw_segments(drawable, dark_orange(), selectedlines);
 
-                if (ev->is_tempo())
-                    render_digits(drawable, int(ev->tempo()), x);
-                else
-                    render_digits(drawable, event_height, x);
-            }
-            ++ev;                                   /* now a must-do        */
+    bool dense = event_summary::use_summary(m_seq, m_zoom);
+    for (int i = first; i < last; ++i)
+    {
+        const data_lane::bar & b = bars[i];
+        int x = b.x - m_scroll_offset_x + 1;
+        bool selected = b.selected_high >= 0;
+        if (b.tempo)
+        {
+            draw_rectangle                          /* draw handle          */
+            (
+                drawable, selected ? dark_orange() : tempo_paint(),
+                x - 4, c_dataarea_y - b.high,
+                c_data_handle_x, c_data_handle_y
+            );
         }
+
 #ifdef USE_STAZED_SEQDATA_EXTENSIONS
-        if (seltype == EVENTS_UNSELECTED)
-            seltype = numselected;
         else
-            break;
-
-    } while (seltype == EVENTS_UNSELECTED);
+        {
+            draw_rectangle                          /* draw handle          */
+            (
+                drawable, selected ? dark_orange() : black_paint(),
+                x - 4, c_dataarea_y - b.high,
+                c_data_handle_x, c_data_handle_y
+            );
+        }
 #endif
+
+        if (! dense)
+            render_digits(drawable, b.value, x);
+    }
 }
 
 /**
@@ -601,6 +570,7 @@ seqdata::on_realize ()
 bool
 seqdata::on_expose_event (GdkEventExpose * ev)
 {
+    rt_trace_span span("seqdata::on_expose_event");
     draw_drawable
     (
         ev->area.x, ev->area.y, ev->area.x, ev->area.y,
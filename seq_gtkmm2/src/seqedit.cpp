@@ -121,6 +121,7 @@
 #include "globals.h"
 #include "gtk_helpers.h"
 #include "gui_key_tests.hpp"            /* is_ctrl_key(), etc.          */
+#include "gui_notifier_gtk2.hpp"        /* seq64::gui_notifier_gtk2     */
 #include "mainwid.hpp"
 #include "options.hpp"
 #include "perfedit.hpp"
@@ -2975,7 +2976,8 @@ seqedit::redraw (bool drawevents)
 }
 
 /**
- *  On realization, calls the base-class version, and connects the redraw
+ *  On realization, calls the base-class version, and attaches the redraw
+ *  callback to the frames of the gui_notifier_gtk2, or, without one, to a
  *  timeout signal, timed at redraw_period_ms().
  */
 
@@ -2983,7 +2985,7 @@ void
 seqedit::on_realize ()
 {
     gui_window_gtk2::on_realize();
-    Glib::signal_timeout().connect
+    gui_notifier_gtk2::attach
     (
         mem_fun(*this, &seqedit::timeout), redraw_period_ms()
     );
@@ -41,6 +41,7 @@
 #include "keystroke.hpp"                /* instead of gdk_basic_keys.h  */
 #include "gui_key_tests.hpp"            /* seq64::is_no_modifier()      */
 #include "perform.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "seqevent.hpp"
 #include "seqdata.hpp"
 #include "sequence.hpp"
@@ -648,6 +649,7 @@ seqevent::on_size_allocate (Gtk::Allocation & a)
 bool
 seqevent::on_expose_event (GdkEventExpose * e)
 {
+    rt_trace_span span("seqevent::on_expose_event");
     draw_drawable
     (
         e->area.x, e->area.y, e->area.x, e->area.y, e->area.width, e->area.height
@@ -57,6 +57,7 @@
 #include "click.hpp"                    /* SEQ64_CLICK_LEFT() etc.      */
 #include "font.hpp"
 #include "globals.h"                    /* c_keyarea_y and more         */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "scales.h"
 #include "seqkeys.hpp"
 #include "sequence.hpp"
@@ -386,6 +387,7 @@ seqkeys::on_realize ()
 bool
 seqkeys::on_expose_event (GdkEventExpose * ev)
 {
+    rt_trace_span span("seqkeys::on_expose_event");
     draw_drawable
     (
         ev->area.x, ev->area.y + m_scroll_offset_y,
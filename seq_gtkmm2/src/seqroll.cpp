@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2015-07-24
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  There are a large number of existing items to discuss.  But for now let's
@@ -117,6 +117,7 @@
 #include "gui_key_tests.hpp"            /* seq64::is_no_modifier() etc. */
 #include "keystroke.hpp"
 #include "perform.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "scales.h"
 #include "seqroll.hpp"
 #include "seqdata.hpp"
@@ -219,6 +220,8 @@ seqroll::seqroll
     m_scroll_offset_key     (0),
     m_scroll_offset_x       (0),
     m_scroll_offset_y       (0),
+    m_drawn_scroll_x        (-1),
+    m_drawn_scroll_y        (-1),
     m_scroll_page           (0),
     m_progress_follow       (true),
     m_transport_follow      (true),
@@ -227,7 +230,9 @@ seqroll::seqroll
     m_drawing_background_seq(false),
     m_ignore_redraw         (false),
     m_status                (0),
-    m_cc                    (0)
+    m_cc                    (0),
+    m_summary               (),
+    m_background_summary    ()
 {
     m_old.clear();
 
@@ -326,6 +331,7 @@ seqroll::update_sizes ()
     {
         m_pixmap = Gdk::Pixmap::create(m_window, m_window_x, m_window_y, -1);
         m_background = Gdk::Pixmap::create(m_window, m_window_x, m_window_y, -1);
+        m_drawn_scroll_x = m_drawn_scroll_y = -1;   /* nothing to scroll    */
         change_vert();
     }
 }
@@ -356,18 +362,15 @@ seqroll::set_scroll_y ()
 
 /**
  *  Change the horizontal scrolling offset and redraw.  Roughly similar to
- *  seqevent::change_horz().
- *
- *  Update_and_draw() is meant to replace calls to update_background();
- *  update_pixmap(); and force_draw().  The m_ignore_redraw (from Seq32?) is
- *  no longer checked before calling these functions.
+ *  seqevent::change_horz().  The pixmaps are scrolled, and only the strip
+ *  that scrolls into view is drawn; see scroll_and_draw().
  */
 
 void
 seqroll::change_horz ()
 {
     set_scroll_x();
-    update_and_draw(true);
+    scroll_and_draw();
 }
 
 /**
@@ -378,7 +381,7 @@ void
 seqroll::change_vert ()
 {
     set_scroll_y();
-    update_and_draw(true);
+    scroll_and_draw();
 }
 
 /**
@@ -424,6 +427,8 @@ seqroll::update_and_draw (int force)
     {
         update_background();
         update_pixmap();
+        m_drawn_scroll_x = m_scroll_offset_x;
+        m_drawn_scroll_y = m_scroll_offset_y;
         if (force)
             force_draw();
         else
@@ -431,6 +436,77 @@ seqroll::update_and_draw (int force)
     }
 }
 
+/**
+ *  Brings the pixmaps up to date with the current scroll offsets by moving
+ *  what is already drawn, and drawing only the strips that scroll into
+ *  view.  When following the progress of a long recording, or dragging the
+ *  scroll-bar, this draws a few columns of background and notes instead of
+ *  the whole window.  If the pixmaps have not been drawn yet, or the view
+ *  moved by a window or more, it falls back to update_and_draw().
+ */
+
+void
+seqroll::scroll_and_draw ()
+{
+    int dx = m_scroll_offset_x - m_drawn_scroll_x;
+    int dy = m_scroll_offset_y - m_drawn_scroll_y;
+    bool canscroll =
+        m_drawn_scroll_x >= 0 && m_drawn_scroll_y >= 0 && ! m_ignore_redraw &&
+        abs(dx) < m_window_x && abs(dy) < m_window_y;
+
+    if (! canscroll)
+    {
+        update_and_draw(true);
+        return;
+    }
+    if (dx == 0 && dy == 0)
+        return;
+
+    scroll_pixmap(m_background, dx, dy);
+    scroll_pixmap(m_pixmap, dx, dy);
+    if (dx > 0)
+        draw_area(m_window_x - dx, 0, dx, m_window_y);
+    else if (dx < 0)
+        draw_area(0, 0, -dx, m_window_y);
+
+    if (dy > 0)
+        draw_area(0, m_window_y - dy, m_window_x, dy);
+    else if (dy < 0)
+        draw_area(0, 0, m_window_x, -dy);
+
+    m_drawn_scroll_x = m_scroll_offset_x;
+    m_drawn_scroll_y = m_scroll_offset_y;
+    force_draw();
+}
+
+/**
+ *  Redraws one rectangle of the background and of the main pixmap.  All
+ *  drawing is clipped to the rectangle, so that the notes and grid lines
+ *  that cross its edges do not disturb the pixels around it.
+ *
+ * \param x
+ *      The x coordinate of the rectangle.
+ *
+ * \param y
+ *      The y coordinate of the rectangle.
+ *
+ * \param w
+ *      The width of the rectangle.
+ *
+ * \param h
+ *      The height of the rectangle.
+ */
+
+void
+seqroll::draw_area (int x, int y, int w, int h)
+{
+    set_clip(x, y, w, h);
+    draw_background(x, x + w);
+    m_pixmap->draw_drawable(m_gc, m_background, x, y, x, y, w, h);
+    draw_events_on(m_pixmap, x, x + w);
+    clear_clip();
+}
+
 /**
  *  Redraws events unless m_ignore_redraw is true.
  */
@@ -459,14 +535,30 @@ seqroll::draw_background_on_pixmap ()
 }
 
 /**
- *  Updates the background of this window.  The first thing done is to clear
- *  the background, painting it white.
+ *  Updates the background of this window.
  */
 
 void
 seqroll::update_background ()
 {
-    draw_rectangle(m_background, white_paint(), 0, 0, m_window_x, m_window_y);
+    draw_background(0, m_window_x);
+}
+
+/**
+ *  Draws the columns of the background between two x coordinates.  The
+ *  first thing done is to clear those columns, painting them white.
+ *
+ * \param x0
+ *      The first column to draw.
+ *
+ * \param x1
+ *      The column after the last column to draw.
+ */
+
+void
+seqroll::draw_background (int x0, int x1)
+{
+    draw_rectangle(m_background, white_paint(), x0, 0, x1 - x0, m_window_y);
 
 #ifdef SEQ64_SOLID_PIANOROLL_GRID
     bool fruity_lines = true;
@@ -509,7 +601,7 @@ seqroll::update_background ()
             }
         }
         int y = key * c_key_y;
-        draw_line(m_background, 0, y, m_window_x, y);
+        draw_line(m_background, x0, y, x1, y);
         if (m_scale != c_scale_off)
         {
             if (! c_scales_policy[m_scale][(modkey - 1) % SEQ64_OCTAVE_SIZE])
@@ -517,7 +609,7 @@ seqroll::update_background ()
                 draw_rectangle
                 (
                     m_background, light_grey_paint(),
-                    0, y + 1, m_window_x, c_key_y - 1
+                    x0, y + 1, x1 - x0, c_key_y - 1
                 );
             }
         }
@@ -534,9 +626,9 @@ seqroll::update_background ()
     int ticks_per_step = m_zoom * 6;
     int ticks_per_beat = 4 * perf().get_ppqn() / bwidth;
     int ticks_per_major = bpbar * ticks_per_beat;
-    int endtick = (m_window_x * m_zoom) + m_scroll_offset_ticks;
-    int starttick = m_scroll_offset_ticks -
-        (m_scroll_offset_ticks % ticks_per_major);
+    int lefttick = (x0 * m_zoom) + m_scroll_offset_ticks;
+    int endtick = (x1 * m_zoom) + m_scroll_offset_ticks;
+    int starttick = lefttick - (lefttick % ticks_per_major);
 
     m_gc->set_foreground(grey_paint());
 
@@ -805,21 +897,30 @@ seqroll::follow_progress ()
  *  Draws events on the given drawable area.  "Method 0" draws the background
  *  sequence, if active.  "Method 1" draws the sequence itself.
  *
+ *  Only the notes that overlap the given columns are drawn, including the
+ *  long notes that start before the columns and end after them.  The
+ *  columns are widened by a couple of pixels, for the outline of the notes.
+ *
  * \param draw
  *      The "drawable" area to draw on.
+ *
+ * \param x0
+ *      The first column to draw.
+ *
+ * \param x1
+ *      The column after the last column to draw.
  */
 
 void
-seqroll::draw_events_on (Glib::RefPtr<Gdk::Drawable> draw)
+seqroll::draw_events_on (Glib::RefPtr<Gdk::Drawable> draw, int x0, int x1)
 {
     midipulse tick_s;
     midipulse tick_f;
     int note;
     bool selected;
-    int velocity;
     draw_type_t dt;
-    int starttick = m_scroll_offset_ticks;
-    int endtick = (m_window_x * m_zoom) + m_scroll_offset_ticks;
+    int starttick = ((x0 - 2) * m_zoom) + m_scroll_offset_ticks;
+    int endtick = ((x1 + 2) * m_zoom) + m_scroll_offset_ticks;
     sequence * seq = nullptr;
     for (int method = 0; method < 2; ++method)  /* weird way to do it       */
     {
@@ -836,16 +937,28 @@ seqroll::draw_events_on (Glib::RefPtr<Gdk::Drawable> draw)
         if (method == 1)
             seq = &m_seq;
 
-        m_gc->set_foreground(black_paint());    /* draw boxes from sequence */
-        seq->reset_draw_marker();
-        while
-        (
+        if (event_summary::use_summary(*seq, m_zoom))
+        {
+            m_gc->set_foreground(method == 0 ? dark_cyan() : black_paint());
+            draw_summary_on                     /* too dense for each note  */
             (
-                dt = seq->get_next_note_event(tick_s, tick_f,
-                   note, selected, velocity)
-            ) != DRAW_FIN
-        )
+                draw, *seq, method == 0 ? m_background_summary : m_summary,
+                starttick, endtick
+            );
+            continue;
+        }
+
+        m_gc->set_foreground(black_paint());    /* draw boxes from sequence */
+        render_snapshot::pointer snap = seq->snapshot();    /* no locking */
+        const render_snapshot::Notes & notes = snap->notes();
+        render_snapshot::Notes::const_iterator ni;
+        for (ni = notes.begin(); ni != notes.end(); ++ni)
         {
+            tick_s = ni->tick_s;
+            tick_f = ni->tick_f;
+            note = ni->key;
+            selected = ni->selected;
+            dt = ni->type;
 #ifdef SEQ64_SEQROLL_DRAW_TEMPO
             bool istempo = dt == DRAW_TEMPO;
             bool do_draw = true;
@@ -854,10 +967,12 @@ seqroll::draw_events_on (Glib::RefPtr<Gdk::Drawable> draw)
 #endif
             if (do_draw)
             {
-                do_draw = tick_s >= starttick && tick_s <= endtick;
-                if (! do_draw)
-                    do_draw = (dt == DRAW_NORMAL_LINKED) &&
-                        tick_f >= starttick && tick_f <= endtick;
+                if (dt != DRAW_NORMAL_LINKED)           /* 16-tick marker   */
+                    do_draw = tick_s <= endtick && tick_s + 16 >= starttick;
+                else if (tick_f >= tick_s)
+                    do_draw = tick_s <= endtick && tick_f >= starttick;
+                else                                    /* wraps around     */
+                    do_draw = tick_s <= endtick || tick_f >= starttick;
             }
             if (do_draw)
             {
@@ -978,6 +1093,67 @@ seqroll::draw_events_on (Glib::RefPtr<Gdk::Drawable> draw)
     }
 }
 
+/**
+ *  Draws the notes of a very dense sequence from its per-pixel summary, in
+ *  the current foreground color.  Each note row gets one rectangle per run
+ *  of adjacent pixel columns in which the note sounds, so the number of
+ *  draw calls depends on the width of the window, not the number of notes.
+ *
+ * \param draw
+ *      The "drawable" area to draw on.
+ *
+ * \param s
+ *      The sequence to draw.
+ *
+ * \param summary
+ *      The summary to use, brought up to date here if needed.
+ *
+ * \param starttick
+ *      The first tick visible in the window.
+ *
+ * \param endtick
+ *      The last tick visible in the window.
+ */
+
+void
+seqroll::draw_summary_on
+(
+    Glib::RefPtr<Gdk::Drawable> draw, sequence & s,
+    event_summary & summary, midipulse starttick, midipulse endtick
+)
+{
+    summary.update_notes(s, m_zoom);
+
+    int b0 = int(starttick / m_zoom);
+    int b1 = int(endtick / m_zoom);
+    if (b0 < 0)
+        b0 = 0;
+
+    if (b1 >= summary.bucket_count())
+        b1 = summary.bucket_count() - 1;
+
+    for (int note = 0; note < c_num_keys; ++note)
+    {
+        int y = c_rollarea_y - (note * c_key_y) - c_key_y + 1;
+        int run = -1;                           /* start of the current run */
+        for (int b = b0; b <= b1 + 1; ++b)
+        {
+            bool on = b <= b1 && summary.note_bucket(b).test(note);
+            if (on && run < 0)
+                run = b;
+            else if (! on && run >= 0)
+            {
+                draw_rectangle
+                (
+                    draw, run - m_scroll_offset_x, y - m_scroll_offset_y,
+                    b - run, c_key_y - 3
+                );
+                run = -1;
+            }
+        }
+    }
+}
+
 /**
  *  Fills the main pixmap with events.  Just calls draw_events_on().
  */
@@ -1961,6 +2137,7 @@ seqroll::on_realize ()
 bool
 seqroll::on_expose_event (GdkEventExpose * ev)
 {
+    rt_trace_span span("seqroll::on_expose_event");
     GdkRectangle & area = ev->area;
     draw_drawable(area.x, area.y, area.x, area.y, area.width, area.height);
     draw_selection_on_window();
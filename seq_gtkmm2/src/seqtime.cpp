@@ -38,6 +38,7 @@
 #include "event.hpp"
 #include "font.hpp"
 #include "perform.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "seqtime.hpp"
 #include "sequence.hpp"
 
@@ -305,7 +306,6 @@ void
 seqtime::on_realize()
 {
     gui_drawingarea_gtk2::on_realize();
-    Glib::signal_timeout().connect(mem_fun(*this, &seqtime::idle_progress), 50);
     m_hadjust.signal_value_changed().connect
     (
         mem_fun(*this, &seqtime::change_horz)
@@ -320,6 +320,7 @@ seqtime::on_realize()
 bool
 seqtime::on_expose_event (GdkEventExpose * a_e)
 {
+    rt_trace_span span("seqtime::on_expose_event");
     draw_drawable
     (
         a_e->area.x, a_e->area.y, a_e->area.x, a_e->area.y,
@@ -28,13 +28,20 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-04
+ * \updates       2018-09-07
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
  *  performance/song editor.
+ *
+ *  The notes shown inside the trigger boxes are drawn once per pattern, at
+ *  the current zoom, into a tile that is then copied into each repetition
+ *  of each trigger.  A tile is redrawn only when its pattern is edited or
+ *  the zoom changes.  During playback, only the progress bar is repainted,
+ *  unless the triggers themselves changed.
  */
 
+#include <QPixmap>
 #include <QWidget>
 
 #include "globals.h"
@@ -126,6 +133,27 @@ private:
     void half_split_trigger (int seq, midipulse tick);
     void delete_trigger (int seq, midipulse tick);
     void follow_progress ();
+    const QPixmap & pattern_tile (int seqid, sequence * s);
+    unsigned long layout_stamp ();
+    void update_progress ();
+
+private:
+
+    /**
+     *  The notes of one loop of a pattern, scaled to the current zoom and the
+     *  height of a trigger box, plus the values the tile was drawn from.
+     */
+
+    struct tile
+    {
+        QPixmap pixmap;
+        const sequence * seq;
+        unsigned long version;
+        int event_count;
+        midipulse length;
+        int zoom;
+        bool transposable;
+    };
 
 private:
 
@@ -147,6 +175,8 @@ private:
     bool mBoxSelect;
     bool m_grow_direction;
     bool m_adding_pressed;
+    tile m_tiles[c_max_sequence];           // note tiles, by sequence
+    unsigned long m_layout_stamp;           // triggers as of the last paint
 
 };          // class qperfroll
 
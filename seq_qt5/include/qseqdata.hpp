@@ -29,20 +29,28 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-14
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The data pane is the drawing-area below the seqedit's event area, and
  *  contains vertical lines whose height matches the value of each data event.
  *  The height of the vertical lines is editable via the mouse.
+ *
+ *  The lines are cached as one QLine per occupied pixel column (see
+ *  data_lane), rebuilt only when the sequence, zoom, or kind of event
+ *  changes, and only the part of the cache that is exposed is drawn, with a
+ *  single drawLines() call.
  */
 
+#include <QLine>
+#include <QVector>
 #include <QWidget>
 #include <QTimer>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPen>
 
+#include "data_lane.hpp"                /* seq64::data_lane                 */
 #include "midibyte.hpp"                 /* midibyte, midipulse typedefs     */
 #include "qseqbase.hpp"                 /* seq64::qseqbase mixin class      */
 
@@ -100,7 +108,7 @@ protected:
 
     // override painting event to draw on the frame
 
-    void paintEvent (QPaintEvent *);
+    void paintEvent (QPaintEvent * qpep);
 
     // override mouse events for interaction
 
@@ -121,6 +129,7 @@ public slots:
 private:
 
     void convert_x (int x, midipulse & tick);
+    void build_lines ();
 
 private:
 
@@ -160,6 +169,33 @@ private:
 
     bool m_dragging;
 
+    /**
+     *  The events being edited, reduced to one bar per pixel column.
+     */
+
+    data_lane m_lane;
+
+    /**
+     *  One line per bar of m_lane, from the bottom of the pane up to the
+     *  highest value in the column.
+     */
+
+    QVector<QLine> m_lines;
+
+    /**
+     *  One line per bar of m_lane that holds more than one event, from the
+     *  bottom of the pane up to the lowest value in the column, drawn in
+     *  gray over m_lines to show the range of the values.
+     */
+
+    QVector<QLine> m_range_lines;
+
+    /**
+     *  The height of the pane when the lines were built.
+     */
+
+    int m_lines_height;
+
 };          // class qseqdata
 
 }           // namespace seq64
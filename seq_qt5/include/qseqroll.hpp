@@ -28,13 +28,21 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-10
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  We are currently moving toward making this class a base class.
  *
  *  User jean-emmanual added support for disabling the following of the
  *  progress bar during playback.  See the qseqbase::m_progress_follow member.
+ *
+ *  The roll is drawn in layers.  The grid and the notes are each drawn into
+ *  a pixmap covering the visible part of the roll, and these are redrawn
+ *  only when their own inputs change:  zoom, scroll, or grid settings for
+ *  the grid, and edits of the sequence for the notes.  The progress bar and
+ *  the selection rectangles are drawn live on top of the note layer, and
+ *  during playback only the strips that the progress bar leaves and enters
+ *  are repainted.
  */
 
 #include <QWidget>
@@ -42,7 +50,9 @@
 #include <QPen>
 #include <QTimer>
 #include <QMouseEvent>
+#include <QPixmap>
 
+#include "event_summary.hpp"            /* seq64::event_summary             */
 #include "qseqbase.hpp"                 /* seq64::qseqbase mixin class      */
 #include "sequence.hpp"                 /* seq64::edit_mode_t mode          */
 
@@ -151,6 +161,16 @@ private:
     void snap_y (int & y);
     void set_adding (bool a_adding);
     void start_paste();
+    void update_layers (const QRect & r);
+    void draw_grid (QPainter & painter);
+    void draw_notes (QPainter & painter);
+    void draw_summary
+    (
+        QPainter & painter, sequence & s, event_summary & summary,
+        const QColor & color, midipulse start_tick, midipulse end_tick
+    );
+    bool notes_changed () const;
+    void update_progress ();
 
 private:
 
@@ -262,6 +282,110 @@ private:
     int m_key_y;               // dimensions of height
     int m_keyarea_y;
 
+    /**
+     *  Holds the values that the grid layer depends upon.  If any of them
+     *  changes, the grid layer is redrawn.
+     */
+
+    struct grid_stamp
+    {
+        int zoom;
+        int key;
+        int scale;
+        int edit_mode;
+        int beats_per_bar;
+        int beat_width;
+        int snap;
+        int scroll_key;
+        int scroll_x;
+        int width;
+        int height;
+
+        bool operator == (const grid_stamp & rhs) const
+        {
+            return zoom == rhs.zoom && key == rhs.key &&
+                scale == rhs.scale && edit_mode == rhs.edit_mode &&
+                beats_per_bar == rhs.beats_per_bar &&
+                beat_width == rhs.beat_width && snap == rhs.snap &&
+                scroll_key == rhs.scroll_key && scroll_x == rhs.scroll_x &&
+                width == rhs.width && height == rhs.height;
+        }
+    };
+
+    /**
+     *  Holds the values that the note layer depends upon, besides the grid.
+     *  The edit versions and event counts change whenever the sequence (or
+     *  the background sequence) is modified.
+     */
+
+    struct note_stamp
+    {
+        unsigned long version;
+        int event_count;
+        const sequence * background;
+        unsigned long background_version;
+        int background_count;
+        midipulse length;
+
+        bool operator == (const note_stamp & rhs) const
+        {
+            return version == rhs.version &&
+                event_count == rhs.event_count &&
+                background == rhs.background &&
+                background_version == rhs.background_version &&
+                background_count == rhs.background_count &&
+                length == rhs.length;
+        }
+    };
+
+    /**
+     *  The area of the widget covered by the layer pixmaps.  Normally the
+     *  visible part of the roll; a paint outside of it rebuilds the layers.
+     */
+
+    QRect m_layer_rect;
+
+    /**
+     *  The grid lines and the scale shading, on a transparent background.
+     */
+
+    QPixmap m_grid_layer;
+
+    /**
+     *  A copy of the grid layer with the notes drawn on it.  This is what
+     *  paintEvent() blits before drawing the progress bar and selections.
+     */
+
+    QPixmap m_note_layer;
+
+    /**
+     *  The values from which m_grid_layer was drawn.
+     */
+
+    grid_stamp m_grid_stamp;
+
+    /**
+     *  The values from which m_note_layer was drawn.
+     */
+
+    note_stamp m_note_stamp;
+
+    /**
+     *  Set when the roll itself is marked dirty (e.g. by a selection), to
+     *  force the note layer to be redrawn on the next paint.
+     */
+
+    bool m_notes_dirty;
+
+    /**
+     *  Per-pixel summaries of the notes of the sequence and of the
+     *  background sequence, used instead of drawing each note when the
+     *  pattern is very dense at the current zoom.
+     */
+
+    event_summary m_summary;
+    event_summary m_background_summary;
+
 signals:
 
 public slots:
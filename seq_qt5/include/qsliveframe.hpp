@@ -33,6 +33,7 @@
  */
 
 #include <QFrame>
+#include <QPixmap>
 
 #include "globals.h"
 #include "gui_palette_qt5.hpp"
@@ -99,6 +100,7 @@ private:
     void calculate_base_sizes (int seq, int & basex, int & basey);
     void drawSequence (int seq);
     void drawAllSequences ();
+    bool update_preview (int seq, sequence * s, int w, int h);
     void updateInternalBankName ();
     bool valid_sequence (int seqnum);
     int seqIDFromClickXY (int click_x, int click_y);
@@ -155,6 +157,32 @@ private:
     bool m_last_playing[c_max_sequence];
     bool m_can_paste;
 
+    /**
+     *  Holds the note preview of one slot, drawn once into a pixmap, plus the
+     *  values it was drawn from.  The preview is redrawn only when one of
+     *  those values changes; otherwise a paint just blits the pixmap and
+     *  draws the progress bar on top of it.
+     */
+
+    struct preview
+    {
+        QPixmap pixmap;                 /**< The notes, on transparency.    */
+        const sequence * seq;           /**< The sequence it was drawn for. */
+        unsigned long version;          /**< sequence::edit_version().      */
+        int event_count;                /**< Catches unflagged edits.       */
+        midipulse length;               /**< Scales the x coordinates.      */
+        int width;                      /**< The preview width, in pixels.  */
+        int height;                     /**< The preview height, in pixels. */
+        bool transposable;              /**< Changes the note color.        */
+        bool have_notes;                /**< False if nothing was drawn.    */
+    };
+
+    /**
+     *  The cached previews, indexed by sequence number.
+     */
+
+    preview m_previews[c_max_sequence];
+
 private slots:
 
     void conditional_update ();
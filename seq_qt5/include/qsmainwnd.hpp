@@ -27,7 +27,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-02
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The main window is known as the "Patterns window" or "Patterns
@@ -74,6 +74,7 @@ namespace seq64
     class qseqeditex;
     class qseqeditframe;
     class qsmaintime;
+    class qsnotifier;
     class qseditoptions;
     class qsabout;
     class qsbuildinfo;
@@ -178,7 +179,9 @@ private:
     qseqeditframe * m_edit_frame;
     QErrorMessage * m_msg_error;
     QMessageBox * m_msg_save_changes;
+    qsnotifier * m_notifier;
     QTimer * m_timer;
+    QTimer * m_save_timer;
     QMenu * m_menu_recent;
     QList<QAction *> m_recent_action_list;     // new
     const int mc_max_recent_files;
@@ -247,6 +250,7 @@ private slots:
     void showqsbuildinfo ();
     void tabWidgetClicked (int newindex);
     void refresh ();                    /* redraw certain GUI elements      */
+    void check_saves ();                /* autosave, background errors      */
     void load_editor (int seqid);
     void load_qseqedit (int seqid);
     void load_qperfedit (bool on);
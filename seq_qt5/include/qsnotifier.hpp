@@ -0,0 +1,148 @@
+#ifndef SEQ64_QSNOTIFIER_HPP
+#define SEQ64_QSNOTIFIER_HPP
+
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          qsnotifier.hpp
+ *
+ *  This module declares the object that turns the engine's change
+ *  notifications into redraw "frames" for all of the Qt widgets.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  Instead of each widget running its own redraw timer, the widgets connect
+ *  their conditional_update() slots to the frame() signal of the single
+ *  qsnotifier, created by qsmainwnd.  A frame is scheduled, at most one
+ *  redraw period later, when the engine posts a change (see the rt_notify
+ *  module) or when the user presses a key or drags the mouse.  When nothing
+ *  happens, no timer runs at all.
+ */
+
+#include <QObject>
+
+#include "globals.h"                    /* c_max_sequence                   */
+
+class QEvent;
+class QSocketNotifier;
+class QTimer;
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+    class perform;
+
+/**
+ *  Drains the engine's change notifications and emits the frame() signal.
+ */
+
+class qsnotifier : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    qsnotifier (perform & p, QObject * parent = nullptr);
+    virtual ~qsnotifier ();
+
+    static QTimer * attach
+    (
+        QObject * receiver, const char * slot, int interval
+    );
+    static unsigned current_changes ();
+    static bool sequence_changed (int seq);
+    static bool sequences_changed (int first, int count);
+
+protected:
+
+    bool eventFilter (QObject * target, QEvent * event);
+
+signals:
+
+    void frame ();
+
+private slots:
+
+    void wake ();
+    void emit_frame ();
+
+private:
+
+    void schedule ();
+
+private:
+
+    /**
+     *  The single notifier, if one has been created.  Widgets created
+     *  without one (e.g. in a test harness) fall back to their own timers.
+     */
+
+    static qsnotifier * sm_instance;
+
+    /**
+     *  The performance object whose changes are drained.
+     */
+
+    perform & m_perform;
+
+    /**
+     *  Watches the read end of the wake-up pipe.  Null if the platform has
+     *  no pipe, in which case m_frame_timer simply runs all of the time.
+     */
+
+    QSocketNotifier * m_socket;
+
+    /**
+     *  The single-shot timer that delays a frame by up to one redraw period,
+     *  to coalesce all of the changes made in that period.
+     */
+
+    QTimer * m_frame_timer;
+
+    /**
+     *  The changes drained for the frame being emitted.
+     */
+
+    unsigned m_changes;
+
+    /**
+     *  The sequences changed in the frame being emitted.
+     */
+
+    bool m_sequences[c_max_sequence];
+
+};          // class qsnotifier
+
+}           // namespace seq64
+
+#endif      // SEQ64_QSNOTIFIER_HPP
+
+/*
+ * qsnotifier.hpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -95,6 +95,7 @@ HEADERS += \
  include/qsmacros.hpp \
  include/qsmaintime.hpp \
  include/qsmainwnd.hpp \
+ include/qsnotifier.hpp \
  include/qstriggereditor.hpp \
  include/qt5_helpers.hpp \
  include/qsbuildinfo.hpp \
@@ -129,6 +130,7 @@ SOURCES += \
  src/qsliveframe.cpp \
  src/qsmaintime.cpp \
  src/qsmainwnd.cpp \
+ src/qsnotifier.cpp \
  src/qstriggereditor.cpp \
  src/qt5_helpers.cpp \
  src/qsbuildinfo.cpp \
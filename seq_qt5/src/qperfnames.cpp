@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-17
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This module is almost exclusively user-interface code.  There are some
@@ -44,9 +44,11 @@
  */
 
 #include <QMouseEvent>
+#include <QPaintEvent>
 
 #include "perform.hpp"
 #include "qperfnames.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -87,12 +89,16 @@ qperfnames::~qperfnames ()
 }
 
 /**
- *
+ *  Draws the names of the patterns, but only the rows in the exposed area,
+ *  so that the number of patterns in the song does not affect the cost of
+ *  a paint.  The start is moved back to the start of a bank, so that the
+ *  sideways bank name is always drawn whole.
  */
 
 void
-qperfnames::paintEvent (QPaintEvent *)
+qperfnames::paintEvent (QPaintEvent * qpep)
 {
+    rt_trace_span span("qperfnames::paintEvent");
     QPainter painter(this);
     QPen pen(Qt::black);
     QBrush brush(Qt::lightGray);
@@ -105,8 +111,10 @@ qperfnames::paintEvent (QPaintEvent *)
     painter.setBrush(brush);
     painter.setFont(m_font);
 
-    int y_s = 0;
-    int y_f = height() / m_nametext_y;
+    QRect r = qpep->rect();                     /* only the exposed rows    */
+    int y_s = r.top() / m_nametext_y;
+    y_s -= y_s % c_seqs_in_set;                 /* whole bank name label    */
+    int y_f = r.bottom() / m_nametext_y;
     painter.drawRect(0, 0, width(), height() - 1);          // draw border
     for (int y = y_s; y <= y_f; ++y)
     {
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
@@ -40,7 +40,9 @@
 #include "perform.hpp"
 #include "qperfeditframe64.hpp"
 #include "qperfroll.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
 #include "rect.hpp"                     /* seq64::rect::xy_to_rect_get()    */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* seq64::usr().key_height(), etc.  */
 
 /*
@@ -85,7 +87,9 @@ qperfroll::qperfroll
     m_sequence_active   (),         // array
     mBoxSelect          (false),
     m_grow_direction    (false),
-    m_adding_pressed    (false)
+    m_adding_pressed    (false),
+    m_tiles             (),         // array
+    m_layout_stamp      (0)
 {
     setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     setFocusPolicy(Qt::StrongFocus);
@@ -95,10 +99,10 @@ qperfroll::qperfroll
     m_roll_length_ticks  = perf().get_max_trigger();
     m_roll_length_ticks -= (m_roll_length_ticks % (ppqn() * 16));
     m_roll_length_ticks += ppqn() * 64;              // ?????
-    m_timer = new QTimer(this);                             // timer for redraws
-    m_timer->setInterval(usr().window_redraw_rate());       // 50
-    QObject::connect(m_timer, SIGNAL(timeout()), this, SLOT(conditional_update()));
-    m_timer->start();
+    m_timer = qsnotifier::attach
+    (
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
+    );
 }
 
 /**
@@ -107,23 +111,192 @@ qperfroll::qperfroll
 
 qperfroll::~qperfroll ()
 {
-    m_timer->stop();
+    if (not_nullptr(m_timer))
+        m_timer->stop();
 }
 
 /**
- *
+ *  Repaints the whole roll if it was marked dirty, or if any trigger or
+ *  pattern changed since the last paint.  Otherwise, while playing, only
+ *  the progress bar is repainted.
  */
 
 void
 qperfroll::conditional_update ()
 {
-    if (needs_update())
+    bool edited = check_dirty() || layout_stamp() != m_layout_stamp;
+    if (edited || perf().is_running())
     {
         if (perf().follow_progress())
             follow_progress();              /* keep up with progress    */
 
-        update();
+        if (edited)
+        {
+            old_progress_x(perf().get_tick() / scale_zoom());
+            update();
+        }
+        else
+            update_progress();
+    }
+}
+
+/**
+ *  Repaints the strip where the progress bar was, and the strip where it is
+ *  now.
+ */
+
+void
+qperfroll::update_progress ()
+{
+    int prog_x = perf().get_tick() / scale_zoom();
+    int old_x = old_progress_x();
+    if (prog_x != old_x)
+    {
+        const int pad = 3;                  /* covers a thick progress bar  */
+        old_progress_x(prog_x);
+        update(old_x - pad, 0, 2 * pad, height());
+        update(prog_x - pad, 0, 2 * pad, height());
+    }
+}
+
+/**
+ *  Calculates a checksum of everything drawn in the trigger boxes:  the
+ *  edit version and color of each active pattern, and the position,
+ *  offset, and selection of each of its triggers.  This walks only the
+ *  triggers, not the events, and only the rows that are scrolled into
+ *  view, so it is cheap enough to do on every tick of the redraw timer, no
+ *  matter how many patterns the song has.  Scrolling repaints the newly
+ *  exposed rows anyway, and that paint takes a new stamp.
+ *
+ * \return
+ *      Returns the checksum; if it differs from the previous one, the roll
+ *      needs a full repaint.
+ */
+
+unsigned long
+qperfroll::layout_stamp ()
+{
+    unsigned long result = (unsigned long) scale_zoom();
+    QRect v = visibleRegion().boundingRect();
+    int first = v.top() / c_names_y;
+    int last = v.bottom() / c_names_y;
+    if (last >= c_max_sequence)
+        last = c_max_sequence - 1;
+
+    result = result * 31 + first;
+    for (int seqid = first; seqid <= last; ++seqid)
+    {
+        if (perf().is_active(seqid))
+        {
+            sequence * seq = perf().get_sequence(seqid);
+            midipulse tick_on;
+            midipulse tick_off;
+            midipulse offset;
+            bool selected;
+            result = result * 31 + seqid;
+            result = result * 31 + seq->edit_version();
+            result = result * 31 + seq->event_count();
+            result = result * 31 + seq->get_length();
+            result = result * 31 + perf().get_sequence_color(seqid);
+            seq->reset_draw_trigger_marker();
+            while (seq->get_next_trigger(tick_on, tick_off, selected, offset))
+            {
+                result = result * 31 + tick_on;
+                result = result * 31 + tick_off;
+                result = result * 31 + offset;
+                result = result * 31 + (selected ? 1 : 0);
+            }
+        }
+    }
+    return result;
+}
+
+/**
+ *  Gets the tile holding the notes of one loop of a pattern, redrawing it
+ *  only if the pattern or the zoom changed since it was last drawn.  The
+ *  tile is as wide as the pattern at the current zoom, and as high as a
+ *  trigger box.
+ *
+ * \param seqid
+ *      The number of the pattern, the index into m_tiles[].
+ *
+ * \param s
+ *      The pattern.  Not checked for null.
+ *
+ * \return
+ *      Returns a reference to the tile's pixmap.
+ */
+
+const QPixmap &
+qperfroll::pattern_tile (int seqid, sequence * s)
+{
+    tile & t = m_tiles[seqid];
+    unsigned long version = s->edit_version();
+    int eventcount = s->event_count();
+    midipulse length = s->get_length();
+    bool transposable = s->get_transposable();
+    bool current =
+        t.seq == s && t.version == version && t.event_count == eventcount &&
+        t.length == length && t.zoom == scale_zoom() &&
+        t.transposable == transposable;
+
+    if (current)
+        return t.pixmap;
+
+    t.seq = s;
+    t.version = version;
+    t.event_count = eventcount;
+    t.length = length;
+    t.zoom = scale_zoom();
+    t.transposable = transposable;
+
+    int length_w = length / scale_zoom();
+    int h = c_names_y - 2;
+    if (length <= 0 || length_w <= 0)
+    {
+        t.pixmap = QPixmap();
+        return t.pixmap;
+    }
+
+    t.pixmap = QPixmap(length_w + 1, h);
+    t.pixmap.fill(Qt::transparent);
+
+    QPainter painter(&t.pixmap);
+    QPen pen(transposable ? Qt::black : Qt::red);
+    painter.setPen(pen);
+
+    render_snapshot::pointer snap = s->snapshot();      /* no locking   */
+    int lowest_note;
+    int highest_note;
+    (void) snap->minmax(lowest_note, highest_note);
+
+    int height = highest_note - lowest_note;
+    height += 2;
+
+    const render_snapshot::Notes & notes = snap->notes();
+    render_snapshot::Notes::const_iterator ni;
+    for (ni = notes.begin(); ni != notes.end(); ++ni)
+    {
+        /*
+         * TODO:  handle DRAW_TEMPO
+         */
+
+        draw_type_t dt = ni->type;
+        int note_y = ((c_names_y - 6) -
+            ((c_names_y - 6)  * (ni->key - lowest_note)) / height) + 1;
+
+        int tick_s_x = (ni->tick_s * length_w) / length;
+        int tick_f_x = (ni->tick_f * length_w) / length;
+        if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
+            tick_f_x = tick_s_x + 1;
+
+        if (tick_f_x <= tick_s_x)
+            tick_f_x = tick_s_x + 1;
+
+        painter.drawLine(tick_s_x, note_y, tick_f_x, note_y);
     }
+
+    return t.pixmap;
 }
 
 /**
@@ -139,12 +312,21 @@ qperfroll::follow_progress ()
 }
 
 /**
+ *  Draws the part of the roll that needs updating:  the grid lines, the
+ *  trigger boxes of the rows in that area (with their pattern tiles), the
+ *  selection box, and finally the progress bar, on top of everything.
  *
+ * \param qpep
+ *      Provides the area to be repainted.
  */
 
 void
-qperfroll::paintEvent (QPaintEvent *)
+qperfroll::paintEvent (QPaintEvent * qpep)
 {
+    rt_trace_span span("qperfroll::paintEvent");
+    QRect r = qpep->rect();
+    m_layout_stamp = layout_stamp();
+
     QPainter painter(this);
     QBrush brush(Qt::NoBrush);
     QPen pen(Qt::black);
@@ -155,22 +337,45 @@ qperfroll::paintEvent (QPaintEvent *)
     painter.setFont(m_font);
     painter.drawRect(0, 0, width(), height());      // EXPERIMENTAL
 
-    for (int i = 0; i < height(); i += c_names_y)
+    int y_s = r.top() / c_names_y;                  /* rows to be drawn     */
+    int y_f = r.bottom() / c_names_y;
+    for (int i = y_s * c_names_y; i <= r.bottom(); i += c_names_y)
     {
         pen.setStyle(Qt::SolidLine);            /* draw horizontal lines    */
         pen.setColor(Qt::lightGray);
         painter.setPen(pen);
-        painter.drawLine(0, i, width(), i);
+        painter.drawLine(r.left(), i, r.right() + 1, i);
     }
 
     /*
-     *  Draw the vertical lines for the measures and the beats.
+     *  Draw the vertical lines for the measures and the beats.  Only beats
+     *  get lines, so step through the beats of the area to be drawn, not
+     *  through every tick.
      */
 
     midipulse tick0 = scroll_offset_ticks();
     midipulse windowticks = length_ticks(width());
     midipulse tick1 = tick0 + windowticks;
+#if USE_TOO_MANY_LINES
     midipulse tickstep = 1;
+#else
+    midipulse tickstep = beat_length();
+#endif
+    if (tickstep <= 0)
+        tickstep = 1;
+
+    int left_x = r.left() - 1 - scroll_offset_x();
+    int right_x = r.right() + 2 - scroll_offset_x();
+    midipulse left_tick = tick0 + midipulse(left_x) * scale_zoom();
+    midipulse right_tick = tick0 + midipulse(right_x) * scale_zoom();
+    if (left_tick > tick0)
+        tick0 = left_tick;
+
+    tick0 -= tick0 % tickstep;
+
+    if (right_tick < tick1)
+        tick1 = right_tick;
+
     pen.setStyle(Qt::SolidLine);
     for (midipulse tick = tick0; tick < tick1; tick += tickstep)
     {
@@ -202,9 +407,8 @@ qperfroll::paintEvent (QPaintEvent *)
         }
 #endif
     }
+    pen.setWidth(1);
 
-    int y_s = 0;                                    // draw background
-    int y_f = height() / c_names_y;
     midipulse tick_on;                              // draw sequence block
     midipulse tick_off;
     midipulse offset;
@@ -223,8 +427,8 @@ qperfroll::paintEvent (QPaintEvent *)
                 sequence * seq =  perf().get_sequence(seqId);
 
                 midipulse seq_length = seq->get_length();
+                const QPixmap & notes = pattern_tile(seqId, seq);
                 seq->reset_draw_trigger_marker();
-                int length_w = seq_length / scale_zoom();
                 while (seq->get_next_trigger(tick_on, tick_off, selected, offset))
                 {
                     if (tick_off > 0)
@@ -236,6 +440,9 @@ qperfroll::paintEvent (QPaintEvent *)
                         int y = c_names_y * seqId + 1;  // + 2
                         int h = c_names_y - 2; // - 4
                         x = x - x_offset;   // adjust to screen coordinates
+                        if (x > r.right() || x + w < r.left())
+                            continue;                   /* not in the area  */
+
                         if (selected)
                             pen.setColor( "orange" /*Qt::red*/ );
                         else
@@ -269,8 +476,8 @@ qperfroll::paintEvent (QPaintEvent *)
                             c_perfroll_size_box_w, c_perfroll_size_box_w
                         );
 
-                        pen.setColor(Qt::black);
-                        painter.setPen(pen);
+                        if (seq_length <= 0)
+                            continue;
 
                         midipulse length_marker_first_tick =
                         (
@@ -278,81 +485,20 @@ qperfroll::paintEvent (QPaintEvent *)
                             (offset % seq_length) - seq_length
                         );
 
+                        /*
+                         * Copy the note tile into each repetition of the
+                         * pattern, clipped to the trigger box.
+                         */
+
+                        painter.setClipRect(QRect(x, y, w + 1, h) & r);
                         midipulse tick_marker = length_marker_first_tick;
                         while (tick_marker < tick_off)
                         {
-                            midipulse tick_marker_x =
+                            int tick_marker_x =
                                 tick_marker / scale_zoom() - x_offset;
 
-                            int lowest_note;  // = seq->get_lowest_note_event();
-                            int highest_note; // = seq->get_highest_note_event();
-                            (void) seq->get_minmax_note_events
-                            (
-                                lowest_note, highest_note
-                            );
-
-                            int height = highest_note - lowest_note;
-                            height += 2;
-
-                            int length = seq->get_length();
-                            midipulse tick_s;
-                            midipulse tick_f;
-                            int note;
-                            bool selected;
-                            int velocity;
-                            draw_type_t dt;
-                            seq->reset_draw_marker();
-                            if (seq->get_transposable())
-                                pen.setColor(Qt::black);
-                            else
-                                pen.setColor(Qt::red);
-
-                            painter.setPen(pen);
-                            do
-                            {
-                                dt = seq->get_next_note_event
-                                (
-                                    tick_s, tick_f, note, selected, velocity
-                                );
-                                if (dt == DRAW_FIN)
-                                    break;
-
-                                /*
-                                 * TODO:  handle DRAW_TEMPO
-                                 */
-
-                                int note_y = ((c_names_y - 6) -
-                                    ((c_names_y - 6)  * (note - lowest_note)) /
-                                    height) + 1;
-
-                                int tick_s_x = ((tick_s * length_w) / length) +
-                                    tick_marker_x;
-
-                                int tick_f_x = ((tick_f * length_w) / length) +
-                                    tick_marker_x;
-
-                                if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
-                                    tick_f_x = tick_s_x + 1;
-
-                                if (tick_f_x <= tick_s_x)
-                                    tick_f_x = tick_s_x + 1;
-
-                                if (tick_s_x < x)
-                                    tick_s_x = x;
-
-                                if (tick_f_x > x + w)
-                                    tick_f_x = x + w;
-
-                                if (tick_f_x >= x && tick_s_x <= x + w)
-                                {
-                                    painter.drawLine
-                                    (
-                                        tick_s_x, y + note_y,
-                                        tick_f_x, y + note_y
-                                    );
-                                }
-
-                            } while (dt != DRAW_FIN);
+                            if (! notes.isNull())
+                                painter.drawPixmap(tick_marker_x, y, notes);
 
                             if (tick_marker > tick_on)
                             {
@@ -363,6 +509,7 @@ qperfroll::paintEvent (QPaintEvent *)
                             }
                             tick_marker += seq_length;
                         }
+                        painter.setClipping(false);
                     }
                 }
             }
@@ -395,11 +542,11 @@ qperfroll::paintEvent (QPaintEvent *)
     painter.drawRect(0, 0, width(), height() - 1);
 
     /*
-     * draw_progress():
+     * draw_progress():  drawn last, as an overlay.  The position is
+     * calculated in conditional_update().
      */
 
-    midipulse tick = perf().get_tick();         // draw playhead
-    int progress_x = tick / scale_zoom();
+    int progress_x = old_progress_x();          // draw playhead
     pen.setColor(Qt::red);
     pen.setStyle(Qt::SolidLine);
     if (usr().progress_bar_thick())
@@ -623,6 +770,9 @@ qperfroll::mouseReleaseEvent (QMouseEvent * event)
         set_adding(false);
     }
 
+    if (mBoxSelect)
+        update();                           /* erase the selection box  */
+
     clear_action_flags();
     m_adding_pressed = false;
     mBoxSelect = false;
@@ -722,6 +872,7 @@ qperfroll::mouseMoveEvent (QMouseEvent * event)
         current_y(event->y());
         snap_current_y();
         convert_xy(0, current_y(), tick, m_drop_sequence);
+        update();                           /* move the selection box   */
     }
     mLastTick = tick;
 }
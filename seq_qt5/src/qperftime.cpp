@@ -25,13 +25,15 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-04
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Compare to perftime, the Gtkmm-2.4 implementation of this class.
  */
 
 #include "qperftime.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"
 
 /*
@@ -55,17 +57,15 @@ qperftime::qperftime
 ) :
     QWidget             (parent),
     qperfbase           (p, zoom, snap, 1, 1 * 1),
-    m_timer             (new QTimer(this)), // refresh timer for redraws
+    m_timer             (nullptr),
     m_font              (),
     m_4bar_offset       (0)
 {
     m_font.setBold(true);
-    QObject::connect
+    m_timer = qsnotifier::attach
     (
-        m_timer, SIGNAL(timeout()), this, SLOT(conditional_update())
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
     );
-    m_timer->setInterval(usr().window_redraw_rate());    // 50
-    m_timer->start();
     setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 }
 
@@ -91,6 +91,7 @@ qperftime::conditional_update ()
 void
 qperftime::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qperftime::paintEvent");
     QPainter painter(this);
     QBrush brush(Qt::lightGray, Qt::SolidPattern);
     QPen pen(Qt::black);
@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-14
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The data pane is the drawing-area below the seqedit's event area, and
@@ -34,10 +34,15 @@
  *  The height of the vertical lines is editable via the mouse.
  */
 
+#include <QPaintEvent>
+
+#include "event_summary.hpp"            /* seq64::event_summary             */
 #include "Globals.hpp"
 #include "perform.hpp"
 #include "qseqdata.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
 #include "rect.hpp"                     /* seq64::rect::xy_to_rect_get()    */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 #include "settings.hpp"                 /* seq64::usr().key_height(), etc.  */
 
@@ -70,13 +75,17 @@ qseqdata::qseqdata
     m_cc                (1),
     m_line_adjust       (false),
     m_relative_adjust   (false),
-    m_dragging          (false)
+    m_dragging          (false),
+    m_lane              (),
+    m_lines             (),
+    m_range_lines       (),
+    m_lines_height      (0)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
-    mTimer = new QTimer(this);                          // redraw timer !!!
-    mTimer->setInterval(usr().window_redraw_rate());    // 20
-    QObject::connect(mTimer, SIGNAL(timeout()), this, SLOT(conditional_update()));
-    mTimer->start();
+    mTimer = qsnotifier::attach
+    (
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
+    );
 }
 
 /**
@@ -106,6 +115,59 @@ qseqdata::sizeHint () const
 }
 
 /**
+ *  Finds the first of a list of vertical lines, sorted by x, that is at or
+ *  to the right of a pixel column.
+ */
+
+static int
+s_first_line_at (const QVector<QLine> & lines, int x)
+{
+    int lo = 0;
+    int hi = lines.size();
+    while (lo < hi)
+    {
+        int mid = lo + (hi - lo) / 2;
+        if (lines[mid].x1() < x)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ *  Rebuilds the cached lines from the bars of the data lane.  Called only
+ *  when the lane has been rebuilt or the pane has changed height, so
+ *  scrolling and repainting reuse the lines.
+ */
+
+void
+qseqdata::build_lines ()
+{
+    const data_lane::Bars & bars = m_lane.bars();
+    int h = height();
+    m_lines.clear();
+    m_range_lines.clear();
+    m_lines.reserve(int(bars.size()));
+    for
+    (
+        data_lane::Bars::const_iterator bi = bars.begin();
+        bi != bars.end(); ++bi
+    )
+    {
+        int x = bi->x + 1;
+        m_lines.append(QLine(x, h - bi->high, x, h));
+        if (bi->count > 1 && bi->low < bi->high)
+            m_range_lines.append(QLine(x, h - bi->low, x, h));
+    }
+    m_lines_height = h;
+}
+
+/**
+ *  Draws the lines of the events that fall in the exposed part of the pane.
+ *  The lines come from the cache built by build_lines(), and each set of
+ *  lines is drawn in one batch.  The value digits are drawn for each
+ *  visible column, unless the events are too dense for them to be read.
  *
  * \note
  *      We had a weird issue with the following function, where d1 would be
@@ -114,12 +176,17 @@ qseqdata::sizeHint () const
  *
  *      seq().get_next_event_kepler(m_status, m_cc, tick, d0, d1, selected)
  *
- *      Instead, we create an iterator and use sequence::get_next_event_ex().
+ *      The data_lane now walks the events with an iterator and
+ *      sequence::get_next_event_match().
+ *
+ * \param qpep
+ *      Provides the rectangle to be repainted.
  */
 
 void
-qseqdata::paintEvent (QPaintEvent *)
+qseqdata::paintEvent (QPaintEvent * qpep)
 {
+    rt_trace_span span("qseqdata::paintEvent");
     QPainter painter(this);
     QPen pen(Qt::black);
     QBrush brush(Qt::lightGray, Qt::SolidPattern);
@@ -129,48 +196,50 @@ qseqdata::paintEvent (QPaintEvent *)
     painter.setFont(mFont);
     painter.drawRect(0, 0, width() - 1, height() - 1);
 
-    event_list::const_iterator cev;
-    int starttick = 0;
-    int endtick = width() * zoom();
-    seq().reset_ex_iterator(cev);               /* reset_draw_marker()      */
-    while (seq().get_next_event_match(m_status, m_cc, cev))
-    {
-        midipulse tick = cev->get_timestamp();
-        if (tick >= starttick && tick <= endtick)
-        {
-            /*
-             *  Convert to screen coordinates.
-             */
+    bool rebuilt = m_lane.update(seq(), zoom(), m_status, m_cc);
+    if (rebuilt || m_lines_height != height())
+        build_lines();
 
-            midibyte d0, d1;
-            int event_x = tick / zoom();        /* + c_keyboard_padding_x;  */
-            cev->get_data(d0, d1);
-
-            int event_height = d1;              /* generate the value       */
-            if (event::is_one_byte_msg(m_status))
-                event_height = d0;
+    /*
+     *  The lines are drawn at the bar's column plus one, two pixels wide,
+     *  and the digits extend about 8 pixels to the right of them.
+     */
 
-            pen.setWidth(2);                    /* draw vertical grid lines */
-            painter.setPen(pen);
-            painter.drawLine
-            (
-                event_x + 1, height() - event_height, event_x + 1, height()
-            );
+    const QRect & area = qpep->rect();
+    int first = m_lane.first_at(area.left() - 12);
+    int last = m_lane.first_at(area.right() + 2);
+    bool dense = event_summary::use_summary(seq(), zoom());
+    pen.setWidth(dense ? 1 : 2);
+    painter.setPen(pen);
+    if (last > first)
+        painter.drawLines(m_lines.constData() + first, last - first);
 
+    int rfirst = s_first_line_at(m_range_lines, area.left() - 12);
+    int rlast = s_first_line_at(m_range_lines, area.right() + 2);
+    if (rlast > rfirst)
+    {
+        pen.setColor(Qt::gray);
+        painter.setPen(pen);
+        painter.drawLines(m_range_lines.constData() + rfirst, rlast - rfirst);
+        pen.setColor(Qt::black);
+    }
+    if (! dense)
+    {
+        const data_lane::Bars & bars = m_lane.bars();
+        pen.setWidth(1);
+        painter.setPen(pen);
+        for (int i = first; i < last; ++i)
+        {
             char tmp[4];
-            snprintf(tmp, sizeof tmp, "%3d", d1);   /* to draw digits       */
-            pen.setColor(Qt::black);
-            pen.setWidth(1);
-            painter.setPen(pen);
+            snprintf(tmp, sizeof tmp, "%3d", bars[i].value);   /* digits  */
 
-            int x_offset = event_x + 3;
+            int x_offset = bars[i].x + 3;
             int y_offset = c_dataarea_y - 25;
             QString val = tmp;
             painter.drawText(x_offset, y_offset,      val.at(0));
             painter.drawText(x_offset, y_offset +  8, val.at(1));
             painter.drawText(x_offset, y_offset + 16, val.at(2));
         }
-        ++cev;
     }
 
     if (m_line_adjust)                            // draw edit line
@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-10
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This version of the qseqedit-frame class is basically the Kepler34
@@ -90,6 +90,7 @@ QGridLayout     | y |                                                   | a |
 #include "qseqkeys.hpp"
 #include "qseqroll.hpp"
 #include "qseqtime.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
 #include "qstriggereditor.hpp"
 #include "qt5_helpers.hpp"              /* seq64::qt_set_icon()             */
 #include "settings.hpp"                 /* usr()                            */
@@ -436,13 +437,10 @@ qseqeditframe::qseqeditframe
     connect(ui->btnThru, SIGNAL(clicked(bool)), this, SLOT(toggleMidiThru(bool)));
     qt_set_icon(thru_xpm, ui->btnThru);
 
-    m_timer = new QTimer(this);                             // redraw timer !!!
-    m_timer->setInterval(2 * usr().window_redraw_rate());   // 20
-    QObject::connect
+    m_timer = qsnotifier::attach
     (
-        m_timer, SIGNAL(timeout()), this, SLOT(conditional_update())
+        this, SLOT(conditional_update()), 2 * usr().window_redraw_rate()
     );
-    m_timer->start();
 }
 
 /**
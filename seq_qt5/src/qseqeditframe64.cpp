@@ -26,7 +26,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-06-15
- * \updates       2018-08-12
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The data pane is the drawing-area below the seqedit's event area, and
@@ -104,6 +104,7 @@ QWidget container?
 #include "qseqkeys.hpp"
 #include "qseqroll.hpp"
 #include "qseqtime.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
 #include "qstriggereditor.hpp"
 #include "qt5_helpers.hpp"              /* seq64::qt_set_icon()             */
 #include "settings.hpp"                 /* usr()                            */
@@ -1132,13 +1133,10 @@ qseqeditframe64::qseqeditframe64 (perform & p, int seqid, QWidget * parent)
     m_seqroll->progress_follow(seqwidth > scrollwidth);
     ui->m_toggle_follow->setChecked(m_seqroll->progress_follow());
 
-    m_timer = new QTimer(this);                             /* redraw timer */
-    m_timer->setInterval(2 * usr().window_redraw_rate());   /* 20           */
-    QObject::connect
+    m_timer = qsnotifier::attach
     (
-        m_timer, SIGNAL(timeout()), this, SLOT(conditional_update())
+        this, SLOT(conditional_update()), 2 * usr().window_redraw_rate()
     );
-    m_timer->start();
 }
 
 /**
@@ -34,6 +34,7 @@
  */
 
 #include "qseqkeys.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 
 /*
@@ -71,6 +72,7 @@ qseqkeys::qseqkeys
 void
 qseqkeys::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qseqkeys::paintEvent");
     QPainter painter(this);
     QPen pen(Qt::black);
     QBrush brush (Qt::SolidPattern);
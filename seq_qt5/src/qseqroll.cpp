@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-11
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  Please see the additional notes for the Gtkmm-2.4 version of this panel,
@@ -41,6 +41,8 @@
 #include "qseqeditframe64.hpp"          /* seq64::qseqeditframe64 class     */
 #include "qseqframe.hpp"                /* interface class for seqedits     */
 #include "qseqroll.hpp"                 /* seq64::qseqroll class            */
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* seq64::usr().key_height(), etc.  */
 
 /*
@@ -98,19 +100,24 @@ qseqroll::qseqroll
     note_y                  (0),
     note_height             (0),
     m_key_y                 (usr().key_height()),
-    m_keyarea_y             (m_key_y * c_num_keys + 1)
+    m_keyarea_y             (m_key_y * c_num_keys + 1),
+    m_layer_rect            (),
+    m_grid_layer            (),
+    m_note_layer            (),
+    m_grid_stamp            (),
+    m_note_stamp            (),
+    m_notes_dirty           (true),
+    m_summary               (),
+    m_background_summary    ()
 {
     set_snap(seq.get_snap_tick());
     setFocusPolicy(Qt::StrongFocus);
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
     show();
-    m_timer = new QTimer(this);                          // redraw timer !!!
-    m_timer->setInterval(usr().window_redraw_rate());    // 20
-    QObject::connect
+    m_timer = qsnotifier::attach
     (
-        m_timer, SIGNAL(timeout()), this, SLOT(conditional_update())
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
     );
-    m_timer->start();
 }
 
 /**
@@ -176,29 +183,265 @@ qseqroll::set_background_sequence (bool state, int seq)
 
 /**
  *  In an effort to reduce CPU usage when simply idling, this function calls
- *  update() only if necessary.  See qseqbase::needs_update().
+ *  update() only if necessary.  See qseqbase::needs_update().  If the roll or
+ *  the sequence has changed, the whole roll is repainted, and paintEvent()
+ *  figures out which layers need to be redrawn.  Otherwise (i.e. just
+ *  playing), only the progress bar is repainted.
  */
 
 void
 qseqroll::conditional_update ()
 {
-    if (needs_update())
+    bool edited = check_dirty() || notes_changed();
+    if (edited || perf().needs_update(seq().number()))
     {
         if (progress_follow())
             follow_progress();              /* keep up with progress    */
 
-        update();
+        if (edited)
+        {
+            m_notes_dirty = true;
+            old_progress_x(seq().get_last_tick() / zoom() + c_keyboard_padding_x);
+            update();
+        }
+        else
+            update_progress();
+    }
+}
+
+/**
+ *  Checks whether the sequence, or the background sequence, has been
+ *  modified since the note layer was drawn.
+ *
+ * \return
+ *      Returns true if the note layer is stale.
+ */
+
+bool
+qseqroll::notes_changed () const
+{
+    if (seq().edit_version() != m_note_stamp.version)
+        return true;
+
+    if (seq().event_count() != m_note_stamp.event_count)
+        return true;
+
+    if (seq().get_length() != m_note_stamp.length)
+        return true;
+
+    if (not_nullptr(m_note_stamp.background))
+    {
+        const sequence * bs = m_note_stamp.background;
+        if (bs->edit_version() != m_note_stamp.background_version)
+            return true;
+
+        if (bs->event_count() != m_note_stamp.background_count)
+            return true;
+    }
+    return false;
+}
+
+/**
+ *  Repaints the strip where the progress bar was, and the strip where it is
+ *  now.  Everything else on the roll stays as it is.
+ */
+
+void
+qseqroll::update_progress ()
+{
+    int prog_x = seq().get_last_tick() / zoom() + c_keyboard_padding_x;
+    int old_x = old_progress_x();
+    if (prog_x != old_x)
+    {
+        const int pad = 3;                  /* covers a thick progress bar  */
+        old_progress_x(prog_x);
+        update(old_x - pad, 0, 2 * pad, height());
+        update(prog_x - pad, 0, 2 * pad, height());
     }
 }
 
 /**
- *  Draws the piano roll.
+ *  Draws the piano roll.  The grid and the notes come from the layer
+ *  pixmaps, which are brought up to date first; then the progress bar and
+ *  any selection box are drawn on top.  Only the area to be updated is
+ *  copied, which during playback is just the strips around the progress bar.
+ *
+ * \param qpep
+ *      Provides the area to be repainted.
  */
 
 void
-qseqroll::paintEvent (QPaintEvent *)
+qseqroll::paintEvent (QPaintEvent * qpep)
 {
+    rt_trace_span span("qseqroll::paintEvent");
+    QRect r = qpep->rect();
+    update_layers(r);
+
     QPainter painter(this);
+    QBrush brush(Qt::NoBrush);
+    QPen pen(Qt::red);
+    painter.drawPixmap(r, m_note_layer, r.translated(-m_layer_rect.topLeft()));
+
+    /*
+     * draw_progress_on_window():
+     *
+     *  Note that the progress-bar position is based on the
+     *  sequence::get_last_tick() value, the current zoom, and the current
+     *  scroll-offset x value.  It is calculated in conditional_update().
+     *
+     *  If this test is used, then when not running, the overwrite
+     *  functionality of recording will not work: if (perf().is_running())
+     */
+
+    int prog_x = old_progress_x();
+    pen.setStyle(Qt::SolidLine);
+    if (usr().progress_bar_thick())
+        pen.setWidth(2);
+    else
+        pen.setWidth(1);
+
+    painter.setPen(pen);
+    painter.drawLine(prog_x, 0, prog_x, height());
+    pen.setWidth(1);
+
+    int x, y, w, h;                     /* draw selections              */
+    brush.setStyle(Qt::NoBrush);        /* painter reset                */
+    painter.setBrush(brush);
+    if (select_action())                /* select/move/paste/grow       */
+        pen.setStyle(Qt::SolidLine);
+
+    if (selecting())
+    {
+        rect::xy_to_rect_get
+        (
+            drop_x(), drop_y(), current_x(), current_y(), x, y, w, h
+        );
+
+        old_rect().set(x, y, w, h + m_key_y);
+        pen.setColor("orange");         /*  pen.setColor(Qt::black);    */
+        painter.setPen(pen);
+        painter.drawRect(x + c_keyboard_padding_x, y, w, h + m_key_y);
+    }
+
+    if (drop_action())
+    {
+        int delta_x = current_x() - drop_x();
+        int delta_y = current_y() - drop_y();
+        x = selection().x() + delta_x;
+        y = selection().y() + delta_y;
+        pen.setColor(Qt::black);
+        painter.setPen(pen);
+        switch (m_edit_mode)
+        {
+        case EDIT_MODE_NOTE:
+            painter.drawRect
+            (
+                x + c_keyboard_padding_x, y,
+                selection().width(), selection().height()
+            );
+            break;
+
+        case EDIT_MODE_DRUM:
+            painter.drawRect
+            (
+                x - note_height * 0.5 + c_keyboard_padding_x,
+                y, selection().width() + note_height, selection().height()
+            );
+            break;
+        }
+        old_rect().x(x);
+        old_rect().y(y);
+        old_rect().width(selection().width());
+        old_rect().height(selection().height());
+    }
+
+    if (growing())
+    {
+        int delta_x = current_x() - drop_x();
+        int width = delta_x + selection().width();
+        if (width < 1)
+            width = 1;
+
+        x = selection().x();
+        y = selection().y();
+
+        pen.setColor(Qt::black);
+        painter.setPen(pen);
+        painter.drawRect(x + c_keyboard_padding_x, y, width, selection().height());
+        old_rect().x(x);
+        old_rect().y(y);
+        old_rect().width(width);
+        old_rect().height(selection().height());
+    }
+}
+
+/**
+ *  Makes sure the layer pixmaps cover the given area and are up to date.
+ *  The grid layer is redrawn if the area is not covered, or if any of the
+ *  grid settings (zoom, scroll, key, scale, ...) changed.  The note layer is
+ *  redrawn if the grid layer was, or if the sequence was edited.  The layers
+ *  cover the whole visible part of the roll, so that a small paint (such as
+ *  the progress strip) does not shrink them.
+ *
+ * \param r
+ *      The area about to be painted.
+ */
+
+void
+qseqroll::update_layers (const QRect & r)
+{
+    grid_stamp gs;
+    gs.zoom = zoom();
+    gs.key = m_key;
+    gs.scale = m_scale;
+    gs.edit_mode = int(m_edit_mode);
+    gs.beats_per_bar = seq().get_beats_per_bar();
+    gs.beat_width = seq().get_beat_width();
+    gs.snap = snap();
+    gs.scroll_key = scroll_offset_key();
+    gs.scroll_x = scroll_offset_x();
+    gs.width = width();
+    gs.height = height();
+
+    bool regrid = m_grid_layer.isNull() || ! m_layer_rect.contains(r) ||
+        ! (gs == m_grid_stamp);
+
+    if (regrid)
+    {
+        m_layer_rect = visibleRegion().boundingRect().united(r);
+        m_grid_stamp = gs;
+        m_grid_layer = QPixmap(m_layer_rect.size());
+        m_grid_layer.fill(Qt::transparent);
+
+        QPainter painter(&m_grid_layer);
+        painter.translate(-m_layer_rect.topLeft());
+        draw_grid(painter);
+    }
+    if (regrid || m_notes_dirty || notes_changed())
+    {
+        m_notes_dirty = false;
+        m_note_stamp.version = seq().edit_version();
+        m_note_stamp.event_count = seq().event_count();
+        m_note_stamp.length = seq().get_length();
+        m_note_layer = m_grid_layer;            /* detaches on painting     */
+
+        QPainter painter(&m_note_layer);
+        painter.translate(-m_layer_rect.topLeft());
+        draw_notes(painter);
+    }
+}
+
+/**
+ *  Draws the border, the note rows (with scale shading), and the beat and
+ *  measure lines.  Called only when the grid layer is rebuilt.
+ *
+ * \param painter
+ *      The painter for the grid layer, translated to widget coordinates.
+ */
+
+void
+qseqroll::draw_grid (QPainter & painter)
+{
     QBrush brush(Qt::NoBrush);
     mFont.setPointSize(6);
 
@@ -298,9 +541,21 @@ qseqroll::paintEvent (QPaintEvent *)
     midipulse ticks_per_beat = (4 * perf().get_ppqn()) / bwidth;
     midipulse ticks_per_bar = bpbar * ticks_per_beat;
     midipulse ticks_per_step = 6 * zoom();
-    midipulse starttick = scroll_offset_ticks() -
-            (scroll_offset_ticks() % ticks_per_step);
+    midipulse starttick = scroll_offset_ticks();
     midipulse endtick = ww * zoom() + scroll_offset_ticks();
+    midipulse lefttick = midipulse(m_layer_rect.left() - c_keyboard_padding_x) *
+        zoom() + scroll_offset_ticks();         /* only the layer's lines   */
+
+    midipulse righttick = midipulse(m_layer_rect.right() - c_keyboard_padding_x) *
+        zoom() + scroll_offset_ticks() + ticks_per_step;
+
+    if (lefttick > starttick)
+        starttick = lefttick;
+
+    if (righttick < endtick)
+        endtick = righttick;
+
+    starttick -= starttick % ticks_per_step;
 
     pen.setColor(Qt::darkGray);                 // can we use Palette?
     painter.setPen(pen);
@@ -355,85 +610,44 @@ qseqroll::paintEvent (QPaintEvent *)
         painter.setPen(pen);
         painter.drawLine(x_offset, 0, x_offset, m_keyarea_y);
     }
-    pen.setWidth(1);
-
-#if ! defined SEQ64_SOLID_PIANOROLL_GRID
-    pen.setStyle(Qt::SolidLine);
-#endif
-
-    /*
-     * draw_progress_on_window():
-     *
-     *  Draw a progress line on the window.  This is done by first blanking out
-     *  the line with the background, which contains white space and grey lines,
-     *  using the the draw_drawable function.  Remember that we wrap the
-     *  draw_drawable() function so it's parameters are xsrc, ysrc, xdest, ydest,
-     *  width, and height.
-     *
-     *  Note that the progress-bar position is based on the
-     *  sequence::get_last_tick() value, the current zoom, and the current
-     *  scroll-offset x value.
-     */
-
-    int prog_x = old_progress_x();
-    pen.setColor(Qt::red);                      // draw the playhead
-    pen.setStyle(Qt::SolidLine);
-
-    /*
-     * If this test is used, then when not running, the overwrite
-     * functionality of recording will not work: if (perf().is_running())
-     */
-
-    if (usr().progress_bar_thick())
-        pen.setWidth(2);
-    else
-        pen.setWidth(1);
-
-    painter.setPen(pen);
-    painter.drawLine(prog_x, 0, prog_x, wh * 8);    // why * 8?
-    old_progress_x(seq().get_last_tick() / zoom() + c_keyboard_padding_x);
-
-    /*
-     * It would be easier to use ticks here, rather than x values.
-     */
-
-#if 0
-
-    static bool s_loop_in_progress = false;     /* indicates when to reset  */
-    if (old_progress_x() > c_keyboard_padding_x)
-    {
-        s_loop_in_progress = true;
-    }
-    else
-    {
-        if (s_loop_in_progress)
-        {
-            seq().loop_reset(true);             /* for overwrite recording  */
-            s_loop_in_progress = false;
-        }
-    }
-
-#endif
+}
 
-    /*
-     * End of draw_progress_on_window()
-     */
+/**
+ *  Draws the notes of the background sequence (if any) and of the sequence,
+ *  limited to the horizontal range of the layers.  Called only when the
+ *  note layer is rebuilt.
+ *
+ * \param painter
+ *      The painter for the note layer, translated to widget coordinates.
+ */
 
+void
+qseqroll::draw_notes (QPainter & painter)
+{
+    QBrush brush(Qt::NoBrush);
+    QPen pen(Qt::black);
     midipulse tick_s;                               // draw notes
     midipulse tick_f;
     int note;
     bool selected;
-    int velocity;
     draw_type_t dt;
-    int start_tick = 0;
-    int end_tick = ww * zoom();
+    int left = m_layer_rect.left() - c_keyboard_padding_x - m_key_y;
+    int right = m_layer_rect.right() - c_keyboard_padding_x + m_key_y;
+    midipulse start_tick = left > 0 ? left * zoom() : 0 ;
+    midipulse end_tick = right * zoom();
     sequence * s = nullptr;
+    m_note_stamp.background = nullptr;
     for (int method = 0; method < 2; ++method)
     {
         if (method == 0 && m_drawing_background_seq)
         {
             if (perf().is_active(m_background_sequence))
+            {
                 s = perf().get_sequence(m_background_sequence);
+                m_note_stamp.background = s;
+                m_note_stamp.background_version = s->edit_version();
+                m_note_stamp.background_count = s->event_count();
+            }
             else
                 ++method;
         }
@@ -443,26 +657,43 @@ qseqroll::paintEvent (QPaintEvent *)
         if (method == 1)
             s = &seq();
 
+        if
+        (
+            m_edit_mode == EDIT_MODE_NOTE &&
+            event_summary::use_summary(*s, zoom())
+        )
+        {
+            draw_summary                    /* too dense to draw each note  */
+            (
+                painter, *s, method == 0 ? m_background_summary : m_summary,
+                method == 0 ? QColor(Qt::darkCyan) : QColor(Qt::black),
+                start_tick, end_tick
+            );
+            continue;
+        }
+
         pen.setColor(Qt::black);      /* draw boxes from sequence */
         pen.setStyle(Qt::SolidLine);
         pen.setWidth(1);
-        s->reset_draw_marker();
-        while
-        (
-            (
-                dt = s->get_next_note_event
-                (
-                    tick_s, tick_f, note, selected, velocity
-                )
-            ) != DRAW_FIN
-        )
+        render_snapshot::pointer snap = s->snapshot();  /* no locking   */
+        const render_snapshot::Notes & notes = snap->notes();
+        render_snapshot::Notes::const_iterator ni;
+        for (ni = notes.begin(); ni != notes.end(); ++ni)
         {
+            tick_s = ni->tick_s;
+            tick_f = ni->tick_f;
+            note = ni->key;
+            selected = ni->selected;
+            dt = ni->type;
             if
             (
                 (tick_s >= start_tick && tick_s <= end_tick) ||
                 (
                     (dt == DRAW_NORMAL_LINKED) &&
-                    (tick_f >= start_tick && tick_f <= end_tick)
+                    (
+                        (tick_f >= start_tick && tick_f <= end_tick) ||
+                        (tick_s < start_tick && tick_f > end_tick)
+                    )
                 )
             )
             {
@@ -619,75 +850,69 @@ qseqroll::paintEvent (QPaintEvent *)
             }
         }
     }
+}
 
-    int x, y, w, h;                     /* draw selections              */
-    brush.setStyle(Qt::NoBrush);        /* painter reset                */
-    painter.setBrush(brush);
-    if (select_action())                /* select/move/paste/grow       */
-        pen.setStyle(Qt::SolidLine);
+/**
+ *  Draws the notes of a very dense sequence from its per-pixel summary.
+ *  Each note row gets one rectangle per run of adjacent pixel columns in
+ *  which the note sounds, so the number of draw calls is bounded by the
+ *  width of the layer, not the number of notes.  Note boundaries and
+ *  selection highlights are not shown; at this zoom they would be lost in
+ *  the crowd anyway.
+ *
+ * \param painter
+ *      The painter for the note layer.
+ *
+ * \param s
+ *      The sequence to draw.
+ *
+ * \param summary
+ *      The summary to use, brought up to date here if needed.
+ *
+ * \param color
+ *      The color of the note runs.
+ *
+ * \param start_tick
+ *      The first tick covered by the layer.
+ *
+ * \param end_tick
+ *      The last tick covered by the layer.
+ */
 
-    if (selecting())
-    {
-        rect::xy_to_rect_get
-        (
-            drop_x(), drop_y(), current_x(), current_y(), x, y, w, h
-        );
+void
+qseqroll::draw_summary
+(
+    QPainter & painter, sequence & s, event_summary & summary,
+    const QColor & color, midipulse start_tick, midipulse end_tick
+)
+{
+    summary.update_notes(s, zoom());
 
-        old_rect().set(x, y, w, h + m_key_y);
-        pen.setColor("orange");         /*  pen.setColor(Qt::black);    */
-        painter.setPen(pen);
-        painter.drawRect(x + c_keyboard_padding_x, y, w, h + m_key_y);
-    }
+    int b0 = int(start_tick / zoom());
+    int b1 = int(end_tick / zoom());
+    if (b1 >= summary.bucket_count())
+        b1 = summary.bucket_count() - 1;
 
-    if (drop_action())
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QBrush(color, Qt::SolidPattern));
+    for (int note = 0; note < c_num_keys; ++note)
     {
-        int delta_x = current_x() - drop_x();
-        int delta_y = current_y() - drop_y();
-        x = selection().x() + delta_x;
-        y = selection().y() + delta_y;
-        pen.setColor(Qt::black);
-        painter.setPen(pen);
-        switch (m_edit_mode)
+        int y = m_keyarea_y - (note * m_key_y) - m_key_y - 1 + 2;
+        int run = -1;                           /* start of the current run */
+        for (int b = b0; b <= b1 + 1; ++b)
         {
-        case EDIT_MODE_NOTE:
-            painter.drawRect
-            (
-                x + c_keyboard_padding_x, y,
-                selection().width(), selection().height()
-            );
-            break;
-
-        case EDIT_MODE_DRUM:
-            painter.drawRect
-            (
-                x - note_height * 0.5 + c_keyboard_padding_x,
-                y, selection().width() + note_height, selection().height()
-            );
-            break;
+            bool on = b <= b1 && summary.note_bucket(b).test(note);
+            if (on && run < 0)
+                run = b;
+            else if (! on && run >= 0)
+            {
+                painter.drawRect
+                (
+                    run + c_keyboard_padding_x, y, b - run, m_key_y - 3
+                );
+                run = -1;
+            }
         }
-        old_rect().x(x);
-        old_rect().y(y);
-        old_rect().width(selection().width());
-        old_rect().height(selection().height());
-    }
-
-    if (growing())
-    {
-        int delta_x = current_x() - drop_x();
-        int width = delta_x + selection().width();
-        if (width < 1)
-            width = 1;
-
-        x = selection().x();
-        y = selection().y();
-
-        pen.setColor(Qt::black);
-        painter.setPen(pen);
-        painter.drawRect(x + c_keyboard_padding_x, y, width, selection().height());
-        old_rect().x(x);
-        old_rect().y(y);
-        old_rect().width(width);
-        old_rect().height(selection().height());
     }
 }
 
@@ -1034,6 +1259,8 @@ qseqroll::mouseMoveEvent (QMouseEvent * event)
         convert_xy(current_x(), current_y(), tick, note);
         seq().add_note(tick, m_note_length - 2, note, true);
     }
+    if (select_action())
+        update();                       /* move the selection box only  */
 }
 
 /**
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-31
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  */
@@ -33,6 +33,8 @@
 #include "Globals.hpp"
 #include "perform.hpp"
 #include "qseqtime.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 #include "settings.hpp"                 /* seq64::usr().key_height(), etc.  */
 
@@ -61,10 +63,10 @@ qseqtime::qseqtime
     m_font                  ()
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
-    m_timer = new QTimer(this);                             // redraw timer !!!
-    m_timer->setInterval(2 * usr().window_redraw_rate());   // 50
-    QObject::connect(m_timer, SIGNAL(timeout()), this, SLOT(conditional_update()));
-    m_timer->start();
+    m_timer = qsnotifier::attach
+    (
+        this, SLOT(conditional_update()), 2 * usr().window_redraw_rate()
+    );
 }
 
 /**
@@ -86,6 +88,7 @@ qseqtime::conditional_update ()
 void
 qseqtime::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qseqtime::paintEvent");
     QPainter painter(this);
     QBrush brush(Qt::lightGray, Qt::SolidPattern);
     QPen pen(Qt::black);
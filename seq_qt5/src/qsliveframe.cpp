@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-31
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  */
@@ -40,6 +40,8 @@
 #include "qskeymaps.hpp"                /* mapping between Gtkmm and Qt     */
 #include "qsliveframe.hpp"
 #include "qsmacros.hpp"                 /* QS_TEXT_CHAR() macro             */
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "settings.hpp"                 /* usr().window_redraw_rate()       */
 
 /*
@@ -103,7 +105,8 @@ qsliveframe::qsliveframe (perform & p, QWidget * parent)
     m_adding_new        (false),
     m_last_tick_x       (),             // array
     m_last_playing      (),             // array
-    m_can_paste         (false)
+    m_can_paste         (false),
+    m_previews          ()              // array
 {
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setFocusPolicy(Qt::StrongFocus);
@@ -127,10 +130,10 @@ qsliveframe::qsliveframe (perform & p, QWidget * parent)
     connect(ui->spinBank, SIGNAL(valueChanged(int)), this, SLOT(updateBank(int)));
     connect(ui->txtBankName, SIGNAL(textChanged()), this, SLOT(updateBankName()));
 
-    m_timer = new QTimer(this);        /* timer for regular redraws    */
-    m_timer->setInterval(usr().window_redraw_rate());
-    connect(m_timer, SIGNAL(timeout()), this, SLOT(conditional_update()));
-    m_timer->start();
+    m_timer = qsnotifier::attach
+    (
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
+    );
 }
 
 /**
@@ -149,15 +152,29 @@ qsliveframe::~qsliveframe()
 
 /**
  *  In an effort to reduce CPU usage when simply idling, this function calls
- *  update() only if necessary.  See qseqbase::needs_update().  For now, we
- *  just copped the code from that function, but have to check all sequences
- *  at some point.  LATER.
+ *  update() only if necessary.  See qseqbase::needs_update().  Besides the
+ *  playback check, the changes posted by the engine for this frame (see
+ *  qsnotifier) cover edits, mute changes, and screen-set changes, which
+ *  needs_update() does not see while stopped.  Edits and mute changes count
+ *  only if they are to a pattern of the screen-set shown in this frame.
  */
 
 void
 qsliveframe::conditional_update ()
 {
-    if (perf().needs_update(0))     // seq().number()))
+    const unsigned changes = CHANGE_SEQUENCE | CHANGE_MUTE;
+    unsigned current = qsnotifier::current_changes();
+    if ((current & CHANGE_SCREENSET) != 0)
+        update();
+    else if
+    (
+        (current & changes) != 0 &&
+        qsnotifier::sequences_changed(m_screenset_offset, m_screenset_slots)
+    )
+    {
+        update();
+    }
+    else if (perf().needs_update(0))     // seq().number()))
         update();
 }
 
@@ -168,6 +185,7 @@ qsliveframe::conditional_update ()
 void
 qsliveframe::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qsliveframe::paintEvent");
     drawAllSequences();
 }
 
@@ -342,81 +360,14 @@ qsliveframe::drawSequence (int seq)
             painter.setPen(pen);                /* for inner box of notes       */
             painter.drawRect(rectangle_x-2, rectangle_y-1, m_preview_w, m_preview_h);
 
-            int lowest_note;
-            int highest_note;
-            bool have_notes = s->get_minmax_note_events(lowest_note, highest_note);
-            if (have_notes)
+            m_preview_h -= 6;               /* padding for box measurements */
+            m_preview_w -= 6;
+            rectangle_x += 2;
+            rectangle_y += 2;
+            if (update_preview(seq, s, m_preview_w, m_preview_h))
             {
-                int height = highest_note - lowest_note + 2;
                 int length = s->get_length();
-                midipulse tick_s;
-                midipulse tick_f;
-                int note;
-                bool selected;
-                int velocity;
-                draw_type_t dt;
-                Color drawcolor = fg_color();
-                Color eventcolor = fg_color();
-                if (! s->get_transposable())
-                {
-                    eventcolor = red();
-                    drawcolor = red();
-                }
-                m_preview_h -= 6;           /* padding for box measurements */
-                m_preview_w -= 6;
-                rectangle_x += 2;
-                rectangle_y += 2;
-                s->reset_draw_marker();     /* reset container iterator     */
-                while
-                (
-                    (
-                        dt = s->get_next_note_event
-                        (
-                            tick_s, tick_f, note, selected, velocity
-                        )
-                    ) != DRAW_FIN
-                )
-                {
-                    int tick_s_x = (tick_s * m_preview_w) / length;
-                    int tick_f_x = (tick_f * m_preview_h) / length;
-                    int note_y;
-                    if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
-                        tick_f_x = tick_s_x + 1;
-
-                    if (tick_f_x <= tick_s_x)
-                        tick_f_x = tick_s_x + 1;
-
-                    if (dt == DRAW_TEMPO)
-                    {
-                        /*
-                         * Do not scale by the note range here.
-                         */
-
-                        pen.setWidth(2);
-                        drawcolor = tempo_paint();
-                        note_y = m_slot_w -
-                             m_slot_h * (note + 1) / SEQ64_MAX_DATA_VALUE;
-                    }
-                    else
-                    {
-                        pen.setWidth(1);                    /* 2 too thick  */
-                        note_y = m_preview_h -
-                             (m_preview_h * (note+1-lowest_note)) / height;
-                    }
-
-                    int sx = rectangle_x + tick_s_x;        /* start x      */
-                    int fx = rectangle_x + tick_f_x;        /* finish x     */
-                    int sy = rectangle_y + note_y;          /* start y      */
-                    int fy = sy;                            /* finish y     */
-                    pen.setColor(drawcolor);                /* note line    */
-                    painter.setPen(pen);
-                    painter.drawLine(sx, sy, fx, fy);
-                    if (dt == DRAW_TEMPO)
-                    {
-                        pen.setWidth(1);                    /* 2 too thick  */
-                        drawcolor = eventcolor;
-                    }
-                }
+                painter.drawPixmap(rectangle_x, rectangle_y, m_previews[seq].pixmap);
 
                 int a_tick = perf().get_tick();             /* for playhead */
                 a_tick += (length - s->get_trigger_offset());
@@ -492,6 +443,121 @@ qsliveframe::drawSequence (int seq)
     m_last_metro = metro;
 }
 
+/**
+ *  Brings the cached note preview of a slot up to date.  The notes are drawn
+ *  into a pixmap only when the sequence has been edited (its edit version or
+ *  event count changed), or the slot size, length, or transposability
+ *  changed.  Otherwise this function does nothing, so that a redraw while
+ *  playing does not scan the events of every pattern.
+ *
+ * \param seq
+ *      The number of the sequence, used as the index into m_previews[].
+ *
+ * \param s
+ *      The sequence to draw.  Not checked for null.
+ *
+ * \param w
+ *      The width of the preview area.
+ *
+ * \param h
+ *      The height of the preview area.
+ *
+ * \return
+ *      Returns true if the sequence has notes, and so there is a preview to
+ *      draw.
+ */
+
+bool
+qsliveframe::update_preview (int seq, sequence * s, int w, int h)
+{
+    preview & p = m_previews[seq];
+    unsigned long version = s->edit_version();
+    int eventcount = s->event_count();
+    midipulse length = s->get_length();
+    bool transposable = s->get_transposable();
+    bool current =
+        p.seq == s && p.version == version && p.event_count == eventcount &&
+        p.length == length && p.transposable == transposable &&
+        p.width == w && p.height == h;
+
+    if (current)
+        return p.have_notes;
+
+    p.seq = s;
+    p.version = version;
+    p.event_count = eventcount;
+    p.length = length;
+    p.width = w;
+    p.height = h;
+    p.transposable = transposable;
+
+    render_snapshot::pointer snap = s->snapshot();      /* no locking   */
+    int lowest_note;
+    int highest_note;
+    p.have_notes = w > 0 && h > 0 && length > 0 &&
+        snap->minmax(lowest_note, highest_note);
+
+    if (! p.have_notes)
+    {
+        p.pixmap = QPixmap();
+        return false;
+    }
+
+    p.pixmap = QPixmap(w, h);
+    p.pixmap.fill(Qt::transparent);
+
+    QPainter painter(&p.pixmap);
+    QPen pen(Qt::black);
+    int height = highest_note - lowest_note + 2;
+    Color drawcolor = fg_color();
+    Color eventcolor = fg_color();
+    if (! transposable)
+    {
+        eventcolor = red();
+        drawcolor = red();
+    }
+    const render_snapshot::Notes & notes = snap->notes();
+    render_snapshot::Notes::const_iterator ni;
+    for (ni = notes.begin(); ni != notes.end(); ++ni)
+    {
+        draw_type_t dt = ni->type;
+        int note = ni->key;
+        int tick_s_x = (ni->tick_s * w) / length;
+        int tick_f_x = (ni->tick_f * w) / length;
+        int note_y;
+        if (dt == DRAW_NOTE_ON || dt == DRAW_NOTE_OFF)
+            tick_f_x = tick_s_x + 1;
+
+        if (tick_f_x <= tick_s_x)
+            tick_f_x = tick_s_x + 1;
+
+        if (dt == DRAW_TEMPO)
+        {
+            /*
+             * Do not scale by the note range here.
+             */
+
+            pen.setWidth(2);
+            drawcolor = tempo_paint();
+            note_y = m_slot_w - m_slot_h * (note + 1) / SEQ64_MAX_DATA_VALUE;
+        }
+        else
+        {
+            pen.setWidth(1);                            /* 2 too thick  */
+            note_y = h - (h * (note + 1 - lowest_note)) / height;
+        }
+        pen.setColor(drawcolor);                        /* note line    */
+        painter.setPen(pen);
+        painter.drawLine(tick_s_x, note_y, tick_f_x, note_y);
+        if (dt == DRAW_TEMPO)
+        {
+            pen.setWidth(1);                            /* 2 too thick  */
+            drawcolor = eventcolor;
+        }
+    }
+    return true;
+}
+
 /**
  *
  */
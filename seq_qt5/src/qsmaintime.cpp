@@ -32,6 +32,7 @@
 
 #include "Globals.hpp"
 #include "qsmaintime.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 
 /*
  *  Do not document a namespace; it breaks Doxygen.
@@ -82,6 +83,7 @@ qsmaintime::~qsmaintime ()
 void
 qsmaintime::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qsmaintime::paintEvent");
     QPainter painter(this);
     QPen pen(Qt::darkGray);
     QBrush brush(Qt::NoBrush);
@@ -24,7 +24,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-08-10
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  The main window is known as the "Patterns window" or "Patterns
@@ -57,6 +57,7 @@
 #include "qskeymaps.hpp"                /* mapping between Gtkmm and Qt     */
 #include "qsmaintime.hpp"
 #include "qsmainwnd.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier                */
 #include "qsliveframe.hpp"
 #include "qt5_helpers.hpp"              /* seq64::qt_set_icon()             */
 #include "settings.hpp"                 /* seq64::rc() and seq64::usr()     */
@@ -124,7 +125,9 @@ qsmainwnd::qsmainwnd
     m_edit_frame        (nullptr),
     m_msg_error         (nullptr),
     m_msg_save_changes  (nullptr),
+    m_notifier          (nullptr),
     m_timer             (nullptr),
+    m_save_timer        (new QTimer(this)),
     m_menu_recent       (nullptr),
     m_recent_action_list(),
     mc_max_recent_files (10),
@@ -145,6 +148,13 @@ qsmainwnd::qsmainwnd
 
     ui->setupUi(this);
 
+    /*
+     * The notifier must exist before any of the child frames are created,
+     * so that they can attach their redraw slots to it.
+     */
+
+    m_notifier = new qsnotifier(perf(), this);
+
     QRect screen = QApplication::desktop()->screenGeometry();
     int x = (screen.width() - width()) / 2;             // center on screen
     int y = (screen.height() - height()) / 2;
@@ -423,10 +433,19 @@ qsmainwnd::qsmainwnd
     resize(width, height);
     show();
 
-    m_timer = new QTimer(this);         /* refresh GUI element every few ms */
-    m_timer->setInterval(2 * usr().window_redraw_rate());    // 50
-    connect(m_timer, SIGNAL(timeout()), this, SLOT(refresh()));
-    m_timer->start();
+    m_timer = qsnotifier::attach            /* refresh on engine changes    */
+    (
+        this, SLOT(refresh()), 2 * usr().window_redraw_rate()
+    );
+
+    /*
+     * The redraw frames stop when the GUI is idle, so the saves are checked
+     * by a timer of their own.
+     */
+
+    m_save_timer->setInterval(SEQ64_SAVE_CHECK_PERIOD_MS);
+    connect(m_save_timer, SIGNAL(timeout()), this, SLOT(check_saves()));
+    m_save_timer->start();
 }
 
 /**
@@ -789,6 +808,22 @@ qsmainwnd::refresh ()
     }
 }
 
+/**
+ *  Starts an autosave, if one is due, and shows the error of a background
+ *  save that failed.  Called by m_save_timer.
+ */
+
+void
+qsmainwnd::check_saves ()
+{
+    std::string errmsg;
+    if (perf().check_saves(errmsg))
+    {
+        m_msg_error->showMessage(errmsg.c_str());
+        m_is_title_dirty = true;            /* the song is modified again   */
+    }
+}
+
 /**
  *
  */
@@ -0,0 +1,313 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          qsnotifier.cpp
+ *
+ *  This module defines the object that turns the engine's change
+ *  notifications into redraw frames for the Qt widgets.
+ *
+ * \library       sequencer64 application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-08
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  See the qsnotifier.hpp module for the overview.
+ */
+
+#include <QApplication>
+#include <QEvent>
+#include <QMouseEvent>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include "perform.hpp"                  /* seq64::perform, rt_notify        */
+#include "qsnotifier.hpp"               /* seq64::qsnotifier                */
+#include "settings.hpp"                 /* seq64::usr().window_redraw_rate()*/
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  The single notifier.
+ */
+
+qsnotifier * qsnotifier::sm_instance = nullptr;
+
+/**
+ *  Principal constructor.  Sets up the frame timer, the watch on the
+ *  engine's wake-up pipe, and an event filter on the whole application, so
+ *  that user input also schedules a frame.  Any changes already pending
+ *  are shown in the first frame.
+ *
+ * \param p
+ *      The performance object.
+ *
+ * \param parent
+ *      The owner of this object, normally the qsmainwnd.
+ */
+
+qsnotifier::qsnotifier (perform & p, QObject * parent)
+ :
+    QObject         (parent),
+    m_perform       (p),
+    m_socket        (nullptr),
+    m_frame_timer   (new QTimer(this)),
+    m_changes       (0),
+    m_sequences     ()                  // array
+{
+    m_frame_timer->setInterval(usr().window_redraw_rate());
+    connect(m_frame_timer, SIGNAL(timeout()), this, SLOT(emit_frame()));
+
+    int fd = m_perform.changes().wake_fd();
+    if (fd >= 0)
+    {
+        m_socket = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+        connect(m_socket, SIGNAL(activated(int)), this, SLOT(wake()));
+        m_frame_timer->setSingleShot(true);
+    }
+    m_frame_timer->start();             /* poll forever if no pipe      */
+
+    if (not_nullptr(qApp))
+        qApp->installEventFilter(this);
+
+    sm_instance = this;
+}
+
+/**
+ *  Removes the event filter and forgets the single instance.
+ */
+
+qsnotifier::~qsnotifier ()
+{
+    if (not_nullptr(qApp))
+        qApp->removeEventFilter(this);
+
+    if (sm_instance == this)
+        sm_instance = nullptr;
+}
+
+/**
+ *  Connects a widget's redraw slot to the frame() signal.  If there is no
+ *  notifier, this falls back to the old way of doing things, a free-running
+ *  timer owned by the widget.
+ *
+ * \param receiver
+ *      The widget to be notified.
+ *
+ * \param slot
+ *      The slot, as given by the SLOT() macro, normally
+ *      SLOT(conditional_update()).
+ *
+ * \param interval
+ *      The redraw interval, in milliseconds, for the fallback timer.
+ *
+ * \return
+ *      Returns the fallback timer, or a null pointer if the notifier is
+ *      used.
+ */
+
+QTimer *
+qsnotifier::attach (QObject * receiver, const char * slot, int interval)
+{
+    QTimer * result = nullptr;
+    if (not_nullptr(sm_instance))
+    {
+        connect(sm_instance, SIGNAL(frame()), receiver, slot);
+    }
+    else
+    {
+        result = new QTimer(receiver);
+        result->setInterval(interval);
+        connect(result, SIGNAL(timeout()), receiver, slot);
+        result->start();
+    }
+    return result;
+}
+
+/**
+ *  Gets the changes of the frame being emitted, for use by the slots
+ *  connected to frame().  Without a notifier, claims that everything
+ *  changed, so that a widget never skips a redraw it would have done
+ *  before.
+ *
+ * \return
+ *      Returns the or'ed change_t values.
+ */
+
+unsigned
+qsnotifier::current_changes ()
+{
+    return not_nullptr(sm_instance) ? sm_instance->m_changes : ~0U ;
+}
+
+/**
+ *  Checks if a sequence changed in the frame being emitted.
+ *
+ * \param seq
+ *      The number of the sequence.
+ *
+ * \return
+ *      Returns true if the sequence changed, or if there is no notifier.
+ */
+
+bool
+qsnotifier::sequence_changed (int seq)
+{
+    if (is_nullptr(sm_instance))
+        return true;
+
+    return seq >= 0 && seq < c_max_sequence && sm_instance->m_sequences[seq];
+}
+
+/**
+ *  Checks if any sequence of a range changed in the frame being emitted.
+ *  A view passes the range of patterns it shows, so that changes to
+ *  patterns it does not show (other screen-sets, rows scrolled away) do not
+ *  make it redraw.
+ *
+ * \param first
+ *      The number of the first sequence of the range.
+ *
+ * \param count
+ *      The number of sequences in the range.
+ *
+ * \return
+ *      Returns true if a sequence in the range changed, or if there is no
+ *      notifier.
+ */
+
+bool
+qsnotifier::sequences_changed (int first, int count)
+{
+    if (is_nullptr(sm_instance))
+        return true;
+
+    int last = first + count;
+    if (first < 0)
+        first = 0;
+
+    if (last > c_max_sequence)
+        last = c_max_sequence;
+
+    for (int seq = first; seq < last; ++seq)
+    {
+        if (sm_instance->m_sequences[seq])
+            return true;
+    }
+    return false;
+}
+
+/**
+ *  Schedules a frame for any user input that might change what a widget
+ *  shows:  keys, clicks, the wheel, and mouse drags.  Plain mouse motion is
+ *  ignored.  The event itself is never consumed.
+ *
+ * \param target
+ *      The object receiving the event.  Unused.
+ *
+ * \param event
+ *      The event.
+ *
+ * \return
+ *      Always returns false, so that the event is delivered normally.
+ */
+
+bool
+qsnotifier::eventFilter (QObject * /*target*/, QEvent * event)
+{
+    switch (event->type())
+    {
+    case QEvent::KeyPress:
+    case QEvent::KeyRelease:
+    case QEvent::MouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::Wheel:
+
+        schedule();
+        break;
+
+    case QEvent::MouseMove:
+
+        if (static_cast<QMouseEvent *>(event)->buttons() != Qt::NoButton)
+            schedule();
+        break;
+
+    default:
+
+        break;
+    }
+    return false;
+}
+
+/**
+ *  Called when the engine writes to the wake-up pipe.  The pipe is emptied
+ *  in emit_frame(), by rt_notify::drain(); here we only need to schedule
+ *  the frame.  The socket notifier is disabled until then, since it would
+ *  otherwise fire continuously while the byte is unread.
+ */
+
+void
+qsnotifier::wake ()
+{
+    if (not_nullptr(m_socket))
+        m_socket->setEnabled(false);
+
+    schedule();
+}
+
+/**
+ *  Starts the frame timer, unless a frame is already scheduled.
+ */
+
+void
+qsnotifier::schedule ()
+{
+    if (! m_frame_timer->isActive())
+        m_frame_timer->start();
+}
+
+/**
+ *  Drains the pending changes and tells every connected widget to check
+ *  for updates.  Then re-arms the wake-up pipe watch.
+ */
+
+void
+qsnotifier::emit_frame ()
+{
+    m_changes = m_perform.changes().drain(m_sequences);
+    emit frame();
+    m_changes = 0;
+    if (not_nullptr(m_socket))
+        m_socket->setEnabled(true);
+}
+
+}           // namespace seq64
+
+/*
+ * qsnotifier.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+
@@ -25,7 +25,7 @@
  * \library       sequencer64 application
  * \author        Seq24 team; modifications by Chris Ahlstrom
  * \date          2018-01-01
- * \updates       2018-07-31
+ * \updates       2018-09-08
  * \license       GNU GPLv2 or above
  *
  *  This class represents the central piano-roll user-interface area of the
@@ -35,7 +35,9 @@
 #include "Globals.hpp"
 #include "perform.hpp"
 #include "qseqdata.hpp"
+#include "qsnotifier.hpp"               /* seq64::qsnotifier::attach()      */
 #include "qstriggereditor.hpp"
+#include "rt_trace.hpp"                 /* seq64::rt_trace_span             */
 #include "sequence.hpp"
 #include "settings.hpp"                 /* seq64::usr().key_height(), etc.  */
 
@@ -80,10 +82,10 @@ qstriggereditor::qstriggereditor
     m_cc                (0)
 {
     setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::Fixed);
-    m_timer = new QTimer(this);                          // redraw timer !!!
-    m_timer->setInterval(usr().window_redraw_rate());    // 20
-    QObject::connect(m_timer, SIGNAL(timeout()), this, SLOT(conditional_update()));
-    m_timer->start();
+    m_timer = qsnotifier::attach
+    (
+        this, SLOT(conditional_update()), usr().window_redraw_rate()
+    );
 }
 
 /**
@@ -119,6 +121,7 @@ qstriggereditor::sizeHint () const
 void
 qstriggereditor::paintEvent (QPaintEvent *)
 {
+    rt_trace_span span("qstriggereditor::paintEvent");
     QPainter painter(this);
     QPen pen(Qt::black);
     QBrush brush(Qt::darkGray, Qt::SolidPattern);
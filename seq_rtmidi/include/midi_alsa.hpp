@@ -103,6 +103,14 @@ private:
 
     const std::string m_input_port_name;
 
+    /**
+     *  The ALSA MIDI encoder used by api_play().  It is created once, in the
+     *  constructor, rather than for every event played, so that playback
+     *  does not allocate.
+     */
+
+    snd_midi_event_t * m_midi_encoder;
+
 public:
 
     /*
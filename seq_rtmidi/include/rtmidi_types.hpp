@@ -17,6 +17,7 @@
  *  refactor and partition, and slightly easier to read.
  */
 
+#include <stdexcept>                        /* std::out_of_range            */
 #include <string>                           /* std::string                  */
 #include <vector>                           /* std::vector container        */
 
@@ -120,15 +121,22 @@ enum rtmidi_api
  *  uses the seq64::event rather than the seq64::midi_message object.
  *  For the moment, we will translate between them until we have the
  *  interactions between the old and new modules under control.
+ *
+ *  Channel and system messages, which are never longer than
+ *  SEQ64_MIDI_MESSAGE_FIXED bytes, are held in a fixed array, so that
+ *  creating, copying, and queuing them never touches the heap.  Only a
+ *  longer (SysEx) message moves its bytes into the vector.
  */
 
+#define SEQ64_MIDI_MESSAGE_FIXED    16
+
 class midi_message
 {
 
 public:
 
     /**
-     *  Holds the data of the MIDI message.  Callers should use
+     *  Holds the data of a long MIDI message.  Callers should use
      *  midi_message::container rather than using the vector directly.
      *  Bytes are added by the push() function, and are safely accessed
      *  (with bounds-checking) by operator [].
@@ -139,11 +147,24 @@ public:
 private:
 
     /**
-     *  Holds the event status and data bytes.
+     *  Holds the event status and data bytes of a short message.
+     */
+
+    midibyte m_fixed[SEQ64_MIDI_MESSAGE_FIXED];
+
+    /**
+     *  Holds all of the bytes of a message that has grown longer than
+     *  SEQ64_MIDI_MESSAGE_FIXED.  Empty otherwise.
      */
 
     container m_bytes;
 
+    /**
+     *  The number of bytes in the message.
+     */
+
+    int m_count;
+
     /**
      *  Holds the (optional) timestamp of the MIDI message.
      */
@@ -156,42 +177,46 @@ public:
 
     midibyte operator [] (int i) const
     {
-        return (i >= 0 && i < int(m_bytes.size())) ? m_bytes[i] : 0 ;
+        return (i >= 0 && i < m_count) ? data()[i] : 0 ;
     }
 
 #ifdef USE_MIDI_MESSAGE_AT_ACCESS
 
     midibyte & at (int i)
     {
-        return m_bytes.at(i);       /* can throw an exception */
+        if (i < 0 || i >= m_count)
+            throw std::out_of_range("midi_message::at()");
+
+        return m_count > SEQ64_MIDI_MESSAGE_FIXED ? m_bytes[i] : m_fixed[i] ;
     }
 
     const midibyte & at (int i) const
     {
-        return m_bytes.at(i);       /* can throw an exception */
+        if (i < 0 || i >= m_count)
+            throw std::out_of_range("midi_message::at()");
+
+        return data()[i];
     }
 
 #endif
 
     const char * array () const
     {
-        return reinterpret_cast<const char *>(&m_bytes[0]);
+        return reinterpret_cast<const char *>(data());
     }
 
     int count () const
     {
-        return int(m_bytes.size());
+        return m_count;
     }
 
     bool empty () const
     {
-        return m_bytes.empty();
+        return m_count == 0;
     }
 
-    void push (midibyte b)
-    {
-        m_bytes.push_back(b);
-    }
+    void push (midibyte b);
+    void clear ();
 
     double timestamp () const
     {
@@ -205,11 +230,18 @@ public:
 
     bool is_sysex () const
     {
-        return m_bytes.size() > 0 ? event::is_sysex_msg(m_bytes[0]) : false ;
+        return m_count > 0 ? event::is_sysex_msg(data()[0]) : false ;
     }
 
     void show () const;
 
+private:
+
+    const midibyte * data () const
+    {
+        return m_count > SEQ64_MIDI_MESSAGE_FIXED ? &m_bytes[0] : m_fixed ;
+    }
+
 };          // class midi_message
 
 /**
@@ -100,6 +100,14 @@
 namespace seq64
 {
 
+/**
+ *  Defines the size of the MIDI event buffer, which should be large enough to
+ *  accomodate the largest MIDI message to be encoded.
+ *  A local define for visibility.
+ */
+
+#define SEQ64_MIDI_EVENT_SIZE_MAX   10
+
 /**
  *  Provides a constructor with client number, port number, ALSA sequencer
  *  support, name of client, name of port, etc., mostly contained within an
@@ -145,19 +153,26 @@ midi_alsa::midi_alsa (midibus & parentbus, midi_info & masterinfo)
     m_dest_addr_port    (parentbus.get_port_id()),
     m_local_addr_client (snd_seq_client_id(m_seq)),     /* our client ID    */
     m_local_addr_port   (-1),
-    m_input_port_name   (rc().app_client_name() + " in")
+    m_input_port_name   (rc().app_client_name() + " in"),
+    m_midi_encoder      (nullptr)
 {
     set_bus_id(m_local_addr_client);
     set_name(SEQ64_CLIENT_NAME, bus_name(), port_name());
+    if (snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &m_midi_encoder) < 0)
+    {
+        errprint("snd_midi_event_new() failed");
+        m_midi_encoder = nullptr;
+    }
 }
 
 /**
- *  A rote empty virtual destructor.
+ *  Frees the ALSA MIDI encoder.
  */
 
 midi_alsa::~midi_alsa ()
 {
-    // empty body
+    if (not_nullptr(m_midi_encoder))
+        snd_midi_event_free(m_midi_encoder);
 }
 
 /**
@@ -526,19 +541,12 @@ midi_alsa::api_deinit_in ()
  *
  */
 
-/**
- *  Defines the size of the MIDI event buffer, which should be large enough to
- *  accomodate the largest MIDI message to be encoded.
- *  A local define for visibility.
- */
-
-#define SEQ64_MIDI_EVENT_SIZE_MAX   10
-
 /**
  *  This play() function takes a native event, encodes it to an ALSA MIDI
  *  sequencer event, sets the broadcasting to the subscribers, sets the
  *  direct-passing mode to send the event without queueing, and puts it in the
- *  queue.
+ *  queue.  The encoder is created once by the constructor, and reset here,
+ *  so this function does not allocate.
  *
  * \threadsafe
  *
@@ -558,13 +566,13 @@ midi_alsa::api_play (event * e24, midibyte channel)
     buffer[0] += (channel & 0x0F);
     e24->get_data(buffer[1], buffer[2]);            /* set MIDI data        */
 
-    snd_midi_event_t * midi_ev;                     /* ALSA MIDI parser     */
-    snd_midi_event_new(SEQ64_MIDI_EVENT_SIZE_MAX, &midi_ev);
+    if (is_nullptr(m_midi_encoder))
+        return;
 
     snd_seq_event_t ev;
     snd_seq_ev_clear(&ev);                          /* clear event          */
-    snd_midi_event_encode(midi_ev, buffer, 3, &ev); /* encode 3 raw bytes   */
-    snd_midi_event_free(midi_ev);                   /* free the parser      */
+    snd_midi_event_reset_encode(m_midi_encoder);    /* no running status    */
+    snd_midi_event_encode(m_midi_encoder, buffer, 3, &ev);
     snd_seq_ev_set_source(&ev, m_local_addr_port);  /* set source           */
 
 #ifdef SEQ64_SHOW_API_CALLS_XXX                     /* Too Much Information */
@@ -79,6 +79,12 @@ unsigned midi_alsa_info::sm_input_caps =
 unsigned midi_alsa_info::sm_output_caps =
     SND_SEQ_PORT_CAP_WRITE | SND_SEQ_PORT_CAP_SUBS_WRITE;
 
+/**
+ *  The size of the buffer for decoding incoming ALSA events into MIDI bytes.
+ */
+
+#define SEQ64_MIDI_DECODE_SIZE      0x1000
+
 /**
  *  Principal constructor.
  *
@@ -101,7 +107,8 @@ midi_alsa_info::midi_alsa_info
     midi_info               (appname, ppqn, bpm),
     m_alsa_seq              (nullptr),
     m_num_poll_descriptors  (0),            /* from ALSA mastermidibus      */
-    m_poll_descriptors      (nullptr)       /* ditto                        */
+    m_poll_descriptors      (nullptr),      /* ditto                        */
+    m_midi_decoder          (nullptr)       /* created below                */
 {
     snd_seq_t * seq;                        /* point to member              */
     int result = snd_seq_open               /* set up ALSA sequencer client */
@@ -144,6 +151,11 @@ midi_alsa_info::midi_alsa_info
         );
         snd_seq_set_output_buffer_size(m_alsa_seq, c_midibus_output_size);
         snd_seq_set_input_buffer_size(m_alsa_seq, c_midibus_input_size);
+        if (snd_midi_event_new(SEQ64_MIDI_DECODE_SIZE, &m_midi_decoder) < 0)
+        {
+            errprint("snd_midi_event_new() failed");
+            m_midi_decoder = nullptr;
+        }
     }
 }
 
@@ -167,6 +179,11 @@ midi_alsa_info::~midi_alsa_info ()
             delete [] m_poll_descriptors;
             m_poll_descriptors = nullptr;
         }
+        if (not_nullptr(m_midi_decoder))
+        {
+            snd_midi_event_free(m_midi_decoder);
+            m_midi_decoder = nullptr;
+        }
     }
 }
 
@@ -510,7 +527,7 @@ midi_alsa_info::api_get_midi_event (event * inev)
     snd_seq_event_t * ev;
     bool sysex = false;
     bool result = false;
-    midibyte buffer[0x1000];                /* temporary buffer for MIDI data */
+    midibyte buffer[SEQ64_MIDI_DECODE_SIZE];    /* temp buffer for MIDI data  */
     int remcount = snd_seq_event_input(m_alsa_seq, &ev);
     if (remcount < 0 || is_nullptr(ev))
     {
@@ -559,14 +576,11 @@ midi_alsa_info::api_get_midi_event (event * inev)
     if (result)
         return false;
 
-    snd_midi_event_t * midi_ev;                     /* make ALSA MIDI parser */
-    int rc = snd_midi_event_new(sizeof(buffer), &midi_ev);
-    if (rc < 0 || is_nullptr(midi_ev))
-    {
-        errprint("snd_midi_event_new() failed");
+    snd_midi_event_t * midi_ev = m_midi_decoder;   /* ALSA MIDI parser     */
+    if (is_nullptr(midi_ev))
         return false;
-    }
 
+    snd_midi_event_reset_decode(midi_ev);
     long bytes = snd_midi_event_decode(midi_ev, buffer, sizeof(buffer), ev);
     if (bytes <= 0)
     {
@@ -574,7 +588,6 @@ midi_alsa_info::api_get_midi_event (event * inev)
          * This happens even at startup, before anything is really happening.
          */
 
-        snd_midi_event_free(midi_ev);
         return false;
     }
 
@@ -628,7 +641,6 @@ midi_alsa_info::api_get_midi_event (event * inev)
         else
             sysex = false;
     }
-    snd_midi_event_free(midi_ev);
     return true;
 }
 
@@ -732,10 +732,10 @@ midi_jack::api_deinit_in ()
 }
 
 /**
- *  We could push the bytes of the event into a midibyte vector, as done in
- *  send_message().  The ALSA code (seq_alsamidi/src/midibus.cpp) sticks the
- *  event bytes in an array, which might be a little faster than using
- *  push_back(), but let's try the vector first.  The rtmidi code here is from
+ *  We push the bytes of the event into a midi_message, as done in
+ *  send_message().  A channel message fits in the fixed array of the
+ *  midi_message, so this function does not allocate, and is safe in the
+ *  "-o rtsafe" mode.  The rtmidi code here is from
  *  midi_out_jack::send_message().
  */
 
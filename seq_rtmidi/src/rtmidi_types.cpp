@@ -33,12 +33,52 @@ namespace seq64
 
 midi_message::midi_message ()
  :
+    m_fixed     (),
     m_bytes     (),
+    m_count     (0),
     m_timestamp (0.0)
 {
     // Empty body
 }
 
+/**
+ *  Appends a byte to the message.  Up to SEQ64_MIDI_MESSAGE_FIXED bytes are
+ *  stored in the fixed array.  When the message grows past that, which only
+ *  happens for SysEx, all of the bytes are moved to the vector.
+ *
+ * \param b
+ *      The byte to append.
+ */
+
+void
+midi_message::push (midibyte b)
+{
+    if (m_count < SEQ64_MIDI_MESSAGE_FIXED)
+    {
+        m_fixed[m_count] = b;
+    }
+    else
+    {
+        if (m_count == SEQ64_MIDI_MESSAGE_FIXED)
+            m_bytes.assign(m_fixed, m_fixed + SEQ64_MIDI_MESSAGE_FIXED);
+
+        m_bytes.push_back(b);
+    }
+    ++m_count;
+}
+
+/**
+ *  Empties the message, so that it can be reused.  The capacity of the
+ *  vector, if any, is kept.
+ */
+
+void
+midi_message::clear ()
+{
+    m_bytes.clear();
+    m_count = 0;
+}
+
 /**
  *  Shows the bytes in a message, for trouble-shooting.
  */
@@ -46,7 +86,7 @@ midi_message::midi_message ()
 void
 midi_message::show () const
 {
-    if (m_bytes.empty())
+    if (empty())
     {
         fprintf(stderr, "midi_message: empty\n");
         fflush(stderr);
@@ -54,14 +94,9 @@ midi_message::show () const
     else
     {
         fprintf(stderr, "midi_message:\n");
-        for
-        (
-            container::const_iterator ci = m_bytes.begin();
-            ci != m_bytes.end(); ++ci
-        )
-        {
-            fprintf(stderr, " 0x%2x", int(*ci));
-        }
+        for (int i = 0; i < m_count; ++i)
+            fprintf(stderr, " 0x%2x", int(data()[i]));
+
         fprintf(stderr, "\n");
         fflush(stderr);
     }
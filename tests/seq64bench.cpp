@@ -0,0 +1,1037 @@
+/*
+ *  This file is part of seq24/sequencer64.
+ *
+ *  seq24 is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  seq24 is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with seq24; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file          seq64bench.cpp
+ *
+ *  This module provides a benchmark for the core (non-GUI, non-MIDI-API)
+ *  parts of the libseq64 library.
+ *
+ * \library       seq64bench application
+ * \author        Seq24 team; modifications by Chris Ahlstrom
+ * \date          2018-09-02
+ * \updates       2018-09-08
+ * \license       GNU GPLv2 or above
+ *
+ *  The benchmark drives a perform object that is never launched, so that no
+ *  MIDI buss is created and no ALSA or JACK server is needed.  The events
+ *  that would go out to the buss are simply dropped.  This lets us measure
+ *  the cost of the engine itself:
+ *
+ *      -   sequence::play() for one output frame.
+ *      -   event_list::add(), merge(), and sort().
+ *      -   sequence::verify_and_link().
+ *      -   midifile::parse() and midifile::write(), on synthetic data and on
+ *          any MIDI files named on the command line (e.g. contrib/midi).
+ *      -   wrkfile::parse(), on any WRK files named on the command line
+ *          (e.g. contrib/wrk).
+ *      -   Filling the sequences of those MIDI files by sequence::
+ *          append_event() and sort_events(), versus a sequence_builder.
+ *      -   sequence::play() on the longest track of those MIDI files, with
+ *          its events loaded, versus streamed with "-o stream=kb".
+ *      -   sequence::quantize_events().
+ *      -   perform::midi_control_event().
+ *      -   perform::play() with all 1024 pattern slots filled and playing.
+ *
+ *  The results are written as JSON so that they can be compared between
+ *  releases.  Usage:
+ *
+\verbatim
+    seq64bench [ --output file.json ] [ --scale n ] [ file.midi|.wrk ... ]
+\endverbatim
+ *
+ *  The default output file is "seq64bench.json".  The scale value multiplies
+ *  the number of iterations of each benchmark; the default is 1.
+ */
+
+#include <chrono>                       /* std::chrono::steady_clock        */
+#include <stdio.h>
+#include <stdlib.h>                     /* atoi(), EXIT_SUCCESS             */
+#include <string.h>                     /* strcmp()                         */
+#include <string>
+#include <vector>
+
+#include "event_list.hpp"               /* seq64::event_list                */
+#include "file_functions.hpp"           /* seq64::file_accessible()         */
+#include "gui_assistant.hpp"            /* seq64::gui_assistant base class  */
+#include "keys_perform.hpp"             /* seq64::keys_perform              */
+#include "midifile.hpp"                 /* seq64::midifile                  */
+#include "perform.hpp"                  /* seq64::perform, the main object  */
+#include "sequence.hpp"                 /* seq64::sequence                  */
+#include "sequence_builder.hpp"         /* seq64::sequence_builder          */
+#include "settings.hpp"                 /* seq64::usr() and seq64::rc()     */
+#include "wrkfile.hpp"                  /* seq64::wrkfile                   */
+
+/*
+ *  Do not document a namespace; it breaks Doxygen.
+ */
+
+namespace seq64
+{
+
+/**
+ *  Holds the outcome of one benchmark.  The "items" value is the number of
+ *  units of work (events, frames, files) processed in one iteration, so that
+ *  the per-item cost can be compared even if the data size changes.
+ */
+
+struct bench_result
+{
+    std::string m_name;
+    std::string m_data;
+    long m_iterations;
+    long m_items;
+    double m_total_ns;
+};
+
+/**
+ *  The benchmark runner.  It is a friend of the perform class so that it can
+ *  call the private perform::play() and perform::midi_control_event()
+ *  functions, just as the output and input threads do.
+ */
+
+class benchmark
+{
+
+private:
+
+    typedef std::chrono::steady_clock clock_type;
+
+    /**
+     *  Provides the keystroke support needed to create a perform object.
+     */
+
+    keys_perform m_keys;
+
+    /**
+     *  The minimal "GUI" support needed to create a perform object.
+     */
+
+    gui_assistant m_gui;
+
+    /**
+     *  Multiplies the iteration count of each benchmark.
+     */
+
+    int m_scale;
+
+    /**
+     *  The results accumulated by each benchmark.
+     */
+
+    std::vector<bench_result> m_results;
+
+public:
+
+    benchmark (int scale);
+
+    void run_event_list ();
+    void run_verify_and_link ();
+    void run_sequence_play ();
+    void run_quantize ();
+    void run_midi_control ();
+    void run_perform_play ();
+    void run_midifile (const std::string & tmpname);
+    void run_midifile_parse (const std::string & filename);
+    void run_wrkfile_parse (const std::string & filename);
+    void run_sequence_load (const std::string & filename);
+    void run_sequence_stream (const std::string & filename);
+    bool write_json (const std::string & filename) const;
+
+private:
+
+    /**
+     *  Gets the time, to be passed to elapsed_ns() later.
+     */
+
+    static clock_type::time_point now ()
+    {
+        return clock_type::now();
+    }
+
+    /**
+     *  Calculates the nanoseconds since the given starting time.
+     */
+
+    static double elapsed_ns (clock_type::time_point start)
+    {
+        std::chrono::duration<double, std::nano> d = clock_type::now() - start;
+        return d.count();
+    }
+
+    /**
+     *  Scales an iteration count, never returning less than 1.
+     */
+
+    long iterations (long base) const
+    {
+        long result = base * m_scale;
+        return result > 0 ? result : 1 ;
+    }
+
+    void add_result
+    (
+        const std::string & name, const std::string & data,
+        long iterations, long items, double total_ns
+    );
+    static void fill_pattern
+    (
+        sequence & s, int measures, int notesperbeat, int seed
+    );
+    void fill_perform (perform & p, int count, int measures, int notesperbeat);
+    void play_frames
+    (
+        sequence & s, const std::string & name, const std::string & data
+    );
+
+};          // class benchmark
+
+/**
+ *  Principal constructor.
+ *
+ * \param scale
+ *      The iteration multiplier.  Values less than 1 are forced to 1.
+ */
+
+benchmark::benchmark (int scale)
+ :
+    m_keys      (),
+    m_gui       (m_keys),
+    m_scale     (scale > 0 ? scale : 1),
+    m_results   ()
+{
+    // no code needed
+}
+
+/**
+ *  Logs a result and prints a one-line summary to the console.
+ */
+
+void
+benchmark::add_result
+(
+    const std::string & name, const std::string & data,
+    long iterations, long items, double total_ns
+)
+{
+    bench_result r;
+    r.m_name = name;
+    r.m_data = data;
+    r.m_iterations = iterations;
+    r.m_items = items;
+    r.m_total_ns = total_ns;
+    m_results.push_back(r);
+
+    double periter = total_ns / double(iterations);
+    double peritem = items > 0 ? periter / double(items) : periter ;
+    printf
+    (
+        "%-24s %-20s %8ld iters %12.1f ns/iter %10.2f ns/item\n",
+        name.c_str(), data.c_str(), iterations, periter, peritem
+    );
+}
+
+/**
+ *  Fills a pattern with a simple, deterministic pattern of notes.  The notes
+ *  are not on the grid, so that quantizing has work to do.
+ *
+ * \param s
+ *      The sequence to fill.  It should be installed in a perform object, so
+ *      that it has a parent.
+ *
+ * \param measures
+ *      The length of the pattern in 4/4 measures.
+ *
+ * \param notesperbeat
+ *      The number of notes in each quarter note.
+ *
+ * \param seed
+ *      Varies the note numbers from pattern to pattern.
+ */
+
+void
+benchmark::fill_pattern
+(
+    sequence & s, int measures, int notesperbeat, int seed
+)
+{
+    int ppqn = s.get_ppqn();
+    midipulse length = midipulse(measures) * 4 * ppqn;
+    midipulse step = ppqn / notesperbeat;
+    s.set_length(length, false, false);
+    for (midipulse t = 0; t < length; t += step)
+    {
+        int note = 36 + int((t / step + seed) % 48);
+        midipulse jitter = (t / step) % 5;
+        (void) s.add_note(t + jitter, step - 4, note, false, 100);
+    }
+    s.verify_and_link();
+}
+
+/**
+ *  Creates and fills a number of patterns in the perform object, starting at
+ *  slot 0.
+ */
+
+void
+benchmark::fill_perform
+(
+    perform & p, int count, int measures, int notesperbeat
+)
+{
+    for (int seq = 0; seq < count; ++seq)
+    {
+        p.new_sequence(seq);
+        sequence * s = p.get_sequence(seq);
+        if (not_nullptr(s))
+        {
+            fill_pattern(*s, measures, notesperbeat, seq);
+            s->set_midi_channel(midibyte(seq % 16));
+        }
+    }
+}
+
+/**
+ *  Measures event_list::add(), which keeps the list sorted, event_list::
+ *  append() followed by event_list::sort(), and event_list::merge().
+ */
+
+void
+benchmark::run_event_list ()
+{
+    const int count = 4096;
+    std::vector<event> events;
+    events.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        event e;
+        midipulse t = midipulse((i * 7919) % count) * 12;   /* shuffled     */
+        e.set_timestamp(t);
+        e.set_status((i % 2) == 0 ? EVENT_NOTE_ON : EVENT_NOTE_OFF);
+        e.set_data(midibyte(36 + i % 48), midibyte(100));
+        events.push_back(e);
+    }
+
+    long iters = iterations(2);                 /* add() sorts, slow    */
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        event_list el;
+        clock_type::time_point start = now();
+        for (int i = 0; i < count; ++i)
+            (void) el.add(events[i]);
+
+        total += elapsed_ns(start);
+    }
+    add_result("event_list_add", "synthetic", iters, count, total);
+
+    iters = iterations(20);
+    total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        event_list el;
+        clock_type::time_point start = now();
+        for (int i = 0; i < count; ++i)
+            (void) el.append(events[i]);
+
+        el.sort();
+        total += elapsed_ns(start);
+    }
+    add_result("event_list_append_sort", "synthetic", iters, count, total);
+
+    total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        event_list a;
+        event_list b;
+        for (int i = 0; i < count; ++i)
+        {
+            if ((i % 2) == 0)
+                (void) a.append(events[i]);
+            else
+                (void) b.append(events[i]);
+        }
+        clock_type::time_point start = now();
+        a.merge(b, true);
+        total += elapsed_ns(start);
+    }
+    add_result("event_list_merge", "synthetic", iters, count, total);
+}
+
+/**
+ *  Measures sequence::verify_and_link() on a dense pattern.
+ */
+
+void
+benchmark::run_verify_and_link ()
+{
+    perform p(m_gui);
+    fill_perform(p, 1, 16, 8);
+    sequence * s = p.get_sequence(0);
+    if (is_nullptr(s))
+        return;
+
+    long items = long(s->event_count());
+    long iters = iterations(100);
+    clock_type::time_point start = now();
+    for (long n = 0; n < iters; ++n)
+        s->verify_and_link();
+
+    add_result("verify_and_link", "synthetic", iters, items, elapsed_ns(start));
+}
+
+/**
+ *  Measures sequence::play() for a single pattern, one frame at a time, in
+ *  Live mode.  A frame here is one tick; the output thread usually plays
+ *  one or two ticks per frame at normal tempos.
+ */
+
+void
+benchmark::run_sequence_play ()
+{
+    perform p(m_gui);
+    fill_perform(p, 1, 4, 4);
+    sequence * s = p.get_sequence(0);
+    if (is_nullptr(s))
+        return;
+
+    s->set_playing(true);
+
+    const long frames = 4 * 4 * long(s->get_ppqn());        /* four bars */
+    long iters = iterations(20);
+    double total = 0.0;
+    midipulse tick = 0;
+    for (long n = 0; n < iters; ++n)
+    {
+        clock_type::time_point start = now();
+        for (long f = 0; f < frames; ++f)
+            s->play(tick++, false);
+
+        total += elapsed_ns(start);
+    }
+    s->set_playing(false);
+    add_result("sequence_play_frame", "synthetic", iters, frames, total);
+}
+
+/**
+ *  Measures sequence::quantize_events() on all of the notes in a pattern.
+ *  Since quantizing changes the pattern, it is rebuilt, untimed, before each
+ *  iteration.
+ */
+
+void
+benchmark::run_quantize ()
+{
+    perform p(m_gui);
+    long iters = iterations(20);
+    long items = 0;
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        fill_perform(p, 1, 16, 4);
+        sequence * s = p.get_sequence(0);
+        if (is_nullptr(s))
+            return;
+
+        s->select_all();
+        items = long(s->event_count());
+
+        clock_type::time_point start = now();
+        s->quantize_events(EVENT_NOTE_ON, 0, s->get_ppqn() / 4, 1, true);
+        total += elapsed_ns(start);
+        p.delete_sequence(0);
+    }
+    add_result("quantize_events", "synthetic", iters, items, total);
+}
+
+/**
+ *  Measures perform::midi_control_event().  The 32 pattern-toggle controls
+ *  are bound to Note On events; half of the incoming events match one of
+ *  them, the other half (Control Change) match nothing and so scan the whole
+ *  control table.
+ */
+
+void
+benchmark::run_midi_control ()
+{
+    perform p(m_gui);
+    fill_perform(p, c_seqs_in_set, 1, 1);
+    for (int ctl = 0; ctl < c_seqs_in_set; ++ctl)
+    {
+        int values[6] = { 1, 0, EVENT_NOTE_ON, 36 + ctl, 1, 127 };
+        p.midi_control_toggle(ctl).set(values);
+    }
+
+    const int count = 1024;
+    std::vector<event> events;
+    events.reserve(count);
+    for (int i = 0; i < count; ++i)
+    {
+        event e;
+        if ((i % 2) == 0)
+        {
+            e.set_status(EVENT_NOTE_ON);
+            e.set_data(midibyte(36 + (i / 2) % c_seqs_in_set), midibyte(100));
+        }
+        else
+        {
+            e.set_status(EVENT_CONTROL_CHANGE);
+            e.set_data(midibyte(i % 128), midibyte(64));
+        }
+        events.push_back(e);
+    }
+
+    long iters = iterations(20);
+    clock_type::time_point start = now();
+    for (long n = 0; n < iters; ++n)
+    {
+        for (int i = 0; i < count; ++i)
+            (void) p.midi_control_event(events[i]);
+    }
+    add_result("midi_control_event", "synthetic", iters, count, elapsed_ns(start));
+}
+
+/**
+ *  Measures perform::play() with every pattern slot (c_max_sequence, 1024)
+ *  filled and playing in Live mode, one tick per frame.
+ */
+
+void
+benchmark::run_perform_play ()
+{
+    perform p(m_gui);
+    fill_perform(p, c_max_sequence, 1, 4);
+    for (int seq = 0; seq < c_max_sequence; ++seq)
+    {
+        sequence * s = p.get_sequence(seq);
+        if (not_nullptr(s))
+            s->set_playing(true);
+    }
+
+    const long frames = 4 * long(p.get_ppqn());            /* one bar      */
+    long iters = iterations(2);
+    double total = 0.0;
+    midipulse tick = 0;
+    for (long n = 0; n < iters; ++n)
+    {
+        clock_type::time_point start = now();
+        for (long f = 0; f < frames; ++f)
+            p.play(tick++);
+
+        total += elapsed_ns(start);
+    }
+    p.reset_sequences();
+    add_result("perform_play_1024", "synthetic", iters, frames, total);
+}
+
+/**
+ *  Measures midifile::write() and midifile::parse() on a synthetic song of
+ *  64 patterns.
+ *
+ * \param tmpname
+ *      The name of the scratch file to write and then read back.
+ */
+
+void
+benchmark::run_midifile (const std::string & tmpname)
+{
+    const int count = 64;
+    perform p(m_gui);
+    fill_perform(p, count, 4, 4);
+
+    long iters = iterations(10);
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        midifile f(tmpname);
+        clock_type::time_point start = now();
+        bool ok = f.write(p);
+        total += elapsed_ns(start);
+        if (! ok)
+        {
+            printf("? midifile::write() failed\n");
+            return;
+        }
+    }
+    add_result("midifile_write", "synthetic", iters, count, total);
+    run_midifile_parse(tmpname);
+}
+
+/**
+ *  Measures midifile::parse() on the given file.  Each iteration parses into
+ *  a freshly-cleared perform object.
+ *
+ * \param filename
+ *      The MIDI file to parse.
+ */
+
+void
+benchmark::run_midifile_parse (const std::string & filename)
+{
+    if (! file_accessible(filename))
+    {
+        printf("? MIDI file not found: %s\n", filename.c_str());
+        return;
+    }
+
+    perform p(m_gui);
+    long iters = iterations(10);
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        (void) p.clear_all();
+        midifile f(filename);
+        clock_type::time_point start = now();
+        bool ok = f.parse(p);
+        total += elapsed_ns(start);
+        if (! ok)
+        {
+            printf("? MIDI file not parsed: %s\n", filename.c_str());
+            return;
+        }
+    }
+
+    std::string::size_type slash = filename.find_last_of("/");
+    std::string base = slash == std::string::npos ?
+        filename : filename.substr(slash + 1) ;
+
+    add_result("midifile_parse", base, iters, p.sequence_count(), total);
+}
+
+/**
+ *  Measures wrkfile::parse() on the given file, which reads the file one
+ *  chunk at a time.  Each iteration parses into a freshly-cleared perform
+ *  object.
+ *
+ * \param filename
+ *      The WRK file to parse.
+ */
+
+void
+benchmark::run_wrkfile_parse (const std::string & filename)
+{
+    if (! file_accessible(filename))
+    {
+        printf("? WRK file not found: %s\n", filename.c_str());
+        return;
+    }
+
+    perform p(m_gui);
+    long iters = iterations(10);
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        (void) p.clear_all();
+        wrkfile f(filename);
+        clock_type::time_point start = now();
+        bool ok = f.parse(p);
+        total += elapsed_ns(start);
+        if (! ok)
+        {
+            printf("? WRK file not parsed: %s\n", filename.c_str());
+            return;
+        }
+    }
+
+    std::string::size_type slash = filename.find_last_of("/");
+    std::string base = slash == std::string::npos ?
+        filename : filename.substr(slash + 1) ;
+
+    add_result("wrkfile_parse", base, iters, p.sequence_count(), total);
+}
+
+/**
+ *  Measures the two ways the importers have had of filling a sequence:
+ *  sequence::append_event() for each event, then sequence::sort_events(),
+ *  which is how the MIDI and WRK parsers used to load a track, and a
+ *  sequence_builder, which is how they load it now.  Both finish with the
+ *  set_length() call that links the notes, as midifile::link_sequence()
+ *  does.  The events are those of the sequences of the given file, in the
+ *  order the parser stored them.
+ *
+ * \param filename
+ *      The MIDI file providing the events.
+ */
+
+void
+benchmark::run_sequence_load (const std::string & filename)
+{
+    if (! file_accessible(filename))
+        return;                                 /* already reported     */
+
+    perform p(m_gui);
+    midifile f(filename);
+    if (! f.parse(p))
+        return;
+
+    std::vector< std::vector<event> > tracks;
+    std::vector<midipulse> lengths;
+    long items = 0;
+    for (int seq = 0; seq < c_max_sequence; ++seq)
+    {
+        sequence * s = p.get_sequence(seq);
+        if (not_nullptr(s) && s->event_count() > 0)
+        {
+            const event_list & evl = s->events();
+            std::vector<event> events;
+            events.reserve(evl.count());
+            for
+            (
+                event_list::const_iterator e = evl.begin();
+                e != evl.end(); ++e
+            )
+            {
+                events.push_back(event_list::dref(e));
+            }
+            items += long(events.size());
+            tracks.push_back(events);
+            lengths.push_back(s->get_length());
+        }
+    }
+    if (items == 0)
+        return;
+
+    std::string::size_type slash = filename.find_last_of("/");
+    std::string base = slash == std::string::npos ?
+        filename : filename.substr(slash + 1) ;
+
+    int ppqn = p.get_ppqn();
+    long iters = iterations(5);
+    double total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        for (size_t t = 0; t < tracks.size(); ++t)
+        {
+            const std::vector<event> & events = tracks[t];
+            sequence s(ppqn);
+            clock_type::time_point start = now();
+            for (size_t i = 0; i < events.size(); ++i)
+                (void) s.append_event(events[i]);
+
+            s.sort_events();
+            s.set_length(lengths[t], false);
+            total += elapsed_ns(start);
+        }
+    }
+    add_result("sequence_load_append", base, iters, items, total);
+
+    total = 0.0;
+    for (long n = 0; n < iters; ++n)
+    {
+        for (size_t t = 0; t < tracks.size(); ++t)
+        {
+            const std::vector<event> & events = tracks[t];
+            sequence s(ppqn);
+            clock_type::time_point start = now();
+            sequence_builder builder;
+            for (size_t i = 0; i < events.size(); ++i)
+                builder.append(events[i]);
+
+            builder.commit(s);
+            s.set_length(lengths[t], false);
+            total += elapsed_ns(start);
+        }
+    }
+    add_result("sequence_load_builder", base, iters, items, total);
+}
+
+/**
+ *  Measures sequence::play() on the longest track of the given file, once
+ *  with its events loaded, and once streamed from the track data, as done
+ *  for "-o stream=kb".  With the events loaded, each frame walks the event
+ *  list from its start, so the cost grows with the position in the track.
+ *  The streamed pattern decodes only the events of the frame.
+ *
+ * \param filename
+ *      The MIDI file providing the track.
+ */
+
+void
+benchmark::run_sequence_stream (const std::string & filename)
+{
+    if (! file_accessible(filename))
+        return;                                 /* already reported     */
+
+    perform loaded(m_gui);
+    perform streamed(m_gui);
+    midifile f(filename);
+    midifile g(filename);
+    g.stream_bytes(1);                          /* stream every track   */
+    if (! f.parse(loaded) || ! g.parse(streamed))
+        return;
+
+    int longest = -1;
+    int count = 0;
+    for (int seq = 0; seq < c_max_sequence; ++seq)
+    {
+        sequence * s = loaded.get_sequence(seq);
+        if (not_nullptr(s) && s->event_count() > count)
+        {
+            longest = seq;
+            count = s->event_count();
+        }
+    }
+    if (longest < 0)
+        return;
+
+    sequence * s = streamed.get_sequence(longest);
+    if (is_nullptr(s) || ! s->streaming())
+        return;                                 /* e.g. an SMF 0 file   */
+
+    std::string::size_type slash = filename.find_last_of("/");
+    std::string base = slash == std::string::npos ?
+        filename : filename.substr(slash + 1) ;
+
+    play_frames(*loaded.get_sequence(longest), "sequence_play_loaded", base);
+    play_frames(*s, "sequence_play_streamed", base);
+}
+
+/**
+ *  Plays four bars of a pattern, one tick per frame, from the middle of the
+ *  pattern, as run_sequence_play() does from its start.
+ *
+ * \param s
+ *      The pattern to play.
+ *
+ * \param name
+ *      The name of the result.
+ *
+ * \param data
+ *      The name of the data, normally the base name of the file.
+ */
+
+void
+benchmark::play_frames
+(
+    sequence & s, const std::string & name, const std::string & data
+)
+{
+    const long frames = 4 * 4 * long(s.get_ppqn());        /* four bars */
+    midipulse middle = s.get_length() / 2;
+    long iters = iterations(2);
+    double total = 0.0;
+    s.set_playing(true);
+    for (long n = 0; n < iters; ++n)
+    {
+        midipulse tick = middle;
+        s.set_last_tick(tick);
+        clock_type::time_point start = now();
+        for (long f = 0; f < frames; ++f)
+            s.play(tick++, false);
+
+        total += elapsed_ns(start);
+    }
+    s.set_playing(false);
+    add_result(name, data, iters, frames, total);
+}
+
+/**
+ *  Makes a string safe to put between the quotes of a JSON string:  quotes
+ *  and backslashes are escaped, and other control characters are written
+ *  as "\\u" escapes.
+ *
+ * \param s
+ *      The string, normally the name of a file.
+ *
+ * \return
+ *      Returns the escaped string, without the surrounding quotes.
+ */
+
+static std::string
+json_escape (const std::string & s)
+{
+    std::string result;
+    for (std::string::const_iterator c = s.begin(); c != s.end(); ++c)
+    {
+        unsigned char ch = (unsigned char)(*c);
+        if (ch == '"' || ch == '\\')
+        {
+            result += '\\';
+            result += char(ch);
+        }
+        else if (ch < 0x20)
+        {
+            char tmp[8];
+            snprintf(tmp, sizeof tmp, "\\u%04x", unsigned(ch));
+            result += tmp;
+        }
+        else
+            result += char(ch);
+    }
+    return result;
+}
+
+/**
+ *  Writes all the results as a JSON document.
+ *
+\verbatim
+    {
+        "benchmark": "seq64bench",
+        "version": "0.96.0",
+        "ppqn": 192,
+        "scale": 1,
+        "results":
+        [
+            {
+                "name": "event_list_add",
+                "data": "synthetic",
+                "iterations": 10,
+                "items": 4096,
+                "ns_per_iteration": 123456.7,
+                "ns_per_item": 30.1
+            },
+            ...
+        ]
+    }
+\endverbatim
+ *
+ * \param filename
+ *      The destination file.  If "-", the JSON goes to standard output.
+ *
+ * \return
+ *      Returns true if the file could be written.
+ */
+
+bool
+benchmark::write_json (const std::string & filename) const
+{
+    bool tostdout = filename == "-";
+    FILE * fp = tostdout ? stdout : fopen(filename.c_str(), "w");
+    if (is_nullptr(fp))
+    {
+        printf("? Cannot open %s\n", filename.c_str());
+        return false;
+    }
+    fprintf(fp, "{\n");
+    fprintf(fp, "    \"benchmark\": \"seq64bench\",\n");
+    fprintf(fp, "    \"version\": \"%s\",\n", SEQ64_VERSION);
+    fprintf(fp, "    \"ppqn\": %d,\n", SEQ64_DEFAULT_PPQN);
+    fprintf(fp, "    \"scale\": %d,\n", m_scale);
+    fprintf(fp, "    \"results\":\n    [\n");
+    for (size_t i = 0; i < m_results.size(); ++i)
+    {
+        const bench_result & r = m_results[i];
+        double periter = r.m_total_ns / double(r.m_iterations);
+        double peritem = r.m_items > 0 ? periter / double(r.m_items) : periter ;
+        fprintf
+        (
+            fp,
+            "        {\n"
+            "            \"name\": \"%s\",\n"
+            "            \"data\": \"%s\",\n"
+            "            \"iterations\": %ld,\n"
+            "            \"items\": %ld,\n"
+            "            \"ns_per_iteration\": %.1f,\n"
+            "            \"ns_per_item\": %.3f\n"
+            "        }%s\n",
+            json_escape(r.m_name).c_str(), json_escape(r.m_data).c_str(),
+            r.m_iterations, r.m_items,
+            periter, peritem, (i + 1) < m_results.size() ? "," : ""
+        );
+    }
+    fprintf(fp, "    ]\n}\n");
+    if (! tostdout)
+    {
+        fclose(fp);
+        printf("[Wrote benchmark results to '%s']\n", filename.c_str());
+    }
+    return true;
+}
+
+}           // namespace seq64
+
+/**
+ *  The standard C/C++ entry point to this application.  Options are
+ *  "--output file" (or "-o file"), "--scale n" (or "-s n"), and "--help".
+ *  Any other arguments are taken to be MIDI files to be parsed.
+ *
+ * \param argc
+ *      The number of command-line parameters, including the name of the
+ *      application as parameter 0.
+ *
+ * \param argv
+ *      The array of pointers to the command-line parameters.
+ *
+ * \return
+ *      Returns EXIT_SUCCESS (0) or EXIT_FAILURE, depending on the status of
+ *      writing the results.
+ */
+
+int
+main (int argc, char * argv [])
+{
+    std::string outfile = "seq64bench.json";
+    std::string tmpfile = "seq64bench.midi";
+    std::vector<std::string> midifiles;
+    int scale = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char * arg = argv[i];
+        bool hasvalue = (i + 1) < argc;
+        if ((strcmp(arg, "--output") == 0 || strcmp(arg, "-o") == 0) && hasvalue)
+            outfile = argv[++i];
+        else if ((strcmp(arg, "--scale") == 0 || strcmp(arg, "-s") == 0) && hasvalue)
+            scale = atoi(argv[++i]);
+        else if (strcmp(arg, "--help") == 0 || strcmp(arg, "-h") == 0)
+        {
+            printf
+            (
+                "Usage: seq64bench [ --output file.json | - ] [ --scale n ] "
+                "[ file.midi|.wrk ... ]\n"
+            );
+            return EXIT_SUCCESS;
+        }
+        else
+            midifiles.push_back(std::string(arg));
+    }
+
+    seq64::rc().set_defaults();             /* start out with normal values */
+    seq64::usr().set_defaults();            /* start out with normal values */
+
+    seq64::benchmark bench(scale);
+    bench.run_event_list();
+    bench.run_verify_and_link();
+    bench.run_sequence_play();
+    bench.run_quantize();
+    bench.run_midi_control();
+    bench.run_perform_play();
+    bench.run_midifile(tmpfile);
+    for (size_t f = 0; f < midifiles.size(); ++f)
+    {
+        if (seq64::file_extension_match(midifiles[f], "wrk"))
+        {
+            bench.run_wrkfile_parse(midifiles[f]);
+        }
+        else
+        {
+            bench.run_midifile_parse(midifiles[f]);
+            bench.run_sequence_load(midifiles[f]);
+            bench.run_sequence_stream(midifiles[f]);
+        }
+    }
+
+    (void) remove(tmpfile.c_str());
+    return bench.write_json(outfile) ? EXIT_SUCCESS : EXIT_FAILURE ;
+}
+
+/*
+ * seq64bench.cpp
+ *
+ * vim: sw=4 ts=4 wm=4 et ft=cpp
+ */
+